@@ -0,0 +1,150 @@
+#include "AllocationTracker.h"
+#include "Counters.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+    const char* const OVERFLOW_PHASE = "overflow";
+
+    struct PhaseSlot {
+        std::atomic<const char*> name;
+        std::atomic<uint64_t> allocations;
+        std::atomic<uint64_t> bytes;
+    };
+
+    // Fixed table so that attributing an allocation never allocates. Slots
+    // are claimed once per distinct name pointer and never released.
+    PhaseSlot gPhases[AllocationTracker::MAX_PHASES];
+    PhaseSlot gOverflow;
+
+    thread_local uint64_t tAllocations = 0;
+
+#ifdef BOMBERMAN_TRACK_ALLOCATIONS
+    const char* const UNTRACKED_PHASE = "untracked";
+
+    PhaseSlot& findPhase(const char* name) {
+        for (auto& slot : gPhases) {
+            const char* current = slot.name.load(std::memory_order_acquire);
+            if (current == name) return slot;
+            if (!current) {
+                const char* expected = nullptr;
+                if (slot.name.compare_exchange_strong(expected, name, std::memory_order_acq_rel) || expected == name) {
+                    return slot;
+                }
+            }
+        }
+        return gOverflow;
+    }
+#endif
+
+    void recordAllocation(std::size_t size) {
+        COUNTER_ADD(Counter::HEAP_ALLOCATIONS, 1);
+        ++tAllocations;
+#ifdef BOMBERMAN_TRACK_ALLOCATIONS
+        const char* phase = AllocationTracker::getCurrentPhase();
+        PhaseSlot& slot = findPhase(phase ? phase : UNTRACKED_PHASE);
+        slot.allocations.fetch_add(1, std::memory_order_relaxed);
+        slot.bytes.fetch_add(size, std::memory_order_relaxed);
+#else
+        (void)size;
+#endif
+    }
+}
+
+bool AllocationTracker::isTrackingPhases() {
+#ifdef BOMBERMAN_TRACK_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t AllocationTracker::getThreadAllocations() {
+    return tAllocations;
+}
+
+std::vector<AllocationPhaseStats> AllocationTracker::getPhaseStats() {
+    std::vector<AllocationPhaseStats> stats;
+    auto add = [&stats](const char* name, const PhaseSlot& slot) {
+        uint64_t allocations = slot.allocations.load(std::memory_order_relaxed);
+        if (allocations == 0) return;
+        uint64_t bytes = slot.bytes.load(std::memory_order_relaxed);
+        // The same literal may live at different addresses in different
+        // translation units; merge those by text.
+        for (auto& entry : stats) {
+            if (std::strcmp(entry.name, name) == 0) {
+                entry.allocations += allocations;
+                entry.bytes += bytes;
+                return;
+            }
+        }
+        stats.push_back({ name, allocations, bytes });
+    };
+    for (const auto& slot : gPhases) {
+        const char* name = slot.name.load(std::memory_order_acquire);
+        if (name) add(name, slot);
+    }
+    add(OVERFLOW_PHASE, gOverflow);
+    std::sort(stats.begin(), stats.end(), [](const AllocationPhaseStats& a, const AllocationPhaseStats& b) {
+        return a.allocations > b.allocations;
+    });
+    return stats;
+}
+
+void AllocationTracker::resetPhaseStats() {
+    for (auto& slot : gPhases) {
+        slot.allocations.store(0, std::memory_order_relaxed);
+        slot.bytes.store(0, std::memory_order_relaxed);
+    }
+    gOverflow.allocations.store(0, std::memory_order_relaxed);
+    gOverflow.bytes.store(0, std::memory_order_relaxed);
+}
+
+// Only the plain and array forms are replaced; the aligned forms keep the
+// runtime's own allocator, which on some platforms cannot be paired with
+// free().
+void* operator new(std::size_t size) {
+    recordAllocation(size);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    recordAllocation(size);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
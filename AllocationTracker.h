@@ -0,0 +1,75 @@
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+#include <cstdint>
+#include <vector>
+
+// Global operator new is replaced in every executable (the bomberman_env
+// library keeps its host's allocator): each allocation bumps
+// Counter::HEAP_ALLOCATIONS and a per-thread total. Debug builds (no NDEBUG)
+// also attribute the count and bytes to the innermost ALLOCATION_PHASE active
+// on the allocating thread, so a stray allocation can be traced to the part of
+// the frame that made it. Define BOMBERMAN_NO_ALLOCATION_TRACKING to keep the
+// phases out of a debug build.
+#if !defined(NDEBUG) && !defined(BOMBERMAN_NO_ALLOCATION_TRACKING)
+#define BOMBERMAN_TRACK_ALLOCATIONS
+#endif
+
+struct AllocationPhaseStats {
+    const char* name;
+    uint64_t allocations;
+    uint64_t bytes;
+};
+
+class AllocationTracker {
+public:
+    // Distinct phase names; allocations in further phases go to "overflow".
+    static const int MAX_PHASES = 64;
+
+    static bool isTrackingPhases();
+
+    // Allocations made by the calling thread since it started.
+    static uint64_t getThreadAllocations();
+
+    // Names must be string literals. enterPhase returns the phase to restore.
+    // Inline so that core code can mark phases without linking the tracker,
+    // which only the executables do.
+    static const char* enterPhase(const char* name) {
+        const char* previous = tPhase;
+        tPhase = name;
+        return previous;
+    }
+    static void leavePhase(const char* previous) { tPhase = previous; }
+    // Innermost phase on the calling thread, or nullptr outside any.
+    static const char* getCurrentPhase() { return tPhase; }
+
+    // Totals per phase across all threads, busiest first. Allocations outside
+    // any phase are reported as "untracked".
+    static std::vector<AllocationPhaseStats> getPhaseStats();
+    static void resetPhaseStats();
+
+private:
+    static inline thread_local const char* tPhase = nullptr;
+};
+
+class AllocationPhase {
+public:
+    explicit AllocationPhase(const char* name) : mPrevious(AllocationTracker::enterPhase(name)) {}
+    ~AllocationPhase() { AllocationTracker::leavePhase(mPrevious); }
+
+    AllocationPhase(const AllocationPhase&) = delete;
+    AllocationPhase& operator=(const AllocationPhase&) = delete;
+
+private:
+    const char* mPrevious;
+};
+
+#ifdef BOMBERMAN_TRACK_ALLOCATIONS
+#define ALLOCATION_CONCAT_INNER(a, b) a##b
+#define ALLOCATION_CONCAT(a, b) ALLOCATION_CONCAT_INNER(a, b)
+#define ALLOCATION_PHASE(name) AllocationPhase ALLOCATION_CONCAT(allocationPhase, __LINE__)(name)
+#else
+#define ALLOCATION_PHASE(name) ((void)0)
+#endif
+
+#endif // ALLOCATION_TRACKER_H
@@ -0,0 +1,204 @@
+#include "AssetArchive.h"
+#include <SDL.h>
+#include <SDL_image.h>
+#include <SDL_mixer.h>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace {
+    const char ARCHIVE_MAGIC[4] = { 'B', 'M', 'P', 'K' };
+
+    bool hasExtension(const std::string& path, const char* extension) {
+        size_t length = std::strlen(extension);
+        return path.size() >= length && path.compare(path.size() - length, length, extension) == 0;
+    }
+
+    // The loader wraps texture payloads in an SDL_Surface as they stand, so
+    // every row the header describes has to lie inside the entry.
+    bool hasValidPixels(const ArchiveEntry& entry) {
+        if (entry.kind != static_cast<uint32_t>(ArchiveEntryKind::TEXTURE_RGBA32)) return true;
+        return static_cast<uint64_t>(entry.width) * 4 <= entry.pitch
+            && static_cast<uint64_t>(entry.pitch) * entry.height <= entry.size
+            && entry.pitch <= static_cast<uint32_t>(std::numeric_limits<int>::max())
+            && entry.height <= static_cast<uint32_t>(std::numeric_limits<int>::max());
+    }
+
+    bool readWholeFile(const std::string& path, std::vector<uint8_t>& out) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) return false;
+        std::streamsize size = file.tellg();
+        file.seekg(0, std::ios::beg);
+        out.resize(static_cast<size_t>(size));
+        return size == 0 || static_cast<bool>(file.read(reinterpret_cast<char*>(out.data()), size));
+    }
+}
+
+bool AssetArchive::open(const std::string& path) {
+    mIndex.clear();
+    if (!mFile.open(path)) return false;
+
+    const size_t fileSize = mFile.size();
+    if (fileSize < sizeof(ArchiveHeader)) {
+        std::cerr << "AssetArchive Error: '" << path << "' is too small to be an archive." << std::endl;
+        mFile.close();
+        return false;
+    }
+    const ArchiveHeader* header = reinterpret_cast<const ArchiveHeader*>(mFile.data());
+    if (std::memcmp(header->magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0 || header->version != ARCHIVE_VERSION) {
+        std::cerr << "AssetArchive Error: '" << path << "' has an unknown format or version." << std::endl;
+        mFile.close();
+        return false;
+    }
+    if (sizeof(ArchiveHeader) + static_cast<size_t>(header->entryCount) * sizeof(ArchiveEntry) > fileSize) {
+        std::cerr << "AssetArchive Error: '" << path << "' has a truncated index." << std::endl;
+        mFile.close();
+        return false;
+    }
+
+    const ArchiveEntry* entries = reinterpret_cast<const ArchiveEntry*>(mFile.data() + sizeof(ArchiveHeader));
+    for (uint32_t i = 0; i < header->entryCount; ++i) {
+        const ArchiveEntry& entry = entries[i];
+        std::string name(entry.name, strnlen(entry.name, ARCHIVE_NAME_LENGTH));
+        if (static_cast<size_t>(entry.offset) + entry.size > fileSize) {
+            std::cerr << "AssetArchive Warning: Skipping truncated entry '" << name << "'." << std::endl;
+            continue;
+        }
+        if (!hasValidPixels(entry)) {
+            std::cerr << "AssetArchive Warning: Skipping texture '" << name << "' whose rows do not fit its entry." << std::endl;
+            continue;
+        }
+        mIndex[name] = &entry;
+    }
+    return true;
+}
+
+const ArchiveEntry* AssetArchive::find(const std::string& name) const {
+    auto it = mIndex.find(name);
+    return it != mIndex.end() ? it->second : nullptr;
+}
+
+bool buildAssetArchive(const std::string& outputPath, const std::vector<std::string>& inputPaths) {
+    std::vector<ArchiveEntry> entries;
+    std::vector<std::vector<uint8_t>> payloads;
+
+    for (const auto& path : inputPaths) {
+        if (path.size() >= ARCHIVE_NAME_LENGTH) {
+            std::cerr << "AssetArchive Error: Asset name too long: " << path << std::endl;
+            return false;
+        }
+        if (!std::ifstream(path, std::ios::binary)) {
+            std::cerr << "AssetArchive Warning: '" << path << "' not found, leaving it out of the archive." << std::endl;
+            continue;
+        }
+        ArchiveEntry entry;
+        std::memset(&entry, 0, sizeof(entry));
+        std::memcpy(entry.name, path.c_str(), path.size());
+        std::vector<uint8_t> payload;
+
+        if (hasExtension(path, ".png")) {
+            SDL_Surface* loaded = IMG_Load(path.c_str());
+            SDL_Surface* rgba = loaded ? SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0) : nullptr;
+            if (loaded) SDL_FreeSurface(loaded);
+            if (!rgba) {
+                std::cerr << "AssetArchive Error: Failed to decode '" << path << "'. SDL_image Error: " << IMG_GetError() << std::endl;
+                return false;
+            }
+            entry.kind = static_cast<uint32_t>(ArchiveEntryKind::TEXTURE_RGBA32);
+            entry.width = static_cast<uint32_t>(rgba->w);
+            entry.height = static_cast<uint32_t>(rgba->h);
+            entry.pitch = entry.width * 4;
+            payload.resize(static_cast<size_t>(entry.pitch) * entry.height);
+            SDL_LockSurface(rgba);
+            for (int row = 0; row < rgba->h; ++row) {
+                std::memcpy(payload.data() + static_cast<size_t>(row) * entry.pitch,
+                    static_cast<const uint8_t*>(rgba->pixels) + static_cast<size_t>(row) * rgba->pitch, entry.pitch);
+            }
+            SDL_UnlockSurface(rgba);
+            SDL_FreeSurface(rgba);
+        }
+        else if (hasExtension(path, ".wav")) {
+            int frequency = 0, channels = 0;
+            Uint16 format = 0;
+            Mix_Chunk* chunk = Mix_LoadWAV(path.c_str());
+            if (!chunk || !Mix_QuerySpec(&frequency, &format, &channels)) {
+                std::cerr << "AssetArchive Error: Failed to decode '" << path << "'. Mix_Error: " << Mix_GetError() << std::endl;
+                if (chunk) Mix_FreeChunk(chunk);
+                return false;
+            }
+            entry.kind = static_cast<uint32_t>(ArchiveEntryKind::AUDIO_PCM);
+            entry.audioFrequency = static_cast<uint32_t>(frequency);
+            entry.audioFormat = format;
+            entry.audioChannels = static_cast<uint16_t>(channels);
+            payload.assign(chunk->abuf, chunk->abuf + chunk->alen);
+            Mix_FreeChunk(chunk);
+        }
+        else {
+            if (!readWholeFile(path, payload)) {
+                std::cerr << "AssetArchive Error: Failed to read '" << path << "'." << std::endl;
+                return false;
+            }
+            entry.kind = static_cast<uint32_t>(ArchiveEntryKind::RAW);
+        }
+
+        entry.size = static_cast<uint32_t>(payload.size());
+        entries.push_back(entry);
+        payloads.push_back(std::move(payload));
+    }
+
+    size_t offset = sizeof(ArchiveHeader) + entries.size() * sizeof(ArchiveEntry);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        offset = (offset + ARCHIVE_ALIGNMENT - 1) / ARCHIVE_ALIGNMENT * ARCHIVE_ALIGNMENT;
+        entries[i].offset = static_cast<uint32_t>(offset);
+        offset += entries[i].size;
+    }
+
+    std::ofstream out(outputPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "AssetArchive Error: Cannot open '" << outputPath << "' for writing." << std::endl;
+        return false;
+    }
+    ArchiveHeader header;
+    std::memcpy(header.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+    header.version = ARCHIVE_VERSION;
+    header.entryCount = static_cast<uint32_t>(entries.size());
+    header.reserved = 0;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(ArchiveEntry));
+
+    size_t written = sizeof(ArchiveHeader) + entries.size() * sizeof(ArchiveEntry);
+    const char padding[ARCHIVE_ALIGNMENT] = {};
+    for (size_t i = 0; i < entries.size(); ++i) {
+        out.write(padding, entries[i].offset - written);
+        out.write(reinterpret_cast<const char*>(payloads[i].data()), payloads[i].size());
+        written = entries[i].offset + entries[i].size;
+    }
+    if (!out) {
+        std::cerr << "AssetArchive Error: Failed while writing '" << outputPath << "'." << std::endl;
+        return false;
+    }
+    std::cout << "Asset archive written: " << outputPath << " (" << entries.size() << " entries, " << written << " bytes)" << std::endl;
+    return true;
+}
+
+const std::vector<std::string>& defaultArchiveInputs() {
+    static const std::vector<std::string> inputs = {
+        "game_font.otf",
+        "menu_background.png",
+        "menu_music.mp3",
+        "ingame_music.mp3",
+        "explosion_sound.wav",
+        "player.png",
+        "enemies.png",
+        "background.png",
+        "hard_wall.png",
+        "border_wall.png",
+        "bomb.png",
+        "explosion.png",
+        "soft_wall_1.png",
+        "soft_wall_2.png",
+        "soft_wall_3.png"
+    };
+    return inputs;
+}
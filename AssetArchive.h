@@ -0,0 +1,69 @@
+#ifndef ASSET_ARCHIVE_H
+#define ASSET_ARCHIVE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "MappedFile.h"
+
+// On-disk layout of assets.pak:
+//   ArchiveHeader | ArchiveEntry[entryCount] | payloads (each ARCHIVE_ALIGNMENT aligned)
+// Textures are stored as RGBA32 rows, sound effects as PCM in the mixer's
+// device format, and everything else (music, fonts) as the original file bytes.
+// All integers are little-endian.
+
+const uint32_t ARCHIVE_VERSION = 1;
+const uint32_t ARCHIVE_ALIGNMENT = 64;
+const size_t ARCHIVE_NAME_LENGTH = 48;
+
+enum class ArchiveEntryKind : uint32_t {
+    RAW = 0,
+    TEXTURE_RGBA32 = 1,
+    AUDIO_PCM = 2
+};
+
+struct ArchiveHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct ArchiveEntry {
+    char name[ARCHIVE_NAME_LENGTH];
+    uint32_t kind;
+    uint32_t offset;
+    uint32_t size;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;
+    uint32_t audioFrequency;
+    uint16_t audioFormat;
+    uint16_t audioChannels;
+};
+
+// Read-only view over a memory-mapped archive. Payload pointers stay valid
+// for the lifetime of the AssetArchive object.
+class AssetArchive {
+public:
+    bool open(const std::string& path);
+
+    bool isOpen() const { return mFile.data() != nullptr; }
+    const ArchiveEntry* find(const std::string& name) const;
+    const uint8_t* payload(const ArchiveEntry& entry) const { return mFile.data() + entry.offset; }
+
+private:
+    MappedFile mFile;
+    std::unordered_map<std::string, const ArchiveEntry*> mIndex;
+};
+
+// Decodes the given loose files and writes them into a new archive.
+// Needs SDL_image initialised and the mixer opened with the same spec the game uses.
+bool buildAssetArchive(const std::string& outputPath, const std::vector<std::string>& inputPaths);
+
+// Every loose asset the game loads at runtime.
+const std::vector<std::string>& defaultArchiveInputs();
+
+#endif // ASSET_ARCHIVE_H
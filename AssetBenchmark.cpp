@@ -0,0 +1,83 @@
+#include "AssetBenchmark.h"
+#include "AssetArchive.h"
+#include <SDL_image.h>
+#include <SDL_mixer.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace {
+    double millisecondsSince(Uint64 start) {
+        return (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    }
+
+    bool isTexture(const std::string& path) {
+        return path.size() > 4 && path.compare(path.size() - 4, 4, ".png") == 0;
+    }
+
+    bool isSound(const std::string& path) {
+        return path.size() > 4 && path.compare(path.size() - 4, 4, ".wav") == 0;
+    }
+
+    double loadLoose(SDL_Renderer* renderer) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (const auto& path : defaultArchiveInputs()) {
+            if (isTexture(path)) {
+                SDL_Texture* texture = IMG_LoadTexture(renderer, path.c_str());
+                if (texture) SDL_DestroyTexture(texture);
+            }
+            else if (isSound(path)) {
+                Mix_Chunk* chunk = Mix_LoadWAV(path.c_str());
+                if (chunk) Mix_FreeChunk(chunk);
+            }
+        }
+        return millisecondsSince(start);
+    }
+
+    double loadArchive(SDL_Renderer* renderer, const std::string& archivePath) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        AssetArchive archive;
+        if (!archive.open(archivePath)) return -1.0;
+        for (const auto& path : defaultArchiveInputs()) {
+            const ArchiveEntry* entry = archive.find(path);
+            if (!entry) continue;
+            if (entry->kind == static_cast<uint32_t>(ArchiveEntryKind::TEXTURE_RGBA32)) {
+                SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(const_cast<uint8_t*>(archive.payload(*entry)),
+                    static_cast<int>(entry->width), static_cast<int>(entry->height), 32, static_cast<int>(entry->pitch), SDL_PIXELFORMAT_RGBA32);
+                SDL_Texture* texture = surface ? SDL_CreateTextureFromSurface(renderer, surface) : nullptr;
+                if (surface) SDL_FreeSurface(surface);
+                if (texture) SDL_DestroyTexture(texture);
+            }
+            else if (entry->kind == static_cast<uint32_t>(ArchiveEntryKind::AUDIO_PCM)) {
+                Mix_Chunk* chunk = Mix_QuickLoad_RAW(const_cast<uint8_t*>(archive.payload(*entry)), entry->size);
+                if (chunk) Mix_FreeChunk(chunk);
+            }
+        }
+        return millisecondsSince(start);
+    }
+
+    void report(const char* label, std::vector<double>& samples) {
+        if (samples.empty()) return;
+        std::sort(samples.begin(), samples.end());
+        std::cout << label << ": median " << samples[samples.size() / 2] << " ms, best " << samples.front()
+            << " ms over " << samples.size() << " runs" << std::endl;
+    }
+}
+
+void runAssetStartupBenchmark(SDL_Renderer* renderer, const std::string& archivePath, int iterations) {
+    if (!renderer || iterations <= 0) return;
+
+    std::vector<double> looseSamples;
+    std::vector<double> archiveSamples;
+    for (int i = 0; i < iterations; ++i) {
+        looseSamples.push_back(loadLoose(renderer));
+        double archiveTime = loadArchive(renderer, archivePath);
+        if (archiveTime < 0.0) {
+            std::cerr << "AssetBenchmark Error: Cannot open archive '" << archivePath << "'. Run with --pack-assets first." << std::endl;
+            return;
+        }
+        archiveSamples.push_back(archiveTime);
+    }
+    report("Loose PNG/WAV", looseSamples);
+    report("Packed archive", archiveSamples);
+}
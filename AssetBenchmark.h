@@ -0,0 +1,12 @@
+#ifndef ASSET_BENCHMARK_H
+#define ASSET_BENCHMARK_H
+
+#include <SDL.h>
+#include <string>
+
+// Times loading every game texture and sound effect from loose files
+// (PNG/WAV decode) against the pre-decoded, memory-mapped archive.
+// Prints the median and best time of each path over the given iterations.
+void runAssetStartupBenchmark(SDL_Renderer* renderer, const std::string& archivePath, int iterations);
+
+#endif // ASSET_BENCHMARK_H
@@ -0,0 +1,302 @@
+#include "AssetLoader.h"
+#include "Profiler.h"
+#include <SDL_image.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+AssetLoader::AssetLoader(Renderer* renderer, int workerCount, size_t maxPendingUploads)
+    : mRenderer(renderer),
+    mMaxPendingUploads(std::max<size_t>(1, maxPendingUploads)),
+    mOutstanding(0),
+    mStopping(false)
+{
+    if (workerCount <= 0) {
+        int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+        workerCount = std::max(1, std::min(4, hardwareThreads - 1));
+    }
+    for (int i = 0; i < workerCount; ++i) {
+        mWorkers.emplace_back(&AssetLoader::workerLoop, this);
+    }
+}
+
+AssetLoader::~AssetLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mJobAvailable.notify_all();
+    mCompletedNotFull.notify_all();
+    for (auto& worker : mWorkers) {
+        if (worker.joinable()) worker.join();
+    }
+    for (auto& job : mCompleted) {
+        releaseUndelivered(*job);
+    }
+}
+
+bool AssetLoader::openArchive(const std::string& path) {
+    if (!mArchive.open(path)) {
+        std::cout << "AssetLoader Info: No asset archive at '" << path << "', loading loose files." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void AssetLoader::requestTexture(const std::string& path, TextureCallback onReady) {
+    auto job = std::make_unique<Job>();
+    job->kind = AssetKind::TEXTURE;
+    job->path = path;
+    job->onTexture = std::move(onReady);
+    enqueue(std::move(job));
+}
+
+void AssetLoader::requestMusic(const std::string& path, MusicCallback onReady) {
+    auto job = std::make_unique<Job>();
+    job->kind = AssetKind::MUSIC;
+    job->path = path;
+    job->onMusic = std::move(onReady);
+    enqueue(std::move(job));
+}
+
+void AssetLoader::requestChunk(const std::string& path, ChunkCallback onReady) {
+    auto job = std::make_unique<Job>();
+    job->kind = AssetKind::CHUNK;
+    job->path = path;
+    job->onChunk = std::move(onReady);
+    enqueue(std::move(job));
+}
+
+void AssetLoader::requestFont(const std::string& path, int pointSize, FontCallback onReady) {
+    auto job = std::make_unique<Job>();
+    job->kind = AssetKind::FONT;
+    job->path = path;
+    job->pointSize = pointSize;
+    job->onFont = std::move(onReady);
+    enqueue(std::move(job));
+}
+
+void AssetLoader::enqueue(std::unique_ptr<Job> job) {
+    ++mOutstanding;
+    job->archiveEntry = findArchiveEntry(*job);
+    if (job->archiveEntry) {
+        mArchiveJobs.push_back(std::move(job));
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mJobs.push_back(std::move(job));
+    }
+    mJobAvailable.notify_one();
+}
+
+const ArchiveEntry* AssetLoader::findArchiveEntry(const Job& job) const {
+    if (!mArchive.isOpen()) return nullptr;
+    const ArchiveEntry* entry = mArchive.find(job.path);
+    if (!entry) return nullptr;
+
+    ArchiveEntryKind kind = static_cast<ArchiveEntryKind>(entry->kind);
+    switch (job.kind) {
+    case AssetKind::TEXTURE:
+        return kind == ArchiveEntryKind::TEXTURE_RGBA32 ? entry : nullptr;
+    case AssetKind::CHUNK:
+    {
+        // PCM is only usable in place if it was baked for the device format we opened.
+        int frequency = 0, channels = 0;
+        Uint16 format = 0;
+        if (kind != ArchiveEntryKind::AUDIO_PCM || !Mix_QuerySpec(&frequency, &format, &channels)) return nullptr;
+        if (entry->audioFrequency != static_cast<uint32_t>(frequency) || entry->audioFormat != format ||
+            entry->audioChannels != channels) {
+            return nullptr;
+        }
+        return entry;
+    }
+    case AssetKind::MUSIC:
+    case AssetKind::FONT:
+        return kind == ArchiveEntryKind::RAW ? entry : nullptr;
+    }
+    return nullptr;
+}
+
+void AssetLoader::workerLoop() {
+    while (true) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mJobAvailable.wait(lock, [this] { return mStopping || !mJobs.empty(); });
+            if (mStopping) return;
+            job = std::move(mJobs.front());
+            mJobs.pop_front();
+        }
+
+        decode(*job);
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCompletedNotFull.wait(lock, [this] { return mStopping || mCompleted.size() < mMaxPendingUploads; });
+        if (mStopping) {
+            releaseUndelivered(*job);
+            return;
+        }
+        mCompleted.push_back(std::move(job));
+        lock.unlock();
+        mCompletedAvailable.notify_one();
+    }
+}
+
+void AssetLoader::decode(Job& job) {
+    PROFILE_SCOPE("asset.decode");
+    switch (job.kind) {
+    case AssetKind::TEXTURE:
+        job.surface = IMG_Load(job.path.c_str());
+        if (!job.surface) {
+            std::cerr << "AssetLoader Error: Failed to decode image '" << job.path << "'. SDL_image Error: " << IMG_GetError() << std::endl;
+        }
+        break;
+    case AssetKind::MUSIC:
+        job.music = Mix_LoadMUS(job.path.c_str());
+        if (!job.music) {
+            std::cerr << "AssetLoader Warning: Failed to load " << job.path << ". Mix_Error: " << Mix_GetError() << std::endl;
+        }
+        break;
+    case AssetKind::CHUNK:
+        job.chunk = Mix_LoadWAV(job.path.c_str());
+        if (!job.chunk) {
+            std::cerr << "AssetLoader Warning: Failed to load " << job.path << ". Mix_Error: " << Mix_GetError() << std::endl;
+        }
+        break;
+    case AssetKind::FONT:
+    {
+        std::ifstream file(job.path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            std::cerr << "AssetLoader Error: Failed to read font file '" << job.path << "'." << std::endl;
+            break;
+        }
+        std::streamsize size = file.tellg();
+        file.seekg(0, std::ios::beg);
+        job.fontData = std::make_unique<std::vector<char>>(static_cast<size_t>(size));
+        if (size > 0 && !file.read(job.fontData->data(), size)) {
+            std::cerr << "AssetLoader Error: Failed to read font file '" << job.path << "'." << std::endl;
+            job.fontData.reset();
+        }
+    }
+    break;
+    }
+}
+
+int AssetLoader::pumpUploads(int maxTextureUploads) {
+    PROFILE_SCOPE("asset.upload");
+    int uploaded = 0;
+    while (!mArchiveJobs.empty()) {
+        if (mArchiveJobs.front()->kind == AssetKind::TEXTURE && uploaded >= maxTextureUploads) return uploaded;
+        std::unique_ptr<Job> job = std::move(mArchiveJobs.front());
+        mArchiveJobs.pop_front();
+        if (job->kind == AssetKind::TEXTURE) ++uploaded;
+        deliver(*job);
+        --mOutstanding;
+    }
+    while (true) {
+        std::unique_ptr<Job> job;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mCompleted.empty()) break;
+            if (mCompleted.front()->kind == AssetKind::TEXTURE && uploaded >= maxTextureUploads) break;
+            job = std::move(mCompleted.front());
+            mCompleted.pop_front();
+        }
+        mCompletedNotFull.notify_one();
+
+        if (job->kind == AssetKind::TEXTURE) ++uploaded;
+        deliver(*job);
+        --mOutstanding;
+    }
+    return uploaded;
+}
+
+void AssetLoader::finishAll() {
+    while (mOutstanding > 0) {
+        if (mArchiveJobs.empty()) {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCompletedAvailable.wait(lock, [this] { return !mCompleted.empty(); });
+        }
+        pumpUploads(static_cast<int>(mMaxPendingUploads));
+    }
+}
+
+void AssetLoader::deliver(Job& job) {
+    switch (job.kind) {
+    case AssetKind::TEXTURE:
+    {
+        Texture* texture = nullptr;
+        if (job.archiveEntry) {
+            // The surface borrows the mapped pixels; the only copy is the upload itself.
+            const ArchiveEntry& entry = *job.archiveEntry;
+            job.surface = SDL_CreateRGBSurfaceWithFormatFrom(const_cast<uint8_t*>(mArchive.payload(entry)),
+                static_cast<int>(entry.width), static_cast<int>(entry.height), 32, static_cast<int>(entry.pitch), SDL_PIXELFORMAT_RGBA32);
+        }
+        if (job.surface) {
+            texture = mRenderer->createTextureFromSurface(job.surface);
+            if (!texture) {
+                std::cerr << "AssetLoader Error: SDL_CreateTextureFromSurface failed for '" << job.path << "'. SDL_Error: " << SDL_GetError() << std::endl;
+            }
+            SDL_FreeSurface(job.surface);
+            job.surface = nullptr;
+        }
+        if (job.onTexture) job.onTexture(texture);
+        else if (texture) mRenderer->destroyTexture(texture);
+    }
+    break;
+    case AssetKind::MUSIC:
+        if (job.archiveEntry) {
+            SDL_RWops* rw = SDL_RWFromConstMem(mArchive.payload(*job.archiveEntry), static_cast<int>(job.archiveEntry->size));
+            job.music = rw ? Mix_LoadMUS_RW(rw, 1) : nullptr;
+            if (!job.music) {
+                std::cerr << "AssetLoader Warning: Failed to load " << job.path << " from archive. Mix_Error: " << Mix_GetError() << std::endl;
+            }
+        }
+        if (job.onMusic) job.onMusic(job.music);
+        else if (job.music) Mix_FreeMusic(job.music);
+        job.music = nullptr;
+        break;
+    case AssetKind::CHUNK:
+        if (job.archiveEntry) {
+            job.chunk = Mix_QuickLoad_RAW(const_cast<uint8_t*>(mArchive.payload(*job.archiveEntry)), job.archiveEntry->size);
+        }
+        if (job.onChunk) job.onChunk(job.chunk);
+        else if (job.chunk) Mix_FreeChunk(job.chunk);
+        job.chunk = nullptr;
+        break;
+    case AssetKind::FONT:
+    {
+        TTF_Font* font = nullptr;
+        if (job.archiveEntry) {
+            SDL_RWops* rw = SDL_RWFromConstMem(mArchive.payload(*job.archiveEntry), static_cast<int>(job.archiveEntry->size));
+            font = rw ? TTF_OpenFontRW(rw, 1, job.pointSize) : nullptr;
+            if (!font) {
+                std::cerr << "AssetLoader Error: Failed to open font '" << job.path << "' from archive. TTF_Error: " << TTF_GetError() << std::endl;
+            }
+        }
+        else if (job.fontData) {
+            SDL_RWops* rw = SDL_RWFromConstMem(job.fontData->data(), static_cast<int>(job.fontData->size()));
+            font = rw ? TTF_OpenFontRW(rw, 1, job.pointSize) : nullptr;
+            if (font) {
+                mFontData.push_back(std::move(job.fontData));
+            }
+            else {
+                std::cerr << "AssetLoader Error: Failed to open font '" << job.path << "'. TTF_Error: " << TTF_GetError() << std::endl;
+            }
+        }
+        if (job.onFont) job.onFont(font);
+        else if (font) TTF_CloseFont(font);
+    }
+    break;
+    }
+}
+
+void AssetLoader::releaseUndelivered(Job& job) {
+    if (job.surface) SDL_FreeSurface(job.surface);
+    if (job.music) Mix_FreeMusic(job.music);
+    if (job.chunk) Mix_FreeChunk(job.chunk);
+    job.surface = nullptr;
+    job.music = nullptr;
+    job.chunk = nullptr;
+}
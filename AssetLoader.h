@@ -0,0 +1,109 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <SDL_mixer.h>
+#include "Renderer.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "AssetArchive.h"
+
+// Decodes assets on worker threads and hands them back to the render thread.
+// PNGs are decoded to SDL_Surface off-thread; only SDL_CreateTextureFromSurface
+// runs on the render thread, limited by the budget passed to pumpUploads().
+// Callbacks are always invoked on the thread that calls pumpUploads()/finishAll().
+// Requests and pumping may come from different threads over time, but never
+// from two at once.
+// Assets found in an opened archive skip the workers entirely: their payloads
+// are already decoded and are used straight from the mapping.
+class AssetLoader {
+public:
+    using TextureCallback = std::function<void(Texture*)>;
+    using MusicCallback = std::function<void(Mix_Music*)>;
+    using ChunkCallback = std::function<void(Mix_Chunk*)>;
+    using FontCallback = std::function<void(TTF_Font*)>;
+
+    AssetLoader(Renderer* renderer, int workerCount = 0, size_t maxPendingUploads = 8);
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    // Must be called before any request that should be served from the archive.
+    bool openArchive(const std::string& path);
+
+    void requestTexture(const std::string& path, TextureCallback onReady);
+    void requestMusic(const std::string& path, MusicCallback onReady);
+    void requestChunk(const std::string& path, ChunkCallback onReady);
+    void requestFont(const std::string& path, int pointSize, FontCallback onReady);
+
+    // Uploads at most maxTextureUploads finished textures; audio and fonts are
+    // delivered without counting against the budget. Returns textures uploaded.
+    int pumpUploads(int maxTextureUploads);
+
+    // Blocks until every request made so far has been delivered.
+    void finishAll();
+
+    bool hasPendingWork() const { return mOutstanding > 0; }
+
+private:
+    enum class AssetKind {
+        TEXTURE,
+        MUSIC,
+        CHUNK,
+        FONT
+    };
+
+    struct Job {
+        AssetKind kind;
+        std::string path;
+        int pointSize = 0;
+        const ArchiveEntry* archiveEntry = nullptr;
+        TextureCallback onTexture;
+        MusicCallback onMusic;
+        ChunkCallback onChunk;
+        FontCallback onFont;
+
+        SDL_Surface* surface = nullptr;
+        Mix_Music* music = nullptr;
+        Mix_Chunk* chunk = nullptr;
+        std::unique_ptr<std::vector<char>> fontData;
+    };
+
+    Renderer* mRenderer;
+    size_t mMaxPendingUploads;
+    int mOutstanding;
+
+    std::vector<std::thread> mWorkers;
+    bool mStopping;
+
+    std::mutex mMutex;
+    std::condition_variable mJobAvailable;
+    std::condition_variable mCompletedNotFull;
+    std::condition_variable mCompletedAvailable;
+    std::deque<std::unique_ptr<Job>> mJobs;
+    std::deque<std::unique_ptr<Job>> mCompleted;
+
+    AssetArchive mArchive;
+    std::deque<std::unique_ptr<Job>> mArchiveJobs;
+
+    // TTF_OpenFontRW streams glyphs from memory on demand, so the file bytes
+    // have to live as long as the fonts opened from them.
+    std::vector<std::unique_ptr<std::vector<char>>> mFontData;
+
+    void enqueue(std::unique_ptr<Job> job);
+    void workerLoop();
+    const ArchiveEntry* findArchiveEntry(const Job& job) const;
+    void decode(Job& job);
+    void deliver(Job& job);
+    static void releaseUndelivered(Job& job);
+};
+
+#endif // ASSET_LOADER_H
@@ -0,0 +1,130 @@
+#include "BatchRunner.h"
+#include "Replay.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+    const uint64_t BOT_SEED_SALT = 0xB07B07ull;
+
+    double percentile(const std::vector<double>& sorted, double fraction) {
+        size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+        return sorted[index];
+    }
+}
+
+uint8_t RandomBot::nextButtons(Rng& rng) {
+    static const uint8_t DIRECTIONS[5] = { 0, INPUT_UP, INPUT_DOWN, INPUT_LEFT, INPUT_RIGHT };
+    if (ticksLeft <= 0) {
+        heldDirection = DIRECTIONS[rng.nextInt(5)];
+        ticksLeft = 10 + rng.nextInt(50);
+    }
+    --ticksLeft;
+    uint8_t buttons = heldDirection;
+    if (rng.nextInt(90) == 0) buttons |= INPUT_BOMB;
+    return buttons;
+}
+
+MatchResult playBotMatch(Simulation& simulation, const MatchConfig& config, ReplayRecorder* recorder) {
+    typedef std::chrono::steady_clock Clock;
+
+    MatchResult result;
+    result.seed = config.seed;
+    if (!simulation.reset(config)) return result;
+    if (recorder) recorder->begin(config);
+
+    Rng botRng(config.seed ^ BOT_SEED_SALT);
+    RandomBot bots[MAX_PLAYERS];
+    TickInput input;
+    double totalNs = 0.0;
+    while (!simulation.isOver()) {
+        for (int p = 0; p < config.playerCount; ++p) {
+            input.buttons[p] = bots[p].nextButtons(botRng);
+        }
+        if (recorder) recorder->recordTick(input);
+
+        Clock::time_point start = Clock::now();
+        simulation.step(input);
+        double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        totalNs += ns;
+        if (ns > result.maxTickNs) result.maxTickNs = ns;
+    }
+    if (recorder) recorder->finish(simulation);
+
+    result.outcome = simulation.getOutcome();
+    result.ticks = simulation.getTick();
+    result.winner = simulation.getWinner();
+    result.enemiesLeft = static_cast<int>(simulation.getEnemies().size());
+    for (int p = 0; p < config.playerCount; ++p) result.scores[p] = simulation.getScore(p);
+    result.meanTickNs = result.ticks > 0 ? totalNs / result.ticks : 0.0;
+    return result;
+}
+
+Distribution Distribution::of(std::vector<double>& values) {
+    Distribution distribution;
+    if (values.empty()) return distribution;
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (double value : values) sum += value;
+    distribution.mean = sum / values.size();
+    distribution.p50 = percentile(values, 0.50);
+    distribution.p90 = percentile(values, 0.90);
+    distribution.p99 = percentile(values, 0.99);
+    distribution.min = values.front();
+    distribution.max = values.back();
+    return distribution;
+}
+
+BatchSummary runBatch(const BatchConfig& config, std::vector<MatchResult>* results) {
+    BatchSummary summary;
+    summary.matches = config.matches > 0 ? config.matches : 0;
+    int threads = config.threads > 0 ? config.threads : static_cast<int>(std::thread::hardware_concurrency());
+    if (threads < 1) threads = 1;
+    if (threads > summary.matches) threads = summary.matches > 0 ? summary.matches : 1;
+    summary.threads = threads;
+
+    std::vector<MatchResult> matchResults(summary.matches);
+    std::atomic<int> nextMatch(0);
+    auto worker = [&]() {
+        Simulation simulation;
+        MatchConfig matchConfig = config.match;
+        for (;;) {
+            int match = nextMatch.fetch_add(1, std::memory_order_relaxed);
+            if (match >= summary.matches) break;
+            matchConfig.seed = config.match.seed + static_cast<uint64_t>(match);
+            matchResults[match] = playBotMatch(simulation, matchConfig);
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; ++i) pool.emplace_back(worker);
+    worker();
+    for (auto& thread : pool) thread.join();
+    summary.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double> matchSeconds, scores, meanTicks, maxTicks;
+    matchSeconds.reserve(summary.matches);
+    scores.reserve(summary.matches * config.match.playerCount);
+    meanTicks.reserve(summary.matches);
+    maxTicks.reserve(summary.matches);
+    for (const auto& result : matchResults) {
+        summary.outcomes[static_cast<int>(result.outcome)]++;
+        if (result.winner >= 0 && result.winner < MAX_PLAYERS) summary.wins[result.winner]++;
+        summary.totalTicks += result.ticks;
+        matchSeconds.push_back(static_cast<double>(result.ticks) / TICKS_PER_SECOND);
+        for (int p = 0; p < config.match.playerCount && p < MAX_PLAYERS; ++p) scores.push_back(result.scores[p]);
+        meanTicks.push_back(result.meanTickNs);
+        maxTicks.push_back(result.maxTickNs);
+    }
+    summary.winRate = summary.matches > 0 ? static_cast<double>(summary.outcomes[static_cast<int>(MatchOutcome::WON)]) / summary.matches : 0.0;
+    summary.matchSeconds = Distribution::of(matchSeconds);
+    summary.scores = Distribution::of(scores);
+    summary.meanTickNs = Distribution::of(meanTicks);
+    summary.maxTickNs = Distribution::of(maxTicks);
+    summary.ticksPerSecond = summary.wallSeconds > 0.0 ? summary.totalTicks / summary.wallSeconds : 0.0;
+
+    if (results) results->swap(matchResults);
+    return summary;
+}
@@ -0,0 +1,81 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <cstdint>
+#include <vector>
+#include "Simulation.h"
+
+class ReplayRecorder;
+
+// Holds a random direction for a while and now and then drops a bomb. Cheap
+// enough that a batch spends its time in the simulation, not the bots.
+struct RandomBot {
+    uint8_t heldDirection = 0;
+    int ticksLeft = 0;
+
+    uint8_t nextButtons(Rng& rng);
+};
+
+struct MatchResult {
+    uint64_t seed = 0;
+    MatchOutcome outcome = MatchOutcome::IN_PROGRESS;
+    int ticks = 0;
+    int winner = -1;
+    int enemiesLeft = 0;
+    int scores[MAX_PLAYERS] = {};
+    // Wall-clock cost of Simulation::step over the match.
+    double meanTickNs = 0.0;
+    double maxTickNs = 0.0;
+};
+
+// Plays one match to the end with RandomBots. The bots are seeded from the
+// match seed, so a result depends only on the config. Pass a recorder to
+// capture the match as a replay.
+MatchResult playBotMatch(Simulation& simulation, const MatchConfig& config, ReplayRecorder* recorder = nullptr);
+
+struct Distribution {
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+
+    // Sorts the values in place.
+    static Distribution of(std::vector<double>& values);
+};
+
+struct BatchConfig {
+    // Match i is played with seed match.seed + i.
+    MatchConfig match;
+    int matches = 1000;
+    // 0 uses every hardware thread.
+    int threads = 0;
+};
+
+struct BatchSummary {
+    int matches = 0;
+    int threads = 0;
+    int outcomes[4] = {};
+    // Matches each player ended as the only survivor.
+    int wins[MAX_PLAYERS] = {};
+    // Share of matches ending in MatchOutcome::WON.
+    double winRate = 0.0;
+    // Match length in seconds of game time.
+    Distribution matchSeconds;
+    // Every player's final score in every match.
+    Distribution scores;
+    Distribution meanTickNs;
+    Distribution maxTickNs;
+    long long totalTicks = 0;
+    double wallSeconds = 0.0;
+    double ticksPerSecond = 0.0;
+};
+
+// Plays config.matches independent matches on a pool of worker threads. Each
+// worker owns its Simulation and pulls match indices from a shared counter;
+// results land in per-match slots, so workers share nothing else. Per-match
+// results are returned in match order through `results` when given.
+BatchSummary runBatch(const BatchConfig& config, std::vector<MatchResult>* results = nullptr);
+
+#endif // BATCH_RUNNER_H
@@ -0,0 +1,48 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "CoreBenchmark.h"
+
+// Benchmark driver for the simulation core. Results go to stdout (or --out)
+// as JSON; a readable summary goes to stderr.
+//
+//   bomberman_bench [--filter NAME] [--quick] [--seed S] [--out results.json]
+//                   [--replay FILE]...
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    std::string outputPath;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--filter" && hasValue) options.filter = argv[++i];
+        else if (arg == "--quick") options.quick = true;
+        else if (arg == "--seed" && hasValue) options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--out" && hasValue) outputPath = argv[++i];
+        else if (arg == "--replay" && hasValue) options.replayPaths.push_back(argv[++i]);
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--filter NAME] [--quick] [--seed S] [--out results.json] [--replay FILE]..." << std::endl;
+            return 2;
+        }
+    }
+
+    std::vector<BenchmarkResult> results = runCoreBenchmarks(options);
+    for (const auto& result : results) {
+        std::cerr << result.name;
+        for (const auto& param : result.params) std::cerr << " " << param.first << "=" << param.second;
+        std::cerr << ": p50 " << result.p50 << " ns, p99 " << result.p99 << " ns (" << result.samples << " samples)" << std::endl;
+    }
+
+    if (outputPath.empty()) {
+        writeBenchmarkJson(std::cout, results);
+        return 0;
+    }
+    std::ofstream out(outputPath);
+    if (!out) {
+        std::cerr << "Benchmark Error: Cannot open '" << outputPath << "' for writing." << std::endl;
+        return 1;
+    }
+    writeBenchmarkJson(out, results);
+    return out ? 0 : 1;
+}
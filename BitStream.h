@@ -0,0 +1,119 @@
+#ifndef BIT_STREAM_H
+#define BIT_STREAM_H
+
+#include <cstdint>
+#include <vector>
+
+// Bit-granular counterpart of ByteStream.h for replication, where most
+// fields are a few bits wide. Bits fill each byte from the least significant
+// end. Varints here use 4-bit groups, each followed by a continuation bit, so
+// small counts and deltas cost five bits rather than a byte.
+class BitWriter {
+public:
+    // Appends to `out`; call flush() once done to write the last partial byte.
+    explicit BitWriter(std::vector<uint8_t>& out) : mOut(out), mPending(0), mPendingBits(0), mBitCount(0) {}
+
+    void writeBits(uint32_t value, int bits) {
+        if (bits < 32) value &= (1u << bits) - 1;
+        mPending |= static_cast<uint64_t>(value) << mPendingBits;
+        mPendingBits += bits;
+        mBitCount += bits;
+        while (mPendingBits >= 8) {
+            mOut.push_back(static_cast<uint8_t>(mPending));
+            mPending >>= 8;
+            mPendingBits -= 8;
+        }
+    }
+
+    void writeBool(bool value) { writeBits(value ? 1 : 0, 1); }
+
+    void writeVarint(uint32_t value) {
+        while (value >= (1u << VARINT_GROUP_BITS)) {
+            writeBits(value, VARINT_GROUP_BITS);
+            writeBits(1, 1);
+            value >>= VARINT_GROUP_BITS;
+        }
+        writeBits(value, VARINT_GROUP_BITS);
+        writeBits(0, 1);
+    }
+
+    void writeSignedVarint(int32_t value) {
+        writeVarint((static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+    }
+
+    void flush() {
+        if (mPendingBits > 0) mOut.push_back(static_cast<uint8_t>(mPending));
+        mPending = 0;
+        mPendingBits = 0;
+    }
+
+    size_t getBitCount() const { return mBitCount; }
+
+    static const int VARINT_GROUP_BITS = 4;
+
+private:
+    std::vector<uint8_t>& mOut;
+    uint64_t mPending;
+    int mPendingBits;
+    size_t mBitCount;
+};
+
+// Reading past the end or a malformed varint clears isOk() and yields zeros
+// from then on, as with ByteReader.
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size)
+        : mData(data),
+        mBitSize(size * 8),
+        mPosition(0),
+        mOk(true)
+    {
+    }
+
+    uint32_t readBits(int bits) {
+        if (!mOk || mBitSize - mPosition < static_cast<size_t>(bits)) {
+            mOk = false;
+            return 0;
+        }
+        uint64_t value = 0;
+        int read = 0;
+        while (read < bits) {
+            int offset = static_cast<int>(mPosition & 7);
+            int take = 8 - offset < bits - read ? 8 - offset : bits - read;
+            uint32_t chunk = (mData[mPosition >> 3] >> offset) & ((1u << take) - 1);
+            value |= static_cast<uint64_t>(chunk) << read;
+            read += take;
+            mPosition += take;
+        }
+        return static_cast<uint32_t>(value);
+    }
+
+    bool readBool() { return readBits(1) != 0; }
+
+    uint32_t readVarint() {
+        uint32_t value = 0;
+        for (int shift = 0; shift < 32; shift += BitWriter::VARINT_GROUP_BITS) {
+            value |= readBits(BitWriter::VARINT_GROUP_BITS) << shift;
+            if (!readBool()) return value;
+        }
+        mOk = false;
+        return 0;
+    }
+
+    int32_t readSignedVarint() {
+        uint32_t value = readVarint();
+        return static_cast<int32_t>((value >> 1) ^ (0u - (value & 1)));
+    }
+
+    void fail() { mOk = false; }
+    bool isOk() const { return mOk; }
+    size_t getBitPosition() const { return mPosition; }
+
+private:
+    const uint8_t* mData;
+    size_t mBitSize;
+    size_t mPosition;
+    bool mOk;
+};
+
+#endif // BIT_STREAM_H
@@ -1,145 +1,118 @@
-﻿#include "bomb.h"
-#include "map.h"
-#include <iostream> // Để debug
-
-Bomb::Bomb(int x, int y, int size, float fuseTime, int explosionRange)
-    : mX(x),
-    mY(y),
-    mSize(size),
-    mFuseTime(fuseTime),
-    mTimer(0.0f),
-    mExplosionRange(explosionRange),
-    mExplosionDuration(0.8f),
-    mExplosionTimer(0.0f),
-    mExploding(false),
-    mDone(false),
-    mMap(nullptr),
-    mCurrentFrame(0),
-    mFrameTime(0.0f),
-    mExplosionSoundPlayed(false) 
-{
-}
-
-void Bomb::update(float deltaTime) {
-    if (mDone) return;
-
-    if (!mExploding) {
-        mTimer += deltaTime;
-        mFrameTime += deltaTime;
-        if (mFrameTime >= mFrameDuration) {
-            mFrameTime = 0.0f;
-            mCurrentFrame = (mCurrentFrame + 1) % mTotalBombFrames;
-        }
-
-        if (mTimer >= mFuseTime) {
-            mExploding = true;
-            mTimer = 0.0f; 
-            mCurrentFrame = 0; 
-            createExplosion();
-           
-        }
-    }
-    else {
-        mExplosionTimer += deltaTime;
-        if (mExplosionTimer >= mExplosionDuration) {
-            mDone = true;
-        }
-    }
-}
-
-void Bomb::render(SDL_Renderer* renderer, SDL_Texture* bombTexture, SDL_Texture* explosionTexture) {
-    if (mDone) return;
-
-    if (!mExploding) {
-        if (!bombTexture) return;
-        int frameWidth = 0, frameHeight = 0;
-        SDL_QueryTexture(bombTexture, nullptr, nullptr, &frameWidth, &frameHeight);
-
-        if (mTotalBombFrames > 0) { 
-            frameWidth /= mTotalBombFrames;
-        }
-        else {
-        }
-
-
-        SDL_Rect srcRect = { mCurrentFrame * frameWidth, 0, frameWidth, frameHeight };
-        SDL_Rect destRect = { mX, mY, mSize, mSize };
-        SDL_RenderCopy(renderer, bombTexture, &srcRect, &destRect);
-    }
-    else {
-        if (!explosionTexture) return;
-        for (const auto& part : mExplosion.parts) {
-            SDL_Rect destRect = { part.x, part.y, mSize, mSize };
-            SDL_RenderCopy(renderer, explosionTexture, nullptr, &destRect);
-        }
-    }
-}
-
-void Bomb::createExplosion() {
-    mExplosion.parts.clear();
-    mExplosion.parts.push_back({ mX, mY }); 
-
-    
-    int currentExplosionRange = 1; 
-
-   
-    for (int i = 1; i <= currentExplosionRange; ++i) {
-        int newX = mX + i * mSize;
-        int newY = mY;
-        if (mMap) {
-            int tileRow = newY / mMap->getTileSize();
-            int tileCol = newX / mMap->getTileSize();
-            if (mMap->getTileType(tileRow, tileCol) == TileType::HARD_WALL) break;
-            mExplosion.parts.push_back({ newX, newY });
-            if (mMap->getTileType(tileRow, tileCol) == TileType::SOFT_WALL) break;
-        }
-        else {
-            mExplosion.parts.push_back({ newX, newY }); 
-        }
-    }
-
-    for (int i = 1; i <= currentExplosionRange; ++i) {
-        int newX = mX - i * mSize;
-        int newY = mY;
-        if (mMap) {
-            int tileRow = newY / mMap->getTileSize();
-            int tileCol = newX / mMap->getTileSize();
-            if (mMap->getTileType(tileRow, tileCol) == TileType::HARD_WALL) break;
-            mExplosion.parts.push_back({ newX, newY });
-            if (mMap->getTileType(tileRow, tileCol) == TileType::SOFT_WALL) break;
-        }
-        else {
-            mExplosion.parts.push_back({ newX, newY });
-        }
-    }
- 
-    for (int i = 1; i <= currentExplosionRange; ++i) {
-        int newX = mX;
-        int newY = mY + i * mSize;
-        if (mMap) {
-            int tileRow = newY / mMap->getTileSize();
-            int tileCol = newX / mMap->getTileSize();
-            if (mMap->getTileType(tileRow, tileCol) == TileType::HARD_WALL) break;
-            mExplosion.parts.push_back({ newX, newY });
-            if (mMap->getTileType(tileRow, tileCol) == TileType::SOFT_WALL) break;
-        }
-        else {
-            mExplosion.parts.push_back({ newX, newY });
-        }
-    }
-  
-    for (int i = 1; i <= currentExplosionRange; ++i) {
-        int newX = mX;
-        int newY = mY - i * mSize;
-        if (mMap) {
-            int tileRow = newY / mMap->getTileSize();
-            int tileCol = newX / mMap->getTileSize();
-            if (mMap->getTileType(tileRow, tileCol) == TileType::HARD_WALL) break;
-            mExplosion.parts.push_back({ newX, newY });
-            if (mMap->getTileType(tileRow, tileCol) == TileType::SOFT_WALL) break;
-        }
-        else {
-            mExplosion.parts.push_back({ newX, newY });
-        }
-    }
-}
+﻿#include "Bomb.h"
+#include "Map.h"
+#include "ByteStream.h"
+
+const int Bomb::DIRECTIONS[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
+Bomb::Bomb(int x, int y, int size, int fuseTicks, int explosionRange, int owner)
+    : mX(x),
+    mY(y),
+    mSize(size),
+    mFuseTicks(fuseTicks),
+    mTimer(0),
+    mExplosionRange(explosionRange < Explosion::MAX_RANGE ? explosionRange : Explosion::MAX_RANGE),
+    mExplosionTimer(0),
+    mExploding(false),
+    mDone(false),
+    mOwner(owner)
+{
+}
+
+bool Bomb::update(const Map& map) {
+    if (mDone) return false;
+
+    if (!mExploding) {
+        ++mTimer;
+        if (mTimer >= mFuseTicks) {
+            mExploding = true;
+            createExplosion(map);
+            return true;
+        }
+    }
+    else {
+        ++mExplosionTimer;
+        if (mExplosionTimer >= EXPLOSION_TICKS) {
+            mDone = true;
+        }
+    }
+    return false;
+}
+
+void Bomb::createExplosion(const Map& map) {
+    mExplosion.partCount = 0;
+    mExplosion.parts[mExplosion.partCount++] = { mX, mY };
+
+    int tileSize = map.getTileSize();
+    for (const auto& direction : DIRECTIONS) {
+        for (int i = 1; i <= mExplosionRange; ++i) {
+            int newX = mX + direction[0] * i * mSize;
+            int newY = mY + direction[1] * i * mSize;
+            TileType tile = map.getTileType(newY / tileSize, newX / tileSize);
+            if (tile == TileType::HARD_WALL || tile == TileType::BORDER_WALL) break;
+            mExplosion.parts[mExplosion.partCount++] = { newX, newY };
+            if (tile == TileType::SOFT_WALL) break;
+        }
+    }
+}
+
+void Bomb::getArmLengths(int lengths[4]) const {
+    for (int d = 0; d < 4; ++d) lengths[d] = 0;
+    for (int i = 1; i < mExplosion.partCount; ++i) {
+        const ExplosionPart& part = mExplosion.parts[i];
+        for (int d = 0; d < 4; ++d) {
+            if ((part.x - mX) * DIRECTIONS[d][0] > 0 || (part.y - mY) * DIRECTIONS[d][1] > 0) {
+                ++lengths[d];
+                break;
+            }
+        }
+    }
+}
+
+void Bomb::saveState(ByteWriter& writer) const {
+    writer.writeSignedVarint(mX);
+    writer.writeSignedVarint(mY);
+    writer.writeVarint(static_cast<uint64_t>(mFuseTicks));
+    writer.writeVarint(static_cast<uint64_t>(mTimer));
+    writer.writeU8(static_cast<uint8_t>(mExplosionRange));
+    writer.writeVarint(static_cast<uint64_t>(mExplosionTimer));
+    writer.writeU8(static_cast<uint8_t>(mOwner));
+    writer.writeU8((mExploding ? 0x01 : 0) | (mDone ? 0x02 : 0));
+    if (!mExploding) return;
+
+    int armLengths[4];
+    getArmLengths(armLengths);
+    writer.writeU8(static_cast<uint8_t>(armLengths[0] | (armLengths[1] << 4)));
+    writer.writeU8(static_cast<uint8_t>(armLengths[2] | (armLengths[3] << 4)));
+}
+
+void Bomb::loadState(ByteReader& reader) {
+    mX = static_cast<int>(reader.readSignedVarint());
+    mY = static_cast<int>(reader.readSignedVarint());
+    mFuseTicks = static_cast<int>(reader.readVarint());
+    mTimer = static_cast<int>(reader.readVarint());
+    mExplosionRange = reader.readU8();
+    mExplosionTimer = static_cast<int>(reader.readVarint());
+    mOwner = reader.readU8();
+    uint8_t flags = reader.readU8();
+    mExploding = (flags & 0x01) != 0;
+    mDone = (flags & 0x02) != 0;
+    if (mExplosionRange > Explosion::MAX_RANGE) {
+        reader.fail();
+        return;
+    }
+
+    mExplosion.partCount = 0;
+    if (!mExploding) return;
+    uint8_t packed[2] = { reader.readU8(), reader.readU8() };
+    mExplosion.parts[mExplosion.partCount++] = { mX, mY };
+    for (int d = 0; d < 4; ++d) {
+        int length = (packed[d / 2] >> ((d % 2) * 4)) & 0x0F;
+        if (length > mExplosionRange) {
+            reader.fail();
+            return;
+        }
+        for (int i = 1; i <= length; ++i) {
+            mExplosion.parts[mExplosion.partCount++] = { mX + DIRECTIONS[d][0] * i * mSize, mY + DIRECTIONS[d][1] * i * mSize };
+        }
+    }
+}
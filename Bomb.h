@@ -1,63 +1,72 @@
-﻿#ifndef BOMB_H
-#define BOMB_H
-
-#include <SDL.h>
-#include <vector>
-
-class Map;
-
-struct ExplosionPart {
-    int x;
-    int y;
-};
-
-struct Explosion {
-    std::vector<ExplosionPart> parts;
-};
-
-class Bomb {
-public:
-    Bomb(int x, int y, int size, float fuseTime, int explosionRange);
-    ~Bomb() = default;
-
-    void update(float deltaTime);
-    void render(SDL_Renderer* renderer, SDL_Texture* bombTexture, SDL_Texture* explosionTexture);
-
-    void setMap(Map* map) { mMap = map; }
-    void createExplosion(); // Đảm bảo hàm này công khai nếu Game cần gọi trực tiếp
-
-
-    bool isExploding() const { return mExploding; }
-    bool isDone() const { return mDone; }
-    int getX() const { return mX; }
-    int getY() const { return mY; }
-    int getSize() const { return mSize; }
-    const Explosion& getExplosion() const { return mExplosion; }
-    Explosion& getExplosion() { return mExplosion; }
-
-    bool hasExplosionSoundPlayed() const { return mExplosionSoundPlayed; } 
-    void setExplosionSoundPlayed(bool played) { mExplosionSoundPlayed = played; } 
-
-
-private:
-    int mX, mY;
-    int mSize;
-    float mFuseTime;
-    float mTimer;
-    int mExplosionRange;
-    float mExplosionDuration;
-    float mExplosionTimer;
-    bool mExploding;
-    bool mDone;
-    Map* mMap = nullptr;
-
-    int mCurrentFrame;
-    float mFrameTime;
-    const float mFrameDuration = 0.2f;
-    const int mTotalBombFrames = 3;
-
-    Explosion mExplosion;
-    bool mExplosionSoundPlayed;
-};
-
-#endif 
+﻿#ifndef BOMB_H
+#define BOMB_H
+
+class Map;
+class ByteWriter;
+class ByteReader;
+
+struct ExplosionPart {
+    int x;
+    int y;
+};
+
+// Stored inline in the bomb so that going off never allocates. Ranges above
+// MAX_RANGE are clamped when the bomb is created.
+struct Explosion {
+    static const int MAX_RANGE = 8;
+    static const int MAX_PARTS = 1 + 4 * MAX_RANGE;
+
+    ExplosionPart parts[MAX_PARTS];
+    int partCount = 0;
+
+    const ExplosionPart* begin() const { return parts; }
+    const ExplosionPart* end() const { return parts + partCount; }
+    int size() const { return partCount; }
+};
+
+class Bomb {
+public:
+    static const int DEFAULT_FUSE_TICKS = 120;
+    static const int EXPLOSION_TICKS = 48;
+
+    Bomb(int x, int y, int size, int fuseTicks, int explosionRange, int owner);
+
+    // Advances one tick. Returns true on the tick the bomb goes off.
+    bool update(const Map& map);
+    void createExplosion(const Map& map);
+
+    bool isExploding() const { return mExploding; }
+    bool isDone() const { return mDone; }
+    int getX() const { return mX; }
+    int getY() const { return mY; }
+    int getSize() const { return mSize; }
+    int getOwner() const { return mOwner; }
+    int getAgeTicks() const { return mTimer; }
+    int getExplosionTicks() const { return mExplosionTimer; }
+    const Explosion& getExplosion() const { return mExplosion; }
+    // Tiles covered by each arm of the explosion, in DIRECTIONS order (right,
+    // left, down, up); all zero before the bomb goes off.
+    void getArmLengths(int lengths[4]) const;
+
+    // Snapshot support. A live explosion is stored as the length of each arm
+    // rather than re-traced, since the walls it broke are already gone.
+    void saveState(ByteWriter& writer) const;
+    void loadState(ByteReader& reader);
+
+private:
+    int mX, mY;
+    int mSize;
+    int mFuseTicks;
+    int mTimer;
+    int mExplosionRange;
+    int mExplosionTimer;
+    bool mExploding;
+    bool mDone;
+    int mOwner;
+
+    Explosion mExplosion;
+
+    static const int DIRECTIONS[4][2];
+};
+
+#endif // BOMB_H
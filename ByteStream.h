@@ -0,0 +1,126 @@
+#ifndef BYTE_STREAM_H
+#define BYTE_STREAM_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Little-endian binary encoding shared by replays and snapshots. Varints use
+// 7 bits per byte; signed varints are zigzag-encoded first so that small
+// negative numbers stay small.
+class ByteWriter {
+public:
+    explicit ByteWriter(std::vector<uint8_t>& out) : mOut(out) {}
+
+    void writeU8(uint8_t value) { mOut.push_back(value); }
+    void writeU16(uint16_t value) { writeLittleEndian(value, 2); }
+    void writeU32(uint32_t value) { writeLittleEndian(value, 4); }
+    void writeU64(uint64_t value) { writeLittleEndian(value, 8); }
+
+    void writeFloat(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        writeU32(bits);
+    }
+
+    void writeVarint(uint64_t value) {
+        while (value >= 0x80) {
+            mOut.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        mOut.push_back(static_cast<uint8_t>(value));
+    }
+
+    void writeSignedVarint(int64_t value) {
+        writeVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    void writeBytes(const uint8_t* data, size_t size) { mOut.insert(mOut.end(), data, data + size); }
+
+    size_t size() const { return mOut.size(); }
+
+private:
+    std::vector<uint8_t>& mOut;
+
+    void writeLittleEndian(uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) mOut.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+};
+
+// Reading past the end or a malformed varint clears isOk() and yields zeros
+// from then on, so callers can decode a whole record and check once.
+class ByteReader {
+public:
+    ByteReader(const uint8_t* data, size_t size, size_t position = 0)
+        : mData(data),
+        mSize(size),
+        mPosition(position),
+        mOk(position <= size)
+    {
+    }
+
+    uint8_t readU8() {
+        if (!mOk || mPosition >= mSize) {
+            mOk = false;
+            return 0;
+        }
+        return mData[mPosition++];
+    }
+
+    uint16_t readU16() { return static_cast<uint16_t>(readLittleEndian(2)); }
+    uint32_t readU32() { return static_cast<uint32_t>(readLittleEndian(4)); }
+    uint64_t readU64() { return readLittleEndian(8); }
+
+    float readFloat() {
+        uint32_t bits = readU32();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    uint64_t readVarint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte = readU8();
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        mOk = false;
+        return 0;
+    }
+
+    int64_t readSignedVarint() {
+        uint64_t value = readVarint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    bool readBytes(uint8_t* out, size_t size) {
+        if (!mOk || mSize - mPosition < size) {
+            mOk = false;
+            return false;
+        }
+        std::memcpy(out, mData + mPosition, size);
+        mPosition += size;
+        return true;
+    }
+
+    // Marks the stream bad, for values that decode but make no sense.
+    void fail() { mOk = false; }
+    bool isOk() const { return mOk; }
+    bool atEnd() const { return mPosition == mSize; }
+    size_t getPosition() const { return mPosition; }
+
+private:
+    const uint8_t* mData;
+    size_t mSize;
+    size_t mPosition;
+    bool mOk;
+
+    uint64_t readLittleEndian(int bytes) {
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i) value |= static_cast<uint64_t>(readU8()) << (i * 8);
+        return value;
+    }
+};
+
+#endif // BYTE_STREAM_H
@@ -0,0 +1,896 @@
+#include "CoreBenchmark.h"
+#include "Simulation.h"
+#include "Replay.h"
+#include "BatchRunner.h"
+#include "RollbackSession.h"
+#include "Replication.h"
+#include "MctsBot.h"
+#include "VecEnv.h"
+#include "VoiceManager.h"
+#include "Leaderboard.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct MapSize {
+        int columns;
+        int rows;
+    };
+
+    const MapSize MAP_SIZES[] = { { 20, 15 }, { 64, 48 }, { 256, 192 } };
+    const int ENEMY_COUNTS[] = { 10, 100, 1000, 10000, 100000 };
+    const int BOMB_COUNTS[] = { 0, 16, 64, 256 };
+    const int BATCH_SIZE = 1000;
+
+    // Keeps the optimizer from discarding the work being measured.
+    volatile long long gSink = 0;
+
+    double nanosecondsSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    double percentile(const std::vector<double>& sorted, double fraction) {
+        size_t rank = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(rank, sorted.size() - 1)];
+    }
+
+    bool wanted(const BenchmarkOptions& options, const std::string& name) {
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    }
+
+    Map makeMap(const MapSize& size, uint64_t seed) {
+        Map map;
+        Rng rng(seed);
+        map.initialize(size.columns, size.rows, 40);
+        map.generateInitialLayout(rng, { { 1, 1 } });
+        return map;
+    }
+
+    // Times `sampleCount` batches of BATCH_SIZE calls and records the mean
+    // time per call of each batch.
+    template <typename Operation>
+    std::vector<double> sampleBatches(int sampleCount, Operation operation) {
+        std::vector<double> samples;
+        samples.reserve(sampleCount);
+        for (int sample = 0; sample < sampleCount; ++sample) {
+            Clock::time_point start = Clock::now();
+            for (int i = 0; i < BATCH_SIZE; ++i) {
+                operation(i);
+            }
+            samples.push_back(nanosecondsSince(start) / BATCH_SIZE);
+        }
+        return samples;
+    }
+
+    void benchIsColliding(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+        if (!wanted(options, "map_is_colliding")) return;
+        for (const auto& size : MAP_SIZES) {
+            Map map = makeMap(size, options.seed);
+            Rng rng(options.seed);
+            std::vector<Rect> probes(BATCH_SIZE);
+            for (auto& probe : probes) {
+                probe = { rng.nextInt(map.getPixelWidth()), rng.nextInt(map.getPixelHeight()), 25, 25 };
+            }
+            std::vector<double> samples = sampleBatches(options.quick ? 50 : 500, [&](int i) {
+                const Rect& probe = probes[i];
+                gSink += map.isColliding(probe.x, probe.y, probe.w, probe.h);
+            });
+            BenchmarkResult result = summarizeSamples("map_is_colliding", samples);
+            result.params = { { "columns", size.columns }, { "rows", size.rows } };
+            results.push_back(result);
+        }
+    }
+
+    void benchHandleExplosion(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+        if (!wanted(options, "map_handle_explosion")) return;
+        for (const auto& size : MAP_SIZES) {
+            const Map original = makeMap(size, options.seed);
+            Rng rng(options.seed);
+            std::vector<Explosion> explosions;
+            for (int i = 0; i < BATCH_SIZE; ++i) {
+                int row = 1 + rng.nextInt(size.rows - 2);
+                int col = 1 + rng.nextInt(size.columns - 2);
+                Bomb bomb(col * 40, row * 40, 40, 1, 5, 0);
+                bomb.createExplosion(original);
+                explosions.push_back(bomb.getExplosion());
+            }
+
+            // Explosions clear the soft walls they hit, so every batch starts
+            // from a fresh copy of the map; the copy is not timed.
+            std::vector<double> samples;
+            int sampleCount = options.quick ? 50 : 500;
+            for (int sample = 0; sample < sampleCount; ++sample) {
+                Map map = original;
+                Clock::time_point start = Clock::now();
+                for (const auto& explosion : explosions) {
+                    gSink += map.handleExplosion(explosion);
+                }
+                samples.push_back(nanosecondsSince(start) / explosions.size());
+            }
+            BenchmarkResult result = summarizeSamples("map_handle_explosion", samples);
+            result.params = { { "columns", size.columns }, { "rows", size.rows }, { "range", 5 } };
+            results.push_back(result);
+        }
+    }
+
+    void benchCreateExplosion(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+        if (!wanted(options, "bomb_create_explosion")) return;
+        const Map map = makeMap(MAP_SIZES[1], options.seed);
+        for (int range : { 1, 3, 5 }) {
+            Rng rng(options.seed);
+            std::vector<Bomb> bombs;
+            for (int i = 0; i < BATCH_SIZE; ++i) {
+                int row = 1 + rng.nextInt(map.getRows() - 2);
+                int col = 1 + rng.nextInt(map.getColumns() - 2);
+                bombs.emplace_back(col * 40, row * 40, 40, 1, range, 0);
+            }
+            std::vector<double> samples = sampleBatches(options.quick ? 50 : 500, [&](int i) {
+                bombs[i].createExplosion(map);
+                gSink += static_cast<long long>(bombs[i].getExplosion().size());
+            });
+            BenchmarkResult result = summarizeSamples("bomb_create_explosion", samples);
+            result.params = { { "range", range } };
+            results.push_back(result);
+        }
+    }
+
+    void benchSkeletonDistance(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+        if (!wanted(options, "skeleton_distance")) return;
+        for (const MapSize& size : MAP_SIZES) {
+            WallSkeleton skeleton;
+            skeleton.build(size.columns, size.rows);
+            Rng rng(options.seed);
+            std::vector<TilePos> tiles;
+            while (tiles.size() < BATCH_SIZE + 1) {
+                TilePos tile = { 1 + rng.nextInt(size.rows - 2), 1 + rng.nextInt(size.columns - 2) };
+                if (skeleton.isOpen(tile.row, tile.col)) tiles.push_back(tile);
+            }
+            std::vector<double> samples = sampleBatches(options.quick ? 50 : 1000, [&](int i) {
+                gSink += skeleton.distance(tiles[i], tiles[i + 1]);
+            });
+            BenchmarkResult result = summarizeSamples("skeleton_distance", samples);
+            result.params = { { "columns", size.columns }, { "rows", size.rows } };
+            results.push_back(result);
+        }
+    }
+
+    void benchCheckCollision(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+        if (!wanted(options, "check_collision")) return;
+        Rng rng(options.seed);
+        std::vector<Rect> rects(BATCH_SIZE + 1);
+        for (auto& rect : rects) {
+            rect = { rng.nextInt(800), rng.nextInt(600), 25 + rng.nextInt(16), 25 + rng.nextInt(16) };
+        }
+        std::vector<double> samples = sampleBatches(options.quick ? 50 : 1000, [&](int i) {
+            gSink += checkCollision(rects[i], rects[i + 1]);
+        });
+        results.push_back(summarizeSamples("check_collision", samples));
+    }
+
+    void benchEnemyUpdate(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+        if (!wanted(options, "enemy_update")) return;
+        const MapSize& size = MAP_SIZES[1];
+        const Map map = makeMap(size, options.seed);
+        for (int enemyCount : ENEMY_COUNTS) {
+            if (options.quick && enemyCount > 1000) break;
+            Rng rng(options.seed);
+            std::vector<Enemy> enemies;
+            enemies.reserve(enemyCount);
+            for (int i = 0; i < enemyCount; ++i) {
+                Enemy enemy(0, 0, map.getTileSize(), static_cast<Direction>(rng.nextInt(4)));
+                if (enemy.findSafePosition(map, rng, { { 1, 1 } })) enemies.push_back(enemy);
+            }
+
+            // One sample is one tick's worth of updates for every enemy, with
+            // a player in the corner to chase.
+            const std::vector<TilePos> targets = { { 1, 1 } };
+            std::vector<double> samples;
+            int sampleCount = options.quick ? 30 : 300;
+            for (int sample = 0; sample < sampleCount; ++sample) {
+                Clock::time_point start = Clock::now();
+                for (auto& enemy : enemies) {
+                    enemy.update(map, rng, targets);
+                }
+                samples.push_back(nanosecondsSince(start));
+                gSink += enemies.empty() ? 0 : enemies.front().getX();
+            }
+            BenchmarkResult result = summarizeSamples("enemy_update", samples);
+            result.params = { { "columns", size.columns }, { "rows", size.rows }, { "enemies", enemyCount } };
+            results.push_back(result);
+        }
+    }
+
+    // Keeps roughly `bombCount` bombs alive by dropping new ones on random
+    // free tiles with staggered fuses, so explosions are spread over time.
+    void topUpBombs(Simulation& simulation, Rng& rng, int bombCount) {
+        const Map& map = simulation.getMap();
+        for (int attempt = 0; attempt < bombCount * 4 && static_cast<int>(simulation.getBombs().size()) < bombCount; ++attempt) {
+            int row = 1 + rng.nextInt(map.getRows() - 2);
+            int col = 1 + rng.nextInt(map.getColumns() - 2);
+            simulation.addBomb(row, col, 0, Bomb::DEFAULT_FUSE_TICKS / 2 + rng.nextInt(Bomb::DEFAULT_FUSE_TICKS));
+        }
+    }
+
+    void runStepScenario(const BenchmarkOptions& options, const MapSize& size, int enemyCount, int bombCount,
+        std::vector<BenchmarkResult>& results) {
+        MatchConfig config;
+        config.columns = size.columns;
+        config.rows = size.rows;
+        config.enemyCount = enemyCount;
+        config.playerCount = 4;
+        config.bombRange = 3;
+        config.seed = options.seed;
+        config.invulnerablePlayers = true;
+
+        Simulation simulation;
+        if (!simulation.reset(config)) return;
+        Rng rng(options.seed ^ 0x5EEDull);
+        TickInput input;
+
+        int tickCount = options.quick ? 30 : (enemyCount >= 10000 ? 120 : 600);
+        std::vector<double> samples;
+        samples.reserve(tickCount);
+        int restarts = 0;
+        for (int tick = 0; tick < tickCount; ++tick) {
+            if (simulation.isOver()) {
+                simulation.reset(config);
+                ++restarts;
+            }
+            topUpBombs(simulation, rng, bombCount);
+            for (int p = 0; p < config.playerCount; ++p) {
+                input.buttons[p] = static_cast<uint8_t>(1 << rng.nextInt(4));
+            }
+
+            Clock::time_point start = Clock::now();
+            simulation.step(input);
+            samples.push_back(nanosecondsSince(start));
+        }
+
+        BenchmarkResult result = summarizeSamples("sim_step", samples);
+        result.params = { { "columns", size.columns }, { "rows", size.rows }, { "enemies", enemyCount },
+            { "bombs", bombCount }, { "restarts", restarts } };
+        results.push_back(result);
+    }
+
+    void benchSimulationStep(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+        if (!wanted(options, "sim_step")) return;
+        for (const auto& size : MAP_SIZES) {
+            for (int enemyCount : ENEMY_COUNTS) {
+                if (options.quick && enemyCount > 1000) break;
+                runStepScenario(options, size, enemyCount, 16, results);
+            }
+        }
+        for (int bombCount : BOMB_COUNTS) {
+            if (bombCount == 16) continue;
+            runStepScenario(options, MAP_SIZES[1], 1000, bombCount, results);
+        }
+    }
+
+    // Enemy counts paired with MAP_SIZES for the snapshot and rollback
+    // scenarios.
+    const int MID_MATCH_ENEMY_COUNTS[] = { 3, 100, 1000 };
+
+    // A four-player match on the given map, 1.5 s in with 16 live bombs.
+    bool setUpMidMatch(const BenchmarkOptions& options, const MapSize& size, int enemyCount, Simulation& simulation) {
+        MatchConfig config;
+        config.columns = size.columns;
+        config.rows = size.rows;
+        config.enemyCount = enemyCount;
+        config.playerCount = 4;
+        config.bombRange = 3;
+        config.seed = options.seed;
+        config.invulnerablePlayers = true;
+        if (!simulation.reset(config)) return false;
+        Rng rng(options.seed ^ 0x5EEDull);
+        topUpBombs(simulation, rng, 16);
+        TickInput input;
+        for (int tick = 0; tick < 90; ++tick) simulation.step(input);
+        return true;
+    }
+
+    // Save and restore of a mid-match state with live bombs, per map size and
+    // enemy count. The blob size is reported as a parameter.
+    void benchSnapshots(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+        if (!wanted(options, "snapshot")) return;
+        for (size_t i = 0; i < sizeof(MID_MATCH_ENEMY_COUNTS) / sizeof(MID_MATCH_ENEMY_COUNTS[0]); ++i) {
+            const MapSize& size = MAP_SIZES[i];
+            Simulation simulation;
+            if (!setUpMidMatch(options, size, MID_MATCH_ENEMY_COUNTS[i], simulation)) continue;
+            const MatchConfig& config = simulation.getConfig();
+
+            std::vector<uint8_t> blob;
+            simulation.saveSnapshot(blob);
+            Simulation restored;
+            int sampleCount = options.quick ? 100 : 2000;
+            std::vector<double> saveSamples;
+            std::vector<double> restoreSamples;
+            saveSamples.reserve(sampleCount);
+            restoreSamples.reserve(sampleCount);
+            for (int sample = 0; sample < sampleCount; ++sample) {
+                Clock::time_point start = Clock::now();
+                simulation.saveSnapshot(blob);
+                saveSamples.push_back(nanosecondsSince(start));
+
+                start = Clock::now();
+                restored.restoreSnapshot(blob);
+                restoreSamples.push_back(nanosecondsSince(start));
+            }
+            if (restored.computeChecksum() != simulation.computeChecksum()) {
+                std::cerr << "Benchmark Warning: Snapshot round trip changed the state." << std::endl;
+            }
+
+            std::vector<std::pair<std::string, long long>> params = { { "columns", size.columns }, { "rows", size.rows },
+                { "enemies", config.enemyCount }, { "bombs", static_cast<long long>(simulation.getBombs().size()) },
+                { "bytes", static_cast<long long>(blob.size()) } };
+            BenchmarkResult saveResult = summarizeSamples("snapshot_save", saveSamples);
+            saveResult.params = params;
+            results.push_back(saveResult);
+            BenchmarkResult restoreResult = summarizeSamples("snapshot_restore", restoreSamples);
+            restoreResult.params = params;
+            results.push_back(restoreResult);
+        }
+    }
+
+    // What a RollbackSession does when a late input arrives: restore the
+    // snapshot from N ticks ago and step back to the present. Must stay well
+    // inside one 16.7 ms frame for the deepest rollback allowed.
+    void benchRollbacks(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+        if (!wanted(options, "rollback")) return;
+        const int DEPTHS[] = { 8, RollbackSession::MAX_ROLLBACK_TICKS };
+        for (size_t i = 0; i < sizeof(MID_MATCH_ENEMY_COUNTS) / sizeof(MID_MATCH_ENEMY_COUNTS[0]); ++i) {
+            const MapSize& size = MAP_SIZES[i];
+            Simulation simulation;
+            if (!setUpMidMatch(options, size, MID_MATCH_ENEMY_COUNTS[i], simulation)) continue;
+            std::vector<uint8_t> snapshot;
+            std::vector<uint8_t> ring;
+            simulation.saveSnapshot(snapshot);
+            simulation.saveSnapshot(ring);
+
+            Rng rng(options.seed ^ 0xB07ull);
+            RandomBot bots[4];
+            TickInput inputs[RollbackSession::MAX_ROLLBACK_TICKS];
+            for (auto& input : inputs) {
+                for (int p = 0; p < 4; ++p) input.buttons[p] = bots[p].nextButtons(rng);
+            }
+
+            for (int depth : DEPTHS) {
+                int sampleCount = options.quick ? 50 : 500;
+                std::vector<double> samples;
+                samples.reserve(sampleCount);
+                for (int sample = 0; sample < sampleCount; ++sample) {
+                    Clock::time_point start = Clock::now();
+                    simulation.restoreSnapshot(snapshot);
+                    for (int tick = 0; tick < depth; ++tick) {
+                        // The ring keeps each re-simulated tick's state too.
+                        if (tick > 0) simulation.saveSnapshot(ring);
+                        simulation.step(inputs[tick]);
+                    }
+                    samples.push_back(nanosecondsSince(start));
+                }
+                BenchmarkResult result = summarizeSamples("rollback_resimulate", samples);
+                result.params = { { "columns", size.columns }, { "rows", size.rows },
+                    { "enemies", MID_MATCH_ENEMY_COUNTS[i] }, { "ticks", depth } };
+                results.push_back(result);
+            }
+        }
+    }
+
+    // Server-side cost and size of replicating an eight-player match with 100
+    // enemies to one client, which acknowledges every state `lag` ticks after
+    // it was sent (1 on a LAN, 6 for about 100 ms round trip). One sample is
+    // one encode; capturing the tick is timed separately, since a server does
+    // it once for all clients. Mean bytes per tick (keyframes included), the
+    // largest keyframe and the mean full snapshot are reported as parameters.
+    void benchReplication(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+        if (!wanted(options, "replication")) return;
+        const int ACK_LAGS[] = { 1, 6 };
+        for (int lag : ACK_LAGS) {
+            MatchConfig config;
+            config.columns = MAP_SIZES[1].columns;
+            config.rows = MAP_SIZES[1].rows;
+            config.enemyCount = 100;
+            config.playerCount = MAX_PLAYERS;
+            config.bombRange = 3;
+            config.maxActiveBombs = 2;
+            config.seed = options.seed;
+            config.invulnerablePlayers = true;
+            Simulation simulation;
+            if (!simulation.reset(config)) return;
+
+            Replicator replicator;
+            ReplicaClient client;
+            ReplicaDecoder decoder;
+            Rng botRng(options.seed ^ 0xB075ull);
+            RandomBot bots[MAX_PLAYERS];
+            TickInput input;
+            std::vector<uint8_t> message;
+            std::vector<uint8_t> snapshot;
+            // What the client acknowledged on each of the last `lag` ticks.
+            std::pair<uint8_t, int> acks[ACK_LAGS[1]];
+
+            int tickCount = options.quick ? 300 : 3000;
+            std::vector<double> captureSamples;
+            std::vector<double> encodeSamples;
+            captureSamples.reserve(tickCount);
+            encodeSamples.reserve(tickCount);
+            long long bytes = 0;
+            long long snapshotBytes = 0;
+            size_t maxKeyframe = 0;
+            int keyframes = 0;
+            bool decodedAll = true;
+            for (int tick = 0; tick < tickCount; ++tick) {
+                if (simulation.isOver()) simulation.reset(config);
+                Clock::time_point start = Clock::now();
+                replicator.capture(simulation);
+                captureSamples.push_back(nanosecondsSince(start));
+
+                if (tick >= lag) replicator.acknowledge(client, acks[tick % lag].first, acks[tick % lag].second);
+                message.clear();
+                start = Clock::now();
+                bool keyframe = replicator.encode(client, message);
+                encodeSamples.push_back(nanosecondsSince(start));
+                bytes += static_cast<long long>(message.size());
+                if (keyframe) {
+                    ++keyframes;
+                    maxKeyframe = std::max(maxKeyframe, message.size());
+                }
+                decodedAll = decoder.decode(message.data(), message.size()) && decodedAll;
+                acks[tick % lag] = { decoder.getGeneration(), decoder.getLatestTick() };
+
+                simulation.saveSnapshot(snapshot);
+                snapshotBytes += static_cast<long long>(snapshot.size());
+                for (int p = 0; p < config.playerCount; ++p) input.buttons[p] = bots[p].nextButtons(botRng);
+                simulation.step(input);
+            }
+            if (!decodedAll) {
+                std::cerr << "Benchmark Warning: A replicated state failed to decode." << std::endl;
+            }
+
+            std::vector<std::pair<std::string, long long>> params = { { "columns", config.columns }, { "rows", config.rows },
+                { "players", config.playerCount }, { "enemies", config.enemyCount }, { "ack_lag", lag },
+                { "bytes_per_tick", bytes / tickCount }, { "keyframes", keyframes },
+                { "keyframe_bytes", static_cast<long long>(maxKeyframe) }, { "snapshot_bytes", snapshotBytes / tickCount } };
+            BenchmarkResult captureResult = summarizeSamples("replication_capture", captureSamples);
+            captureResult.params = params;
+            results.push_back(captureResult);
+            BenchmarkResult encodeResult = summarizeSamples("replication_encode", encodeSamples);
+            encodeResult.params = params;
+            results.push_back(encodeResult);
+        }
+    }
+
+    // One client per player on the largest map, each shown a screen-sized
+    // area around its player, against one client shown the whole map.
+    void benchInterest(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+        if (!wanted(options, "replication")) return;
+        MatchConfig config;
+        config.columns = MAP_SIZES[2].columns;
+        config.rows = MAP_SIZES[2].rows;
+        config.enemyCount = 1000;
+        config.playerCount = MAX_PLAYERS;
+        config.bombRange = 3;
+        config.maxActiveBombs = 2;
+        config.seed = options.seed;
+        config.invulnerablePlayers = true;
+        Simulation simulation;
+        if (!simulation.reset(config)) return;
+        const int AREA_COLUMNS = MAP_SIZES[0].columns;
+        const int AREA_ROWS = MAP_SIZES[0].rows;
+        int tileSize = simulation.getMap().getTileSize();
+
+        Replicator replicator;
+        ReplicaClient wholeClient;
+        ReplicaDecoder wholeDecoder;
+        ReplicaClient clients[MAX_PLAYERS];
+        ReplicaDecoder decoders[MAX_PLAYERS];
+        Rng botRng(options.seed ^ 0xB075ull);
+        RandomBot bots[MAX_PLAYERS];
+        TickInput input;
+        std::vector<uint8_t> message;
+
+        int tickCount = options.quick ? 300 : 3000;
+        std::vector<double> collectSamples;
+        std::vector<double> areaSamples;
+        std::vector<double> wholeSamples;
+        collectSamples.reserve(static_cast<size_t>(tickCount) * MAX_PLAYERS);
+        areaSamples.reserve(static_cast<size_t>(tickCount) * MAX_PLAYERS);
+        wholeSamples.reserve(tickCount);
+        std::vector<int> scratch;
+        std::vector<ReplicaEnemy> enemies;
+        std::vector<ReplicaBomb> bombs;
+        long long areaBytes = 0;
+        long long wholeBytes = 0;
+        long long areaEnemies = 0;
+        bool decodedAll = true;
+        for (int tick = 0; tick < tickCount; ++tick) {
+            if (simulation.isOver()) simulation.reset(config);
+            replicator.capture(simulation);
+            const ReplicaFrame& frame = replicator.getLatest();
+            for (int p = 0; p < config.playerCount; ++p) {
+                ReplicaClient& client = clients[p];
+                client.area = InterestArea::centredOn(frame.players[p].x, frame.players[p].y, AREA_COLUMNS * tileSize,
+                    AREA_ROWS * tileSize);
+                Clock::time_point start = Clock::now();
+                frame.collect(client.area, scratch, enemies, bombs);
+                collectSamples.push_back(nanosecondsSince(start));
+                areaEnemies += static_cast<long long>(enemies.size());
+
+                message.clear();
+                start = Clock::now();
+                replicator.encode(client, message);
+                areaSamples.push_back(nanosecondsSince(start));
+                areaBytes += static_cast<long long>(message.size());
+                decodedAll = decoders[p].decode(message.data(), message.size()) && decodedAll;
+                replicator.acknowledge(client, decoders[p].getGeneration(), decoders[p].getLatestTick());
+            }
+
+            message.clear();
+            Clock::time_point start = Clock::now();
+            replicator.encode(wholeClient, message);
+            wholeSamples.push_back(nanosecondsSince(start));
+            wholeBytes += static_cast<long long>(message.size());
+            decodedAll = wholeDecoder.decode(message.data(), message.size()) && decodedAll;
+            replicator.acknowledge(wholeClient, wholeDecoder.getGeneration(), wholeDecoder.getLatestTick());
+
+            for (int p = 0; p < config.playerCount; ++p) input.buttons[p] = bots[p].nextButtons(botRng);
+            simulation.step(input);
+        }
+        if (!decodedAll) {
+            std::cerr << "Benchmark Warning: A replicated state failed to decode." << std::endl;
+        }
+
+        long long areaMessages = static_cast<long long>(tickCount) * config.playerCount;
+        std::vector<std::pair<std::string, long long>> params = { { "columns", config.columns }, { "rows", config.rows },
+            { "players", config.playerCount }, { "enemies", config.enemyCount }, { "area_columns", AREA_COLUMNS },
+            { "area_rows", AREA_ROWS }, { "enemies_in_area", areaEnemies / areaMessages },
+            { "area_bytes_per_tick", areaBytes / areaMessages }, { "whole_map_bytes_per_tick", wholeBytes / tickCount } };
+        const char* names[] = { "interest_collect", "interest_encode", "interest_encode_whole_map" };
+        std::vector<double>* samples[] = { &collectSamples, &areaSamples, &wholeSamples };
+        for (int i = 0; i < 3; ++i) {
+            BenchmarkResult result = summarizeSamples(names[i], *samples[i]);
+            result.params = params;
+            results.push_back(result);
+        }
+    }
+
+    // Times whole MctsBot decisions at a fixed play-out count, so the samples
+    // compare across machines and thread counts; playouts_per_second is the
+    // throughput the time budget buys.
+    void benchMcts(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+        if (!wanted(options, "mcts")) return;
+        MatchConfig config;
+        config.playerCount = MAX_PLAYERS;
+        config.enemyCount = 5;
+        config.seed = options.seed;
+        const int THREAD_COUNTS[] = { 1, 4 };
+        const int PLAYOUTS = 512;
+        int decisionCount = options.quick ? 10 : 100;
+        for (int threads : THREAD_COUNTS) {
+            MctsConfig mctsConfig;
+            mctsConfig.fixedPlayouts = PLAYOUTS;
+            mctsConfig.threads = threads;
+            mctsConfig.seed = options.seed;
+            MctsBot bot(mctsConfig);
+            Simulation simulation;
+            if (!simulation.reset(config)) return;
+            Rng botRng(options.seed ^ 0xB075ull);
+            RandomBot bots[MAX_PLAYERS];
+            TickInput input;
+
+            std::vector<double> samples;
+            samples.reserve(decisionCount);
+            for (int decision = 0; decision < decisionCount; ++decision) {
+                if (simulation.isOver()) simulation.reset(config);
+                Clock::time_point start = Clock::now();
+                gSink = gSink + bot.think(simulation, 0);
+                samples.push_back(nanosecondsSince(start));
+                // Moves the match on between decisions so they search varied states.
+                for (int tick = 0; tick < mctsConfig.actionTicks && !simulation.isOver(); ++tick) {
+                    for (int p = 0; p < config.playerCount; ++p) input.buttons[p] = bots[p].nextButtons(botRng);
+                    simulation.step(input);
+                }
+            }
+
+            const MctsStats& stats = bot.getStats();
+            BenchmarkResult result = summarizeSamples("mcts_think", samples);
+            result.params = { { "threads", threads }, { "playouts", PLAYOUTS }, { "horizon_ticks", mctsConfig.horizonTicks },
+                { "playouts_per_second", static_cast<long long>(stats.playouts / stats.thinkSeconds) } };
+            results.push_back(result);
+        }
+    }
+
+    // Times VecEnv::step over every environment at a few batch sizes, with
+    // random actions. A VecEnv runs on one thread, so steps_per_second is per
+    // core; each sample is one batched step.
+    void benchVecEnv(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+        if (!wanted(options, "env")) return;
+        const int ENV_COUNTS[] = { 1, 16, 256 };
+        int stepCount = options.quick ? 200 : 2000;
+        for (int envCount : ENV_COUNTS) {
+            VecEnvConfig config;
+            config.envCount = envCount;
+            config.match.seed = options.seed;
+            config.match.playerCount = 2;
+            VecEnv env;
+            if (!env.reset(config)) return;
+            Rng rng(options.seed);
+            std::vector<int32_t> actions(static_cast<size_t>(envCount));
+            int batches = std::max(8, stepCount * 16 / envCount);
+
+            std::vector<double> samples;
+            samples.reserve(batches);
+            double totalNs = 0.0;
+            for (int batch = 0; batch < batches; ++batch) {
+                for (auto& action : actions) action = rng.nextInt(VecEnv::ACTION_COUNT);
+                Clock::time_point start = Clock::now();
+                env.step(actions.data());
+                double ns = nanosecondsSince(start);
+                samples.push_back(ns);
+                totalNs += ns;
+                gSink = gSink + env.getObservations()[batch % env.getObservationSize()];
+            }
+
+            long long steps = static_cast<long long>(batches) * envCount;
+            BenchmarkResult result = summarizeSamples("env_step", samples);
+            result.params = { { "envs", envCount }, { "frame_skip", config.frameSkip },
+                { "observation_bytes", static_cast<long long>(env.getObservationSize()) },
+                { "episodes", env.getEpisodeCount() },
+                { "steps_per_second", static_cast<long long>(steps / (totalNs * 1e-9)) } };
+            results.push_back(result);
+        }
+    }
+
+    // Channels that each play for SOUND_MS of simulated time.
+    class TimedVoiceBackend : public VoiceBackend {
+    public:
+        static const uint32_t SOUND_MS = 1500;
+
+        explicit TimedVoiceBackend(int channels) : mEndMs(static_cast<size_t>(channels), 0), mNowMs(0), mPlays(0) {}
+
+        void setNow(uint32_t nowMs) { mNowMs = nowMs; }
+        long long getPlays() const { return mPlays; }
+
+        int getChannelCount() const override { return static_cast<int>(mEndMs.size()); }
+        bool play(int channel, int, int) override {
+            mEndMs[channel] = mNowMs + SOUND_MS;
+            ++mPlays;
+            return true;
+        }
+        void setVolume(int, int) override {}
+        void stop(int channel) override { mEndMs[channel] = mNowMs; }
+        bool isPlaying(int channel) const override { return mEndMs[channel] > mNowMs; }
+
+    private:
+        std::vector<uint32_t> mEndMs;
+        uint32_t mNowMs;
+        long long mPlays;
+    };
+
+    // Bursts of explosions every few frames, as chain reactions set them off,
+    // against 16 channels. Each sample is one frame's process() call; the
+    // voices started stay bounded however many explosions are triggered.
+    void benchVoices(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+        if (!wanted(options, "voice")) return;
+        const int CHANNELS = 16;
+        const uint32_t FRAME_MS = 16;
+        const int BURST_FRAMES = 6;
+        int frameCount = options.quick ? 600 : 6000;
+        for (int burst : { 1, 8, 64 }) {
+            TimedVoiceBackend backend(CHANNELS);
+            VoiceManager voices(backend);
+            SoundSettings explosion;
+            explosion.maxVoices = 3;
+            explosion.coalesceMs = 60;
+            explosion.priority = 1;
+            voices.setSound(0, explosion);
+            voices.setSound(1, SoundSettings());
+            Rng rng(options.seed);
+
+            std::vector<double> samples;
+            samples.reserve(frameCount);
+            for (int frame = 0; frame < frameCount; ++frame) {
+                uint32_t nowMs = static_cast<uint32_t>(frame) * FRAME_MS;
+                if (frame % BURST_FRAMES == 0) {
+                    for (int i = 0; i < burst; ++i) voices.trigger(0, 0.5f + rng.nextInt(100) / 100.0f);
+                }
+                if (rng.nextInt(10) == 0) voices.trigger(1);
+                backend.setNow(nowMs);
+                Clock::time_point start = Clock::now();
+                voices.process(nowMs);
+                samples.push_back(nanosecondsSince(start));
+            }
+
+            VoiceStats stats = voices.getStats();
+            BenchmarkResult result = summarizeSamples("voice_process", samples);
+            result.params = { { "channels", CHANNELS }, { "explosions_per_burst", burst },
+                { "triggers", static_cast<long long>(stats.triggers) }, { "voices_started", backend.getPlays() },
+                { "coalesced", static_cast<long long>(stats.coalesced) }, { "stolen", static_cast<long long>(stats.stolen) },
+                { "dropped", static_cast<long long>(stats.dropped) }, { "max_playing", stats.maxPlaying } };
+            results.push_back(result);
+        }
+    }
+
+    // A board filled in kiosk-sized batches to `scores` entries (24 bytes of
+    // log each), rebuilt from the log alone, then given a pending tail and
+    // reopened from its index. Samples are single rank-of-score and top-10
+    // queries, which read both the mapped index and the tail.
+    void benchLeaderboard(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+        if (!wanted(options, "leaderboard")) return;
+        const int BATCH_SCORES = 10000;
+        const int TAIL_SCORES = 2000;
+        const int MAX_SCORE = 100000;
+        const long long scoreCount = options.quick ? 100000 : 8000000;
+        const int queryCount = options.quick ? 1000 : 100000;
+        std::string path = (std::filesystem::temp_directory_path() / "bomberman_bench_scores").string();
+        std::error_code error;
+        std::filesystem::remove(path + ".log", error);
+        std::filesystem::remove(path + ".idx", error);
+
+        Rng rng(options.seed);
+        std::vector<ScoreRecord> batch(BATCH_SCORES);
+        auto fillBatch = [&](long long firstTime, int count) {
+            batch.resize(count);
+            for (int i = 0; i < count; ++i) {
+                batch[i].score = rng.nextInt(MAX_SCORE);
+                batch[i].source = static_cast<uint32_t>(rng.nextInt(64));
+                batch[i].time = static_cast<uint64_t>(firstTime + i);
+            }
+        };
+
+        Leaderboard board;
+        if (!board.open(path)) return;
+        Clock::time_point start = Clock::now();
+        for (long long added = 0; added < scoreCount; added += BATCH_SCORES) {
+            fillBatch(added, BATCH_SCORES);
+            board.add(batch);
+        }
+        double fillMs = nanosecondsSince(start) * 1e-6;
+
+        board.close();
+        std::filesystem::remove(path + ".idx", error);
+        start = Clock::now();
+        board.open(path);
+        double rebuildMs = nanosecondsSince(start) * 1e-6;
+
+        fillBatch(scoreCount, TAIL_SCORES);
+        board.add(batch);
+        board.close();
+        start = Clock::now();
+        board.open(path);
+        double reopenUs = nanosecondsSince(start) * 1e-3;
+        long long logBytes = static_cast<long long>(std::filesystem::file_size(path + ".log", error));
+
+        std::vector<double> rankSamples;
+        std::vector<double> topSamples;
+        rankSamples.reserve(queryCount);
+        topSamples.reserve(queryCount);
+        std::vector<ScoreRecord> top;
+        for (int i = 0; i < queryCount; ++i) {
+            int32_t score = rng.nextInt(MAX_SCORE);
+            start = Clock::now();
+            gSink = gSink + static_cast<long long>(board.getRank(score));
+            rankSamples.push_back(nanosecondsSince(start));
+
+            start = Clock::now();
+            board.getTop(10, top);
+            topSamples.push_back(nanosecondsSince(start));
+            if (!top.empty()) gSink = gSink + top.front().score;
+        }
+
+        std::vector<std::pair<std::string, long long>> params = { { "scores", static_cast<long long>(board.getCount()) },
+            { "log_bytes", logBytes }, { "fill_ms", static_cast<long long>(fillMs) },
+            { "rebuild_ms", static_cast<long long>(rebuildMs) }, { "reopen_us", static_cast<long long>(reopenUs) } };
+        BenchmarkResult rank = summarizeSamples("leaderboard_rank", rankSamples);
+        rank.params = params;
+        results.push_back(rank);
+        BenchmarkResult topResult = summarizeSamples("leaderboard_top10", topSamples);
+        topResult.params = params;
+        results.push_back(topResult);
+
+        board.close();
+        std::filesystem::remove(path + ".log", error);
+        std::filesystem::remove(path + ".idx", error);
+    }
+
+    void benchReplays(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+        if (!wanted(options, "replay")) return;
+        for (size_t i = 0; i < options.replayPaths.size(); ++i) {
+            Replay replay;
+            if (!replay.load(options.replayPaths[i])) continue;
+
+            Simulation simulation;
+            std::vector<double> samples;
+            samples.reserve(replay.inputs.size() * (options.quick ? 1 : 5));
+            for (int pass = 0; pass < (options.quick ? 1 : 5); ++pass) {
+                simulation.reset(replay.config);
+                for (const auto& input : replay.inputs) {
+                    Clock::time_point start = Clock::now();
+                    simulation.step(input);
+                    samples.push_back(nanosecondsSince(start));
+                }
+                if (simulation.computeChecksum() != replay.finalChecksum) {
+                    std::cerr << "Benchmark Warning: Replay '" << options.replayPaths[i] << "' diverged from its recording." << std::endl;
+                }
+            }
+            BenchmarkResult result = summarizeSamples("replay", samples);
+            result.params = { { "index", static_cast<long long>(i) }, { "ticks", static_cast<long long>(replay.inputs.size()) },
+                { "players", replay.config.playerCount }, { "enemies", replay.config.enemyCount } };
+            results.push_back(result);
+        }
+    }
+
+    void writeJsonString(std::ostream& out, const std::string& text) {
+        out << '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\') out << '\\';
+            out << c;
+        }
+        out << '"';
+    }
+}
+
+BenchmarkResult summarizeSamples(const std::string& name, std::vector<double>& samples) {
+    BenchmarkResult result;
+    result.name = name;
+    result.samples = samples.size();
+    if (samples.empty()) return result;
+
+    std::sort(samples.begin(), samples.end());
+    double total = 0.0;
+    for (double sample : samples) total += sample;
+    result.mean = total / samples.size();
+    result.p50 = percentile(samples, 0.50);
+    result.p90 = percentile(samples, 0.90);
+    result.p99 = percentile(samples, 0.99);
+    result.min = samples.front();
+    result.max = samples.back();
+    return result;
+}
+
+std::vector<BenchmarkResult> runCoreBenchmarks(const BenchmarkOptions& options) {
+    std::vector<BenchmarkResult> results;
+    benchIsColliding(options, results);
+    benchHandleExplosion(options, results);
+    benchCreateExplosion(options, results);
+    benchSkeletonDistance(options, results);
+    benchCheckCollision(options, results);
+    benchEnemyUpdate(options, results);
+    benchSimulationStep(options, results);
+    benchSnapshots(options, results);
+    benchRollbacks(options, results);
+    benchReplication(options, results);
+    benchInterest(options, results);
+    benchMcts(options, results);
+    benchVecEnv(options, results);
+    benchVoices(options, results);
+    benchLeaderboard(options, results);
+    benchReplays(options, results);
+    return results;
+}
+
+void writeBenchmarkJson(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+    out << "{\n  \"unit\": \"ns\",\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& result = results[i];
+        out << (i ? ",\n" : "\n") << "    {\"name\": ";
+        writeJsonString(out, result.name);
+        out << ", \"params\": {";
+        for (size_t p = 0; p < result.params.size(); ++p) {
+            out << (p ? ", " : "");
+            writeJsonString(out, result.params[p].first);
+            out << ": " << result.params[p].second;
+        }
+        out << "}, \"samples\": " << result.samples
+            << ", \"mean\": " << result.mean
+            << ", \"p50\": " << result.p50
+            << ", \"p90\": " << result.p90
+            << ", \"p99\": " << result.p99
+            << ", \"min\": " << result.min
+            << ", \"max\": " << result.max << "}";
+    }
+    out << "\n  ]\n}\n";
+}
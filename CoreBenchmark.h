@@ -0,0 +1,45 @@
+#ifndef CORE_BENCHMARK_H
+#define CORE_BENCHMARK_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Summary of one benchmark: every sample is a duration in nanoseconds, either
+// of a single operation or of one whole tick depending on the benchmark.
+struct BenchmarkResult {
+    std::string name;
+    std::vector<std::pair<std::string, long long>> params;
+    size_t samples = 0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+};
+
+struct BenchmarkOptions {
+    // Substring match on benchmark names; empty runs everything.
+    std::string filter;
+    // Fewer samples and smaller scenario grids, for smoke runs in CI.
+    bool quick = false;
+    uint64_t seed = 1;
+    // Recorded matches to replay tick by tick as real-world workloads.
+    std::vector<std::string> replayPaths;
+};
+
+BenchmarkResult summarizeSamples(const std::string& name, std::vector<double>& samples);
+
+// Runs the micro benchmarks (Map::isColliding, Map::handleExplosion,
+// Bomb::createExplosion, WallSkeleton::distance, checkCollision, Enemy::update) and the full
+// Simulation::step scenarios over map size, enemy count and live bombs,
+// snapshot save/restore, rollback re-simulation depth, replication encoding,
+// Monte Carlo bot decisions, batched training environment steps, sound
+// voice management, leaderboard queries, plus any replays given in the options.
+std::vector<BenchmarkResult> runCoreBenchmarks(const BenchmarkOptions& options);
+
+void writeBenchmarkJson(std::ostream& out, const std::vector<BenchmarkResult>& results);
+
+#endif // CORE_BENCHMARK_H
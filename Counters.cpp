@@ -0,0 +1,128 @@
+#include "Counters.h"
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Profiler.h"
+
+std::atomic<uint64_t> Counters::sGauges[COUNTER_COUNT] = {};
+
+namespace {
+    const char* const COUNTER_NAMES[COUNTER_COUNT] = {
+        "draw_calls",
+        "textures_created",
+        "textures_destroyed",
+        "heap_allocations",
+        "map_collision_queries",
+        "collision_pair_tests",
+        "bombs_alive",
+        "enemies_alive",
+        "sound_triggers",
+        "voices_started",
+        "voices_playing",
+        "input_age_ms"
+    };
+
+    bool isGauge(int counter) {
+        return counter == static_cast<int>(Counter::BOMBS_ALIVE) || counter == static_cast<int>(Counter::ENEMIES_ALIVE)
+            || counter == static_cast<int>(Counter::VOICES_PLAYING)
+            || counter == static_cast<int>(Counter::INPUT_AGE_MS);
+    }
+
+    // Blocks are never freed, so counts from threads that have exited still
+    // reach the frame they happened in. `published` is what endFrame() last
+    // saw of each block and is touched by the main loop only.
+    struct BlockRegistry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<CounterBlock>> blocks;
+        std::vector<std::unique_ptr<uint64_t[]>> published;
+    };
+
+    BlockRegistry& registry() {
+        static BlockRegistry instance;
+        return instance;
+    }
+
+    // Registering allocates, which would count an allocation on the block
+    // being registered; those are dropped instead of recursing.
+    thread_local bool tRegistering = false;
+
+    CounterFrame gLastFrame;
+    uint64_t gFrameCount = 0;
+    std::ofstream gCsvLog;
+}
+
+CounterBlock* Counters::currentBlock() {
+    if (tRegistering) return nullptr;
+    tRegistering = true;
+    std::unique_ptr<CounterBlock> block(new CounterBlock());
+    std::unique_ptr<uint64_t[]> published(new uint64_t[COUNTER_COUNT]());
+    for (auto& value : block->values) value.store(0, std::memory_order_relaxed);
+    {
+        BlockRegistry& blocks = registry();
+        std::lock_guard<std::mutex> lock(blocks.mutex);
+        tBlock = block.get();
+        blocks.blocks.push_back(std::move(block));
+        blocks.published.push_back(std::move(published));
+    }
+    tRegistering = false;
+    return tBlock;
+}
+
+const char* Counters::getName(Counter counter) {
+    int index = static_cast<int>(counter);
+    return index >= 0 && index < COUNTER_COUNT ? COUNTER_NAMES[index] : "unknown";
+}
+
+void Counters::endFrame() {
+    CounterFrame frame;
+    frame.frame = gFrameCount++;
+    {
+        BlockRegistry& blocks = registry();
+        std::lock_guard<std::mutex> lock(blocks.mutex);
+        for (size_t i = 0; i < blocks.blocks.size(); ++i) {
+            for (int counter = 0; counter < COUNTER_COUNT; ++counter) {
+                if (isGauge(counter)) continue;
+                uint64_t value = blocks.blocks[i]->values[counter].load(std::memory_order_relaxed);
+                frame.values[counter] += value - blocks.published[i][counter];
+                blocks.published[i][counter] = value;
+            }
+        }
+    }
+    for (int counter = 0; counter < COUNTER_COUNT; ++counter) {
+        if (isGauge(counter)) frame.values[counter] = sGauges[counter].load(std::memory_order_relaxed);
+    }
+    gLastFrame = frame;
+
+    if (gCsvLog.is_open()) {
+        gCsvLog << frame.frame << "," << Profiler::nowNs() / 1000;
+        for (int counter = 0; counter < COUNTER_COUNT; ++counter) gCsvLog << "," << frame.values[counter];
+        gCsvLog << "\n";
+    }
+}
+
+CounterFrame Counters::getLastFrame() {
+    return gLastFrame;
+}
+
+bool Counters::openCsvLog(const std::string& path) {
+    closeCsvLog();
+    gCsvLog.open(path, std::ios::trunc);
+    if (!gCsvLog) {
+        std::cerr << "Counters Error: Cannot open '" << path << "' for writing." << std::endl;
+        return false;
+    }
+    gCsvLog << "frame,time_us";
+    for (int counter = 0; counter < COUNTER_COUNT; ++counter) gCsvLog << "," << COUNTER_NAMES[counter];
+    gCsvLog << "\n";
+    return true;
+}
+
+void Counters::closeCsvLog() {
+    if (gCsvLog.is_open()) gCsvLog.close();
+}
+
+bool Counters::isCsvLogOpen() {
+    return gCsvLog.is_open();
+}
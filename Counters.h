@@ -0,0 +1,88 @@
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Per-frame engine counters. Event counters (draw calls, allocations,
+// collision queries) are bumped on a thread-local block that only its own
+// thread writes, so an increment is a relaxed load and store. endFrame()
+// sums the change since the previous frame across every thread and publishes
+// it; gauges (entities alive) are set directly and published as they stand.
+// Define BOMBERMAN_COUNTERS_DISABLED to compile the increments out.
+
+enum class Counter : uint8_t {
+    DRAW_CALLS,
+    TEXTURES_CREATED,
+    TEXTURES_DESTROYED,
+    // Fed by the operator new hooks in AllocationTracker.cpp.
+    HEAP_ALLOCATIONS,
+    MAP_COLLISION_QUERIES,
+    COLLISION_PAIR_TESTS,
+    BOMBS_ALIVE,
+    ENEMIES_ALIVE,
+    // Fed by VoiceManager: sounds asked for, and voices actually started.
+    SOUND_TRIGGERS,
+    VOICES_STARTED,
+    VOICES_PLAYING,
+    // How old the oldest key event in the last tick that had one was when
+    // that tick was simulated, in milliseconds.
+    INPUT_AGE_MS,
+    COUNT
+};
+
+const int COUNTER_COUNT = static_cast<int>(Counter::COUNT);
+
+struct CounterFrame {
+    uint64_t frame = 0;
+    uint64_t values[COUNTER_COUNT] = {};
+
+    uint64_t get(Counter counter) const { return values[static_cast<int>(counter)]; }
+};
+
+struct CounterBlock {
+    std::atomic<uint64_t> values[COUNTER_COUNT];
+};
+
+class Counters {
+public:
+    static void add(Counter counter, uint64_t amount = 1) {
+        CounterBlock* block = tBlock ? tBlock : currentBlock();
+        if (!block) return;
+        std::atomic<uint64_t>& value = block->values[static_cast<int>(counter)];
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static void set(Counter counter, uint64_t value) {
+        sGauges[static_cast<int>(counter)].store(value, std::memory_order_relaxed);
+    }
+
+    static const char* getName(Counter counter);
+
+    // Called once per main-loop frame, after Profiler::endFrame().
+    static void endFrame();
+    static CounterFrame getLastFrame();
+
+    // Appends one row per frame until closed. Returns false if the file
+    // cannot be opened.
+    static bool openCsvLog(const std::string& path);
+    static void closeCsvLog();
+    static bool isCsvLogOpen();
+
+private:
+    // Defined inline so every caller sees the constant initializer and reads
+    // the slot directly instead of through a TLS init wrapper.
+    static inline thread_local CounterBlock* tBlock = nullptr;
+    static std::atomic<uint64_t> sGauges[COUNTER_COUNT];
+
+    static CounterBlock* currentBlock();
+};
+
+#ifndef BOMBERMAN_COUNTERS_DISABLED
+#define COUNTER_ADD(counter, amount) Counters::add(counter, amount)
+#else
+#define COUNTER_ADD(counter, amount) ((void)0)
+#endif
+
+#endif // COUNTERS_H
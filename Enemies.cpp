@@ -1,142 +1,145 @@
-﻿#include "enemies.h"
-#include "map.h" 
-#include <random>
-#include <ctime>   
-#include <iostream> 
-
-Enemy::Enemy(SDL_Renderer* renderer, SDL_Texture* texture, int x, int y)
-    : mRenderer(renderer),
-    mTexture(texture),
-    mX(x),
-    mY(y),
-    mWidth(40), 
-    mHeight(40),
-    mSpeed(100.0f),
-    mDirection(static_cast<Direction>(rand() % 4)),
-    mDirectionChangeTimer(0.0f),
-    mDirectionChangeCooldown(2.0f)
-{
-   
-    if (mTexture) {
-        SDL_QueryTexture(mTexture, nullptr, nullptr, &mWidth, &mHeight);
-    }
-   
-}
-
-
-void Enemy::setSize(int width, int height) {
-    mWidth = width;
-    mHeight = height;
-}
-
-// Find a safe spawn position that doesn't overlap with walls
-bool Enemy::findSafePosition(Map* map) {
-    if (!map) { 
-        std::cerr << "Error: Map pointer is null in Enemy::findSafePosition" << std::endl;
-        return false;
-    }
-    int tileSize = map->getTileSize();
-    int maxRows = map->getRows();
-    int maxCols = map->getColumns();
-
-    if (maxCols <= 2 || maxRows <= 2) { 
-        std::cerr << "Error: Map is too small to find a safe position." << std::endl;
-        return false; 
-    }
-
-
-    for (int attempts = 0; attempts < 100; attempts++) {
-       
-        int col = 1 + (rand() % (maxCols - 2));
-        int row = 1 + (rand() % (maxRows - 2));
-
-        int testX = col * tileSize;
-        int testY = row * tileSize;
-
-        
-        if (!map->isColliding(testX, testY, mWidth, mHeight)) {
-            mX = testX;
-            mY = testY;
-            return true;
-        }
-    }
-    std::cerr << "Warning: Enemy::findSafePosition failed after 100 attempts." << std::endl;
-    return false; 
-}
-
-void Enemy::update(float deltaTime, Map* map) {
-    if (!map) return;
-
-    mDirectionChangeTimer += deltaTime;
-
-    if (mDirectionChangeTimer >= mDirectionChangeCooldown) {
-        changeDirection();
-        mDirectionChangeTimer = 0.0f;
-    }
-
-    int prevX = mX;
-    int prevY = mY;
-
-    int moveAmount = static_cast<int>(mSpeed * deltaTime);
-
-    switch (mDirection) {
-    case UP:    mY -= moveAmount; break;
-    case DOWN:  mY += moveAmount; break;
-    case LEFT:  mX -= moveAmount; break;
-    case RIGHT: mX += moveAmount; break;
-    }
-
-   
-    if (map->isColliding(mX, mY, mWidth, mHeight)) {
-        mX = prevX;
-        mY = prevY;
-        changeDirection(); // Đổi hướng khi va chạm
-    }
-
-   
-    int mapPixelWidth = map->getColumns() * map->getTileSize();
-    int mapPixelHeight = map->getRows() * map->getTileSize();
-
-    if (mX < 0) { mX = 0; changeDirection(); }
-    if (mX + mWidth > mapPixelWidth) { mX = mapPixelWidth - mWidth; changeDirection(); }
-    if (mY < 0) { mY = 0; changeDirection(); }
-    if (mY + mHeight > mapPixelHeight) { mY = mapPixelHeight - mHeight; changeDirection(); }
-}
-
-void Enemy::render() {
-    if (mRenderer && mTexture) {
-        SDL_Rect destRect = { mX, mY, mWidth, mHeight };
-        SDL_RenderCopy(mRenderer, mTexture, nullptr, &destRect);
-    }
-}
-}
-
-void Enemy::changeDirection() {
-    Direction newDirection;
-    int attempts = 0; 
-    do {
-        newDirection = static_cast<Direction>(rand() % 4);
-        attempts++;
-    } while (newDirection == mDirection && attempts < 8); 
-
-    mDirection = newDirection;
-}
-
-
-bool Enemy::canMoveInDirection(Direction dir, Map* map) {
-    if (!map) return false;
-
-    // int tileSize = map->getTileSize(); // Không cần thiết nếu dùng isColliding
-    int nextX = mX;
-    int nextY = mY;
-    int moveStep = 1; // Kiểm tra một khoảng nhỏ phía trước
-
-    switch (dir) {
-    case UP:    nextY -= moveStep; break;
-    case DOWN:  nextY += moveStep; break;
-    case LEFT:  nextX -= moveStep; break;
-    case RIGHT: nextX += moveStep; break;
-    }
-
-    return !map->isColliding(nextX, nextY, mWidth, mHeight);
-}
+﻿#include "Enemies.h"
+#include "Map.h"
+#include "ByteStream.h"
+#include <cstdlib>
+
+Enemy::Enemy(int x, int y, int size, Direction direction)
+    : mId(0),
+    mX(x),
+    mY(y),
+    mWidth(size),
+    mHeight(size),
+    mDirection(direction),
+    mDirectionChangeTimer(0)
+{
+}
+
+void Enemy::setSize(int width, int height) {
+    mWidth = width;
+    mHeight = height;
+}
+
+void Enemy::saveState(ByteWriter& writer) const {
+    writer.writeVarint(mId);
+    writer.writeSignedVarint(mX);
+    writer.writeSignedVarint(mY);
+    writer.writeU8(static_cast<uint8_t>(mDirection));
+    writer.writeVarint(static_cast<uint64_t>(mDirectionChangeTimer));
+}
+
+void Enemy::loadState(ByteReader& reader) {
+    mId = static_cast<uint32_t>(reader.readVarint());
+    mX = static_cast<int>(reader.readSignedVarint());
+    mY = static_cast<int>(reader.readSignedVarint());
+    mDirection = static_cast<Direction>(reader.readU8() & 0x03);
+    mDirectionChangeTimer = static_cast<int>(reader.readVarint());
+}
+
+bool Enemy::findSafePosition(const Map& map, Rng& rng, const std::vector<TilePos>& spawnTiles) {
+    int tileSize = map.getTileSize();
+    int maxRows = map.getRows();
+    int maxCols = map.getColumns();
+
+    if (maxCols <= 2 || maxRows <= 2) {
+        return false;
+    }
+
+    for (int attempts = 0; attempts < 100; attempts++) {
+        int col = 1 + rng.nextInt(maxCols - 2);
+        int row = 1 + rng.nextInt(maxRows - 2);
+
+        bool inSpawnArea = false;
+        for (const auto& spawn : spawnTiles) {
+            int distance = map.getSkeleton().distance(spawn, { row, col });
+            if (distance >= 0 && distance < MIN_SPAWN_DISTANCE) {
+                inSpawnArea = true;
+                break;
+            }
+        }
+        if (inSpawnArea) continue;
+
+        int testX = col * tileSize;
+        int testY = row * tileSize;
+        if (!map.isColliding(testX, testY, mWidth, mHeight)) {
+            mX = testX;
+            mY = testY;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Enemy::update(const Map& map, Rng& rng, const std::vector<TilePos>& targets) {
+    ++mDirectionChangeTimer;
+    int tileSize = map.getTileSize();
+    if (!targets.empty() && mX % tileSize == 0 && mY % tileSize == 0 && chase(map, targets)) {
+        mDirectionChangeTimer = 0;
+    }
+    else if (mDirectionChangeTimer >= DIRECTION_CHANGE_TICKS) {
+        changeDirection(rng);
+        mDirectionChangeTimer = 0;
+    }
+
+    int prevX = mX;
+    int prevY = mY;
+
+    switch (mDirection) {
+    case UP:    mY -= STEP_PER_TICK; break;
+    case DOWN:  mY += STEP_PER_TICK; break;
+    case LEFT:  mX -= STEP_PER_TICK; break;
+    case RIGHT: mX += STEP_PER_TICK; break;
+    }
+
+    if (map.isColliding(mX, mY, mWidth, mHeight)) {
+        mX = prevX;
+        mY = prevY;
+        changeDirection(rng);
+    }
+
+    int mapPixelWidth = map.getPixelWidth();
+    int mapPixelHeight = map.getPixelHeight();
+
+    if (mX < 0) { mX = 0; changeDirection(rng); }
+    if (mX + mWidth > mapPixelWidth) { mX = mapPixelWidth - mWidth; changeDirection(rng); }
+    if (mY < 0) { mY = 0; changeDirection(rng); }
+    if (mY + mHeight > mapPixelHeight) { mY = mapPixelHeight - mHeight; changeDirection(rng); }
+}
+
+// Skeleton distances ignore soft walls, so of the shortest first steps only
+// one onto an empty tile is taken; with none, the enemy keeps wandering.
+bool Enemy::chase(const Map& map, const std::vector<TilePos>& targets) {
+    const WallSkeleton& skeleton = map.getSkeleton();
+    TilePos here = { mY / map.getTileSize(), mX / map.getTileSize() };
+    int nearest = CHASE_DISTANCE + 1;
+    TilePos target = here;
+    for (const auto& candidate : targets) {
+        int distance = skeleton.distance(here, candidate);
+        if (distance >= 0 && distance < nearest) {
+            nearest = distance;
+            target = candidate;
+        }
+    }
+    if (nearest > CHASE_DISTANCE) return false;
+
+    Direction steps[2];
+    int stepCount = skeleton.nextSteps(here, target, steps);
+    for (int i = 0; i < stepCount; ++i) {
+        TilePos next = WallSkeleton::step(here, steps[i]);
+        if (map.getTileType(next.row, next.col) == TileType::EMPTY) {
+            mDirection = steps[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+void Enemy::changeDirection(Rng& rng) {
+    Direction newDirection;
+    int attempts = 0;
+    do {
+        newDirection = static_cast<Direction>(rng.nextInt(4));
+        attempts++;
+    } while (newDirection == mDirection && attempts < 8);
+
+    mDirection = newDirection;
+}
@@ -1,49 +1,58 @@
-﻿#ifndef ENEMIES_H
-#define ENEMIES_H
-
-#include <SDL.h>
-#include "map.h" // Đảm bảo Map được include nếu Enemy tương tác trực tiếp với nó
-
-
-
-enum Direction {
-    UP,
-    DOWN,
-    LEFT,
-    RIGHT
-};
-
-class Enemy {
-public:
-    Enemy(SDL_Renderer* renderer, SDL_Texture* texture, int x, int y);
-    ~Enemy() = default; 
-
-    void update(float deltaTime, Map* map);
-    void render();
-    bool findSafePosition(Map* map);
-
-    int getX() const { return mX; }
-    int getY() const { return mY; }
-    int getWidth() const { return mWidth; }
-    int getHeight() const { return mHeight; }
-
-    void setPosition(int x, int y) { mX = x; mY = y; }
-    void setSize(int width, int height); // <<< THÊM DÒNG NÀY
-    void changeDirection();
-
-private:
-    SDL_Renderer* mRenderer;
-    SDL_Texture* mTexture;
-
-    int mX, mY;
-    int mWidth, mHeight;
-    float mSpeed;
-    Direction mDirection;
-
-    float mDirectionChangeTimer;
-    float mDirectionChangeCooldown;
-
-    bool canMoveInDirection(Direction dir, Map* map);
-};
-
-#endif 
+﻿#ifndef ENEMIES_H
+#define ENEMIES_H
+
+#include <vector>
+#include "SimTypes.h"
+#include "Rng.h"
+
+class Map;
+class ByteWriter;
+class ByteReader;
+
+class Enemy {
+public:
+    Enemy(int x, int y, int size, Direction direction);
+
+    // Wanders at random, but whenever it stands square on a tile with a
+    // target (a living player's tile) within CHASE_DISTANCE steps through the
+    // wall skeleton, heads along a shortest path towards the nearest one.
+    void update(const Map& map, Rng& rng, const std::vector<TilePos>& targets);
+    // Picks a random empty tile at least MIN_SPAWN_DISTANCE steps from every
+    // spawn tile, so no enemy starts out chasing a player.
+    bool findSafePosition(const Map& map, Rng& rng, const std::vector<TilePos>& spawnTiles);
+
+    int getX() const { return mX; }
+    int getY() const { return mY; }
+    int getWidth() const { return mWidth; }
+    int getHeight() const { return mHeight; }
+    Rect getRect() const { return { mX, mY, mWidth, mHeight }; }
+    // Stable across the match while enemies before it die, so replication
+    // can tell which enemies a client already has.
+    uint32_t getId() const { return mId; }
+    void setId(uint32_t id) { mId = id; }
+
+    void setPosition(int x, int y) { mX = x; mY = y; }
+    void setSize(int width, int height);
+    void changeDirection(Rng& rng);
+
+    // Snapshot support. Size is not stored; it comes from the match config.
+    void saveState(ByteWriter& writer) const;
+    void loadState(ByteReader& reader);
+
+    static const int CHASE_DISTANCE = 5;
+    static const int MIN_SPAWN_DISTANCE = CHASE_DISTANCE + 1;
+
+private:
+    static const int STEP_PER_TICK = 1;
+    static const int DIRECTION_CHANGE_TICKS = 120;
+
+    uint32_t mId;
+    int mX, mY;
+    int mWidth, mHeight;
+    Direction mDirection;
+    int mDirectionChangeTimer;
+
+    bool chase(const Map& map, const std::vector<TilePos>& targets);
+};
+
+#endif // ENEMIES_H
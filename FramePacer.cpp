@@ -0,0 +1,111 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <cmath>
+
+FramePacer::FramePacer(PacingMode mode, double targetFps)
+    : mMode(mode),
+    mFrequency(SDL_GetPerformanceFrequency()),
+    mTicksPerFrame(0),
+    mSpinThresholdTicks(0),
+    mLastFrameStart(0),
+    mNextDeadline(0),
+    mNextSample(0),
+    mFrameCount(0)
+{
+    if (targetFps <= 0.0) targetFps = 60.0;
+    mTicksPerFrame = static_cast<Uint64>(mFrequency / targetFps);
+    // SDL_Delay can oversleep by a millisecond or so; the last 2 ms are spun.
+    mSpinThresholdTicks = mFrequency * 2 / 1000;
+    mFrameTimesMs.reserve(SAMPLE_WINDOW);
+}
+
+void FramePacer::setMode(PacingMode mode) {
+    mMode = mode;
+    mNextDeadline = 0;
+}
+
+float FramePacer::beginFrame() {
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (mLastFrameStart == 0) {
+        mLastFrameStart = now;
+        mNextDeadline = now + mTicksPerFrame;
+        return 0.0f;
+    }
+
+    Uint64 elapsed = now - mLastFrameStart;
+    mLastFrameStart = now;
+
+    float elapsedMs = static_cast<float>(elapsed * 1000.0 / mFrequency);
+    if (mFrameTimesMs.size() < SAMPLE_WINDOW) {
+        mFrameTimesMs.push_back(elapsedMs);
+    }
+    else {
+        mFrameTimesMs[mNextSample] = elapsedMs;
+    }
+    mNextSample = (mNextSample + 1) % SAMPLE_WINDOW;
+    ++mFrameCount;
+
+    return std::min(MAX_DELTA_SECONDS, elapsedMs / 1000.0f);
+}
+
+void FramePacer::endFrame(bool presented) {
+    if (mMode == PacingMode::FIXED || (mMode == PacingMode::VSYNC && !presented)) {
+        waitForDeadline();
+    }
+}
+
+void FramePacer::waitForDeadline() {
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (mNextDeadline == 0 || now > mNextDeadline + mTicksPerFrame) {
+        // More than a frame behind: resynchronise instead of rushing to catch up.
+        mNextDeadline = now + mTicksPerFrame;
+        return;
+    }
+
+    while (now < mNextDeadline) {
+        Uint64 remaining = mNextDeadline - now;
+        if (remaining > mSpinThresholdTicks) {
+            Uint32 sleepMs = static_cast<Uint32>((remaining - mSpinThresholdTicks) * 1000 / mFrequency);
+            if (sleepMs > 0) SDL_Delay(sleepMs);
+        }
+        now = SDL_GetPerformanceCounter();
+    }
+    // Deadlines advance on a fixed grid so rounding never accumulates into drift.
+    mNextDeadline += mTicksPerFrame;
+}
+
+void FramePacer::resync() {
+    mLastFrameStart = SDL_GetPerformanceCounter();
+    mNextDeadline = mLastFrameStart + mTicksPerFrame;
+}
+
+FramePacer::Stats FramePacer::computeStats() const {
+    Stats stats;
+    stats.frames = mFrameCount;
+    if (mFrameTimesMs.empty()) return stats;
+
+    std::vector<float> sorted(mFrameTimesMs);
+    std::sort(sorted.begin(), sorted.end());
+
+    double sum = 0.0;
+    for (float sample : sorted) sum += sample;
+    stats.averageMs = sum / sorted.size();
+
+    double variance = 0.0;
+    for (float sample : sorted) variance += (sample - stats.averageMs) * (sample - stats.averageMs);
+    stats.jitterMs = std::sqrt(variance / sorted.size());
+
+    stats.minMs = sorted.front();
+    stats.maxMs = sorted.back();
+    stats.p50Ms = sorted[sorted.size() / 2];
+    stats.p99Ms = sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+    return stats;
+}
+
+void FramePacer::printStats(std::ostream& out) const {
+    Stats stats = computeStats();
+    out << "Frame pacing (" << (mMode == PacingMode::VSYNC ? "vsync" : mMode == PacingMode::FIXED ? "fixed" : "uncapped")
+        << ", last " << std::min<unsigned long long>(stats.frames, SAMPLE_WINDOW) << " of " << stats.frames << " frames): "
+        << "avg " << stats.averageMs << " ms, p50 " << stats.p50Ms << " ms, p99 " << stats.p99Ms
+        << " ms, min " << stats.minMs << " ms, max " << stats.maxMs << " ms, jitter " << stats.jitterMs << " ms" << std::endl;
+}
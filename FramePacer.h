@@ -0,0 +1,65 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <SDL.h>
+#include <vector>
+#include <ostream>
+
+enum class PacingMode {
+    VSYNC,      // SDL_RenderPresent blocks on the display; the pacer only measures
+    FIXED,      // sleep most of the remaining frame, then spin to the deadline
+    UNCAPPED    // never wait
+};
+
+// Frame timing built on SDL_GetPerformanceCounter. Call beginFrame() at the
+// top of the loop and endFrame() after presenting.
+class FramePacer {
+public:
+    struct Stats {
+        unsigned long long frames = 0;
+        double averageMs = 0.0;
+        double minMs = 0.0;
+        double maxMs = 0.0;
+        double p50Ms = 0.0;
+        double p99Ms = 0.0;
+        double jitterMs = 0.0; // standard deviation of the frame interval
+    };
+
+    explicit FramePacer(PacingMode mode, double targetFps = 60.0);
+
+    // Returns seconds since the previous beginFrame(), clamped so a stall
+    // (window drag, breakpoint) cannot teleport entities.
+    float beginFrame();
+    // In vsync mode a frame that skipped SDL_RenderPresent has nothing to
+    // block on, so it is paced like a fixed frame instead.
+    void endFrame(bool presented = true);
+
+    // Restarts the frame clock, e.g. after the loop blocked waiting for input,
+    // so the next beginFrame() does not report the idle time as a long frame.
+    void resync();
+
+    PacingMode getMode() const { return mMode; }
+    void setMode(PacingMode mode);
+
+    Stats computeStats() const;
+    void printStats(std::ostream& out) const;
+
+private:
+    PacingMode mMode;
+    Uint64 mFrequency;
+    Uint64 mTicksPerFrame;
+    Uint64 mSpinThresholdTicks;
+    Uint64 mLastFrameStart;
+    Uint64 mNextDeadline;
+
+    std::vector<float> mFrameTimesMs; // ring buffer of recent frame intervals
+    size_t mNextSample;
+    unsigned long long mFrameCount;
+
+    static const size_t SAMPLE_WINDOW = 600;
+    const float MAX_DELTA_SECONDS = 0.25f;
+
+    void waitForDeadline();
+};
+
+#endif // FRAME_PACER_H
@@ -1,756 +1,991 @@
-#include "game.h"
-#include <SDL_image.h>
-#include <iostream>
-#include <random>
-#include <ctime>
-#include <algorithm>
-#include <iomanip>
-#include <sstream>
-
-#include "player.h"
-#include "map.h"
-#include "bomb.h"
-#include "enemies.h"
-
-
-Game::Game(SDL_Renderer* renderer, int screenWidth, int screenHeight)
-    : mRenderer(renderer),
-    mScreenWidth(screenWidth),
-    mScreenHeight(screenHeight),
-    mGameOver(false),
-    mCurrentState(GameState::MAIN_MENU),
-    mMainMenu(nullptr),
-    mOptionsMenu(nullptr),
-    mGameSettings(),
-    mPlayer(nullptr),
-    mMap(nullptr),
-    mPlayerTexture(nullptr),
-    mEnemyTexture(nullptr),
-    mBackgroundTexture(nullptr),
-    mHardWallTexture(nullptr),
-    mBorderWallTexture(nullptr),
-    mBombTexture(nullptr),
-    mExplosionTexture(nullptr),
-    mGameFont(nullptr),
-    mUiFont(nullptr),
-    mMenuMusic(nullptr),
-    mIngameMusic(nullptr),
-    mBombExplosionSound(nullptr),
-    mCurrentScore(0),
-    mHighScore(0),
-    mGameTimerSeconds(MAX_GAME_TIME_SECONDS),
-    mScoreTextTexture(nullptr),
-    mTimerTextTexture(nullptr),
-    mUiTextColor({ 255, 255, 255, 255 }),
-    mGameOverStateTitleTexture(nullptr),
-    mFinalScoreTextTexture(nullptr),
-    mHighScoreTextTexture(nullptr),
-    mContinueButtonTexture(nullptr),
-    mEndGameButtonTexture(nullptr)
-
-{
-    for (auto& texture : mSoftWallTextures) {
-        texture = nullptr;
-    }
-    loadHighScore();
-    mGameSettings.updateActualPlayerSpeed();
-}
-
-Game::~Game() {
-    if (mPlayerTexture) SDL_DestroyTexture(mPlayerTexture);
-    if (mEnemyTexture) SDL_DestroyTexture(mEnemyTexture);
-    if (mBackgroundTexture) SDL_DestroyTexture(mBackgroundTexture);
-    if (mHardWallTexture) SDL_DestroyTexture(mHardWallTexture);
-    if (mBorderWallTexture) SDL_DestroyTexture(mBorderWallTexture);
-    if (mBombTexture) SDL_DestroyTexture(mBombTexture);
-    if (mExplosionTexture) SDL_DestroyTexture(mExplosionTexture);
-    for (auto& texture : mSoftWallTextures) {
-        if (texture) SDL_DestroyTexture(texture);
-    }
-
-    if (mGameFont) TTF_CloseFont(mGameFont);
-    if (mUiFont && mUiFont != mGameFont) TTF_CloseFont(mUiFont);
-    else if (mUiFont == mGameFont) mUiFont = nullptr;
-
-    if (mMenuMusic) Mix_FreeMusic(mMenuMusic);
-    if (mIngameMusic) Mix_FreeMusic(mIngameMusic);
-    if (mBombExplosionSound) Mix_FreeChunk(mBombExplosionSound);
-
-    if (mScoreTextTexture) SDL_DestroyTexture(mScoreTextTexture);
-    if (mTimerTextTexture) SDL_DestroyTexture(mTimerTextTexture);
-    if (mGameOverStateTitleTexture) SDL_DestroyTexture(mGameOverStateTitleTexture);
-    if (mFinalScoreTextTexture) SDL_DestroyTexture(mFinalScoreTextTexture);
-    if (mHighScoreTextTexture) SDL_DestroyTexture(mHighScoreTextTexture);
-    if (mContinueButtonTexture) SDL_DestroyTexture(mContinueButtonTexture);
-    if (mEndGameButtonTexture) SDL_DestroyTexture(mEndGameButtonTexture);
-}
-
-bool Game::initialize() {
-    std::srand(static_cast<unsigned int>(std::time(nullptr)));
-
-    mGameFont = TTF_OpenFont("game_font.otf", 48);
-    if (!mGameFont) {
-        std::cerr << "Game Error: Failed to load main font 'game_font.otf'. TTF_Error: " << TTF_GetError() << std::endl;
-        return false;
-    }
-    mUiFont = TTF_OpenFont("game_font.otf", 28);
-    if (!mUiFont) {
-        std::cerr << "Game Warning: Failed to load UI font. Using main font instead." << std::endl;
-        mUiFont = mGameFont;
-    }
-
-    if (!loadAudio()) {
-        std::cerr << "Game Warning: Failed to load some audio assets. Game will continue without them." << std::endl;
-    }
-
-    mMainMenu = std::make_unique<Menu>(mRenderer, mGameFont, mScreenWidth, mScreenHeight, mMenuMusic);
-    if (!mMainMenu || !mMainMenu->initialize("menu_background.png")) {
-        std::cerr << "Game Error: Failed to initialize the main menu!" << std::endl;
-        return false;
-    }
-
-    mOptionsMenu = std::make_unique<OptionsMenu>(mRenderer, mUiFont, mScreenWidth, mScreenHeight, mGameSettings);
-    if (!mOptionsMenu || !mOptionsMenu->initialize()) {
-        std::cerr << "Game Error: Failed to initialize the options menu!" << std::endl;
-    }
-
-    initializeGameOverMenuAssets();
-
-    transitionToMainMenu();
-
-    updateScoreDisplay();
-    updateTimerDisplay();
-
-    return true;
-}
-
-SDL_Texture* Game::createTextTexture(const std::string& text, SDL_Color color, TTF_Font* fontToUse) {
-    if (!fontToUse || !mRenderer) {
-        std::cerr << "Game Error: Cannot create text texture, font or renderer is null. Text: " << text << std::endl;
-        return nullptr;
-    }
-    SDL_Surface* textSurface = TTF_RenderText_Solid(fontToUse, text.c_str(), color);
-    if (!textSurface) {
-        std::cerr << "Game Error: TTF_RenderText_Solid failed for \"" << text << "\". TTF_Error: " << TTF_GetError() << std::endl;
-        return nullptr;
-    }
-    SDL_Texture* textTexture = SDL_CreateTextureFromSurface(mRenderer, textSurface);
-    SDL_FreeSurface(textSurface);
-    if (!textTexture) {
-        std::cerr << "Game Error: SDL_CreateTextureFromSurface failed for \"" << text << "\". SDL_Error: " << SDL_GetError() << std::endl;
-    }
-    return textTexture;
-}
-
-void Game::initializeGameOverMenuAssets() {
-    mContinueButtonTexture = createTextTexture("Choi Lai (R)", mUiTextColor, mUiFont);
-    mEndGameButtonTexture = createTextTexture("Menu Chinh (M)", mUiTextColor, mUiFont);
-
-    if (!mContinueButtonTexture || !mEndGameButtonTexture) {
-        std::cerr << "Game Error: Failed to create Game Over Menu button textures." << std::endl;
-    }
-
-    int btnWidth, btnHeight;
-    if (mContinueButtonTexture && TTF_SizeText(mUiFont, "Choi Lai (R)", &btnWidth, &btnHeight) == 0) {
-        mContinueButtonRect = { (mScreenWidth - btnWidth) / 2, mScreenHeight / 2 + 60, btnWidth, btnHeight };
-    }
-    else {
-        mContinueButtonRect = { (mScreenWidth - 220) / 2, mScreenHeight / 2 + 60, 220, 40 };
-    }
-
-    if (mEndGameButtonTexture && TTF_SizeText(mUiFont, "Menu Chinh (M)", &btnWidth, &btnHeight) == 0) {
-        mEndGameButtonRect = { (mScreenWidth - btnWidth) / 2, mContinueButtonRect.y + mContinueButtonRect.h + 20, btnWidth, btnHeight };
-    }
-    else {
-        mEndGameButtonRect = { (mScreenWidth - 240) / 2, mContinueButtonRect.y + mContinueButtonRect.h + 20, 240, 40 };
-    }
-}
-
-
-void Game::loadHighScore() {
-    mHighScore = 0;
-    std::cout << "High score loaded (session-based): " << mHighScore << std::endl;
-}
-
-void Game::saveHighScore() {
-    if (mCurrentScore > mHighScore) {
-        mHighScore = mCurrentScore;
-        std::cout << "New high score achieved: " << mHighScore << std::endl;
-    }
-}
-
-void Game::updateScoreDisplay() {
-    if (mScoreTextTexture) SDL_DestroyTexture(mScoreTextTexture);
-    std::ostringstream scoreStream;
-    scoreStream << "Score: " << std::setw(4) << std::setfill('0') << mCurrentScore;
-    mScoreTextTexture = createTextTexture(scoreStream.str(), mUiTextColor, mUiFont);
-}
-
-void Game::updateTimerDisplay() {
-    if (mTimerTextTexture) SDL_DestroyTexture(mTimerTextTexture);
-    int minutes = static_cast<int>(mGameTimerSeconds) / 60;
-    int seconds = static_cast<int>(mGameTimerSeconds) % 60;
-    if (minutes < 0) minutes = 0;
-    if (seconds < 0) seconds = 0;
-
-    std::ostringstream timerStream;
-    timerStream << "Time: " << std::setw(2) << std::setfill('0') << minutes
-        << ":" << std::setw(2) << std::setfill('0') << seconds;
-    mTimerTextTexture = createTextTexture(timerStream.str(), mUiTextColor, mUiFont);
-}
-
-bool Game::loadAudio() {
-    bool success = true;
-    mMenuMusic = Mix_LoadMUS("menu_music.mp3");
-    if (!mMenuMusic) {
-        std::cerr << "Game Warning: Failed to load menu_music.mp3. Mix_Error: " << Mix_GetError() << std::endl;
-        success = false;
-    }
-    mIngameMusic = Mix_LoadMUS("ingame_music.mp3");
-    if (!mIngameMusic) {
-        std::cerr << "Game Warning: Failed to load ingame_music.mp3. Mix_Error: " << Mix_GetError() << std::endl;
-        success = false;
-    }
-    mBombExplosionSound = Mix_LoadWAV("explosion_sound.wav");
-    if (!mBombExplosionSound) {
-        std::cerr << "Game Warning: Failed to load explosion_sound.wav. Mix_Error: " << Mix_GetError() << std::endl;
-        success = false;
-    }
-    return success;
-}
-
-void Game::playIngameMusic() {
-    if (mIngameMusic) {
-        stopMusic();
-        Mix_PlayMusic(mIngameMusic, -1);
-    }
-}
-
-void Game::stopMusic() {
-    Mix_HaltMusic();
-}
-
-void Game::playBombSoundEffect() {
-    if (mBombExplosionSound) {
-        Mix_PlayChannel(-1, mBombExplosionSound, 0);
-    }
-}
-
-void Game::startGame() {
-    resetGame();
-    mGameSettings.updateActualPlayerSpeed();
-
-    mPlayerTexture = loadTexture("player.png");
-    mEnemyTexture = loadTexture("enemies.png");
-    mBackgroundTexture = loadTexture("background.png");
-    mHardWallTexture = loadTexture("hard_wall.png");
-    mBorderWallTexture = loadTexture("border_wall.png");
-    mBombTexture = loadTexture("bomb.png");
-    mExplosionTexture = loadTexture("explosion.png");
-    mSoftWallTextures[0] = loadTexture("soft_wall_1.png");
-    mSoftWallTextures[1] = loadTexture("soft_wall_2.png");
-    mSoftWallTextures[2] = loadTexture("soft_wall_3.png");
-
-    bool texturesLoaded = mPlayerTexture && mEnemyTexture && mBackgroundTexture &&
-        mHardWallTexture && mBorderWallTexture && mBombTexture && mExplosionTexture &&
-        mSoftWallTextures[0] && mSoftWallTextures[1] && mSoftWallTextures[2];
-
-    if (!texturesLoaded) {
-        std::cerr << "Game Error: Failed to load essential game textures! Returning to main menu." << std::endl;
-        transitionToMainMenu();
-        return;
-    }
-
-    mMap = std::make_unique<Map>(mRenderer, mBackgroundTexture, mHardWallTexture, mBorderWallTexture, mSoftWallTextures);
-    if (!mMap || !mMap->initialize(mScreenWidth, mScreenHeight)) {
-        std::cerr << "Game Error: Failed to initialize map! Returning to main menu." << std::endl;
-        transitionToMainMenu();
-        return;
-    }
-
-    mPlayer = std::make_unique<Player>(mRenderer, mPlayerTexture, 0, 0, mMap.get());
-    if (mPlayer && mMap) {
-        mPlayer->setPosition(mMap->getTileSize(), mMap->getTileSize());
-        mPlayer->setSpeed(mGameSettings.actualPlayerSpeed);
-    }
-    else {
-        std::cerr << "Game Error: Failed to initialize player! Returning to main menu." << std::endl;
-        transitionToMainMenu();
-        return;
-    }
-
-    createEnemiesBasedOnOptions();
-
-    mCurrentScore = 0;
-    mGameTimerSeconds = MAX_GAME_TIME_SECONDS;
-    mGameOver = false;
-    updateScoreDisplay();
-    updateTimerDisplay();
-
-    mCurrentState = GameState::PLAYING;
-    playIngameMusic();
-}
-
-void Game::resetGame() {
-    mPlayer.reset();
-    mMap.reset();
-    mEnemies.clear();
-    mBombs.clear();
-    mGameOver = false;
-}
-
-void Game::createEnemiesBasedOnOptions() {
-    if (!mMap || !mEnemyTexture) {
-        std::cerr << "Game Warning: Cannot create enemies. Essential components (map or enemy texture) are missing." << std::endl;
-        return;
-    }
-    mEnemies.clear();
-    int tileSize = mMap->getTileSize();
-    int enemyCountToCreate = mGameSettings.enemyCount;
-
-    for (int i = 0; i < enemyCountToCreate; ++i) {
-        auto enemy = std::make_unique<Enemy>(mRenderer, mEnemyTexture, 0, 0);
-        enemy->setSize(tileSize, tileSize);
-
-        bool foundPos = false;
-        if (mMap) foundPos = enemy->findSafePosition(mMap.get());
-
-        if (foundPos) {
-            mEnemies.push_back(std::move(enemy));
-        }
-        else {
-            std::cerr << "Game Warning: Could not find a safe position for enemy " << (i + 1) << ". Enemy not created." << std::endl;
-        }
-    }
-    if (mEnemies.empty() && enemyCountToCreate > 0 && mMap) {
-        std::cerr << "Game Info: Fallback - placing at least one enemy." << std::endl;
-        auto enemy = std::make_unique<Enemy>(mRenderer, mEnemyTexture, 0, 0);
-        enemy->setSize(tileSize, tileSize);
-        if (enemy->findSafePosition(mMap.get())) {
-            mEnemies.push_back(std::move(enemy));
-        }
-        else {
-            int farX = (mMap->getColumns() - 2) * tileSize;
-            int farY = (mMap->getRows() - 2) * tileSize;
-            if (farX < tileSize && mMap->getColumns() > 1) farX = tileSize; else if (farX < 0) farX = 0;
-            if (farY < tileSize && mMap->getRows() > 1) farY = tileSize; else if (farY < 0) farY = 0;
-
-            if (!isColliding(farX, farY, enemy->getWidth(), enemy->getHeight())) {
-                enemy->setPosition(farX, farY);
-                mEnemies.push_back(std::move(enemy));
-            }
-            else {
-                std::cerr << "Game Critical Error: Could not place any enemy even in fallback." << std::endl;
-            }
-        }
-    }
-}
-
-
-void Game::handleEvent(SDL_Event& e) {
-    if (e.type == SDL_QUIT) {
-        return;
-    }
-    switch (mCurrentState) {
-    case GameState::MAIN_MENU:
-        handleMainMenuEvents(e);
-        break;
-    case GameState::OPTIONS_MENU:
-        handleOptionsMenuEvents(e);
-        break;
-    case GameState::PLAYING:
-        if (!mGameOver) {
-            if (mPlayer) mPlayer->handleEvent(e);
-            if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_SPACE) {
-                placeBomb();
-            }
-        }
-        break;
-    case GameState::GAME_OVER_MENU:
-        handleGameOverMenuEvents(e);
-        break;
-    }
-    if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_o &&
-        (mCurrentState == GameState::MAIN_MENU || mCurrentState == GameState::GAME_OVER_MENU)) {
-        bool menuHandledOptionKey = false;
-        if (mCurrentState == GameState::MAIN_MENU && mMainMenu) {
-
-
-        }
-        if (!menuHandledOptionKey) {
-            transitionToOptionsMenu();
-        }
-    }
-}
-
-void Game::handleMainMenuEvents(SDL_Event& e) {
-    if (mMainMenu) {
-        MenuAction action = mMainMenu->handleEvent(e);
-        switch (action) {
-        case MenuAction::START_GAME:
-            startGame();
-            break;
-        case MenuAction::OPEN_OPTIONS:
-            transitionToOptionsMenu();
-            break;
-        case MenuAction::EXIT_GAME:
-        {
-            SDL_Event quitEvent;
-            quitEvent.type = SDL_QUIT;
-            SDL_PushEvent(&quitEvent);
-        }
-        break;
-        case MenuAction::NONE:
-        default:
-            break;
-        }
-    }
-}
-
-void Game::handleOptionsMenuEvents(SDL_Event& e) {
-    if (mOptionsMenu) {
-        OptionsMenuAction action = mOptionsMenu->handleEvent(e);
-        if (action == OptionsMenuAction::BACK_TO_MAIN_MENU) {
-            mGameSettings.updateActualPlayerSpeed();
-            transitionToMainMenu();
-        }
-    }
-    else {
-        transitionToMainMenu();
-    }
-}
-
-void Game::handleGameOverMenuEvents(SDL_Event& e) {
-    if (e.type == SDL_MOUSEBUTTONDOWN) {
-        if (e.button.button == SDL_BUTTON_LEFT) {
-            int mouseX, mouseY;
-            SDL_GetMouseState(&mouseX, &mouseY);
-            SDL_Point mousePoint = { mouseX, mouseY };
-
-            if (SDL_PointInRect(&mousePoint, &mContinueButtonRect)) {
-                startGame();
-            }
-            else if (SDL_PointInRect(&mousePoint, &mEndGameButtonRect)) {
-                transitionToMainMenu();
-            }
-        }
-    }
-    if (e.type == SDL_KEYDOWN) {
-        if (e.key.keysym.sym == SDLK_r) {
-            startGame();
-        }
-        else if (e.key.keysym.sym == SDLK_m || e.key.keysym.sym == SDLK_ESCAPE) {
-            transitionToMainMenu();
-        }
-    }
-}
-
-void Game::transitionToMainMenu() {
-    mCurrentState = GameState::MAIN_MENU;
-    stopMusic();
-    if (mMainMenu) mMainMenu->playMusic();
-}
-
-void Game::transitionToOptionsMenu() {
-    mCurrentState = GameState::OPTIONS_MENU;
-    stopMusic();
-    if (mOptionsMenu) {
-        mOptionsMenu->updateOptionDisplays();
-    }
-}
-
-
-void Game::update(float deltaTime) {
-    if (mCurrentState == GameState::PLAYING && !mGameOver) {
-        mGameTimerSeconds -= deltaTime;
-        if (mGameTimerSeconds <= 0) {
-            mGameTimerSeconds = 0;
-            mGameOver = true;
-            std::cout << "Time's up! Game Over." << std::endl;
-        }
-        updateTimerDisplay();
-
-        if (mPlayer) {
-            int prevX = mPlayer->getX(); int prevY = mPlayer->getY();
-            mPlayer->update(deltaTime);
-            if (mMap && isColliding(mPlayer->getX(), mPlayer->getY(), mPlayer->getWidth(), mPlayer->getHeight())) {
-                mPlayer->setPosition(prevX, prevY);
-            }
-        }
-
-        for (auto enemyIt = mEnemies.begin(); enemyIt != mEnemies.end();) {
-            if (*enemyIt) {
-                (*enemyIt)->update(deltaTime, mMap.get());
-                if (mPlayer) {
-                    SDL_Rect playerRect = { mPlayer->getX(), mPlayer->getY(), mPlayer->getWidth(), mPlayer->getHeight() };
-                    SDL_Rect enemyRect = { (*enemyIt)->getX(), (*enemyIt)->getY(), (*enemyIt)->getWidth(), (*enemyIt)->getHeight() };
-                    if (checkCollision(playerRect, enemyRect)) {
-                        mGameOver = true;
-                        std::cout << "Game Over! Collided with an enemy." << std::endl;
-                        break;
-                    }
-                }
-                ++enemyIt;
-            }
-            else { enemyIt = mEnemies.erase(enemyIt); }
-        }
-        if (mGameOver) { transitionToGameOver(); return; }
-
-        for (auto it = mBombs.begin(); it != mBombs.end();) {
-            if (*it) {
-                bool wasBombExploding = (*it)->isExploding();
-                (*it)->update(deltaTime);
-
-                if ((*it)->isExploding() && !wasBombExploding && !(*it)->hasExplosionSoundPlayed()) {
-                    playBombSoundEffect();
-                    (*it)->setExplosionSoundPlayed(true);
-                }
-
-                if ((*it)->isExploding()) {
-                    Explosion& explosion = (*it)->getExplosion();
-                    if (mMap) {
-                        int softWallsDestroyed = mMap->handleExplosion(explosion);
-                        if (softWallsDestroyed > 0) {
-                            mCurrentScore += softWallsDestroyed * 50;
-                            updateScoreDisplay();
-                        }
-                    }
-
-                    if (mPlayer && !mGameOver) {
-                        SDL_Rect playerRect = { mPlayer->getX(), mPlayer->getY(), mPlayer->getWidth(), mPlayer->getHeight() };
-                        for (const auto& part : explosion.parts) {
-                            SDL_Rect explosionRect = { part.x, part.y, mMap ? mMap->getTileSize() : 32, mMap ? mMap->getTileSize() : 32 };
-                            if (checkCollision(playerRect, explosionRect)) {
-                                mGameOver = true;
-                                std::cout << "Game Over! Caught in an explosion." << std::endl;
-                                break;
-                            }
-                        }
-                    }
-                    if (mGameOver) break;
-
-                    for (auto enemyIt = mEnemies.begin(); enemyIt != mEnemies.end();) {
-                        if (*enemyIt) {
-                            bool enemyHit = false;
-                            SDL_Rect enemyRect = { (*enemyIt)->getX(), (*enemyIt)->getY(), (*enemyIt)->getWidth(), (*enemyIt)->getHeight() };
-                            for (const auto& part : explosion.parts) {
-                                SDL_Rect explosionRect = { part.x, part.y, mMap ? mMap->getTileSize() : 32, mMap ? mMap->getTileSize() : 32 };
-                                if (checkCollision(enemyRect, explosionRect)) {
-                                    enemyHit = true; break;
-                                }
-                            }
-                            if (enemyHit) {
-                                enemyIt = mEnemies.erase(enemyIt);
-                                mCurrentScore += 500;
-                                updateScoreDisplay();
-                            }
-                            else { ++enemyIt; }
-                        }
-                        else { enemyIt = mEnemies.erase(enemyIt); }
-                    }
-                }
-                if ((*it)->isDone()) {
-                    it = mBombs.erase(it);
-                }
-                else { ++it; }
-            }
-            else { it = mBombs.erase(it); }
-        }
-        if (mGameOver) { transitionToGameOver(); return; }
-
-        if (mEnemies.empty() && mGameTimerSeconds > 0) {
-            std::cout << "You win! All enemies defeated." << std::endl;
-            mGameOver = true;
-        }
-        if (mGameOver) {
-            transitionToGameOver();
-        }
-    }
-    else if (mCurrentState == GameState::OPTIONS_MENU) {
-
-    }
-}
-
-void Game::transitionToGameOver() {
-    stopMusic();
-    calculateFinalScore();
-    saveHighScore();
-
-    TTF_Font* titleFont = TTF_OpenFont("game_font.otf", 60);
-    if (!titleFont) titleFont = mGameFont;
-
-    if (mGameOverStateTitleTexture) SDL_DestroyTexture(mGameOverStateTitleTexture);
-    if (mEnemies.empty() && mGameTimerSeconds > 0) {
-        mGameOverStateTitleTexture = createTextTexture("YOU WIN!", { 50, 205, 50, 255 }, titleFont);
-    }
-    else {
-        mGameOverStateTitleTexture = createTextTexture("GAME OVER", { 255, 69, 0, 255 }, titleFont);
-    }
-
-    if (mFinalScoreTextTexture) SDL_DestroyTexture(mFinalScoreTextTexture);
-    std::ostringstream finalScoreStream;
-    finalScoreStream << "Final Score: " << std::setw(4) << std::setfill('0') << mCurrentScore;
-    mFinalScoreTextTexture = createTextTexture(finalScoreStream.str(), mUiTextColor, mUiFont);
-
-    if (mHighScoreTextTexture) SDL_DestroyTexture(mHighScoreTextTexture);
-    std::ostringstream highScoreStream;
-    highScoreStream << "High Score: " << std::setw(4) << std::setfill('0') << mHighScore;
-    mHighScoreTextTexture = createTextTexture(highScoreStream.str(), mUiTextColor, mUiFont);
-
-    if (titleFont && titleFont != mGameFont) TTF_CloseFont(titleFont);
-
-    mCurrentState = GameState::GAME_OVER_MENU;
-}
-
-void Game::calculateFinalScore() {
-    if (mEnemies.empty() && mGameTimerSeconds > 0) {
-        int timeBonus = static_cast<int>(mGameTimerSeconds) * 20;
-        mCurrentScore += timeBonus;
-        std::cout << "Time Bonus: +" << timeBonus << " points." << std::endl;
-    }
-}
-
-
-void Game::render() {
-    switch (mCurrentState) {
-    case GameState::MAIN_MENU:
-        if (mMainMenu) mMainMenu->render();
-        break;
-    case GameState::OPTIONS_MENU:
-        if (mOptionsMenu) mOptionsMenu->render();
-        else {
-            SDL_SetRenderDrawColor(mRenderer, 30, 30, 30, 255); SDL_RenderClear(mRenderer);
-            SDL_Texture* errText = createTextTexture("Options Not Available", mUiTextColor, mGameFont);
-            if (errText) {
-                int w, h; SDL_QueryTexture(errText, 0, 0, &w, &h);
-                SDL_Rect r = { (mScreenWidth - w) / 2, (mScreenHeight - h) / 2,w,h };
-                SDL_RenderCopy(mRenderer, errText, 0, &r);
-                SDL_DestroyTexture(errText);
-            }
-        }
-        break;
-    case GameState::PLAYING:
-        renderPlayingState();
-        break;
-    case GameState::GAME_OVER_MENU:
-        renderGameOverMenu();
-        break;
-    }
-}
-
-void Game::renderPlayingState() {
-    if (mMap) mMap->render();
-    for (const auto& bomb : mBombs) {
-        if (bomb) bomb->render(mRenderer, mBombTexture, mExplosionTexture);
-    }
-    for (const auto& enemy : mEnemies) {
-        if (enemy) enemy->render();
-    }
-    if (mPlayer) mPlayer->render();
-    renderScoreAndTimer();
-}
-
-void Game::renderScoreAndTimer() {
-    if (mScoreTextTexture) {
-        int w, h;
-        SDL_QueryTexture(mScoreTextTexture, NULL, NULL, &w, &h);
-        SDL_Rect destRect = { 20, 10, w, h };
-        SDL_RenderCopy(mRenderer, mScoreTextTexture, NULL, &destRect);
-    }
-    if (mTimerTextTexture) {
-        int w, h;
-        SDL_QueryTexture(mTimerTextTexture, NULL, NULL, &w, &h);
-        SDL_Rect destRect = { mScreenWidth - w - 20, 10, w, h };
-        SDL_RenderCopy(mRenderer, mTimerTextTexture, NULL, &destRect);
-    }
-}
-
-void Game::renderGameOverMenu() {
-    renderPlayingState();
-
-    SDL_SetRenderDrawBlendMode(mRenderer, SDL_BLENDMODE_BLEND);
-    SDL_SetRenderDrawColor(mRenderer, 0, 0, 0, 180);
-    SDL_Rect overlayRect = { 0, 0, mScreenWidth, mScreenHeight };
-    SDL_RenderFillRect(mRenderer, &overlayRect);
-    SDL_SetRenderDrawBlendMode(mRenderer, SDL_BLENDMODE_NONE);
-
-    if (mGameOverStateTitleTexture) {
-        int w, h;
-        SDL_QueryTexture(mGameOverStateTitleTexture, NULL, NULL, &w, &h);
-        SDL_Rect titleRect = { (mScreenWidth - w) / 2, mScreenHeight / 4 - h / 2, w, h };
-        SDL_RenderCopy(mRenderer, mGameOverStateTitleTexture, NULL, &titleRect);
-    }
-
-    if (mFinalScoreTextTexture) {
-        int w, h;
-        SDL_QueryTexture(mFinalScoreTextTexture, NULL, NULL, &w, &h);
-        SDL_Rect scoreRect = { (mScreenWidth - w) / 2, mScreenHeight / 2 - h - 40, w, h };
-        SDL_RenderCopy(mRenderer, mFinalScoreTextTexture, NULL, &scoreRect);
-    }
-
-    if (mHighScoreTextTexture) {
-        int w, h;
-        SDL_QueryTexture(mHighScoreTextTexture, NULL, NULL, &w, &h);
-        SDL_Rect highScoreRect = { (mScreenWidth - w) / 2, mScreenHeight / 2 - 0, w, h };
-        SDL_RenderCopy(mRenderer, mHighScoreTextTexture, NULL, &highScoreRect);
-    }
-
-    if (mContinueButtonTexture) {
-        SDL_RenderCopy(mRenderer, mContinueButtonTexture, NULL, &mContinueButtonRect);
-    }
-
-    if (mEndGameButtonTexture) {
-        SDL_RenderCopy(mRenderer, mEndGameButtonTexture, NULL, &mEndGameButtonRect);
-    }
-}
-
-SDL_Texture* Game::loadTexture(const std::string& path) {
-    SDL_Texture* texture = IMG_LoadTexture(mRenderer, path.c_str());
-    if (texture == nullptr) {
-        std::cerr << "Game Error: Failed to load texture '" << path << "'. SDL_image Error: " << IMG_GetError() << std::endl;
-    }
-    return texture;
-}
-
-void Game::placeBomb() {
-    if (!mPlayer || !mMap) return;
-
-    long activeBombsCount = 0;
-    for (const auto& currentBomb : mBombs) {
-        if (currentBomb && !currentBomb->isExploding() && !currentBomb->isDone()) {
-            activeBombsCount++;
-        }
-    }
-
-    if (activeBombsCount >= mGameSettings.playerMaxActiveBombs) {
-        return;
-    }
-
-    int tileSize = mMap->getTileSize();
-    int bombPlacementX = (mPlayer->getX() + mPlayer->getWidth() / 2) / tileSize * tileSize;
-    int bombPlacementY = (mPlayer->getY() + mPlayer->getHeight() / 2) / tileSize * tileSize;
-
-    for (const auto& existingBomb : mBombs) {
-        if (existingBomb && !existingBomb->isDone() &&
-            existingBomb->getX() == bombPlacementX && existingBomb->getY() == bombPlacementY) {
-            return;
-        }
-    }
-
-    auto newBomb = std::make_unique<Bomb>(bombPlacementX, bombPlacementY, tileSize, 2.0f, mGameSettings.playerBombRange);
-    newBomb->setMap(mMap.get());
-    newBomb->setExplosionSoundPlayed(false);
-    mBombs.push_back(std::move(newBomb));
-}
-
-bool Game::checkCollision(SDL_Rect a, SDL_Rect b) {
-    int leftA = a.x, rightA = a.x + a.w, topA = a.y, bottomA = a.y + a.h;
-    int leftB = b.x, rightB = b.x + b.w, topB = b.y, bottomB = b.y + b.h;
-    if (bottomA <= topB || topA >= bottomB || rightA <= leftB || leftA >= rightB) return false;
-    return true;
-}
-
-bool Game::isColliding(int x, int y, int width, int height) {
-    if (!mMap) return true;
-    return mMap->isColliding(x, y, width, height);
-}
+#include "Game.h"
+#include "Profiler.h"
+#include "Counters.h"
+#include "AllocationTracker.h"
+#include <SDL_image.h>
+#include <iostream>
+#include <ctime>
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+    const char* LAST_MATCH_REPLAY_PATH = "last_match.bmr";
+    const char* COUNTER_LOG_PATH = "frame_counters.csv";
+    const char* ASSET_ARCHIVE_PATH = "assets.pak";
+    const char* LEADERBOARD_PATH = "scores";
+
+    bool isAudioOpen() {
+        int frequency = 0, channels = 0;
+        Uint16 format = 0;
+        return Mix_QuerySpec(&frequency, &format, &channels) != 0;
+    }
+
+    uint8_t buttonForKey(SDL_Keycode key) {
+        switch (key) {
+        case SDLK_UP:    return INPUT_UP;
+        case SDLK_DOWN:  return INPUT_DOWN;
+        case SDLK_LEFT:  return INPUT_LEFT;
+        case SDLK_RIGHT: return INPUT_RIGHT;
+        case SDLK_SPACE: return INPUT_BOMB;
+        default:         return 0;
+        }
+    }
+
+    uint8_t pollHeldButtons() {
+        const Uint8* keys = SDL_GetKeyboardState(nullptr);
+        uint8_t buttons = 0;
+        if (keys[SDL_SCANCODE_UP]) buttons |= INPUT_UP;
+        if (keys[SDL_SCANCODE_DOWN]) buttons |= INPUT_DOWN;
+        if (keys[SDL_SCANCODE_LEFT]) buttons |= INPUT_LEFT;
+        if (keys[SDL_SCANCODE_RIGHT]) buttons |= INPUT_RIGHT;
+        return buttons;
+    }
+}
+
+Game::Game(Renderer* renderer, int screenWidth, int screenHeight)
+    : mRenderer(renderer),
+    mScreenWidth(screenWidth),
+    mScreenHeight(screenHeight),
+    mCurrentState(GameState::MAIN_MENU),
+    mAssetLoader(nullptr),
+    mMainMenu(nullptr),
+    mOptionsMenu(nullptr),
+    mGameSettings(),
+    mTickAccumulator(0.0f),
+    mInput(INPUT_BOMB),
+    mDisplayedSeconds(-1),
+    mNetMatchesStarted(0),
+    mLocalPlayer(0),
+    mPlayerTexture(nullptr),
+    mEnemyTexture(nullptr),
+    mBackgroundTexture(nullptr),
+    mHardWallTexture(nullptr),
+    mBorderWallTexture(nullptr),
+    mBombTexture(nullptr),
+    mExplosionTexture(nullptr),
+    mGameFont(nullptr),
+    mUiFont(nullptr),
+    mTitleFont(nullptr),
+    mDebugFont(nullptr),
+    mMenuMusic(nullptr),
+    mIngameMusic(nullptr),
+    mBombExplosionSound(nullptr),
+    mCurrentScore(0),
+    mHighScore(0),
+    mPersistent(true),
+    mUiTextColor({ 255, 255, 255, 255 }),
+    mScoreLabelTexture(nullptr),
+    mTimerLabelTexture(nullptr),
+    mWinTitle(UiScreen::NO_WIDGET),
+    mLoseTitle(UiScreen::NO_WIDGET),
+    mFinalScoreLabel(UiScreen::NO_WIDGET),
+    mHighScoreLabel(UiScreen::NO_WIDGET),
+    mGameOverBackdrop(nullptr),
+    mNeedsRedraw(true),
+    mMusicWasPlaying(false)
+
+{
+    for (auto& texture : mSoftWallTextures) {
+        texture = nullptr;
+    }
+    for (auto& glyph : mHudGlyphs) {
+        glyph = nullptr;
+    }
+    mScoreText[0] = '\0';
+    mTimerText[0] = '\0';
+    mGameSettings.updateActualPlayerSpeed();
+}
+
+Game::~Game() {
+    // The voice thread may still be playing the chunks freed below.
+    mVoices.reset();
+    if (mPlayerTexture) mRenderer->destroyTexture(mPlayerTexture);
+    if (mEnemyTexture) mRenderer->destroyTexture(mEnemyTexture);
+    if (mBackgroundTexture) mRenderer->destroyTexture(mBackgroundTexture);
+    if (mHardWallTexture) mRenderer->destroyTexture(mHardWallTexture);
+    if (mBorderWallTexture) mRenderer->destroyTexture(mBorderWallTexture);
+    if (mBombTexture) mRenderer->destroyTexture(mBombTexture);
+    if (mExplosionTexture) mRenderer->destroyTexture(mExplosionTexture);
+    for (auto& texture : mSoftWallTextures) {
+        if (texture) mRenderer->destroyTexture(texture);
+    }
+
+    if (mGameFont) TTF_CloseFont(mGameFont);
+    if (mUiFont && mUiFont != mGameFont) TTF_CloseFont(mUiFont);
+    else if (mUiFont == mGameFont) mUiFont = nullptr;
+    if (mTitleFont && mTitleFont != mGameFont) TTF_CloseFont(mTitleFont);
+    mProfilerOverlay.reset();
+    if (mDebugFont) TTF_CloseFont(mDebugFont);
+
+    if (mMenuMusic) Mix_FreeMusic(mMenuMusic);
+    if (mIngameMusic) Mix_FreeMusic(mIngameMusic);
+    if (mBombExplosionSound) Mix_FreeChunk(mBombExplosionSound);
+
+    for (auto& glyph : mHudGlyphs) {
+        if (glyph) mRenderer->destroyTexture(glyph);
+    }
+    if (mScoreLabelTexture) mRenderer->destroyTexture(mScoreLabelTexture);
+    if (mTimerLabelTexture) mRenderer->destroyTexture(mTimerLabelTexture);
+    mGameOverUi.reset();
+    if (mGameOverBackdrop) mRenderer->destroyTexture(mGameOverBackdrop);
+
+    mAssetLoader.reset();
+}
+
+bool Game::initialize() {
+    StartupGraph startup;
+    addStartupTasks(startup, StartupGraph::NO_TASK, StartupGraph::NO_TASK, StartupGraph::NO_TASK, StartupGraph::NO_TASK);
+    if (!startup.run()) return false;
+    addDeferredTasks(startup);
+    return startup.run();
+}
+
+// The loader is only ever used by one task at a time: the font task runs on a
+// worker while the window is created, and every later task that requests
+// assets depends on it.
+void Game::addStartupTasks(StartupGraph& graph, StartupGraph::TaskId video, StartupGraph::TaskId fonts,
+    StartupGraph::TaskId images, StartupGraph::TaskId audio) {
+    StartupGraph::TaskId archive = graph.add("game.archive", TaskThread::WORKER, {}, [this]() {
+        mAssetLoader = std::make_unique<AssetLoader>(mRenderer);
+        mAssetLoader->openArchive(ASSET_ARCHIVE_PATH);
+        return true;
+    });
+    if (mPersistent) {
+        graph.add("game.scores", TaskThread::WORKER, {}, [this]() {
+            loadHighScore();
+            return true;
+        });
+    }
+    StartupGraph::TaskId gameFonts = graph.add("game.fonts", TaskThread::WORKER, { archive, fonts }, [this]() {
+        return loadFonts();
+    });
+    StartupGraph::TaskId menu = graph.add("game.menu", TaskThread::MAIN, { gameFonts, video }, [this]() {
+        return initializeMainMenu();
+    });
+    graph.add("game.sounds", TaskThread::MAIN, { gameFonts, audio }, [this]() {
+        requestAudio();
+        return true;
+    });
+    graph.add("game.textures", TaskThread::MAIN, { menu, images }, [this]() {
+        mAssetLoader->requestTexture("menu_background.png", [this](Texture* texture) {
+            if (!texture) std::cerr << "Game Warning: Failed to load menu background texture." << std::endl;
+            if (mMainMenu) mMainMenu->setBackgroundTexture(texture);
+        });
+        requestGameplayTextures();
+        return true;
+    });
+}
+
+void Game::addDeferredTasks(StartupGraph& graph) {
+    graph.add("game.options_menu", TaskThread::MAIN, {}, [this]() {
+        mOptionsMenu = std::make_unique<OptionsMenu>(mRenderer, mUiFont, mScreenWidth, mScreenHeight, mGameSettings);
+        if (!mOptionsMenu || !mOptionsMenu->initialize()) {
+            std::cerr << "Game Error: Failed to initialize the options menu!" << std::endl;
+        }
+        return true;
+    });
+    graph.add("game.game_over_menu", TaskThread::MAIN, {}, [this]() {
+        initializeGameOverMenuAssets();
+        return true;
+    });
+    graph.add("game.hud", TaskThread::MAIN, {}, [this]() {
+        createHudGlyphs();
+        updateScoreDisplay();
+        updateTimerDisplay();
+        return true;
+    });
+    graph.add("game.ingame_music", TaskThread::MAIN, {}, [this]() {
+        requestIngameMusic();
+        return true;
+    });
+}
+
+// The menu cannot be laid out without its fonts, so those are the only assets
+// the first frame waits for. Everything else streams in afterwards.
+bool Game::loadFonts() {
+    mAssetLoader->requestFont("game_font.otf", 48, [this](TTF_Font* font) { mGameFont = font; });
+    mAssetLoader->requestFont("game_font.otf", 28, [this](TTF_Font* font) { mUiFont = font; });
+    mAssetLoader->requestFont("game_font.otf", 60, [this](TTF_Font* font) { mTitleFont = font; });
+    mAssetLoader->requestFont("game_font.otf", 16, [this](TTF_Font* font) { mDebugFont = font; });
+    mAssetLoader->finishAll();
+
+    if (!mGameFont) {
+        std::cerr << "Game Error: Failed to load main font 'game_font.otf'." << std::endl;
+        return false;
+    }
+    if (!mUiFont) {
+        std::cerr << "Game Warning: Failed to load UI font. Using main font instead." << std::endl;
+        mUiFont = mGameFont;
+    }
+    if (!mTitleFont) mTitleFont = mGameFont;
+    return true;
+}
+
+bool Game::initializeMainMenu() {
+    mProfilerOverlay = std::make_unique<ProfilerOverlay>(mRenderer, mDebugFont ? mDebugFont : mUiFont);
+
+    mMainMenu = std::make_unique<Menu>(mRenderer, mGameFont, mScreenWidth, mScreenHeight, mMenuMusic);
+    if (!mMainMenu || !mMainMenu->initialize()) {
+        std::cerr << "Game Error: Failed to initialize the main menu!" << std::endl;
+        return false;
+    }
+    transitionToMainMenu();
+    return true;
+}
+
+Texture* Game::createTextTexture(const char* text, SDL_Color color, TTF_Font* fontToUse) {
+    PROFILE_SCOPE("ui.textTexture");
+    if (!fontToUse || !mRenderer) {
+        std::cerr << "Game Error: Cannot create text texture, font or renderer is null. Text: " << text << std::endl;
+        return nullptr;
+    }
+    SDL_Surface* textSurface = TTF_RenderText_Solid(fontToUse, text, color);
+    if (!textSurface) {
+        std::cerr << "Game Error: TTF_RenderText_Solid failed for \"" << text << "\". TTF_Error: " << TTF_GetError() << std::endl;
+        return nullptr;
+    }
+    Texture* textTexture = mRenderer->createTextureFromSurface(textSurface);
+    SDL_FreeSurface(textSurface);
+    if (!textTexture) {
+        std::cerr << "Game Error: SDL_CreateTextureFromSurface failed for \"" << text << "\". SDL_Error: " << SDL_GetError() << std::endl;
+    }
+    return textTexture;
+}
+
+void Game::initializeGameOverMenuAssets() {
+    mGameOverUi = std::make_unique<UiScreen>(mRenderer, mUiFont);
+    UiScreen& ui = *mGameOverUi;
+    TTF_Font* titleFont = mTitleFont ? mTitleFont : mGameFont;
+    int centerX = mScreenWidth / 2;
+    int centerY = mScreenHeight / 2;
+
+    mWinTitle = ui.addLabel("YOU WIN!", { 50, 205, 50, 255 }, titleFont);
+    mLoseTitle = ui.addLabel("GAME OVER", { 255, 69, 0, 255 }, titleFont);
+    ui.place(mWinTitle, centerX, mScreenHeight / 4, UiAlign::CENTER, UiAlign::CENTER);
+    ui.place(mLoseTitle, centerX, mScreenHeight / 4, UiAlign::CENTER, UiAlign::CENTER);
+    ui.setVisible(mWinTitle, false);
+
+    mFinalScoreLabel = ui.addLabel("Final Score: 0000", mUiTextColor);
+    mHighScoreLabel = ui.addLabel("High Score: 0000", mUiTextColor);
+    ui.place(mFinalScoreLabel, centerX, centerY - 40, UiAlign::CENTER, UiAlign::END);
+    ui.place(mHighScoreLabel, centerX, centerY);
+
+    UiScreen::WidgetId playAgain = ui.addButton("Choi Lai (R)", mUiTextColor, static_cast<int>(GameOverAction::PLAY_AGAIN));
+    UiScreen::WidgetId mainMenu = ui.addButton("Menu Chinh (M)", mUiTextColor, static_cast<int>(GameOverAction::MAIN_MENU));
+    ui.place(playAgain, centerX, centerY + 60);
+    ui.place(mainMenu, centerX, 20, UiAlign::CENTER, UiAlign::START, playAgain);
+}
+
+
+void Game::loadHighScore() {
+    // Without the leaderboard files the high score only lasts the session.
+    if (!mLeaderboard.open(LEADERBOARD_PATH)) {
+        mHighScore = 0;
+        return;
+    }
+    mHighScore = mLeaderboard.getBestScore();
+    std::cout << "High score loaded: " << mHighScore << " (" << mLeaderboard.getCount() << " scores on the leaderboard)" << std::endl;
+}
+
+void Game::saveHighScore() {
+    if (mPersistent) {
+        ScoreRecord record;
+        record.score = mCurrentScore;
+        record.time = static_cast<uint64_t>(std::time(nullptr));
+        mLeaderboard.add(record);
+    }
+    if (mCurrentScore > mHighScore) {
+        mHighScore = mCurrentScore;
+        std::cout << "New high score achieved: " << mHighScore << std::endl;
+    }
+}
+
+void Game::createHudGlyphs() {
+    static const char GLYPHS[HUD_GLYPH_COUNT + 1] = "0123456789:";
+    for (int i = 0; i < HUD_GLYPH_COUNT; ++i) {
+        char text[2] = { GLYPHS[i], '\0' };
+        mHudGlyphs[i] = createTextTexture(text, mUiTextColor, mUiFont);
+    }
+    mScoreLabelTexture = createTextTexture("Score: ", mUiTextColor, mUiFont);
+    mTimerLabelTexture = createTextTexture("Time: ", mUiTextColor, mUiFont);
+}
+
+int Game::measureHudText(const char* text) const {
+    int width = 0;
+    for (const char* c = text; *c; ++c) {
+        int index = *c == ':' ? 10 : *c - '0';
+        if (index >= 0 && index < HUD_GLYPH_COUNT && mHudGlyphs[index]) width += mHudGlyphs[index]->width;
+    }
+    return width;
+}
+
+void Game::renderHudText(const char* text, int x, int y) {
+    for (const char* c = text; *c; ++c) {
+        int index = *c == ':' ? 10 : *c - '0';
+        if (index < 0 || index >= HUD_GLYPH_COUNT || !mHudGlyphs[index]) continue;
+        Texture* glyph = mHudGlyphs[index];
+        SDL_Rect destRect = { x, y, glyph->width, glyph->height };
+        mRenderer->copy(glyph, NULL, &destRect);
+        x += glyph->width;
+    }
+}
+
+void Game::updateScoreDisplay() {
+    std::snprintf(mScoreText, sizeof(mScoreText), "%04d", mCurrentScore);
+}
+
+void Game::updateTimerDisplay() {
+    mDisplayedSeconds = mSimulation.getRemainingTicks() / TICKS_PER_SECOND;
+    int minutes = mDisplayedSeconds / 60;
+    int seconds = mDisplayedSeconds % 60;
+    std::snprintf(mTimerText, sizeof(mTimerText), "%02d:%02d", minutes, seconds);
+}
+
+void Game::requestAudio() {
+    if (!isAudioOpen()) {
+        std::cout << "Game Info: No audio device open, skipping audio assets." << std::endl;
+        return;
+    }
+    mVoiceBackend = std::make_unique<MixerVoiceBackend>(SOUND_CHANNELS);
+    mVoices = std::make_unique<VoiceManager>(*mVoiceBackend);
+    SoundSettings explosion;
+    explosion.maxVoices = 3;
+    explosion.coalesceMs = 60;
+    explosion.priority = 1;
+    // A lone blast plays at full volume, as it did before voices were
+    // managed; coalesced ones clip there.
+    explosion.volume = 1.0f;
+    mVoices->setSound(SOUND_EXPLOSION, explosion);
+    mVoices->start();
+
+    mAssetLoader->requestMusic("menu_music.mp3", [this](Mix_Music* music) {
+        mMenuMusic = music;
+        if (mMainMenu) mMainMenu->setMusic(music);
+        if (mCurrentState == GameState::MAIN_MENU && mMainMenu) mMainMenu->playMusic();
+    });
+    mAssetLoader->requestChunk("explosion_sound.wav", [this](Mix_Chunk* chunk) {
+        mBombExplosionSound = chunk;
+        mVoiceBackend->setChunk(SOUND_EXPLOSION, chunk);
+    });
+}
+
+// Nobody hears this before pressing Start, so it is requested only once the
+// menu is up and decodes while the player is still in the menus. A match
+// started before it arrives picks it up when it does.
+void Game::requestIngameMusic() {
+    if (!isAudioOpen()) return;
+    mAssetLoader->requestMusic("ingame_music.mp3", [this](Mix_Music* music) {
+        mIngameMusic = music;
+        if (mCurrentState == GameState::PLAYING) playIngameMusic();
+    });
+}
+
+void Game::requestGameplayTextures() {
+    mAssetLoader->requestTexture("player.png", [this](Texture* texture) { mPlayerTexture = texture; });
+    mAssetLoader->requestTexture("enemies.png", [this](Texture* texture) { mEnemyTexture = texture; });
+    mAssetLoader->requestTexture("background.png", [this](Texture* texture) { mBackgroundTexture = texture; });
+    mAssetLoader->requestTexture("hard_wall.png", [this](Texture* texture) { mHardWallTexture = texture; });
+    mAssetLoader->requestTexture("border_wall.png", [this](Texture* texture) { mBorderWallTexture = texture; });
+    mAssetLoader->requestTexture("bomb.png", [this](Texture* texture) { mBombTexture = texture; });
+    mAssetLoader->requestTexture("explosion.png", [this](Texture* texture) { mExplosionTexture = texture; });
+    mAssetLoader->requestTexture("soft_wall_1.png", [this](Texture* texture) { mSoftWallTextures[0] = texture; });
+    mAssetLoader->requestTexture("soft_wall_2.png", [this](Texture* texture) { mSoftWallTextures[1] = texture; });
+    mAssetLoader->requestTexture("soft_wall_3.png", [this](Texture* texture) { mSoftWallTextures[2] = texture; });
+}
+
+void Game::playIngameMusic() {
+    if (mIngameMusic) {
+        stopMusic();
+        Mix_PlayMusic(mIngameMusic, -1);
+    }
+}
+
+void Game::stopMusic() {
+    Mix_HaltMusic();
+}
+
+void Game::playBombSoundEffect() {
+    PROFILE_SCOPE("audio.play");
+    if (mVoices) mVoices->trigger(SOUND_EXPLOSION);
+}
+
+void Game::startGame() {
+    resetGame();
+    mGameSettings.updateActualPlayerSpeed();
+
+    // Gameplay textures were requested during startup and the in-game music
+    // once the menu was up; only wait here if the player pressed Start before
+    // they finished streaming in.
+    if (mAssetLoader) mAssetLoader->finishAll();
+
+    bool texturesLoaded = mPlayerTexture && mEnemyTexture && mBackgroundTexture &&
+        mHardWallTexture && mBorderWallTexture && mBombTexture && mExplosionTexture &&
+        mSoftWallTextures[0] && mSoftWallTextures[1] && mSoftWallTextures[2];
+
+    if (!texturesLoaded) {
+        std::cerr << "Game Error: Failed to load essential game textures! Returning to main menu." << std::endl;
+        transitionToMainMenu();
+        return;
+    }
+
+    MatchConfig config = MatchConfig::fromOptions(mGameSettings, mScreenWidth, mScreenHeight);
+    config.seed = static_cast<uint64_t>(std::time(nullptr));
+    if (mNetplay.localPlayer >= 0) {
+        if (!startNetSession(config)) {
+            std::cerr << "Game Error: Failed to start the online match! Returning to main menu." << std::endl;
+            transitionToMainMenu();
+            return;
+        }
+    }
+    else if (!mSimulation.reset(config)) {
+        std::cerr << "Game Error: Failed to initialize map! Returning to main menu." << std::endl;
+        transitionToMainMenu();
+        return;
+    }
+    mReplayRecorder.begin(config);
+
+    mBots.clear();
+    if (!mNetSession) {
+        for (int player = 1; player < config.playerCount; ++player) {
+            MctsConfig botConfig;
+            botConfig.seed = config.seed + static_cast<uint64_t>(player);
+            mBots.emplace_back(new MctsBot(botConfig));
+        }
+    }
+
+    mCurrentScore = 0;
+    updateScoreDisplay();
+    updateTimerDisplay();
+
+    mCurrentState = GameState::PLAYING;
+    mNeedsRedraw = true;
+    playIngameMusic();
+}
+
+// Opens the socket on first use and resets the simulation through a new
+// rollback session; the seed and player count come from the netplay setup.
+bool Game::startNetSession(MatchConfig& config) {
+    mNetSession.reset();
+    if (!mNetTransport) {
+        std::unique_ptr<UdpTransport> transport(new UdpTransport());
+        std::string host;
+        uint16_t port = 0;
+        for (size_t p = 0; p < mNetplay.peers.size(); ++p) {
+            if (!parseHostPort(mNetplay.peers[p], host, port)) {
+                std::cerr << "Game Error: '" << mNetplay.peers[p] << "' is not HOST:PORT." << std::endl;
+                return false;
+            }
+            bool ready = static_cast<int>(p) == mNetplay.localPlayer ? transport->open(port)
+                : transport->setPeer(static_cast<int>(p), host, port);
+            if (!ready) return false;
+        }
+        mNetTransport = std::move(transport);
+    }
+
+    config.playerCount = static_cast<int>(mNetplay.peers.size());
+    config.seed = mNetplay.seed + mNetMatchesStarted++;
+    RollbackConfig rollbackConfig;
+    rollbackConfig.match = config;
+    rollbackConfig.localPlayer = mNetplay.localPlayer;
+    rollbackConfig.inputDelayTicks = mNetplay.inputDelayTicks;
+    mNetSession.reset(new RollbackSession(mSimulation, *mNetTransport));
+    if (!mNetSession->start(rollbackConfig)) {
+        mNetSession.reset();
+        return false;
+    }
+    mLocalPlayer = mNetplay.localPlayer;
+    return true;
+}
+
+void Game::resetGame() {
+    mTickAccumulator = 0.0f;
+    mInput.clear();
+}
+
+void Game::handleEvent(SDL_Event& e) {
+    if (e.type == SDL_QUIT) {
+        return;
+    }
+    if (e.type != SDL_MOUSEMOTION) {
+        mNeedsRedraw = true;
+    }
+    if (e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_F3 && mProfilerOverlay) {
+        mProfilerOverlay->toggle();
+        return;
+    }
+    if (e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_F4) {
+        Profiler::writeChromeTrace("profile_trace.json", PROFILER_DUMP_SECONDS);
+        return;
+    }
+    if (e.type == SDL_KEYDOWN && e.key.repeat == 0 && e.key.keysym.sym == SDLK_F5) {
+        if (Counters::isCsvLogOpen()) Counters::closeCsvLog();
+        else Counters::openCsvLog(COUNTER_LOG_PATH);
+        return;
+    }
+    if (e.type == SDL_RENDER_TARGETS_RESET && mCurrentState == GameState::GAME_OVER_MENU) {
+        snapshotGameOverBackdrop();
+    }
+    switch (mCurrentState) {
+    case GameState::MAIN_MENU:
+        handleMainMenuEvents(e);
+        break;
+    case GameState::OPTIONS_MENU:
+        handleOptionsMenuEvents(e);
+        break;
+    case GameState::PLAYING:
+        handlePlayingEvents(e);
+        break;
+    case GameState::GAME_OVER_MENU:
+        handleGameOverMenuEvents(e);
+        break;
+    }
+    if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_o &&
+        (mCurrentState == GameState::MAIN_MENU || mCurrentState == GameState::GAME_OVER_MENU)) {
+        bool menuHandledOptionKey = false;
+        if (mCurrentState == GameState::MAIN_MENU && mMainMenu) {
+
+
+        }
+        if (!menuHandledOptionKey) {
+            transitionToOptionsMenu();
+        }
+    }
+}
+
+void Game::handleMainMenuEvents(SDL_Event& e) {
+    if (mMainMenu) {
+        MenuAction action = mMainMenu->handleEvent(e);
+        switch (action) {
+        case MenuAction::START_GAME:
+            startGame();
+            break;
+        case MenuAction::OPEN_OPTIONS:
+            transitionToOptionsMenu();
+            break;
+        case MenuAction::EXIT_GAME:
+        {
+            SDL_Event quitEvent;
+            quitEvent.type = SDL_QUIT;
+            SDL_PushEvent(&quitEvent);
+        }
+        break;
+        case MenuAction::NONE:
+        default:
+            break;
+        }
+    }
+}
+
+void Game::handleOptionsMenuEvents(SDL_Event& e) {
+    if (mOptionsMenu) {
+        OptionsMenuAction action = mOptionsMenu->handleEvent(e);
+        if (action == OptionsMenuAction::BACK_TO_MAIN_MENU) {
+            mGameSettings.updateActualPlayerSpeed();
+            transitionToMainMenu();
+        }
+    }
+    else {
+        transitionToMainMenu();
+    }
+}
+
+void Game::handleGameOverMenuEvents(SDL_Event& e) {
+    if (e.type == SDL_MOUSEBUTTONDOWN) {
+        if (e.button.button == SDL_BUTTON_LEFT) {
+            GameOverAction action = mGameOverUi ? static_cast<GameOverAction>(mGameOverUi->click(e.button.x, e.button.y))
+                : GameOverAction::NONE;
+            if (action == GameOverAction::PLAY_AGAIN) {
+                startGame();
+            }
+            else if (action == GameOverAction::MAIN_MENU) {
+                transitionToMainMenu();
+            }
+        }
+    }
+    if (e.type == SDL_KEYDOWN) {
+        if (e.key.keysym.sym == SDLK_r) {
+            startGame();
+        }
+        else if (e.key.keysym.sym == SDLK_m || e.key.keysym.sym == SDLK_ESCAPE) {
+            transitionToMainMenu();
+        }
+    }
+}
+
+bool Game::isIdle() const {
+    if (mCurrentState == GameState::PLAYING) return false;
+    if (mProfilerOverlay && mProfilerOverlay->isVisible()) return false;
+    return !(mAssetLoader && mAssetLoader->hasPendingWork());
+}
+
+bool Game::consumeRedraw() {
+    if (mCurrentState == GameState::PLAYING) return true;
+    if (mProfilerOverlay && mProfilerOverlay->isVisible()) return true;
+    bool redraw = mNeedsRedraw;
+    mNeedsRedraw = false;
+    return redraw;
+}
+
+void Game::transitionToMainMenu() {
+    mCurrentState = GameState::MAIN_MENU;
+    mNeedsRedraw = true;
+    stopMusic();
+    if (mMainMenu) mMainMenu->playMusic();
+}
+
+void Game::transitionToOptionsMenu() {
+    mCurrentState = GameState::OPTIONS_MENU;
+    mNeedsRedraw = true;
+    stopMusic();
+    if (mOptionsMenu) {
+        mOptionsMenu->updateOptionDisplays();
+    }
+}
+
+
+void Game::update(float deltaTime) {
+    PROFILE_SCOPE("game.update");
+    ALLOCATION_PHASE("game.update");
+    if (mAssetLoader && mAssetLoader->pumpUploads(MAX_TEXTURE_UPLOADS_PER_FRAME) > 0) {
+        mNeedsRedraw = true;
+    }
+    bool musicPlaying;
+    {
+        PROFILE_SCOPE("audio.poll");
+        musicPlaying = Mix_PlayingMusic() != 0;
+    }
+    if (musicPlaying != mMusicWasPlaying) {
+        mMusicWasPlaying = musicPlaying;
+        mNeedsRedraw = true;
+    }
+
+    if (mCurrentState == GameState::PLAYING) {
+        stepSimulation(deltaTime);
+    }
+}
+
+// Key events only go into the timeline with their timestamps; nothing
+// changes until the tick they fall in is simulated.
+void Game::handlePlayingEvents(SDL_Event& e) {
+    if ((e.type != SDL_KEYDOWN && e.type != SDL_KEYUP) || e.key.repeat != 0) return;
+    uint8_t button = buttonForKey(e.key.keysym.sym);
+    if (!button) return;
+    if (e.type == SDL_KEYDOWN) mInput.press(button, e.key.timestamp);
+    else mInput.release(button, e.key.timestamp);
+}
+
+// Runs as many fixed ticks as the frame time covers. The ticks trail the
+// clock by what is left in the accumulator, so each takes the input events
+// up to the moment it stands for; the newest tick of the frame takes
+// everything, since that is the state about to be shown. The keyboard is
+// polled first so a release the window missed cannot leave a key stuck.
+// Online, a tick can stall while a remote peer catches up, and then its taps
+// and bomb press carry over. The match only ends once its last tick is
+// confirmed by every peer.
+void Game::stepSimulation(float deltaTime) {
+    const float tickSeconds = 1.0f / TICKS_PER_SECOND;
+    mTickAccumulator += deltaTime;
+    mInput.sync(pollHeldButtons());
+    const Uint32 nowMs = SDL_GetTicks();
+    int steps = 0;
+    while (mTickAccumulator >= tickSeconds && steps < MAX_TICKS_PER_FRAME) {
+        float behindSeconds = mTickAccumulator - tickSeconds;
+        bool newest = behindSeconds < tickSeconds || steps + 1 == MAX_TICKS_PER_FRAME;
+        Uint32 tickEndMs = newest ? nowMs : nowMs - static_cast<Uint32>(behindSeconds * 1000.0f);
+        uint8_t buttons = mInput.collect(tickEndMs);
+        uint32_t eventMs = 0;
+        bool hasEvent = mInput.getOldestEventTime(eventMs);
+        bool simulated = true;
+        if (mNetSession) {
+            PROFILE_SCOPE("net.advance");
+            simulated = mNetSession->advance(buttons);
+        }
+        else {
+            TickInput input;
+            input.buttons[0] = buttons;
+            for (size_t bot = 0; bot < mBots.size(); ++bot) {
+                PROFILE_SCOPE("bot.think");
+                int player = static_cast<int>(bot) + 1;
+                input.buttons[player] = mBots[bot]->nextButtons(mSimulation, player);
+            }
+            mReplayRecorder.recordTick(input);
+            PROFILE_SCOPE("sim.step");
+            mSimulation.step(input);
+        }
+        if (simulated) {
+            if (hasEvent) Counters::set(Counter::INPUT_AGE_MS, nowMs - eventMs);
+            mInput.commit();
+        }
+        mTickAccumulator -= tickSeconds;
+        ++steps;
+        Counters::set(Counter::BOMBS_ALIVE, mSimulation.getBombs().size());
+        Counters::set(Counter::ENEMIES_ALIVE, mSimulation.getEnemies().size());
+
+        processSimEvents();
+        // Offline, a match against bots is over for the player once they fall.
+        bool localOut = !mBots.empty() && !mSimulation.getPlayers()[mLocalPlayer].isAlive();
+        if (mNetSession ? mNetSession->isConfirmedOver() : mSimulation.isOver() || localOut) {
+            transitionToGameOver();
+            return;
+        }
+    }
+    if (steps == MAX_TICKS_PER_FRAME) {
+        mTickAccumulator = 0.0f;
+    }
+    if (mSimulation.getRemainingTicks() / TICKS_PER_SECOND != mDisplayedSeconds) {
+        updateTimerDisplay();
+    }
+}
+
+void Game::processSimEvents() {
+    bool scoreChanged = false;
+    for (const auto& event : mSimulation.getEvents()) {
+        switch (event.type) {
+        case SimEventType::BOMB_EXPLODED:
+            playBombSoundEffect();
+            break;
+        case SimEventType::SOFT_WALL_DESTROYED:
+        case SimEventType::ENEMY_KILLED:
+            scoreChanged = scoreChanged || event.player == mLocalPlayer;
+            break;
+        case SimEventType::MATCH_OVER:
+            scoreChanged = true;
+            if (mSimulation.getOutcome() == MatchOutcome::WON) std::cout << "You win! All enemies defeated." << std::endl;
+            else if (mSimulation.getOutcome() == MatchOutcome::TIME_UP) std::cout << "Time's up! Game Over." << std::endl;
+            else std::cout << "Game Over!" << std::endl;
+            break;
+        default:
+            break;
+        }
+    }
+    if (scoreChanged) {
+        mCurrentScore = mSimulation.getScore(mLocalPlayer);
+        updateScoreDisplay();
+    }
+}
+
+void Game::transitionToGameOver() {
+    stopMusic();
+    mCurrentScore = mSimulation.getScore(mLocalPlayer);
+    saveHighScore();
+
+    if (mNetSession) {
+        for (int tick = 0; tick < mNetSession->getTick(); ++tick) mReplayRecorder.recordTick(mNetSession->getInput(tick));
+    }
+    mReplayRecorder.finish(mSimulation);
+    if (mPersistent) mReplayRecorder.getReplay().save(LAST_MATCH_REPLAY_PATH);
+
+    if (mGameOverUi) {
+        // With other players, WON means someone won; the title is for whether it was us.
+        bool won = mSimulation.getOutcome() == MatchOutcome::WON && mSimulation.getPlayers()[mLocalPlayer].isAlive();
+        mGameOverUi->setVisible(mWinTitle, won);
+        mGameOverUi->setVisible(mLoseTitle, !won);
+
+        char text[64];
+        if (mLeaderboard.getCount() > 0) {
+            std::snprintf(text, sizeof(text), "Final Score: %04d (#%llu of %llu)", mCurrentScore,
+                static_cast<unsigned long long>(mLeaderboard.getRank(mCurrentScore)),
+                static_cast<unsigned long long>(mLeaderboard.getCount()));
+        }
+        else {
+            std::snprintf(text, sizeof(text), "Final Score: %04d", mCurrentScore);
+        }
+        mGameOverUi->setText(mFinalScoreLabel, text);
+        std::snprintf(text, sizeof(text), "High Score: %04d", mHighScore);
+        mGameOverUi->setText(mHighScoreLabel, text);
+    }
+
+    mCurrentState = GameState::GAME_OVER_MENU;
+    mNeedsRedraw = true;
+    snapshotGameOverBackdrop();
+}
+
+// The playfield is frozen once the match ends, so it is drawn (with the dim
+// overlay) into an offscreen texture once instead of on every menu frame.
+void Game::snapshotGameOverBackdrop() {
+    if (!mGameOverBackdrop) {
+        mGameOverBackdrop = mRenderer->createRenderTarget(mScreenWidth, mScreenHeight);
+        if (!mGameOverBackdrop) return;
+    }
+    if (!mRenderer->setRenderTarget(mGameOverBackdrop)) {
+        mRenderer->destroyTexture(mGameOverBackdrop);
+        mGameOverBackdrop = nullptr;
+        return;
+    }
+    mRenderer->setDrawColor(0, 0, 0, 255);
+    mRenderer->clear();
+    renderPlayingState();
+    renderGameOverOverlay();
+    mRenderer->setRenderTarget(nullptr);
+}
+
+void Game::render() {
+    PROFILE_SCOPE("game.render");
+    ALLOCATION_PHASE("game.render");
+    switch (mCurrentState) {
+    case GameState::MAIN_MENU:
+        if (mMainMenu) mMainMenu->render();
+        break;
+    case GameState::OPTIONS_MENU:
+        if (mOptionsMenu) mOptionsMenu->render();
+        else {
+            mRenderer->setDrawColor(30, 30, 30, 255); mRenderer->clear();
+            Texture* errText = createTextTexture("Options Not Available", mUiTextColor, mGameFont);
+            if (errText) {
+                int w, h; Renderer::queryTexture(errText, &w, &h);
+                SDL_Rect r = { (mScreenWidth - w) / 2, (mScreenHeight - h) / 2,w,h };
+                mRenderer->copy(errText, 0, &r);
+                mRenderer->destroyTexture(errText);
+            }
+        }
+        break;
+    case GameState::PLAYING:
+        renderPlayingState();
+        break;
+    case GameState::GAME_OVER_MENU:
+        renderGameOverMenu();
+        break;
+    }
+    if (mProfilerOverlay) mProfilerOverlay->render();
+}
+
+void Game::renderPlayingState() {
+    renderMap();
+    renderBombs();
+    renderEnemies();
+    renderPlayers();
+    renderScoreAndTimer();
+}
+
+void Game::renderMap() {
+    PROFILE_SCOPE("render.map");
+    const Map& map = mSimulation.getMap();
+    int tileSize = map.getTileSize();
+
+    if (mBackgroundTexture) {
+        SDL_Rect destRect = { 0, 0, map.getPixelWidth(), map.getPixelHeight() };
+        mRenderer->copy(mBackgroundTexture, NULL, &destRect);
+    }
+    else {
+        mRenderer->setDrawColor(100, 150, 100, 255);
+        mRenderer->clear();
+    }
+
+    for (int r = 0; r < map.getRows(); ++r) {
+        for (int c = 0; c < map.getColumns(); ++c) {
+            Texture* currentTileTexture = nullptr;
+            switch (map.getTileType(r, c)) {
+            case TileType::BORDER_WALL:
+                currentTileTexture = mBorderWallTexture;
+                break;
+            case TileType::HARD_WALL:
+                currentTileTexture = mHardWallTexture;
+                break;
+            case TileType::SOFT_WALL:
+                currentTileTexture = mSoftWallTextures[(r + c) % mSoftWallTextures.size()];
+                if (!currentTileTexture) currentTileTexture = mSoftWallTextures[0];
+                break;
+            case TileType::EMPTY:
+            default:
+                break;
+            }
+
+            if (currentTileTexture) {
+                SDL_Rect tileRect = { c * tileSize, r * tileSize, tileSize, tileSize };
+                mRenderer->copy(currentTileTexture, NULL, &tileRect);
+            }
+        }
+    }
+}
+
+void Game::renderBombs() {
+    PROFILE_SCOPE("render.bombs");
+    const int BOMB_FRAMES = 3;
+    const int BOMB_FRAME_TICKS = 12;
+    for (const auto& bomb : mSimulation.getBombs()) {
+        if (!bomb.isExploding()) {
+            if (!mBombTexture) continue;
+            int frameWidth = 0, frameHeight = 0;
+            Renderer::queryTexture(mBombTexture, &frameWidth, &frameHeight);
+            frameWidth /= BOMB_FRAMES;
+            int frame = bomb.getAgeTicks() / BOMB_FRAME_TICKS % BOMB_FRAMES;
+            SDL_Rect srcRect = { frame * frameWidth, 0, frameWidth, frameHeight };
+            SDL_Rect destRect = { bomb.getX(), bomb.getY(), bomb.getSize(), bomb.getSize() };
+            mRenderer->copy(mBombTexture, &srcRect, &destRect);
+        }
+        else if (mExplosionTexture) {
+            for (const auto& part : bomb.getExplosion()) {
+                SDL_Rect destRect = { part.x, part.y, bomb.getSize(), bomb.getSize() };
+                mRenderer->copy(mExplosionTexture, nullptr, &destRect);
+            }
+        }
+    }
+}
+
+void Game::renderEnemies() {
+    PROFILE_SCOPE("render.enemies");
+    if (!mEnemyTexture) return;
+    for (const auto& enemy : mSimulation.getEnemies()) {
+        SDL_Rect destRect = { enemy.getX(), enemy.getY(), enemy.getWidth(), enemy.getHeight() };
+        mRenderer->copy(mEnemyTexture, nullptr, &destRect);
+    }
+}
+
+// player.png holds four rows (one per Direction) of four walking frames.
+void Game::renderPlayers() {
+    PROFILE_SCOPE("render.players");
+    const int PLAYER_FRAMES = 4;
+    const int PLAYER_FRAME_TICKS = 9;
+    if (!mPlayerTexture) return;
+    int textureWidth = 0, textureHeight = 0;
+    Renderer::queryTexture(mPlayerTexture, &textureWidth, &textureHeight);
+    int frameWidth = textureWidth / PLAYER_FRAMES;
+    int frameHeight = textureHeight / 4;
+
+    for (const auto& player : mSimulation.getPlayers()) {
+        if (!player.isAlive()) continue;
+        int frame = player.isMoving() ? mSimulation.getTick() / PLAYER_FRAME_TICKS % PLAYER_FRAMES : 0;
+        SDL_Rect srcRect = { frame * frameWidth, static_cast<int>(player.getFacingDirection()) * frameHeight, frameWidth, frameHeight };
+        SDL_Rect destRect = { player.getX(), player.getY(), player.getWidth(), player.getHeight() };
+        mRenderer->copy(mPlayerTexture, &srcRect, &destRect);
+    }
+}
+
+void Game::renderScoreAndTimer() {
+    PROFILE_SCOPE("render.hud");
+    int x = 20;
+    if (mScoreLabelTexture) {
+        SDL_Rect destRect = { x, 10, mScoreLabelTexture->width, mScoreLabelTexture->height };
+        mRenderer->copy(mScoreLabelTexture, NULL, &destRect);
+        x += mScoreLabelTexture->width;
+    }
+    renderHudText(mScoreText, x, 10);
+
+    int labelWidth = mTimerLabelTexture ? mTimerLabelTexture->width : 0;
+    x = mScreenWidth - labelWidth - measureHudText(mTimerText) - 20;
+    if (mTimerLabelTexture) {
+        SDL_Rect destRect = { x, 10, mTimerLabelTexture->width, mTimerLabelTexture->height };
+        mRenderer->copy(mTimerLabelTexture, NULL, &destRect);
+    }
+    renderHudText(mTimerText, x + labelWidth, 10);
+}
+
+void Game::renderGameOverOverlay() {
+    mRenderer->setBlendMode(SDL_BLENDMODE_BLEND);
+    mRenderer->setDrawColor(0, 0, 0, 180);
+    SDL_Rect overlayRect = { 0, 0, mScreenWidth, mScreenHeight };
+    mRenderer->fillRect(&overlayRect);
+    mRenderer->setBlendMode(SDL_BLENDMODE_NONE);
+}
+
+void Game::renderGameOverMenu() {
+    if (mGameOverBackdrop) {
+        mRenderer->copy(mGameOverBackdrop, NULL, NULL);
+    }
+    else {
+        renderPlayingState();
+        renderGameOverOverlay();
+    }
+
+    if (mGameOverUi) mGameOverUi->render();
+}
@@ -1,127 +1,233 @@
-﻿#ifndef GAME_H
-#define GAME_H
-
-#include <SDL.h>
-#include <SDL_ttf.h>
-#include <SDL_mixer.h>
-#include <vector>
-#include <memory> 
-#include <string>
-#include <array>
-#include <iomanip> 
-#include <sstream> 
-
-#include "Menu.h"         
-#include "GameOptions.h"   
-#include "OptionsMenu.h"  
-
-class Player;
-class Map;
-class Bomb;
-class Enemy;
-struct Explosion; 
-
-enum class GameState {
-    MAIN_MENU,
-    OPTIONS_MENU,
-    PLAYING,
-    GAME_OVER_MENU
-};
-
-class Game {
-public:
-    Game(SDL_Renderer* renderer, int screenWidth, int screenHeight);
-    ~Game();
-
-    bool initialize();
-    void handleEvent(SDL_Event& e);
-    void update(float deltaTime);
-    void render();
-
-    bool checkCollision(SDL_Rect a, SDL_Rect b);
-    bool isColliding(int x, int y, int width, int height);
-
-private:
-    SDL_Renderer* mRenderer;
-    int mScreenWidth;
-    int mScreenHeight;
-    bool mGameOver;
-
-    GameState mCurrentState;
-
-    std::unique_ptr<Menu> mMainMenu;
-    std::unique_ptr<OptionsMenu> mOptionsMenu;
-
-    GameOptions mGameSettings;
-
-    std::unique_ptr<Player> mPlayer;
-    std::unique_ptr<Map> mMap;
-    std::vector<std::unique_ptr<Bomb>> mBombs;
-    std::vector<std::unique_ptr<Enemy>> mEnemies;
-
-    SDL_Texture* mPlayerTexture;
-    SDL_Texture* mEnemyTexture;
-    SDL_Texture* mBackgroundTexture;
-    SDL_Texture* mHardWallTexture;
-    SDL_Texture* mBorderWallTexture;
-    std::array<SDL_Texture*, 3> mSoftWallTextures;
-    SDL_Texture* mBombTexture;
-    SDL_Texture* mExplosionTexture;
-
-    TTF_Font* mGameFont;
-    TTF_Font* mUiFont;
-
-    Mix_Music* mMenuMusic;
-    Mix_Music* mIngameMusic;
-    Mix_Chunk* mBombExplosionSound;
-
-    int mCurrentScore;
-    int mHighScore;
-    float mGameTimerSeconds;
-    const float MAX_GAME_TIME_SECONDS = 180.0f;
-    SDL_Texture* mScoreTextTexture;
-    SDL_Texture* mTimerTextTexture;
-    SDL_Color mUiTextColor;
-
-    SDL_Texture* mGameOverStateTitleTexture;
-    SDL_Texture* mFinalScoreTextTexture;
-    SDL_Texture* mHighScoreTextTexture;
-    SDL_Rect mContinueButtonRect;    
-    SDL_Rect mEndGameButtonRect;      
-    SDL_Texture* mContinueButtonTexture; 
-    SDL_Texture* mEndGameButtonTexture;  
-
-    SDL_Texture* loadTexture(const std::string& path);
-    SDL_Texture* createTextTexture(const std::string& text, SDL_Color color, TTF_Font* fontToUse);
-
-    void startGame();
-    void resetGame();
-    void transitionToMainMenu();
-    void transitionToOptionsMenu();
-    void transitionToGameOver();
-
-    void calculateFinalScore();
-    void updateScoreDisplay();
-    void updateTimerDisplay();
-    void loadHighScore();
-    void saveHighScore();
-
-    bool loadAudio();
-    void playIngameMusic();
-    void stopMusic();
-    void playBombSoundEffect();
-
-    void handleMainMenuEvents(SDL_Event& e);
-    void handleOptionsMenuEvents(SDL_Event& e);
-    void handleGameOverMenuEvents(SDL_Event& e);
-
-    void renderPlayingState();
-    void renderScoreAndTimer();
-    void renderGameOverMenu();
-
-    void placeBomb();
-    void createEnemiesBasedOnOptions();
-    void initializeGameOverMenuAssets();
-};
-
-#endif // GAME_H
+﻿#ifndef GAME_H
+#define GAME_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <SDL_mixer.h>
+#include "Renderer.h"
+#include <vector>
+#include <memory> 
+#include <string>
+#include <array>
+#include <iomanip> 
+#include <sstream> 
+
+#include "Menu.h"         
+#include "GameOptions.h"   
+#include "OptionsMenu.h"  
+#include "AssetLoader.h"
+#include "Simulation.h"
+#include "Replay.h"
+#include "ProfilerOverlay.h"
+#include "UdpTransport.h"
+#include "RollbackSession.h"
+#include "MctsBot.h"
+#include "VoiceManager.h"
+#include "MixerVoiceBackend.h"
+#include "StartupGraph.h"
+#include "UiScreen.h"
+#include "InputTimeline.h"
+#include "Leaderboard.h"
+
+enum class GameState {
+    MAIN_MENU,
+    OPTIONS_MENU,
+    PLAYING,
+    GAME_OVER_MENU
+};
+
+enum class GameOverAction {
+    NONE,
+    PLAY_AGAIN,
+    MAIN_MENU
+};
+
+// Online versus play, set from the command line. Every peer lists the same
+// addresses in player order and uses the same seed and options; the entry
+// for localPlayer is the port to listen on.
+struct NetplaySetup {
+    int localPlayer = -1;
+    std::vector<std::string> peers;
+    uint64_t seed = 1;
+    int inputDelayTicks = 1;
+};
+
+class Game {
+public:
+    Game(Renderer* renderer, int screenWidth, int screenHeight);
+    ~Game();
+
+    // Adds the tasks that bring the game up to an interactive main menu.
+    // `video`, `fonts`, `images` and `audio` are the tasks that create the
+    // renderer and initialize SDL_ttf, SDL_image and the audio device, or
+    // StartupGraph::NO_TASK for any that is already done.
+    void addStartupTasks(StartupGraph& graph, StartupGraph::TaskId video, StartupGraph::TaskId fonts,
+        StartupGraph::TaskId images, StartupGraph::TaskId audio);
+    // Adds what the first menu frame does not need, to run once it is shown:
+    // the other menus, the HUD glyphs and the in-game music.
+    void addDeferredTasks(StartupGraph& graph);
+    // Both sets of tasks in one go, for callers that set up SDL themselves.
+    bool initialize();
+    // Call before startup. Matches are then played online as
+    // setup.localPlayer; each new match uses the next seed.
+    void setNetplay(const NetplaySetup& setup) { mNetplay = setup; }
+    // Call before startup. Off for automated runs: the leaderboard is never
+    // opened and finished matches neither add scores nor overwrite
+    // LAST_MATCH_REPLAY_PATH.
+    void setPersistent(bool persistent) { mPersistent = persistent; }
+    void startMatch() { startGame(); }
+    GameState getState() const { return mCurrentState; }
+
+    // Menus only change in response to input, asset arrival or audio state,
+    // so the main loop may block on events while idle and skip redundant frames.
+    bool isIdle() const;
+    bool consumeRedraw();
+    void handleEvent(SDL_Event& e);
+    // Local key events that have reached a simulated tick so far.
+    uint64_t getInputEventsApplied() const { return mInput.getEventsApplied(); }
+    void update(float deltaTime);
+    void render();
+
+private:
+    Renderer* mRenderer;
+    int mScreenWidth;
+    int mScreenHeight;
+
+    GameState mCurrentState;
+
+    std::unique_ptr<AssetLoader> mAssetLoader;
+    static const int MAX_TEXTURE_UPLOADS_PER_FRAME = 2;
+
+    std::unique_ptr<Menu> mMainMenu;
+    std::unique_ptr<OptionsMenu> mOptionsMenu;
+
+    GameOptions mGameSettings;
+
+    // The match itself runs in the simulation at a fixed tick rate; Game only
+    // turns key events into tick inputs and draws the resulting state.
+    Simulation mSimulation;
+    static const int MAX_TICKS_PER_FRAME = 5;
+    float mTickAccumulator;
+    InputTimeline mInput;
+    int mDisplayedSeconds;
+    // Every match is recorded; the last one is saved to LAST_MATCH_REPLAY_PATH
+    // when it ends and can be re-run with bomberman_sim --replay.
+    ReplayRecorder mReplayRecorder;
+
+    // Online matches run the same simulation through a rollback session;
+    // mLocalPlayer is 0 offline.
+    NetplaySetup mNetplay;
+    std::unique_ptr<UdpTransport> mNetTransport;
+    std::unique_ptr<RollbackSession> mNetSession;
+    int mNetMatchesStarted;
+    int mLocalPlayer;
+
+    // One per bot opponent, driving players 1 and up in offline matches.
+    std::vector<std::unique_ptr<MctsBot>> mBots;
+
+    Texture* mPlayerTexture;
+    Texture* mEnemyTexture;
+    Texture* mBackgroundTexture;
+    Texture* mHardWallTexture;
+    Texture* mBorderWallTexture;
+    std::array<Texture*, 3> mSoftWallTextures;
+    Texture* mBombTexture;
+    Texture* mExplosionTexture;
+
+    TTF_Font* mGameFont;
+    TTF_Font* mUiFont;
+    TTF_Font* mTitleFont;
+    TTF_Font* mDebugFont;
+
+    // F3 toggles the profiler overlay, F4 dumps the recent trace to disk.
+    std::unique_ptr<ProfilerOverlay> mProfilerOverlay;
+    static constexpr double PROFILER_DUMP_SECONDS = 5.0;
+
+    Mix_Music* mMenuMusic;
+    Mix_Music* mIngameMusic;
+    Mix_Chunk* mBombExplosionSound;
+
+    // Sound effects are triggered here and played by the voice manager's own
+    // thread; explosions going off together merge into one louder voice.
+    static constexpr int SOUND_EXPLOSION = 0;
+    static constexpr int SOUND_CHANNELS = 16;
+    std::unique_ptr<MixerVoiceBackend> mVoiceBackend;
+    std::unique_ptr<VoiceManager> mVoices;
+
+    int mCurrentScore;
+    int mHighScore;
+    // Every finished match's score, kept across sessions; the high score is
+    // its best entry.
+    Leaderboard mLeaderboard;
+    bool mPersistent;
+    SDL_Color mUiTextColor;
+    // The HUD is drawn from glyphs rendered once at startup, so score and
+    // timer changes during a match create no textures and no strings.
+    static const int HUD_TEXT_LENGTH = 16;
+    static const int HUD_GLYPH_COUNT = 11;
+    std::array<Texture*, HUD_GLYPH_COUNT> mHudGlyphs;
+    Texture* mScoreLabelTexture;
+    Texture* mTimerLabelTexture;
+    char mScoreText[HUD_TEXT_LENGTH];
+    char mTimerText[HUD_TEXT_LENGTH];
+
+    // Both titles are built up front and only shown or hidden; the two score
+    // labels are the only text re-rendered when a match ends.
+    std::unique_ptr<UiScreen> mGameOverUi;
+    UiScreen::WidgetId mWinTitle;
+    UiScreen::WidgetId mLoseTitle;
+    UiScreen::WidgetId mFinalScoreLabel;
+    UiScreen::WidgetId mHighScoreLabel;
+    Texture* mGameOverBackdrop;
+
+    bool mNeedsRedraw;
+    bool mMusicWasPlaying;
+
+    void requestGameplayTextures();
+    Texture* createTextTexture(const char* text, SDL_Color color, TTF_Font* fontToUse);
+    void createHudGlyphs();
+    int measureHudText(const char* text) const;
+    void renderHudText(const char* text, int x, int y);
+
+    void startGame();
+    bool startNetSession(MatchConfig& config);
+    void resetGame();
+    void transitionToMainMenu();
+    void transitionToOptionsMenu();
+    void transitionToGameOver();
+
+    void updateScoreDisplay();
+    void updateTimerDisplay();
+    void loadHighScore();
+    void saveHighScore();
+
+    bool loadFonts();
+    bool initializeMainMenu();
+    void requestAudio();
+    void requestIngameMusic();
+    void playIngameMusic();
+    void stopMusic();
+    void playBombSoundEffect();
+
+    void handleMainMenuEvents(SDL_Event& e);
+    void handleOptionsMenuEvents(SDL_Event& e);
+    void handleGameOverMenuEvents(SDL_Event& e);
+    void handlePlayingEvents(SDL_Event& e);
+
+    void stepSimulation(float deltaTime);
+    void processSimEvents();
+
+    void renderPlayingState();
+    void renderMap();
+    void renderBombs();
+    void renderEnemies();
+    void renderPlayers();
+    void renderScoreAndTimer();
+    void renderGameOverMenu();
+    void renderGameOverOverlay();
+    void snapshotGameOverBackdrop();
+
+    void initializeGameOverMenuAssets();
+};
+
+#endif // GAME_H
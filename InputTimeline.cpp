@@ -0,0 +1,94 @@
+#include "InputTimeline.h"
+
+InputTimeline::InputTimeline(uint8_t edgeButtons) :
+    mEdgeButtons(edgeButtons),
+    mEvents{},
+    mHead(0),
+    mCount(0),
+    mHeld(0),
+    mTapped(0),
+    mSyncPending(false),
+    mSyncedHeld(0),
+    mFoldedEvents(0),
+    mHasOldest(false),
+    mOldestMs(0),
+    mEventsApplied(0)
+{
+}
+
+void InputTimeline::press(uint8_t buttons, uint32_t timeMs) {
+    push(buttons, timeMs, true);
+}
+
+void InputTimeline::release(uint8_t buttons, uint32_t timeMs) {
+    push(buttons, timeMs, false);
+}
+
+void InputTimeline::push(uint8_t buttons, uint32_t timeMs, bool pressed) {
+    mSyncPending = false;
+    if (mCount == CAPACITY) {
+        fold(mEvents[mHead]);
+        mHead = (mHead + 1) % CAPACITY;
+        --mCount;
+    }
+    mEvents[(mHead + mCount) % CAPACITY] = { timeMs, buttons, pressed };
+    ++mCount;
+}
+
+void InputTimeline::fold(const Event& event) {
+    if (event.pressed) {
+        mHeld |= event.buttons;
+        mTapped |= event.buttons;
+    }
+    else {
+        mHeld &= ~event.buttons;
+    }
+    if (!mHasOldest) {
+        mHasOldest = true;
+        mOldestMs = event.timeMs;
+    }
+    ++mFoldedEvents;
+}
+
+void InputTimeline::sync(uint8_t heldButtons) {
+    mSyncPending = true;
+    mSyncedHeld = heldButtons & ~mEdgeButtons;
+}
+
+uint8_t InputTimeline::collect(uint32_t tickEndMs) {
+    // Timestamps only ever grow, so the queue is in time order and the
+    // comparison is written to survive the 49-day wrap of a 32-bit clock.
+    while (mCount > 0 && static_cast<int32_t>(mEvents[mHead].timeMs - tickEndMs) <= 0) {
+        fold(mEvents[mHead]);
+        mHead = (mHead + 1) % CAPACITY;
+        --mCount;
+    }
+    if (mCount == 0 && mSyncPending) {
+        mHeld = (mHeld & mEdgeButtons) | mSyncedHeld;
+        mSyncPending = false;
+    }
+    return (mHeld & ~mEdgeButtons) | mTapped;
+}
+
+void InputTimeline::commit() {
+    mTapped = 0;
+    mEventsApplied += mFoldedEvents;
+    mFoldedEvents = 0;
+    mHasOldest = false;
+}
+
+bool InputTimeline::getOldestEventTime(uint32_t& timeMs) const {
+    if (!mHasOldest) return false;
+    timeMs = mOldestMs;
+    return true;
+}
+
+void InputTimeline::clear() {
+    mHead = 0;
+    mCount = 0;
+    mHeld = 0;
+    mTapped = 0;
+    mSyncPending = false;
+    mFoldedEvents = 0;
+    mHasOldest = false;
+}
@@ -0,0 +1,73 @@
+#ifndef INPUT_TIMELINE_H
+#define INPUT_TIMELINE_H
+
+#include <cstdint>
+
+// One local player's button presses and releases, stamped with when they
+// happened, folded into the buttons of the simulation tick they fall in.
+// A held button shows up on every tick it covers, and a tap that starts and
+// ends between two ticks still shows up on one. Edge buttons (the bomb)
+// count once per press however long they are held. Game builds each tick's
+// mask here and hands that same mask to the replay, the rollback session and
+// the simulation, next to the bots' masks.
+//
+// Times are milliseconds on one clock, SDL's event timestamps in the game.
+// The queue is fixed-size so that recording input never allocates; past
+// capacity the oldest event is folded in early, which only loses its timing.
+class InputTimeline {
+public:
+    static const int CAPACITY = 64;
+
+    explicit InputTimeline(uint8_t edgeButtons = 0);
+
+    void press(uint8_t buttons, uint32_t timeMs);
+    void release(uint8_t buttons, uint32_t timeMs);
+
+    // Replaces the held buttons with a poll of the device once every queued
+    // event has been folded in, which catches releases the window never saw.
+    // Edge buttons are left alone. A press or release after this cancels it.
+    void sync(uint8_t heldButtons);
+
+    // Folds in every event up to tickEndMs and returns the buttons for the
+    // tick ending then. May be called again with a later end before commit().
+    uint8_t collect(uint32_t tickEndMs);
+    // The tick collect() built was simulated, so its taps are used up. A tick
+    // that stalls online skips this and its taps carry over to the next one.
+    void commit();
+
+    // Time of the earliest event folded into the uncommitted tick, for
+    // latency measurement; false if that tick has none.
+    bool getOldestEventTime(uint32_t& timeMs) const;
+    // Events that have reached a committed tick.
+    uint64_t getEventsApplied() const { return mEventsApplied; }
+
+    void clear();
+
+private:
+    struct Event {
+        uint32_t timeMs;
+        uint8_t buttons;
+        bool pressed;
+    };
+
+    uint8_t mEdgeButtons;
+    Event mEvents[CAPACITY];
+    int mHead;
+    int mCount;
+
+    uint8_t mHeld;
+    // Pressed since the last commit, whether or not still held.
+    uint8_t mTapped;
+    bool mSyncPending;
+    uint8_t mSyncedHeld;
+
+    int mFoldedEvents;
+    bool mHasOldest;
+    uint32_t mOldestMs;
+    uint64_t mEventsApplied;
+
+    void push(uint8_t buttons, uint32_t timeMs, bool pressed);
+    void fold(const Event& event);
+};
+
+#endif // INPUT_TIMELINE_H
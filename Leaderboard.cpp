@@ -0,0 +1,420 @@
+#include "Leaderboard.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+    const char LOG_MAGIC[4] = { 'B', 'M', 'S', 'L' };
+    const char INDEX_MAGIC[4] = { 'B', 'M', 'S', 'I' };
+    const uint32_t LOG_VERSION = 1;
+    const uint32_t INDEX_VERSION = 1;
+    const uint32_t FNV_OFFSET = 2166136261u;
+    const uint32_t FNV_PRIME = 16777619u;
+
+    struct ScoreLogHeader {
+        char magic[4];
+        uint32_t version;
+    };
+
+    struct ScoreLogRecord {
+        int32_t score;
+        uint32_t source;
+        uint64_t time;
+        uint32_t checksum;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(ScoreLogRecord) == 24, "score log records are written as-is");
+    static_assert(sizeof(ScoreRecord) == 16, "index entries are mapped as ScoreRecord");
+
+    uint32_t fnv1a(const void* data, size_t size, uint32_t hash = FNV_OFFSET) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * FNV_PRIME;
+        }
+        return hash;
+    }
+
+    uint32_t recordChecksum(const ScoreLogRecord& record) {
+        return fnv1a(&record, offsetof(ScoreLogRecord, checksum));
+    }
+
+    ScoreLogRecord toLogRecord(const ScoreRecord& record) {
+        ScoreLogRecord logRecord = {};
+        logRecord.score = record.score;
+        logRecord.source = record.source;
+        logRecord.time = record.time;
+        logRecord.checksum = recordChecksum(logRecord);
+        return logRecord;
+    }
+
+    ScoreRecord fromLogRecord(const ScoreLogRecord& logRecord) {
+        ScoreRecord record;
+        record.score = logRecord.score;
+        record.source = logRecord.source;
+        record.time = logRecord.time;
+        return record;
+    }
+
+    // Higher scores first, then whoever got there first.
+    bool ranksAbove(const ScoreRecord& a, const ScoreRecord& b) {
+        if (a.score != b.score) return a.score > b.score;
+        if (a.time != b.time) return a.time < b.time;
+        return a.source < b.source;
+    }
+
+    // Pushes the file's buffered writes all the way to the disk.
+    bool syncFile(std::FILE* file) {
+        if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+        return _commit(_fileno(file)) == 0;
+#else
+        return fsync(fileno(file)) == 0;
+#endif
+    }
+}
+
+void Leaderboard::IndexBuilder::setBase(const IndexBucket* buckets, uint32_t bucketCount, uint64_t scoreCount) {
+    mBase = buckets;
+    mBaseCount = bucketCount;
+    mBaseScores = scoreCount;
+}
+
+void Leaderboard::IndexBuilder::add(const ScoreRecord& record) {
+    addTop(record);
+    ++mCounts[record.score];
+}
+
+void Leaderboard::IndexBuilder::addTop(const ScoreRecord& record) {
+    if (mTop.size() < mTopK) {
+        mTop.push_back(record);
+        std::push_heap(mTop.begin(), mTop.end(), ranksAbove);
+    }
+    else if (ranksAbove(record, mTop.front())) {
+        std::pop_heap(mTop.begin(), mTop.end(), ranksAbove);
+        mTop.back() = record;
+        std::push_heap(mTop.begin(), mTop.end(), ranksAbove);
+    }
+}
+
+void Leaderboard::IndexBuilder::finish(std::vector<ScoreRecord>& top, std::vector<IndexBucket>& buckets, uint64_t& scoreCount) {
+    std::sort_heap(mTop.begin(), mTop.end(), ranksAbove);
+    top.swap(mTop);
+    buckets.clear();
+    buckets.reserve(mBaseCount + mCounts.size());
+    scoreCount = 0;
+    // Both run from the highest score down, so one pass merges them.
+    uint32_t base = 0;
+    auto added = mCounts.rbegin();
+    while (base < mBaseCount || added != mCounts.rend()) {
+        IndexBucket bucket = {};
+        uint64_t count = 0;
+        bool fromBase = base < mBaseCount && (added == mCounts.rend() || mBase[base].score >= added->first);
+        bool fromAdded = added != mCounts.rend() && (base == mBaseCount || added->first >= mBase[base].score);
+        if (fromBase) {
+            bucket.score = mBase[base].score;
+            count += (base + 1 < mBaseCount ? mBase[base + 1].above : mBaseScores) - mBase[base].above;
+            ++base;
+        }
+        if (fromAdded) {
+            bucket.score = added->first;
+            count += added->second;
+            ++added;
+        }
+        bucket.above = scoreCount;
+        buckets.push_back(bucket);
+        scoreCount += count;
+    }
+}
+
+Leaderboard::Leaderboard()
+    : mTopK(DEFAULT_TOP_K),
+    mLog(nullptr),
+    mLogRecords(0),
+    mIndex(nullptr),
+    mIndexTop(nullptr),
+    mIndexBuckets(nullptr)
+{
+}
+
+Leaderboard::~Leaderboard() {
+    close();
+}
+
+bool Leaderboard::open(const std::string& path, uint32_t topK) {
+    close();
+    mLogPath = path + ".log";
+    mIndexPath = path + ".idx";
+    mTopK = std::max<uint32_t>(topK, 1);
+
+    std::error_code error;
+    uintmax_t logSize = std::filesystem::exists(mLogPath, error) ? std::filesystem::file_size(mLogPath, error) : 0;
+    if (error) {
+        std::cerr << "Leaderboard Error: Cannot read '" << mLogPath << "': " << error.message() << std::endl;
+        return false;
+    }
+    if (logSize < sizeof(ScoreLogHeader)) {
+        // Missing, or cut short while it was being created.
+        std::FILE* file = std::fopen(mLogPath.c_str(), "wb");
+        ScoreLogHeader header;
+        std::memcpy(header.magic, LOG_MAGIC, sizeof(header.magic));
+        header.version = LOG_VERSION;
+        bool written = file && std::fwrite(&header, sizeof(header), 1, file) == 1 && syncFile(file);
+        if (file) std::fclose(file);
+        if (!written) {
+            std::cerr << "Leaderboard Error: Cannot create '" << mLogPath << "'." << std::endl;
+            return false;
+        }
+    }
+
+    bool indexValid = mapIndex();
+    uint64_t covered = mIndex ? mIndex->coveredRecords : 0;
+    uint64_t validRecords = 0;
+    uint64_t tornBytes = 0;
+    {
+        MappedFile log;
+        if (!log.open(mLogPath)) {
+            std::cerr << "Leaderboard Error: Cannot map '" << mLogPath << "'." << std::endl;
+            return false;
+        }
+        ScoreLogHeader header;
+        std::memcpy(&header, log.data(), sizeof(header));
+        if (std::memcmp(header.magic, LOG_MAGIC, sizeof(header.magic)) != 0 || header.version != LOG_VERSION) {
+            std::cerr << "Leaderboard Error: '" << mLogPath << "' is not a score log." << std::endl;
+            unmapIndex();
+            return false;
+        }
+
+        const uint8_t* records = log.data() + sizeof(ScoreLogHeader);
+        uint64_t storedRecords = (log.size() - sizeof(ScoreLogHeader)) / sizeof(ScoreLogRecord);
+        if (covered > storedRecords) {
+            // The index counts records the log no longer has.
+            indexValid = false;
+            covered = 0;
+        }
+        // Records the index covers were checked when they were folded in.
+        validRecords = covered;
+        std::vector<ScoreRecord> tail;
+        IndexBuilder rebuild(mTopK);
+        for (uint64_t i = covered; i < storedRecords; ++i) {
+            ScoreLogRecord logRecord;
+            std::memcpy(&logRecord, records + i * sizeof(ScoreLogRecord), sizeof(logRecord));
+            if (logRecord.checksum != recordChecksum(logRecord)) break;
+            if (indexValid) tail.push_back(fromLogRecord(logRecord));
+            else rebuild.add(fromLogRecord(logRecord));
+            ++validRecords;
+        }
+        tornBytes = log.size() - sizeof(ScoreLogHeader) - validRecords * sizeof(ScoreLogRecord);
+
+        if (!indexValid) {
+            if (validRecords > 0) std::cout << "Rebuilding leaderboard index from " << validRecords << " logged scores." << std::endl;
+            if (!writeIndex(rebuild, validRecords)) return false;
+        }
+        else {
+            std::stable_sort(tail.begin(), tail.end(), ranksAbove);
+            mPending.swap(tail);
+        }
+    }
+
+    if (tornBytes > 0) {
+        std::cerr << "Leaderboard Warning: Dropping " << tornBytes << " bytes of unfinished records from '" << mLogPath << "'." << std::endl;
+        std::filesystem::resize_file(mLogPath, sizeof(ScoreLogHeader) + validRecords * sizeof(ScoreLogRecord), error);
+        if (error) {
+            std::cerr << "Leaderboard Error: Cannot truncate '" << mLogPath << "': " << error.message() << std::endl;
+            close();
+            return false;
+        }
+    }
+    mLog = std::fopen(mLogPath.c_str(), "ab");
+    if (!mLog) {
+        std::cerr << "Leaderboard Error: Cannot open '" << mLogPath << "' for appending." << std::endl;
+        close();
+        return false;
+    }
+    mLogRecords = validRecords;
+    if (mPending.size() >= COMPACT_THRESHOLD) compact();
+    return true;
+}
+
+void Leaderboard::close() {
+    if (mLog) std::fclose(mLog);
+    mLog = nullptr;
+    mLogRecords = 0;
+    unmapIndex();
+    mPending.clear();
+}
+
+bool Leaderboard::add(const ScoreRecord& record) {
+    return add(std::vector<ScoreRecord>(1, record));
+}
+
+bool Leaderboard::add(const std::vector<ScoreRecord>& records) {
+    if (!mLog) return false;
+    std::vector<ScoreLogRecord> logRecords;
+    logRecords.reserve(records.size());
+    for (const auto& record : records) logRecords.push_back(toLogRecord(record));
+    if (std::fwrite(logRecords.data(), sizeof(ScoreLogRecord), logRecords.size(), mLog) != logRecords.size() || !syncFile(mLog)) {
+        // Whatever part of the write landed is picked up on the next open;
+        // appending past it now would leave the index counting the wrong records.
+        std::cerr << "Leaderboard Error: Cannot append to '" << mLogPath << "'; scores are not saved until it is reopened." << std::endl;
+        std::fclose(mLog);
+        mLog = nullptr;
+        return false;
+    }
+    mLogRecords += records.size();
+    size_t oldPending = mPending.size();
+    mPending.insert(mPending.end(), records.begin(), records.end());
+    std::stable_sort(mPending.begin() + oldPending, mPending.end(), ranksAbove);
+    std::inplace_merge(mPending.begin(), mPending.begin() + oldPending, mPending.end(), ranksAbove);
+    if (mPending.size() >= COMPACT_THRESHOLD) compact();
+    return true;
+}
+
+bool Leaderboard::compact() {
+    if (mPending.empty()) return true;
+    IndexBuilder builder(mTopK);
+    if (mIndex) {
+        for (uint32_t i = 0; i < mIndex->topCount; ++i) builder.addTop(mIndexTop[i]);
+        builder.setBase(mIndexBuckets, mIndex->bucketCount, mIndex->scoreCount);
+    }
+    for (const auto& record : mPending) builder.add(record);
+    if (!writeIndex(builder, mLogRecords)) return false;
+    mPending.clear();
+    return true;
+}
+
+void Leaderboard::getTop(size_t count, std::vector<ScoreRecord>& out) const {
+    out.clear();
+    count = std::min<size_t>(count, mTopK);
+    size_t indexCount = mIndex ? mIndex->topCount : 0;
+    size_t i = 0;
+    size_t j = 0;
+    while (out.size() < count && (i < indexCount || j < mPending.size())) {
+        if (j == mPending.size() || (i < indexCount && !ranksAbove(mPending[j], mIndexTop[i]))) out.push_back(mIndexTop[i++]);
+        else out.push_back(mPending[j++]);
+    }
+}
+
+uint64_t Leaderboard::getRank(int32_t score) const {
+    uint64_t above = 0;
+    if (mIndex) {
+        const IndexBucket* end = mIndexBuckets + mIndex->bucketCount;
+        const IndexBucket* bucket = std::partition_point(mIndexBuckets, end,
+            [score](const IndexBucket& candidate) { return candidate.score > score; });
+        above += bucket == end ? mIndex->scoreCount : bucket->above;
+    }
+    auto pending = std::partition_point(mPending.begin(), mPending.end(),
+        [score](const ScoreRecord& record) { return record.score > score; });
+    above += static_cast<uint64_t>(pending - mPending.begin());
+    return above + 1;
+}
+
+uint64_t Leaderboard::getCount() const {
+    return (mIndex ? mIndex->scoreCount : 0) + mPending.size();
+}
+
+int32_t Leaderboard::getBestScore() const {
+    bool hasIndexed = mIndex && mIndex->topCount > 0;
+    if (!hasIndexed && mPending.empty()) return 0;
+    if (!hasIndexed) return mPending.front().score;
+    if (mPending.empty()) return mIndexTop[0].score;
+    return std::max(mIndexTop[0].score, mPending.front().score);
+}
+
+bool Leaderboard::mapIndex() {
+    unmapIndex();
+    if (!mIndexFile.open(mIndexPath)) return false;
+
+    const uint8_t* data = mIndexFile.data();
+    IndexHeader header = {};
+    bool valid = mIndexFile.size() >= sizeof(IndexHeader);
+    if (valid) {
+        std::memcpy(&header, data, sizeof(header));
+        valid = std::memcmp(header.magic, INDEX_MAGIC, sizeof(header.magic)) == 0 && header.version == INDEX_VERSION
+            && header.topCount <= header.topK
+            && mIndexFile.size() == sizeof(IndexHeader) + static_cast<uint64_t>(header.topCount) * sizeof(ScoreRecord)
+                + static_cast<uint64_t>(header.bucketCount) * sizeof(IndexBucket);
+    }
+    if (valid) {
+        uint32_t stored = header.checksum;
+        header.checksum = 0;
+        uint32_t checksum = fnv1a(&header, sizeof(header));
+        checksum = fnv1a(data + sizeof(IndexHeader), mIndexFile.size() - sizeof(IndexHeader), checksum);
+        valid = checksum == stored;
+    }
+    if (!valid) {
+        std::cerr << "Leaderboard Warning: '" << mIndexPath << "' is damaged and will be rebuilt." << std::endl;
+        unmapIndex();
+        return false;
+    }
+    if (header.topK != mTopK) {
+        // Built for a different size of board; rebuilt at the current one.
+        unmapIndex();
+        return false;
+    }
+
+    mIndex = reinterpret_cast<const IndexHeader*>(data);
+    mIndexTop = reinterpret_cast<const ScoreRecord*>(data + sizeof(IndexHeader));
+    mIndexBuckets = reinterpret_cast<const IndexBucket*>(data + sizeof(IndexHeader) + header.topCount * sizeof(ScoreRecord));
+    return true;
+}
+
+void Leaderboard::unmapIndex() {
+    mIndexFile.close();
+    mIndex = nullptr;
+    mIndexTop = nullptr;
+    mIndexBuckets = nullptr;
+}
+
+bool Leaderboard::writeIndex(IndexBuilder& builder, uint64_t coveredRecords) {
+    std::vector<ScoreRecord> top;
+    std::vector<IndexBucket> buckets;
+    uint64_t scoreCount = 0;
+    builder.finish(top, buckets, scoreCount);
+
+    IndexHeader header = {};
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+    header.version = INDEX_VERSION;
+    header.coveredRecords = coveredRecords;
+    header.scoreCount = scoreCount;
+    header.topCount = static_cast<uint32_t>(top.size());
+    header.bucketCount = static_cast<uint32_t>(buckets.size());
+    header.topK = mTopK;
+    uint32_t checksum = fnv1a(&header, sizeof(header));
+    checksum = fnv1a(top.data(), top.size() * sizeof(ScoreRecord), checksum);
+    checksum = fnv1a(buckets.data(), buckets.size() * sizeof(IndexBucket), checksum);
+    header.checksum = checksum;
+
+    std::string tempPath = mIndexPath + ".tmp";
+    std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+    bool written = file && std::fwrite(&header, sizeof(header), 1, file) == 1
+        && (top.empty() || std::fwrite(top.data(), sizeof(ScoreRecord), top.size(), file) == top.size())
+        && (buckets.empty() || std::fwrite(buckets.data(), sizeof(IndexBucket), buckets.size(), file) == buckets.size())
+        && syncFile(file);
+    if (file && std::fclose(file) != 0) written = false;
+    if (!written) {
+        std::cerr << "Leaderboard Error: Cannot write '" << tempPath << "'." << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    // Windows will not replace a file that is still mapped.
+    unmapIndex();
+    std::error_code error;
+    std::filesystem::rename(tempPath, mIndexPath, error);
+    if (error) {
+        std::cerr << "Leaderboard Error: Cannot replace '" << mIndexPath << "': " << error.message() << std::endl;
+        std::remove(tempPath.c_str());
+        mapIndex();
+        return false;
+    }
+    return mapIndex();
+}
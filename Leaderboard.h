@@ -0,0 +1,136 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+// One finished match. `source` tells kiosks apart when their scores are
+// gathered into one board; `time` is seconds since the epoch.
+struct ScoreRecord {
+    int32_t score = 0;
+    uint32_t source = 0;
+    uint64_t time = 0;
+};
+
+// Scores kept on disk as two files next to each other:
+//
+//   PATH.log  "BMSL" | u32 version | ScoreLogRecord...
+//             Append-only, one checksummed record per score. It is the only
+//             copy of the data; a record torn by a crash fails its checksum
+//             and is cut off the next time the log is opened.
+//   PATH.idx  "BMSI" | header | top entries | score buckets
+//             Memory-mapped. The best topK scores in rank order, and one
+//             bucket per distinct score with how many scores beat it, for
+//             how many log records the header says it covers. It is always
+//             replaced whole (written aside, then renamed over), so it is
+//             either the old index or the new one, never a mix.
+//
+// Scores appended since the index was written are kept in memory in rank
+// order. compact() folds them into a new index; add() does it by itself once
+// COMPACT_THRESHOLD of them pile up, so neither the memory held nor the
+// work of a query grows with the log. Opening reads only the records the
+// index does not cover, unless the index is missing or damaged, in which
+// case it is rebuilt from the whole log.
+//
+// Top-N merges the mapped entries with the pending scores; rank of a score
+// is a binary search in each. Higher scores rank first, and equal scores in
+// the order they were made. Not thread-safe.
+class Leaderboard {
+public:
+    static const uint32_t DEFAULT_TOP_K = 1000;
+    static const size_t COMPACT_THRESHOLD = 4096;
+
+    Leaderboard();
+    ~Leaderboard();
+
+    Leaderboard(const Leaderboard&) = delete;
+    Leaderboard& operator=(const Leaderboard&) = delete;
+
+    // Opens or creates PATH.log and PATH.idx. Fails if the log cannot be
+    // opened or is not a score log; a bad index only costs a rebuild.
+    bool open(const std::string& path, uint32_t topK = DEFAULT_TOP_K);
+    void close();
+    bool isOpen() const { return mLog != nullptr; }
+
+    // Appends and syncs to disk before returning, once per call, so bulk
+    // imports should hand over their records together.
+    bool add(const ScoreRecord& record);
+    bool add(const std::vector<ScoreRecord>& records);
+
+    // Folds the pending scores into a new index.
+    bool compact();
+
+    // The best `count` scores, best first; at most topK of them.
+    void getTop(size_t count, std::vector<ScoreRecord>& out) const;
+    // 1 + how many scores are higher, i.e. where a new score would place.
+    uint64_t getRank(int32_t score) const;
+    uint64_t getCount() const;
+    // 0 while the board is empty.
+    int32_t getBestScore() const;
+
+private:
+    struct IndexHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t coveredRecords;
+        uint64_t scoreCount;
+        uint32_t topCount;
+        uint32_t bucketCount;
+        uint32_t topK;
+        uint32_t checksum;
+    };
+
+    struct IndexBucket {
+        int32_t score;
+        uint32_t reserved;
+        // Scores higher than this one.
+        uint64_t above;
+    };
+
+    // Collects the top entries and per-score counts for a new index, on top
+    // of the buckets of an existing one, which are merged in as they stand.
+    class IndexBuilder {
+    public:
+        explicit IndexBuilder(uint32_t topK) : mTopK(topK), mBase(nullptr), mBaseCount(0), mBaseScores(0) {}
+
+        void setBase(const IndexBucket* buckets, uint32_t bucketCount, uint64_t scoreCount);
+        void add(const ScoreRecord& record);
+        void addTop(const ScoreRecord& record);
+        // Top entries in rank order and buckets from the highest score down.
+        void finish(std::vector<ScoreRecord>& top, std::vector<IndexBucket>& buckets, uint64_t& scoreCount);
+
+    private:
+        uint32_t mTopK;
+        // Heap with the lowest-ranked kept entry on top.
+        std::vector<ScoreRecord> mTop;
+        std::map<int32_t, uint64_t> mCounts;
+        const IndexBucket* mBase;
+        uint32_t mBaseCount;
+        uint64_t mBaseScores;
+    };
+
+    std::string mLogPath;
+    std::string mIndexPath;
+    uint32_t mTopK;
+    std::FILE* mLog;
+    uint64_t mLogRecords;
+
+    MappedFile mIndexFile;
+    const IndexHeader* mIndex;
+    const ScoreRecord* mIndexTop;
+    const IndexBucket* mIndexBuckets;
+
+    std::vector<ScoreRecord> mPending;
+
+    // Maps PATH.idx if it is intact and built for mTopK.
+    bool mapIndex();
+    void unmapIndex();
+    // Writes the builder's index aside, renames it over PATH.idx and maps it.
+    bool writeIndex(IndexBuilder& builder, uint64_t coveredRecords);
+};
+
+#endif // LEADERBOARD_H
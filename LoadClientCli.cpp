@@ -0,0 +1,377 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Simulation.h"
+#include "BatchRunner.h"
+#include "ServerProtocol.h"
+#include "Replication.h"
+#include "UdpTransport.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Load generator for bomberman_server: opens --clients connections from one
+// process, each joining a room over TCP and then sending a RandomBot's input
+// over its own UDP socket at 60 Hz while decoding the state it gets back and
+// acknowledging it with the next input, as a game client would.
+// --spectators adds N viewers after the players, spread over the regions
+// of the first room, which only decode the stream they are sent.
+//
+//   bomberman_loadclient [--server HOST:PORT] [--clients N] [--spectators N]
+//                        [--ramp N] [--duration SECONDS]
+//
+// --ramp connects at most N clients per second. Fails if joins are refused,
+// a state does not decode, or the clients receive less than 90% of the
+// expected state updates.
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    const std::chrono::nanoseconds TICK_PERIOD(1000000000LL / TICKS_PER_SECOND);
+    const double MIN_STATE_SHARE = 0.9;
+    const size_t MAX_STATE_DATAGRAM = 65536;
+    // Spectators repeat WATCH this often in case one was lost.
+    const std::chrono::seconds WATCH_PERIOD(1);
+
+    enum class ClientPhase : uint8_t {
+        JOINING,
+        PLAYING,
+        CLOSED
+    };
+
+    struct LoadClient {
+        int tcp = -1;
+        int udp = -1;
+        ClientPhase phase = ClientPhase::JOINING;
+        std::vector<uint8_t> received;
+        uint32_t token = 0;
+        uint32_t room = 0;
+        int player = -1;
+        int inputTick = 0;
+        RandomBot bot;
+        bool spectator = false;
+        int region = 0;
+        ReplicaDecoder replica;
+        Clock::time_point joinedAt;
+        long long states = 0;
+        long long matchesOver = 0;
+        Clock::time_point lastStateAt;
+        // State updates that came more than two tick periods after the last.
+        long long lateStates = 0;
+    };
+
+    struct LoadTotals {
+        long long states = 0;
+        long long bytes = 0;
+        long long lateStates = 0;
+        long long matchesOver = 0;
+        long long refused = 0;
+        long long dropped = 0;
+        long long decodeFailures = 0;
+    };
+
+    // The epoll payload packs the client index with the socket kind.
+    uint64_t eventKey(size_t client, bool udp) {
+        return (static_cast<uint64_t>(client) << 1) | (udp ? 1 : 0);
+    }
+
+    void closeClient(LoadClient& client, int epoll) {
+        if (client.tcp >= 0) {
+            epoll_ctl(epoll, EPOLL_CTL_DEL, client.tcp, nullptr);
+            close(client.tcp);
+        }
+        if (client.udp >= 0) {
+            epoll_ctl(epoll, EPOLL_CTL_DEL, client.udp, nullptr);
+            close(client.udp);
+        }
+        client.tcp = -1;
+        client.udp = -1;
+        client.phase = ClientPhase::CLOSED;
+    }
+
+    bool connectClient(LoadClient& client, size_t index, const sockaddr_in& server, int epoll) {
+        client.tcp = socket(AF_INET, SOCK_STREAM, 0);
+        if (client.tcp < 0) return false;
+        int enabled = 1;
+        setsockopt(client.tcp, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+        if (connect(client.tcp, reinterpret_cast<const sockaddr*>(&server), sizeof(server)) != 0) {
+            close(client.tcp);
+            client.tcp = -1;
+            return false;
+        }
+        std::vector<uint8_t> join;
+        if (client.spectator) {
+            const int region = client.region;
+            appendFrame(join, ServerMessage::SPECTATE, [region](ByteWriter& writer) {
+                writer.writeU8(SERVER_PROTOCOL_VERSION);
+                writer.writeVarint(0);
+                writer.writeVarint(static_cast<uint64_t>(region));
+            });
+        }
+        else {
+            appendFrame(join, ServerMessage::JOIN, [](ByteWriter& writer) {
+                writer.writeU8(SERVER_PROTOCOL_VERSION);
+                writer.writeVarint(0);
+            });
+        }
+        if (send(client.tcp, join.data(), join.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(join.size())) return false;
+
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.u64 = eventKey(index, false);
+        return epoll_ctl(epoll, EPOLL_CTL_ADD, client.tcp, &event) == 0;
+    }
+
+    // The UDP socket is connected to the server, so only its datagrams arrive.
+    bool openUdp(LoadClient& client, size_t index, const sockaddr_in& server, uint16_t port, int epoll) {
+        client.udp = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+        if (client.udp < 0) return false;
+        sockaddr_in address = server;
+        address.sin_port = htons(port);
+        if (connect(client.udp, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) return false;
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.u64 = eventKey(index, true);
+        return epoll_ctl(epoll, EPOLL_CTL_ADD, client.udp, &event) == 0;
+    }
+
+    // Returns false if the connection should be closed.
+    bool readTcp(LoadClient& client, size_t index, const sockaddr_in& server, int epoll, LoadTotals& totals) {
+        uint8_t buffer[1024];
+        while (true) {
+            ssize_t received = recv(client.tcp, buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (received == 0) return false;
+            if (received < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                return false;
+            }
+            client.received.insert(client.received.end(), buffer, buffer + received);
+        }
+
+        size_t consumed = 0;
+        size_t length = 0;
+        while (true) {
+            FrameStatus status = findFrame(client.received.data() + consumed, client.received.size() - consumed, length);
+            if (status == FrameStatus::INCOMPLETE) break;
+            if (status == FrameStatus::INVALID) return false;
+            ByteReader reader(client.received.data() + consumed + FRAME_HEADER_SIZE, length);
+            consumed += FRAME_HEADER_SIZE + length;
+            ServerMessage type = static_cast<ServerMessage>(reader.readU8());
+            if (type == ServerMessage::JOINED || type == ServerMessage::SPECTATING) {
+                client.room = static_cast<uint32_t>(reader.readVarint());
+                if (type == ServerMessage::JOINED) {
+                    client.player = reader.readU8();
+                }
+                else {
+                    client.region = static_cast<int>(reader.readVarint());
+                    reader.readVarint();
+                }
+                client.token = reader.readU32();
+                uint16_t port = reader.readU16();
+                if (!reader.isOk() || !openUdp(client, index, server, port, epoll)) return false;
+                client.phase = ClientPhase::PLAYING;
+                client.joinedAt = Clock::now();
+                client.lastStateAt = client.joinedAt;
+            }
+            else if (type == ServerMessage::JOIN_REFUSED) {
+                ++totals.refused;
+                return false;
+            }
+            else if (type == ServerMessage::MATCH_OVER) {
+                ++client.matchesOver;
+                ++totals.matchesOver;
+            }
+        }
+        client.received.erase(client.received.begin(), client.received.begin() + consumed);
+        return true;
+    }
+
+    void readUdp(LoadClient& client, std::vector<uint8_t>& buffer, LoadTotals& totals) {
+        while (true) {
+            ssize_t received = recv(client.udp, buffer.data(), buffer.size(), MSG_DONTWAIT);
+            if (received <= 0) return;
+            ByteReader reader(buffer.data(), static_cast<size_t>(received));
+            ServerMessage type = static_cast<ServerMessage>(reader.readU8());
+            uint64_t room = reader.readVarint();
+            reader.readVarint();
+            if (!reader.isOk() || type != ServerMessage::STATE || room != client.room) continue;
+
+            Clock::time_point now = Clock::now();
+            if (client.states > 0 && now - client.lastStateAt > TICK_PERIOD * 2) ++client.lateStates;
+            client.lastStateAt = now;
+            ++client.states;
+            totals.bytes += received;
+            // A spectator's stream is undecodable until its first keyframe.
+            bool hadState = client.replica.hasState();
+            if (!client.replica.decode(buffer.data() + reader.getPosition(), received - reader.getPosition()) && hadState) {
+                ++totals.decodeFailures;
+            }
+        }
+    }
+
+    void sendInputs(std::vector<LoadClient>& clients, Rng& rng, std::vector<uint8_t>& bytes, bool sendWatches) {
+        for (auto& client : clients) {
+            if (client.phase != ClientPhase::PLAYING) continue;
+            bytes.clear();
+            ByteWriter writer(bytes);
+            if (client.spectator) {
+                if (!sendWatches && client.states > 0) continue;
+                writer.writeU8(static_cast<uint8_t>(ServerMessage::WATCH));
+                writer.writeU32(client.token);
+                send(client.udp, bytes.data(), bytes.size(), MSG_DONTWAIT);
+                continue;
+            }
+            writer.writeU8(static_cast<uint8_t>(ServerMessage::INPUT));
+            writer.writeU32(client.token);
+            writer.writeVarint(static_cast<uint64_t>(client.inputTick++));
+            writer.writeU8(client.bot.nextButtons(rng));
+            writer.writeU8(client.replica.getGeneration());
+            writer.writeVarint(static_cast<uint64_t>(client.replica.getLatestTick() + 1));
+            send(client.udp, bytes.data(), bytes.size(), MSG_DONTWAIT);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string serverAddress = "127.0.0.1:" + std::to_string(DEFAULT_SERVER_PORT);
+    int clientCount = 100;
+    int spectatorCount = 0;
+    double ramp = 1000.0;
+    double duration = 10.0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--server" && hasValue) serverAddress = argv[++i];
+        else if (arg == "--clients" && hasValue) clientCount = std::atoi(argv[++i]);
+        else if (arg == "--spectators" && hasValue) spectatorCount = std::atoi(argv[++i]);
+        else if (arg == "--ramp" && hasValue) ramp = std::atof(argv[++i]);
+        else if (arg == "--duration" && hasValue) duration = std::atof(argv[++i]);
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--server HOST:PORT] [--clients N] [--spectators N] [--ramp N] [--duration SECONDS]" << std::endl;
+            return 2;
+        }
+    }
+
+    std::string host;
+    uint16_t port = 0;
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    addrinfo* found = nullptr;
+    if (!parseHostPort(serverAddress, host, port) || getaddrinfo(host.c_str(), nullptr, &hints, &found) != 0 || !found) {
+        std::cerr << "Load Error: Cannot resolve server '" << serverAddress << "'." << std::endl;
+        return 2;
+    }
+    sockaddr_in server = *reinterpret_cast<sockaddr_in*>(found->ai_addr);
+    server.sin_port = htons(port);
+    freeaddrinfo(found);
+
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    int epoll = epoll_create1(0);
+    std::vector<LoadClient> clients(clientCount + spectatorCount);
+    for (int i = 0; i < spectatorCount; ++i) {
+        clients[clientCount + i].spectator = true;
+        clients[clientCount + i].region = i;
+    }
+    std::vector<uint8_t> datagram(MAX_STATE_DATAGRAM);
+    std::vector<uint8_t> input;
+    Rng rng(0x10AD);
+    LoadTotals totals;
+
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(duration));
+    Clock::time_point nextInput = start;
+    Clock::time_point nextWatch = start;
+    Clock::time_point nextReport = start + std::chrono::seconds(1);
+    size_t connected = 0;
+    epoll_event events[256];
+    while (Clock::now() < end) {
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        size_t due = std::min(clients.size(), static_cast<size_t>(ramp * elapsed) + 1);
+        for (; connected < due; ++connected) {
+            if (!connectClient(clients[connected], connected, server, epoll)) {
+                closeClient(clients[connected], epoll);
+                ++totals.dropped;
+            }
+        }
+
+        int waitMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(nextInput - Clock::now()).count());
+        int count = epoll_wait(epoll, events, 256, std::max(0, waitMs));
+        for (int i = 0; i < count; ++i) {
+            size_t index = static_cast<size_t>(events[i].data.u64 >> 1);
+            LoadClient& client = clients[index];
+            if (client.phase == ClientPhase::CLOSED) continue;
+            if (events[i].data.u64 & 1) {
+                readUdp(client, datagram, totals);
+            }
+            else if (!readTcp(client, index, server, epoll, totals)) {
+                closeClient(client, epoll);
+                ++totals.dropped;
+            }
+        }
+
+        Clock::time_point now = Clock::now();
+        if (now >= nextInput) {
+            sendInputs(clients, rng, input, now >= nextWatch);
+            if (now >= nextWatch) nextWatch = now + WATCH_PERIOD;
+            nextInput += TICK_PERIOD;
+            if (now - nextInput > TICK_PERIOD) nextInput = now;
+        }
+        if (now >= nextReport) {
+            int playing = 0;
+            long long states = 0;
+            for (const auto& client : clients) {
+                if (client.phase == ClientPhase::PLAYING) ++playing;
+                states += client.states;
+            }
+            std::cout << std::chrono::duration<double>(now - start).count() << " s: " << playing << " clients playing, "
+                << states << " states received" << std::endl;
+            nextReport += std::chrono::seconds(1);
+        }
+    }
+
+    // Expected updates count from each client's join to the end of the run.
+    double expected = 0.0;
+    int playing = 0;
+    for (auto& client : clients) {
+        if (client.phase == ClientPhase::PLAYING) {
+            ++playing;
+            expected += std::chrono::duration<double>(end - client.joinedAt).count() * TICKS_PER_SECOND;
+        }
+        totals.states += client.states;
+        totals.lateStates += client.lateStates;
+        closeClient(client, epoll);
+    }
+    close(epoll);
+
+    double share = expected > 0.0 ? totals.states / expected : 0.0;
+    std::cout << playing << " of " << clients.size() << " clients playing at the end, " << totals.dropped << " dropped, "
+        << totals.refused << " refused" << std::endl;
+    std::cout << totals.states << " states (" << share * 100.0 << "% of expected), " << totals.lateStates
+        << " late, " << totals.bytes / duration / 1024.0 << " KiB/s, " << totals.matchesOver << " match results" << std::endl;
+    std::cout << totals.decodeFailures << " states failed to decode" << std::endl;
+
+    if (totals.refused > 0 || totals.dropped > 0 || share < MIN_STATE_SHARE || totals.decodeFailures > 0) {
+        std::cerr << "Load Error: The server did not keep up with " << clientCount << " clients and " << spectatorCount << " spectators." << std::endl;
+        return 1;
+    }
+    return 0;
+}
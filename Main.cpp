@@ -1,116 +1,478 @@
-#include <iostream>
-#include <SDL.h>
-#include <SDL_image.h>
-#include <SDL_ttf.h>
-#include <SDL_mixer.h>
-#include "game.h"
-
-const int SCREEN_WIDTH = 800;
-const int SCREEN_HEIGHT = 600;
-
-int WinMain(int argc, char* args[]) {
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
-        std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
-        return 1;
-    }
-
-    int imgFlags = IMG_INIT_PNG;
-    if (!(IMG_Init(imgFlags) & imgFlags)) {
-        std::cerr << "SDL_image could not initialize! SDL_image Error: " << IMG_GetError() << std::endl;
-        SDL_Quit();
-        return 1;
-    }
-
-    if (TTF_Init() == -1) {
-        std::cerr << "SDL_ttf could not initialize! TTF_Error: " << TTF_GetError() << std::endl;
-        IMG_Quit();
-        SDL_Quit();
-        return 1;
-    }
-
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
-        std::cerr << "SDL_mixer could not initialize! Mix_Error: " << Mix_GetError() << std::endl;
-    }
-
-
-    SDL_Window* window = SDL_CreateWindow("Bomberman", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
-        SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
-    if (window == nullptr) {
-        std::cerr << "Window could not be created! SDL_Error: " << SDL_GetError() << std::endl;
-        if (Mix_Linked_Version()) Mix_CloseAudio();
-        Mix_Quit();
-        TTF_Quit();
-        IMG_Quit();
-        SDL_Quit();
-        return 1;
-    }
-
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-    if (renderer == nullptr) {
-        std::cerr << "Renderer could not be created! SDL_Error: " << SDL_GetError() << std::endl;
-        SDL_DestroyWindow(window);
-        if (Mix_Linked_Version()) Mix_CloseAudio();
-        Mix_Quit();
-        TTF_Quit();
-        IMG_Quit();
-        SDL_Quit();
-        return 1;
-    }
-
-    Game game(renderer, SCREEN_WIDTH, SCREEN_HEIGHT);
-    if (!game.initialize()) {
-        std::cerr << "Failed to initialize game!" << std::endl;
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
-        if (Mix_Linked_Version()) Mix_CloseAudio();
-        Mix_Quit();
-        TTF_Quit();
-        IMG_Quit();
-        SDL_Quit();
-        return 1;
-    }
-
-    bool quit = false;
-    SDL_Event e;
-    Uint32 lastTime = SDL_GetTicks();
-    const int FPS = 60;
-    const int FRAME_DELAY = 1000 / FPS;
-
-    while (!quit) {
-        Uint32 frameStart = SDL_GetTicks();
-
-        while (SDL_PollEvent(&e) != 0) {
-            if (e.type == SDL_QUIT) {
-                quit = true;
-            }
-            game.handleEvent(e);
-        }
-
-        Uint32 currentTime = SDL_GetTicks();
-        float deltaTime = (currentTime - lastTime) / 1000.0f;
-        lastTime = currentTime;
-
-        game.update(deltaTime);
-
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderClear(renderer);
-        game.render();
-        SDL_RenderPresent(renderer);
-
-        Uint32 frameTime = SDL_GetTicks() - frameStart;
-        if (frameTime < FRAME_DELAY) {
-            SDL_Delay(FRAME_DELAY - frameTime);
-        }
-    }
-
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
-
-    if (Mix_Linked_Version()) Mix_CloseAudio();
-    Mix_Quit();
-    TTF_Quit();
-    IMG_Quit();
-    SDL_Quit();
-
-    return 0;
-}
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <SDL.h>
+#include <SDL_image.h>
+#include <SDL_ttf.h>
+#include <SDL_mixer.h>
+#include "Game.h"
+#include "AssetArchive.h"
+#include "AssetBenchmark.h"
+#include "SdlRenderer.h"
+#include "NullRenderer.h"
+#include "FramePacer.h"
+#include "Profiler.h"
+#include "Counters.h"
+#include "AllocationTracker.h"
+#include "StartupGraph.h"
+
+const int SCREEN_WIDTH = 800;
+const int SCREEN_HEIGHT = 600;
+const char* ASSET_ARCHIVE_PATH = "assets.pak";
+const double TARGET_FPS = 60.0;
+const int IDLE_WAKE_INTERVAL_MS = 250;
+const int STEADY_STATE_WARMUP_FRAMES = 60;
+const int INPUT_PROBE_MIN_GAP_MS = 50;
+const int INPUT_PROBE_GAP_SPREAD_MS = 67;
+const int INPUT_PROBE_MARKER_SIZE = 32;
+
+// --vsync, --uncapped or --fps N anywhere on the command line; the default is
+// a fixed 60 FPS cap.
+static PacingMode parsePacingMode(int argc, char* args[], double& targetFps) {
+    PacingMode pacingMode = PacingMode::FIXED;
+    targetFps = TARGET_FPS;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = args[i];
+        if (arg == "--vsync") pacingMode = PacingMode::VSYNC;
+        else if (arg == "--uncapped") pacingMode = PacingMode::UNCAPPED;
+        else if (arg == "--fps" && i + 1 < argc) {
+            pacingMode = PacingMode::FIXED;
+            targetFps = std::atof(args[++i]);
+        }
+    }
+    return pacingMode;
+}
+
+// --net-player I --net-peers HOST:PORT,HOST:PORT[,...] plays online as player
+// I; --net-seed S and --net-delay TICKS must match on every peer. Returns
+// false if the options are incomplete or inconsistent.
+static bool parseNetplay(int argc, char* args[], NetplaySetup& setup) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        std::string arg = args[i];
+        if (arg == "--net-player") setup.localPlayer = std::atoi(args[++i]);
+        else if (arg == "--net-seed") setup.seed = std::strtoull(args[++i], nullptr, 10);
+        else if (arg == "--net-delay") setup.inputDelayTicks = std::atoi(args[++i]);
+        else if (arg == "--net-peers") {
+            std::stringstream list(args[++i]);
+            std::string peer;
+            while (std::getline(list, peer, ',')) setup.peers.push_back(peer);
+        }
+    }
+    if (setup.localPlayer < 0 && setup.peers.empty()) return true;
+    int playerCount = static_cast<int>(setup.peers.size());
+    if (playerCount < 2 || playerCount > MAX_PLAYERS || setup.localPlayer < 0 || setup.localPlayer >= playerCount) {
+        std::cerr << "Online play needs --net-player I and --net-peers listing 2 to " << MAX_PLAYERS << " players including I." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Runs the full game loop against the null backend with a fixed timestep and
+// no frame cap, restarting the match whenever it ends. Fails if any
+// steady-state PLAYING frame (past the first second of its match, so that
+// streamed assets have settled) allocates on the heap.
+static int runHeadless(int frameCount) {
+    NullRenderer renderer;
+    Game game(&renderer, SCREEN_WIDTH, SCREEN_HEIGHT);
+    game.setPersistent(false);
+    if (!game.initialize()) {
+        std::cerr << "Failed to initialize game!" << std::endl;
+        return 1;
+    }
+
+    const float deltaTime = 1.0f / 60.0f;
+    int matchesStarted = 0;
+    int framesInMatch = 0;
+    int allocatingFrames = 0;
+    FramePacer pacer(PacingMode::UNCAPPED);
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int frame = 0; frame < frameCount; ++frame) {
+        pacer.beginFrame();
+        if (game.getState() != GameState::PLAYING) {
+            framesInMatch = 0;
+            game.startMatch();
+            ++matchesStarted;
+            if (game.getState() != GameState::PLAYING) {
+                std::cerr << "Headless Error: Could not start a match." << std::endl;
+                return 1;
+            }
+        }
+        bool steadyState = ++framesInMatch > STEADY_STATE_WARMUP_FRAMES;
+        uint64_t allocationsBefore = AllocationTracker::getThreadAllocations();
+
+        game.update(deltaTime);
+
+        renderer.setDrawColor(0, 0, 0, 255);
+        renderer.clear();
+        game.render();
+        renderer.present();
+
+        if (steadyState && game.getState() == GameState::PLAYING
+            && AllocationTracker::getThreadAllocations() != allocationsBefore) {
+            ++allocatingFrames;
+        }
+        pacer.endFrame();
+    }
+    double seconds = static_cast<double>(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+
+    const NullRenderer::Stats& stats = renderer.getStats();
+    std::cout << "Headless run: " << frameCount << " frames, " << matchesStarted << " matches in " << seconds << " s ("
+        << (seconds > 0.0 ? frameCount / seconds : 0.0) << " frames/s)" << std::endl;
+    std::cout << "Draw counts: " << stats.copies << " copies, " << stats.fills << " fills, " << stats.clears << " clears, "
+        << stats.presents << " presents, " << stats.texturesCreated << " textures created, "
+        << stats.texturesDestroyed << " destroyed" << std::endl;
+    pacer.printStats(std::cout);
+
+    if (allocatingFrames > 0) {
+        std::cerr << "Headless Error: " << allocatingFrames << " steady-state frames allocated on the heap." << std::endl;
+#ifdef BOMBERMAN_TRACK_ALLOCATIONS
+        for (const auto& phase : AllocationTracker::getPhaseStats()) {
+            std::cerr << "  " << phase.name << ": " << phase.allocations << " allocations, " << phase.bytes << " bytes" << std::endl;
+        }
+#endif
+        return 1;
+    }
+    return 0;
+}
+
+// One synthetic key event for the input latency test. It is pushed from an
+// SDL timer thread so that it lands at an arbitrary point of the frame, as a
+// real key press would, rather than just before the events are polled.
+struct InputProbe {
+    SDL_Keycode key = SDLK_LEFT;
+    SDL_Scancode scancode = SDL_SCANCODE_LEFT;
+    bool press = true;
+    std::atomic<Uint64> queuedAt{ 0 };
+};
+
+static Uint32 pushInputProbe(Uint32, void* param) {
+    InputProbe* probe = static_cast<InputProbe*>(param);
+    SDL_Event e = {};
+    e.type = probe->press ? SDL_KEYDOWN : SDL_KEYUP;
+    e.key.state = probe->press ? SDL_PRESSED : SDL_RELEASED;
+    e.key.keysym.sym = probe->key;
+    e.key.keysym.scancode = probe->scancode;
+    probe->queuedAt.store(SDL_GetPerformanceCounter());
+    SDL_PushEvent(&e);
+    return 0;
+}
+
+static void printLatency(const char* label, std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double sample : samples) sum += sample;
+    std::cout << label << ": avg " << sum / samples.size() << " ms, p50 " << samples[samples.size() / 2]
+        << " ms, p99 " << samples[std::min(samples.size() - 1, samples.size() * 99 / 100)]
+        << " ms, max " << samples.back() << " ms" << std::endl;
+}
+
+// Plays a match against synthetic arrow key presses and releases, one at a
+// time, and times each from being queued to the tick that applied it and to
+// the return of the present that showed it. That frame also gets a white
+// square in the top-left corner, so a photodiode or high-speed camera can
+// time the rest of the way to the screen.
+static bool runInputLatencyTest(Game& game, SdlRenderer& renderer, FramePacer& pacer, int sampleCount) {
+    const SDL_Rect marker = { 0, 0, INPUT_PROBE_MARKER_SIZE, INPUT_PROBE_MARKER_SIZE };
+    const double ticksPerMs = SDL_GetPerformanceFrequency() / 1000.0;
+    std::vector<double> toTickMs;
+    std::vector<double> toPresentMs;
+    InputProbe probe;
+    SDL_TimerID timer = 0;
+    uint64_t appliedBefore = 0;
+    SDL_Event e;
+
+    while (static_cast<int>(toPresentMs.size()) < sampleCount) {
+        if (game.getState() != GameState::PLAYING) {
+            // A probe that arrives between matches is never applied; drop it
+            // and start over with the new match.
+            if (timer != 0) {
+                SDL_RemoveTimer(timer);
+                SDL_FlushEvents(SDL_KEYDOWN, SDL_KEYUP);
+                timer = 0;
+            }
+            game.startMatch();
+            if (game.getState() != GameState::PLAYING) {
+                std::cerr << "Latency Test Error: Could not start a match." << std::endl;
+                return false;
+            }
+        }
+        if (timer == 0) {
+            appliedBefore = game.getInputEventsApplied();
+            int gapMs = INPUT_PROBE_MIN_GAP_MS + static_cast<int>(toPresentMs.size() * 37) % INPUT_PROBE_GAP_SPREAD_MS;
+            timer = SDL_AddTimer(gapMs, pushInputProbe, &probe);
+            if (timer == 0) {
+                std::cerr << "Latency Test Error: Could not add a timer! SDL_Error: " << SDL_GetError() << std::endl;
+                return false;
+            }
+        }
+
+        float deltaTime = pacer.beginFrame();
+        while (SDL_PollEvent(&e) != 0) {
+            if (e.type == SDL_QUIT) {
+                SDL_RemoveTimer(timer);
+                return false;
+            }
+            game.handleEvent(e);
+        }
+        game.update(deltaTime);
+
+        bool applied = game.getInputEventsApplied() != appliedBefore;
+        if (applied) {
+            toTickMs.push_back((SDL_GetPerformanceCounter() - probe.queuedAt.load()) / ticksPerMs);
+        }
+        game.consumeRedraw();
+        renderer.setDrawColor(0, 0, 0, 255);
+        renderer.clear();
+        game.render();
+        if (applied) {
+            renderer.setDrawColor(255, 255, 255, 255);
+            renderer.fillRect(&marker);
+        }
+        renderer.present();
+        if (applied) {
+            toPresentMs.push_back((SDL_GetPerformanceCounter() - probe.queuedAt.load()) / ticksPerMs);
+            // Press, release, then the same on the other arrow, so the
+            // player wanders back and forth instead of into a wall.
+            if (!probe.press) {
+                probe.key = probe.key == SDLK_LEFT ? SDLK_RIGHT : SDLK_LEFT;
+                probe.scancode = probe.key == SDLK_LEFT ? SDL_SCANCODE_LEFT : SDL_SCANCODE_RIGHT;
+            }
+            probe.press = !probe.press;
+            timer = 0;
+        }
+        pacer.endFrame();
+    }
+
+    std::cout << "Input latency over " << sampleCount << " key events:" << std::endl;
+    printLatency("  queued to tick", toTickMs);
+    printLatency("  queued to present", toPresentMs);
+    pacer.printStats(std::cout);
+    return true;
+}
+
+// Safe to call whatever part of startup got done; the SDL libraries ignore
+// shutdown calls for anything that was never initialized.
+static void shutdownSdl(SDL_Window* window, SDL_Renderer* renderer) {
+    if (renderer) SDL_DestroyRenderer(renderer);
+    if (window) SDL_DestroyWindow(window);
+    if (Mix_Linked_Version()) Mix_CloseAudio();
+    Mix_Quit();
+    TTF_Quit();
+    IMG_Quit();
+    SDL_Quit();
+}
+
+int WinMain(int argc, char* args[]) {
+    // Created first so that every startup timing is measured from launch.
+    StartupGraph startup;
+
+    std::string mode = argc > 1 ? args[1] : "";
+    bool headless = mode == "--headless";
+
+    NetplaySetup netplay;
+    if (!parseNetplay(argc, args, netplay)) {
+        return 1;
+    }
+
+    // Video has to stay on this thread. SDL_image, SDL_ttf and the audio
+    // device only need SDL itself, so they come up on workers while the
+    // window and renderer are created here.
+    Uint32 sdlFlags = headless ? (SDL_INIT_TIMER | SDL_INIT_EVENTS) : (SDL_INIT_VIDEO | SDL_INIT_AUDIO);
+    StartupGraph::TaskId sdl = startup.add("sdl.init", TaskThread::MAIN, {}, [sdlFlags]() {
+        if (SDL_Init(sdlFlags) < 0) {
+            std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
+            return false;
+        }
+        return true;
+    });
+    StartupGraph::TaskId images = startup.add("sdl.image", TaskThread::WORKER, { sdl }, []() {
+        int imgFlags = IMG_INIT_PNG;
+        if (!(IMG_Init(imgFlags) & imgFlags)) {
+            std::cerr << "SDL_image could not initialize! SDL_image Error: " << IMG_GetError() << std::endl;
+            return false;
+        }
+        return true;
+    });
+    StartupGraph::TaskId fonts = startup.add("sdl.ttf", TaskThread::WORKER, { sdl }, []() {
+        if (TTF_Init() == -1) {
+            std::cerr << "SDL_ttf could not initialize! TTF_Error: " << TTF_GetError() << std::endl;
+            return false;
+        }
+        return true;
+    });
+    // Opening the device can take longer than anything else here; the game
+    // still runs without sound if it fails.
+    StartupGraph::TaskId audio = startup.add("sdl.audio", TaskThread::WORKER, { sdl }, [headless]() {
+        if (!headless && Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
+            std::cerr << "SDL_mixer could not initialize! Mix_Error: " << Mix_GetError() << std::endl;
+        }
+        return true;
+    });
+
+    if (headless || mode == "--pack-assets") {
+        int exitCode = 1;
+        if (startup.run()) {
+            if (headless) exitCode = runHeadless(argc > 2 ? std::atoi(args[2]) : 3600);
+            else exitCode = buildAssetArchive(argc > 2 ? args[2] : ASSET_ARCHIVE_PATH, defaultArchiveInputs()) ? 0 : 1;
+        }
+        shutdownSdl(nullptr, nullptr);
+        return exitCode;
+    }
+
+    double targetFps = TARGET_FPS;
+    PacingMode pacingMode = parsePacingMode(argc, args, targetFps);
+    SDL_Window* window = nullptr;
+    SDL_Renderer* renderer = nullptr;
+    SdlRenderer gameRenderer;
+    StartupGraph::TaskId video = startup.add("sdl.window", TaskThread::MAIN, { sdl }, [&]() {
+        window = SDL_CreateWindow("Bomberman", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+            SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+        if (window == nullptr) {
+            std::cerr << "Window could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+            return false;
+        }
+
+        Uint32 rendererFlags = SDL_RENDERER_ACCELERATED;
+        if (pacingMode == PacingMode::VSYNC) rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+        renderer = SDL_CreateRenderer(window, -1, rendererFlags);
+        if (renderer == nullptr) {
+            std::cerr << "Renderer could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+            return false;
+        }
+        gameRenderer.attach(renderer);
+
+        SDL_RendererInfo rendererInfo;
+        if (pacingMode == PacingMode::VSYNC &&
+            (SDL_GetRendererInfo(renderer, &rendererInfo) != 0 || !(rendererInfo.flags & SDL_RENDERER_PRESENTVSYNC))) {
+            std::cerr << "VSync is not available, falling back to a fixed frame cap." << std::endl;
+            pacingMode = PacingMode::FIXED;
+        }
+        return true;
+    });
+
+    if (mode == "--bench-assets") {
+        bool started = startup.run();
+        if (started) runAssetStartupBenchmark(renderer, ASSET_ARCHIVE_PATH, argc > 2 ? std::atoi(args[2]) : 20);
+        shutdownSdl(window, renderer);
+        return started ? 0 : 1;
+    }
+
+    // The game owns textures, fonts and loader threads; it has to be gone
+    // before the renderer and the SDL subsystems are shut down.
+    bool initialized = true;
+    {
+        Game game(&gameRenderer, SCREEN_WIDTH, SCREEN_HEIGHT);
+        game.setNetplay(netplay);
+        // Latency samples are bot matches; keep them off the leaderboard.
+        if (mode == "--input-latency") game.setPersistent(false);
+        game.addStartupTasks(startup, video, fonts, images, audio);
+        if (!startup.run()) {
+            std::cerr << "Failed to initialize game!" << std::endl;
+            initialized = false;
+        }
+
+        bool latencyTest = mode == "--input-latency";
+        if (initialized && latencyTest) {
+            game.addDeferredTasks(startup);
+            startup.run();
+            int sampleCount = argc > 2 ? std::atoi(args[2]) : 0;
+            FramePacer pacer(pacingMode, targetFps);
+            initialized = runInputLatencyTest(game, gameRenderer, pacer, sampleCount > 0 ? sampleCount : 200);
+        }
+
+        bool quit = latencyTest;
+        bool wasIdle = false;
+        bool menuShown = false;
+        bool startupFinished = false;
+        SDL_Event e;
+        FramePacer pacer(pacingMode, targetFps);
+
+        while (!quit && initialized) {
+            if (menuShown && !startupFinished) {
+                // The menu takes input from here on; what it did not need
+                // loads behind it before the report goes out.
+                game.addDeferredTasks(startup);
+                startup.run();
+                startup.printReport(std::cout);
+                startupFinished = true;
+            }
+            if (game.isIdle()) {
+                // Nothing animates in the menus: block until input arrives, waking
+                // now and then to notice audio state changes, and only redraw when
+                // the game reports that something visible changed.
+                if (SDL_WaitEventTimeout(&e, IDLE_WAKE_INTERVAL_MS)) {
+                    do {
+                        if (e.type == SDL_QUIT) {
+                            quit = true;
+                        }
+                        game.handleEvent(e);
+                    } while (SDL_PollEvent(&e) != 0);
+                }
+                game.update(0.0f);
+                if (game.consumeRedraw()) {
+                    gameRenderer.setDrawColor(0, 0, 0, 255);
+                    gameRenderer.clear();
+                    game.render();
+                    gameRenderer.present();
+                    if (!menuShown) startup.mark("first menu frame");
+                    menuShown = true;
+                }
+                wasIdle = true;
+                continue;
+            }
+            if (wasIdle) {
+                pacer.resync();
+                wasIdle = false;
+            }
+
+            PROFILE_SCOPE("frame");
+            float deltaTime = pacer.beginFrame();
+
+            {
+                PROFILE_SCOPE("main.events");
+                ALLOCATION_PHASE("main.events");
+                while (SDL_PollEvent(&e) != 0) {
+                    if (e.type == SDL_QUIT) {
+                        quit = true;
+                    }
+                    game.handleEvent(e);
+                }
+            }
+
+            game.update(deltaTime);
+
+            bool presented = game.consumeRedraw();
+            if (presented) {
+                gameRenderer.setDrawColor(0, 0, 0, 255);
+                gameRenderer.clear();
+                game.render();
+                PROFILE_SCOPE("main.present");
+                ALLOCATION_PHASE("main.present");
+                gameRenderer.present();
+                if (!menuShown) startup.mark("first menu frame");
+                menuShown = true;
+            }
+
+            {
+                PROFILE_SCOPE("main.pace");
+                pacer.endFrame(presented);
+            }
+            Profiler::endFrame();
+            Counters::endFrame();
+        }
+        if (initialized && !latencyTest) pacer.printStats(std::cout);
+    }
+
+    shutdownSdl(window, renderer);
+    return initialized ? 0 : 1;
+}
+
+#ifndef _WIN32
+int main(int argc, char* args[]) {
+    return WinMain(argc, args);
+}
+#endif
@@ -1,61 +1,71 @@
-﻿#ifndef MAP_H
-#define MAP_H
-
-#include <SDL.h>
-#include <vector>
-#include <array>
-#include <string> 
-
-struct Explosion;
-
-enum class TileType {
-    EMPTY,
-    SOFT_WALL,
-    HARD_WALL,
-    BORDER_WALL 
-};
-
-class Map {
-public:
-    Map(SDL_Renderer* renderer,
-        SDL_Texture* backgroundTexture,
-        SDL_Texture* hardWallTexture,
-        SDL_Texture* borderWallTexture,
-        const std::array<SDL_Texture*, 3>& softWallTextures); 
-
-    ~Map(); 
-
-    
-    bool initialize(int screenWidth, int screenHeight);
-
-    void render();
-
-    bool isColliding(int x, int y, int entityWidth, int entityHeight) const;
-
-    TileType getTileType(int row, int col) const;
-
-    int handleExplosion(const Explosion& explosion);
-
-    int getTileSize() const { return mTileSize; }
-    int getRows() const { return mRows; }
-    int getColumns() const { return mColumns; }
-
-private:
-    SDL_Renderer* mRenderer; 
-
-    SDL_Texture* mBackgroundTexture;
-    SDL_Texture* mHardWallTexture;
-    SDL_Texture* mBorderWallTexture;
-    std::array<SDL_Texture*, 3> mSoftWallTextures; 
-    int mCurrentSoftWallTextureIndex; 
-
-    std::vector<std::vector<TileType>> mLayout;
-
-    int mTileSize; 
-    int mRows;    
-    int mColumns;  
-
-    void generateInitialLayout();
-};
-
-#endif // MAP_H
+﻿#ifndef MAP_H
+#define MAP_H
+
+#include <vector>
+#include "SimTypes.h"
+#include "Rng.h"
+#include "WallSkeleton.h"
+
+struct Explosion;
+class ByteWriter;
+class ByteReader;
+
+enum class TileType : uint8_t {
+    EMPTY,
+    SOFT_WALL,
+    HARD_WALL,
+    BORDER_WALL
+};
+
+class Map {
+public:
+    Map();
+
+    bool initialize(int columns, int rows, int tileSize);
+
+    // Border and hard-wall skeleton plus random soft walls. The 3x3 block
+    // around every spawn tile is kept free of soft walls.
+    void generateInitialLayout(Rng& rng, const std::vector<TilePos>& spawnTiles);
+
+    bool isColliding(int x, int y, int entityWidth, int entityHeight) const;
+
+    TileType getTileType(int row, int col) const;
+
+    int handleExplosion(const Explosion& explosion);
+
+    // Snapshot support: every tile at two bits, four to a byte. loadTiles
+    // expects the map to be initialized to the same dimensions.
+    void saveTiles(ByteWriter& writer) const;
+    void loadTiles(ByteReader& reader);
+
+    // Log of tiles changed by explosions, so replication can send only what
+    // changed since a client's last state. Changes are numbered from 0 after
+    // initialize() or loadTiles(); only the last CHANGE_LOG_SIZE are kept.
+    static const int CHANGE_LOG_SIZE = 1024;
+    uint32_t getChangeCount() const { return mChangeCount; }
+    // Tile index (row * columns + col) of change `number`, which must be one
+    // of the last CHANGE_LOG_SIZE.
+    int getChangedTile(uint32_t number) const { return mChangeLog[number % CHANGE_LOG_SIZE]; }
+
+    int getTileSize() const { return mTileSize; }
+    int getRows() const { return mRows; }
+    int getColumns() const { return mColumns; }
+    int getPixelWidth() const { return mColumns * mTileSize; }
+    int getPixelHeight() const { return mRows * mTileSize; }
+
+    // The border and hard walls, built with the map; see WallSkeleton.
+    const WallSkeleton& getSkeleton() const { return mSkeleton; }
+
+private:
+    std::vector<TileType> mLayout;
+    WallSkeleton mSkeleton;
+
+    int mTileSize;
+    int mRows;
+    int mColumns;
+
+    std::vector<int> mChangeLog;
+    uint32_t mChangeCount;
+};
+
+#endif // MAP_H
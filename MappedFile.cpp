@@ -0,0 +1,81 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : mData(nullptr),
+    mSize(0),
+#ifdef _WIN32
+    mFileHandle(INVALID_HANDLE_VALUE),
+    mMappingHandle(nullptr)
+#else
+    mFileDescriptor(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+#ifdef _WIN32
+    mFileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (mFileHandle == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(mFileHandle, &fileSize) || fileSize.QuadPart == 0) {
+        close();
+        return false;
+    }
+    mMappingHandle = CreateFileMappingA(mFileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mMappingHandle) {
+        close();
+        return false;
+    }
+    mData = static_cast<const uint8_t*>(MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0));
+    mSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+    mFileDescriptor = ::open(path.c_str(), O_RDONLY);
+    if (mFileDescriptor < 0) return false;
+    struct stat fileStat;
+    if (fstat(mFileDescriptor, &fileStat) != 0 || fileStat.st_size == 0) {
+        close();
+        return false;
+    }
+    void* mapped = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, mFileDescriptor, 0);
+    if (mapped != MAP_FAILED) {
+        mData = static_cast<const uint8_t*>(mapped);
+        mSize = static_cast<size_t>(fileStat.st_size);
+    }
+#endif
+    if (!mData) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (mData) UnmapViewOfFile(mData);
+    if (mMappingHandle) CloseHandle(mMappingHandle);
+    if (mFileHandle != INVALID_HANDLE_VALUE) CloseHandle(mFileHandle);
+    mMappingHandle = nullptr;
+    mFileHandle = INVALID_HANDLE_VALUE;
+#else
+    if (mData) munmap(const_cast<uint8_t*>(mData), mSize);
+    if (mFileDescriptor >= 0) ::close(mFileDescriptor);
+    mFileDescriptor = -1;
+#endif
+    mData = nullptr;
+    mSize = 0;
+}
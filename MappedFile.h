@@ -0,0 +1,34 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. Empty files fail to open.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    const uint8_t* data() const { return mData; }
+    size_t size() const { return mSize; }
+
+private:
+    const uint8_t* mData;
+    size_t mSize;
+#ifdef _WIN32
+    void* mFileHandle;
+    void* mMappingHandle;
+#else
+    int mFileDescriptor;
+#endif
+};
+
+#endif // MAPPED_FILE_H
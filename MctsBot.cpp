@@ -0,0 +1,373 @@
+#include "MctsBot.h"
+#include "BatchRunner.h"
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    const uint8_t ACTION_BUTTONS[MctsBot::ACTION_COUNT] = { 0, INPUT_UP, INPUT_DOWN, INPUT_LEFT, INPUT_RIGHT, INPUT_BOMB };
+    const int UP_ACTION = 1;
+    const int DOWN_ACTION = 2;
+    const int LEFT_ACTION = 3;
+    const int RIGHT_ACTION = 4;
+    const int BOMB_ACTION = 5;
+    // Deeper nodes see too few play-outs to be worth storing.
+    const int MAX_TREE_DEPTH = 6;
+    const size_t MAX_NODES = 1 + MctsBot::ACTION_COUNT * 4096;
+    const uint64_t WORKER_SEED_SALT = 0x3C75ull;
+
+    // Rewards are in [0, 1]: dead is 0, alive and out of danger at the
+    // horizon is SURVIVE_REWARD, points gained add up to SCORE_REWARD and
+    // being the last one standing is 1.
+    const double SURVIVE_REWARD = 0.6;
+    const double DANGER_PENALTY = 0.4;
+    // An enemy this few steps away through the wall skeleton is as good as
+    // on the bot's heels, since enemies chase.
+    const int HUNTED_DISTANCE = 2;
+    const double HUNTED_PENALTY = 0.2;
+    const double SCORE_REWARD = 0.3;
+    const double SCORE_SCALE = 300.0;
+}
+
+struct MctsNode {
+    int parent;
+    // Children are stored together; -1 until the node is expanded.
+    int firstChild;
+    int action;
+    int visits;
+    double value;
+};
+
+struct MctsWorker {
+    Simulation state;
+    std::vector<MctsNode> nodes;
+    // Flee search scratch: tiles a pending blast covers, and the tile each
+    // visited tile was reached from (-1 unvisited).
+    std::vector<uint8_t> danger;
+    std::vector<int> cameFrom;
+    std::vector<int> queue;
+    Rng rng;
+    RandomBot opponents[MAX_PLAYERS];
+    long long playouts = 0;
+};
+
+namespace {
+    void stepWith(MctsWorker& worker, int player, uint8_t buttons) {
+        TickInput input;
+        for (int p = 0; p < worker.state.getConfig().playerCount; ++p) {
+            input.buttons[p] = p == player ? buttons : worker.opponents[p].nextButtons(worker.rng);
+        }
+        worker.state.step(input);
+    }
+
+    // Steps `ticks` ticks with `player` holding `action`.
+    void playAction(MctsWorker& worker, int player, int action, int ticks) {
+        for (int tick = 0; tick < ticks && !worker.state.isOver(); ++tick) {
+            stepWith(worker, player, MctsBot::getActionButtons(action, tick));
+        }
+    }
+
+    // The move that takes the player towards tile (row, col), next to its
+    // own: players only fit through a gap when lined up with it, so it first
+    // lines up within its own row or column. -1 once it is inside the tile.
+    int moveTowards(const Player& player, int row, int col, int tileSize) {
+        int centreRow = (player.getY() + player.getHeight() / 2) / tileSize;
+        int centreCol = (player.getX() + player.getWidth() / 2) / tileSize;
+        bool inRow = player.getY() >= centreRow * tileSize && player.getY() + player.getHeight() <= (centreRow + 1) * tileSize;
+        bool inCol = player.getX() >= centreCol * tileSize && player.getX() + player.getWidth() <= (centreCol + 1) * tileSize;
+        if (col != centreCol) {
+            if (!inRow) return player.getY() < centreRow * tileSize ? DOWN_ACTION : UP_ACTION;
+            return col > centreCol ? RIGHT_ACTION : LEFT_ACTION;
+        }
+        if (row != centreRow) {
+            if (!inCol) return player.getX() < centreCol * tileSize ? RIGHT_ACTION : LEFT_ACTION;
+            return row > centreRow ? DOWN_ACTION : UP_ACTION;
+        }
+        if (!inRow) return player.getY() < centreRow * tileSize ? DOWN_ACTION : UP_ACTION;
+        if (!inCol) return player.getX() < centreCol * tileSize ? RIGHT_ACTION : LEFT_ACTION;
+        return -1;
+    }
+
+    // Play-out policy when a pending blast covers the player: a breadth-first
+    // search over open tiles to the nearest one no blast covers, then a move
+    // along the way. -1 if the player is safe or has nowhere to go. Random
+    // moves alone hardly ever escape a bomb, which would make every bomb
+    // look like suicide.
+    int fleeAction(MctsWorker& worker, int player) {
+        const Simulation& state = worker.state;
+        const Map& map = state.getMap();
+        const Player& bot = state.getPlayers()[player];
+        int tileSize = map.getTileSize();
+        int columns = map.getColumns();
+        int tiles = columns * map.getRows();
+        worker.danger.assign(static_cast<size_t>(tiles), 0);
+        bool anyBomb = false;
+        for (const auto& bomb : state.getBombs()) {
+            if (bomb.isDone()) continue;
+            Bomb blast = bomb;
+            if (!bomb.isExploding()) blast.createExplosion(map);
+            for (const auto& part : blast.getExplosion()) worker.danger[part.y / tileSize * columns + part.x / tileSize] = 1;
+            anyBomb = true;
+        }
+        if (!anyBomb) return -1;
+
+        int start = (bot.getY() + bot.getHeight() / 2) / tileSize * columns + (bot.getX() + bot.getWidth() / 2) / tileSize;
+        if (!worker.danger[start] && moveTowards(bot, start / columns, start % columns, tileSize) < 0) return -1;
+        worker.cameFrom.assign(static_cast<size_t>(tiles), -1);
+        worker.queue.clear();
+        worker.queue.push_back(start);
+        worker.cameFrom[start] = start;
+        static const int STEPS[4][2] = { { 0, 1 }, { 0, -1 }, { 1, 0 }, { -1, 0 } };
+        for (size_t next = 0; next < worker.queue.size(); ++next) {
+            int tile = worker.queue[next];
+            if (!worker.danger[tile]) {
+                while (worker.cameFrom[tile] != start && tile != start) tile = worker.cameFrom[tile];
+                return moveTowards(bot, tile / columns, tile % columns, tileSize);
+            }
+            for (const auto& step : STEPS) {
+                int row = tile / columns + step[0];
+                int col = tile % columns + step[1];
+                int neighbour = row * columns + col;
+                if (worker.cameFrom[neighbour] >= 0 || map.getTileType(row, col) != TileType::EMPTY) continue;
+                worker.cameFrom[neighbour] = tile;
+                worker.queue.push_back(neighbour);
+            }
+        }
+        return -1;
+    }
+
+    // Plays out to `endTick`: random moves held actionTicks at a time, and
+    // never a bomb, so play-outs are not dominated by the bot blowing itself
+    // up, but fleeing whenever a blast is coming.
+    void playOut(MctsWorker& worker, int player, int endTick, int actionTicks) {
+        Simulation& state = worker.state;
+        int action = 0;
+        for (int tick = 0; state.getTick() < endTick && !state.isOver() && state.getPlayers()[player].isAlive(); ++tick) {
+            int flee = fleeAction(worker, player);
+            if (flee >= 0) action = flee;
+            else if (tick % actionTicks == 0) action = worker.rng.nextInt(BOMB_ACTION);
+            stepWith(worker, player, ACTION_BUTTONS[action]);
+        }
+    }
+
+    // Bombs that have not gone off by the horizon are traced as if they
+    // went off now: one that would catch the player counts as danger, and
+    // the player's own are credited with the soft walls they would break,
+    // since a fuse outlasts most play-outs.
+    double evaluate(const Simulation& state, int player, int startScore) {
+        const Player& bot = state.getPlayers()[player];
+        if (!bot.isAlive()) return 0.0;
+        if (state.getOutcome() == MatchOutcome::WON && state.getWinner() == player) return 1.0;
+
+        const Map& map = state.getMap();
+        int tileSize = map.getTileSize();
+        bool inDanger = false;
+        int gained = state.getScore(player) - startScore;
+        for (const auto& bomb : state.getBombs()) {
+            if (bomb.isExploding() || bomb.isDone()) continue;
+            Bomb blast = bomb;
+            blast.createExplosion(map);
+            for (const auto& part : blast.getExplosion()) {
+                if (bot.getX() < part.x + tileSize && part.x < bot.getX() + bot.getWidth()
+                    && bot.getY() < part.y + tileSize && part.y < bot.getY() + bot.getHeight()) {
+                    inDanger = true;
+                }
+                if (bomb.getOwner() == player && map.getTileType(part.y / tileSize, part.x / tileSize) == TileType::SOFT_WALL) {
+                    gained += Simulation::SCORE_PER_SOFT_WALL;
+                }
+            }
+        }
+
+        TilePos botTile = { (bot.getY() + bot.getHeight() / 2) / tileSize, (bot.getX() + bot.getWidth() / 2) / tileSize };
+        bool hunted = false;
+        for (const auto& enemy : state.getEnemies()) {
+            TilePos enemyTile = { (enemy.getY() + enemy.getHeight() / 2) / tileSize, (enemy.getX() + enemy.getWidth() / 2) / tileSize };
+            int distance = map.getSkeleton().distance(botTile, enemyTile);
+            if (distance >= 0 && distance <= HUNTED_DISTANCE) {
+                hunted = true;
+                break;
+            }
+        }
+
+        double scoreShare = gained / SCORE_SCALE;
+        return SURVIVE_REWARD - (inDanger ? DANGER_PENALTY : 0.0) - (hunted ? HUNTED_PENALTY : 0.0) + SCORE_REWARD * (scoreShare < 1.0 ? scoreShare : 1.0);
+    }
+
+    int selectChild(const MctsWorker& worker, const MctsNode& node, float exploration) {
+        double logVisits = std::log(static_cast<double>(node.visits));
+        int best = node.firstChild;
+        double bestScore = -1.0;
+        for (int child = node.firstChild; child < node.firstChild + MctsBot::ACTION_COUNT; ++child) {
+            const MctsNode& candidate = worker.nodes[child];
+            if (candidate.visits == 0) return child;
+            double score = candidate.value / candidate.visits + exploration * std::sqrt(logVisits / candidate.visits);
+            if (score > bestScore) {
+                bestScore = score;
+                best = child;
+            }
+        }
+        return best;
+    }
+
+    // One selection, expansion, play-out and backup from `root`.
+    void runPlayout(MctsWorker& worker, const Simulation& root, int player, const MctsConfig& config) {
+        worker.state = root;
+        for (auto& opponent : worker.opponents) opponent = RandomBot();
+        const int startTick = root.getTick();
+        const int startScore = root.getScore(player);
+
+        int node = 0;
+        int depth = 0;
+        while (worker.nodes[node].firstChild >= 0 && !worker.state.isOver()) {
+            node = selectChild(worker, worker.nodes[node], config.exploration);
+            playAction(worker, player, worker.nodes[node].action, config.actionTicks);
+            ++depth;
+        }
+        if (worker.nodes[node].visits > 0 && depth < MAX_TREE_DEPTH && worker.nodes.size() < MAX_NODES && !worker.state.isOver()
+            && worker.state.getPlayers()[player].isAlive()) {
+            int firstChild = static_cast<int>(worker.nodes.size());
+            worker.nodes[node].firstChild = firstChild;
+            for (int action = 0; action < MctsBot::ACTION_COUNT; ++action) {
+                worker.nodes.push_back({ node, -1, action, 0, 0.0 });
+            }
+            node = firstChild + worker.rng.nextInt(MctsBot::ACTION_COUNT);
+            playAction(worker, player, worker.nodes[node].action, config.actionTicks);
+        }
+        playOut(worker, player, startTick + config.horizonTicks, config.actionTicks);
+
+        double reward = evaluate(worker.state, player, startScore);
+        for (; node >= 0; node = worker.nodes[node].parent) {
+            ++worker.nodes[node].visits;
+            worker.nodes[node].value += reward;
+        }
+        ++worker.playouts;
+    }
+
+    // Runs `playouts` play-outs, or as many as fit before the deadline if 0.
+    void search(MctsWorker& worker, const Simulation& root, int player, const MctsConfig& config, Clock::time_point deadline,
+        int playouts) {
+        worker.nodes.clear();
+        worker.nodes.push_back({ -1, -1, 0, 0, 0.0 });
+        for (int count = 0; playouts > 0 ? count < playouts : Clock::now() < deadline; ++count) {
+            runPlayout(worker, root, player, config);
+        }
+    }
+}
+
+MctsBot::MctsBot(const MctsConfig& config)
+    : mConfig(config),
+    mAction(0),
+    mActionTick(0),
+    mStopping(false),
+    mSearchGeneration(0),
+    mHelpersBusy(0),
+    mSearchSimulation(nullptr),
+    mSearchPlayer(0),
+    mSearchPlayouts(0)
+{
+    if (mConfig.threads < 1) mConfig.threads = 1;
+    if (mConfig.actionTicks < 1) mConfig.actionTicks = 1;
+    for (int i = 0; i < mConfig.threads; ++i) {
+        mWorkers.push_back(std::unique_ptr<MctsWorker>(new MctsWorker()));
+        mWorkers.back()->rng.reseed(mConfig.seed ^ (WORKER_SEED_SALT * (i + 1)));
+    }
+    // Trees stop growing at MAX_NODES, so searching does not allocate once
+    // the workers' simulations have grown to the map.
+    for (auto& worker : mWorkers) worker->nodes.reserve(MAX_NODES);
+    mActionTick = mConfig.actionTicks;
+    for (size_t i = 1; i < mWorkers.size(); ++i) mHelpers.emplace_back(&MctsBot::runHelper, this, i);
+}
+
+MctsBot::~MctsBot() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mSearchAvailable.notify_all();
+    for (auto& helper : mHelpers) helper.join();
+}
+
+void MctsBot::runHelper(size_t index) {
+    MctsWorker& worker = *mWorkers[index];
+    uint64_t generation = 0;
+    for (;;) {
+        const Simulation* simulation;
+        int player;
+        Clock::time_point deadline;
+        int playouts;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mSearchAvailable.wait(lock, [this, generation] { return mStopping || mSearchGeneration != generation; });
+            if (mStopping) return;
+            generation = mSearchGeneration;
+            simulation = mSearchSimulation;
+            player = mSearchPlayer;
+            deadline = mSearchDeadline;
+            playouts = mSearchPlayouts;
+        }
+        search(worker, *simulation, player, mConfig, deadline, playouts);
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (--mHelpersBusy == 0) mSearchDone.notify_one();
+    }
+}
+
+uint8_t MctsBot::nextButtons(const Simulation& simulation, int player) {
+    if (!simulation.getPlayers()[player].isAlive()) return 0;
+    if (mActionTick >= mConfig.actionTicks) {
+        mAction = think(simulation, player);
+        mActionTick = 0;
+    }
+    return getActionButtons(mAction, mActionTick++);
+}
+
+int MctsBot::think(const Simulation& simulation, int player) {
+    Clock::time_point start = Clock::now();
+    Clock::time_point deadline = start + std::chrono::microseconds(mConfig.thinkMicroseconds);
+    int perWorker = mConfig.fixedPlayouts > 0 ? (mConfig.fixedPlayouts + mConfig.threads - 1) / mConfig.threads : 0;
+    long long before = 0;
+    for (const auto& worker : mWorkers) before += worker->playouts;
+
+    if (!mHelpers.empty()) {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mSearchSimulation = &simulation;
+            mSearchPlayer = player;
+            mSearchDeadline = deadline;
+            mSearchPlayouts = perWorker;
+            mHelpersBusy = mHelpers.size();
+            ++mSearchGeneration;
+        }
+        mSearchAvailable.notify_all();
+    }
+    search(*mWorkers[0], simulation, player, mConfig, deadline, perWorker);
+    if (!mHelpers.empty()) {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mSearchDone.wait(lock, [this] { return mHelpersBusy == 0; });
+    }
+
+    // The most visited action is the one the search trusts most.
+    long long visits[ACTION_COUNT] = {};
+    long long after = 0;
+    for (const auto& worker : mWorkers) {
+        after += worker->playouts;
+        const MctsNode& root = worker->nodes[0];
+        if (root.firstChild < 0) continue;
+        for (int action = 0; action < ACTION_COUNT; ++action) visits[action] += worker->nodes[root.firstChild + action].visits;
+    }
+    int best = 0;
+    for (int action = 1; action < ACTION_COUNT; ++action) {
+        if (visits[action] > visits[best]) best = action;
+    }
+
+    ++mStats.decisions;
+    mStats.playouts += after - before;
+    mStats.thinkSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+    return best;
+}
+
+uint8_t MctsBot::getActionButtons(int action, int tick) {
+    if (action == BOMB_ACTION) return tick == 0 ? INPUT_BOMB : 0;
+    return ACTION_BUTTONS[action];
+}
@@ -0,0 +1,96 @@
+#ifndef MCTS_BOT_H
+#define MCTS_BOT_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Simulation.h"
+
+struct MctsConfig {
+    // Wall-clock time each decision may take.
+    int thinkMicroseconds = 2000;
+    // Plays exactly this many play-outs per decision over all threads,
+    // ignoring the time budget, so a run can be reproduced on any machine; 0
+    // thinks for thinkMicroseconds.
+    int fixedPlayouts = 0;
+    // Threads running play-outs; 1 thinks on the calling thread alone.
+    int threads = 1;
+    // Ticks a chosen action is held before the bot decides again.
+    int actionTicks = 8;
+    // Ticks a play-out simulates from the decision before it is scored.
+    int horizonTicks = 90;
+    float exploration = 0.7f;
+    uint64_t seed = 1;
+};
+
+struct MctsStats {
+    long long decisions = 0;
+    long long playouts = 0;
+    double thinkSeconds = 0.0;
+};
+
+struct MctsWorker;
+
+// Bot that drives a Player through TickInput buttons, as a human would,
+// choosing each action with Monte Carlo tree search. Every play-out copies
+// the real simulation into a worker's own Simulation (vector assignment
+// reuses capacity, so after the first it does not allocate), plays tree
+// actions then random moves out to the horizon, fleeing pending blasts,
+// with other players acting as RandomBots, and scores survival, danger from
+// bombs still to go off, and points gained. Threads each grow a separate
+// tree from the same state and their root visit counts are summed; the
+// helper threads live as long as the bot and sleep between decisions.
+class MctsBot {
+public:
+    static const int ACTION_COUNT = 6;
+
+    explicit MctsBot(const MctsConfig& config = MctsConfig());
+    ~MctsBot();
+
+    MctsBot(const MctsBot&) = delete;
+    MctsBot& operator=(const MctsBot&) = delete;
+
+    // Buttons for `player` on the simulation's next step. Thinks whenever
+    // the current action has been held for actionTicks.
+    uint8_t nextButtons(const Simulation& simulation, int player);
+
+    // Searches from the simulation's current state for `player` and returns
+    // the chosen action, an index into the action set.
+    int think(const Simulation& simulation, int player);
+
+    // Buttons for tick `tick` of holding `action`: no input, one of the four
+    // directions, or a bomb on the first tick and no input after.
+    static uint8_t getActionButtons(int action, int tick);
+
+    const MctsConfig& getConfig() const { return mConfig; }
+    const MctsStats& getStats() const { return mStats; }
+
+private:
+    MctsConfig mConfig;
+    MctsStats mStats;
+    std::vector<std::unique_ptr<MctsWorker>> mWorkers;
+    int mAction;
+    int mActionTick;
+
+    // Helper i searches with mWorkers[i + 1] whenever mSearchGeneration
+    // moves on; the calling thread uses mWorkers[0].
+    std::vector<std::thread> mHelpers;
+    std::mutex mMutex;
+    std::condition_variable mSearchAvailable;
+    std::condition_variable mSearchDone;
+    bool mStopping;
+    uint64_t mSearchGeneration;
+    size_t mHelpersBusy;
+    const Simulation* mSearchSimulation;
+    int mSearchPlayer;
+    std::chrono::steady_clock::time_point mSearchDeadline;
+    int mSearchPlayouts;
+
+    void runHelper(size_t index);
+};
+
+#endif // MCTS_BOT_H
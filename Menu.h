@@ -1,55 +1,52 @@
-﻿#ifndef MENU_H
-#define MENU_H
-
-#include <SDL.h>
-#include <SDL_ttf.h>
-#include <SDL_mixer.h>
-#include <string>
-#include <vector> 
-
-enum class MenuAction {
-    NONE,
-    START_GAME,
-    OPEN_OPTIONS, 
-    EXIT_GAME
-};
-
-class Menu {
-public:
-    Menu(SDL_Renderer* renderer, TTF_Font* font, int screenWidth, int screenHeight, Mix_Music* menuMusic);
-    ~Menu();
-
-    bool initialize(const std::string& backgroundPath);
-
-    MenuAction handleEvent(SDL_Event& e);
-
-    void render();
-
-    void playMusic();
-
-private:
-    SDL_Renderer* mRenderer;
-    TTF_Font* mFont;       
-    int mScreenWidth;
-    int mScreenHeight;
-
-    SDL_Texture* mMenuBackgroundTexture;
-
-    SDL_Rect mStartButtonRect;
-    SDL_Texture* mStartButtonTexture;
-
-    SDL_Rect mOptionsButtonRect;     
-    SDL_Texture* mOptionsButtonTexture;
-
-    SDL_Rect mExitButtonRect;
-    SDL_Texture* mExitButtonTexture;
-
-    SDL_Color mButtonTextColor;      
-
-    Mix_Music* mMenuMusic;
-
-    SDL_Texture* createTextTexture(const std::string& text, SDL_Color color);
-    SDL_Texture* loadTexture(const std::string& path);
-};
-
-#endif // MENU_H
+﻿#ifndef MENU_H
+#define MENU_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <SDL_mixer.h>
+#include "Renderer.h"
+#include "UiScreen.h"
+#include <string>
+#include <vector> 
+
+enum class MenuAction {
+    NONE,
+    START_GAME,
+    OPEN_OPTIONS, 
+    EXIT_GAME
+};
+
+class Menu {
+public:
+    Menu(Renderer* renderer, TTF_Font* font, int screenWidth, int screenHeight, Mix_Music* menuMusic);
+    ~Menu();
+
+    bool initialize();
+
+    // Background and music stream in after the menu is already on screen.
+    void setBackgroundTexture(Texture* texture);
+    void setMusic(Mix_Music* music) { mMenuMusic = music; }
+
+    MenuAction handleEvent(SDL_Event& e);
+
+    void render();
+
+    void playMusic();
+
+private:
+    static const int BUTTON_SPACING = 30;
+
+    Renderer* mRenderer;
+    TTF_Font* mFont;       
+    int mScreenWidth;
+    int mScreenHeight;
+
+    Texture* mMenuBackgroundTexture;
+    UiScreen mUi;
+
+    SDL_Color mButtonTextColor;      
+
+    Mix_Music* mMenuMusic;
+};
+
+#endif // MENU_H
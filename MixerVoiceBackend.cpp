@@ -0,0 +1,35 @@
+#include "MixerVoiceBackend.h"
+
+MixerVoiceBackend::MixerVoiceBackend(int channels)
+    : mChannelCount(0)
+{
+    for (auto& chunk : mChunks) {
+        chunk.store(nullptr, std::memory_order_relaxed);
+    }
+    if (Mix_AllocateChannels(-1) < channels) Mix_AllocateChannels(channels);
+    mChannelCount = Mix_AllocateChannels(-1);
+}
+
+void MixerVoiceBackend::setChunk(int sound, Mix_Chunk* chunk) {
+    if (sound < 0 || sound >= VoiceManager::MAX_SOUNDS) return;
+    mChunks[sound].store(chunk, std::memory_order_release);
+}
+
+bool MixerVoiceBackend::play(int channel, int sound, int volume) {
+    Mix_Chunk* chunk = mChunks[sound].load(std::memory_order_acquire);
+    if (!chunk) return false;
+    Mix_Volume(channel, volume);
+    return Mix_PlayChannel(channel, chunk, 0) == channel;
+}
+
+void MixerVoiceBackend::setVolume(int channel, int volume) {
+    Mix_Volume(channel, volume);
+}
+
+void MixerVoiceBackend::stop(int channel) {
+    Mix_HaltChannel(channel);
+}
+
+bool MixerVoiceBackend::isPlaying(int channel) const {
+    return Mix_Playing(channel) != 0;
+}
@@ -0,0 +1,29 @@
+#ifndef MIXER_VOICE_BACKEND_H
+#define MIXER_VOICE_BACKEND_H
+
+#include <SDL_mixer.h>
+#include <atomic>
+#include "VoiceManager.h"
+
+// VoiceBackend over SDL_mixer's channels. Chunks arrive from the asset
+// loader on the game thread while the voice manager's thread plays them, so
+// each sound's chunk is an atomic pointer; a sound plays once it is set.
+class MixerVoiceBackend : public VoiceBackend {
+public:
+    // Takes over every channel SDL_mixer has allocated, at least `channels`.
+    explicit MixerVoiceBackend(int channels);
+
+    void setChunk(int sound, Mix_Chunk* chunk);
+
+    int getChannelCount() const override { return mChannelCount; }
+    bool play(int channel, int sound, int volume) override;
+    void setVolume(int channel, int volume) override;
+    void stop(int channel) override;
+    bool isPlaying(int channel) const override;
+
+private:
+    std::atomic<Mix_Chunk*> mChunks[VoiceManager::MAX_SOUNDS];
+    int mChannelCount;
+};
+
+#endif // MIXER_VOICE_BACKEND_H
@@ -0,0 +1,296 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Simulation.h"
+#include "BatchRunner.h"
+#include "NetTransport.h"
+#include "UdpTransport.h"
+#include "RollbackSession.h"
+
+// Command-line driver for rollback netplay. By default every peer of a match
+// runs in this process, driven by random-walk bots on a simulated 60 Hz
+// clock, over an in-memory network (or real UDP sockets on 127.0.0.1 with
+// --udp) that adds the given latency, jitter and loss. Each match must end
+// with every peer in the same state as a plain replay of the confirmed
+// inputs, and no rollback may take longer than one frame.
+//
+//   bomberman_net [--matches N] [--seed S] [--players P] [--enemies E]
+//                 [--latency MS] [--jitter MS] [--loss PCT] [--delay TICKS]
+//                 [--udp] [--quiet]
+//   bomberman_net --play I --peers HOST:PORT,HOST:PORT[,...] [--seed S]
+//                 [match and network options]
+//
+// --play joins a real match as player I with a bot at the keyboard; the
+// peers are listed in player order, this player's entry giving the port to
+// bind. Start one process per player with the same options.
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    const double FRAME_MS = 1000.0 / TICKS_PER_SECOND;
+    // A real peer that sends nothing for this long is taken to be gone.
+    const double PEER_TIMEOUT_MS = 10000.0;
+
+    struct NetOptions {
+        NetConditions conditions;
+        int inputDelayTicks = 1;
+        bool udp = false;
+        bool quiet = false;
+    };
+
+    struct LoopbackPeer {
+        Simulation simulation;
+        std::unique_ptr<UdpTransport> socket;
+        std::unique_ptr<ConditionedTransport> link;
+        std::unique_ptr<RollbackSession> session;
+        RandomBot bot;
+        Rng botRng;
+    };
+
+    struct HarnessTotals {
+        long long ticks = 0;
+        long long rollbacks = 0;
+        long long resimulatedTicks = 0;
+        long long stalls = 0;
+        long long packetsSent = 0;
+        long long packetsDropped = 0;
+        int maxRollbackTicks = 0;
+        double maxRollbackMs = 0.0;
+    };
+
+    void printRollbackStats(const RollbackStats& stats) {
+        std::cout << stats.rollbacks << " rollbacks (mean "
+            << (stats.rollbacks > 0 ? static_cast<double>(stats.resimulatedTicks) / stats.rollbacks : 0.0)
+            << " ticks, max " << stats.maxRollbackTicks << " ticks, worst " << stats.maxRollbackMs << " ms), "
+            << stats.stalls << " stalls";
+    }
+
+    // Plays one match between in-process peers. Returns false if the match
+    // did not finish or the peers disagree.
+    bool playLoopbackMatch(const MatchConfig& config, const NetOptions& options, HarnessTotals& totals) {
+        const int playerCount = config.playerCount;
+        LoopbackNetwork network(playerCount);
+        std::vector<std::unique_ptr<LoopbackPeer>> peers;
+        for (int p = 0; p < playerCount; ++p) {
+            std::unique_ptr<LoopbackPeer> peer(new LoopbackPeer());
+            NetTransport* transport = &network.getEndpoint(p);
+            if (options.udp) {
+                peer->socket.reset(new UdpTransport());
+                if (!peer->socket->open(0)) return false;
+                transport = peer->socket.get();
+            }
+            peer->link.reset(new ConditionedTransport(*transport, options.conditions, config.seed * MAX_PLAYERS + p));
+            peer->session.reset(new RollbackSession(peer->simulation, *peer->link));
+            peer->botRng.reseed(config.seed ^ (0xB07ull + p));
+
+            RollbackConfig rollbackConfig;
+            rollbackConfig.match = config;
+            rollbackConfig.localPlayer = p;
+            rollbackConfig.inputDelayTicks = options.inputDelayTicks;
+            if (!peer->session->start(rollbackConfig)) return false;
+            peers.push_back(std::move(peer));
+        }
+        if (options.udp) {
+            for (auto& peer : peers) {
+                for (int p = 0; p < playerCount; ++p) {
+                    if (!peer->socket->setPeer(p, "127.0.0.1", peers[p]->socket->getLocalPort())) return false;
+                }
+            }
+        }
+
+        const long long maxFrames = static_cast<long long>(config.matchTicks) * 4 + TICKS_PER_SECOND * 10;
+        bool finished = false;
+        for (long long frame = 0; frame < maxFrames && !finished; ++frame) {
+            finished = true;
+            for (auto& peer : peers) {
+                peer->link->update(frame * FRAME_MS);
+                peer->session->advance(peer->bot.nextButtons(peer->botRng));
+                finished = finished && peer->session->isConfirmedOver();
+            }
+        }
+        if (!finished) {
+            std::cerr << "Net Error: Match with seed " << config.seed << " did not finish." << std::endl;
+            return false;
+        }
+
+        // Every peer must end where a plain replay of the confirmed inputs ends.
+        const RollbackSession& reference = *peers[0]->session;
+        Simulation replayed;
+        replayed.reset(config);
+        for (int tick = 0; tick < reference.getTick(); ++tick) replayed.step(reference.getInput(tick));
+        const uint64_t checksum = replayed.computeChecksum();
+        bool agree = true;
+        for (int p = 0; p < playerCount; ++p) {
+            if (peers[p]->simulation.computeChecksum() != checksum) {
+                std::cerr << "Net Error: Player " << p << " desynced in match with seed " << config.seed << "." << std::endl;
+                agree = false;
+            }
+        }
+
+        for (int p = 0; p < playerCount; ++p) {
+            const RollbackStats& stats = peers[p]->session->getStats();
+            totals.ticks += stats.ticks;
+            totals.rollbacks += stats.rollbacks;
+            totals.resimulatedTicks += stats.resimulatedTicks;
+            totals.stalls += stats.stalls;
+            totals.packetsSent += peers[p]->link->getSentCount();
+            totals.packetsDropped += peers[p]->link->getDroppedCount();
+            if (stats.maxRollbackTicks > totals.maxRollbackTicks) totals.maxRollbackTicks = stats.maxRollbackTicks;
+            if (stats.maxRollbackMs > totals.maxRollbackMs) totals.maxRollbackMs = stats.maxRollbackMs;
+        }
+        if (!options.quiet) {
+            std::cout << "match seed " << config.seed << ": " << reference.getTick() << " ticks, checksum " << std::hex
+                << checksum << std::dec << (agree ? "" : " (DESYNC)") << "; player 0: ";
+            printRollbackStats(peers[0]->session->getStats());
+            std::cout << std::endl;
+        }
+        return agree;
+    }
+
+    int runLoopback(MatchConfig config, int matches, const NetOptions& options) {
+        HarnessTotals totals;
+        int failures = 0;
+        const uint64_t firstSeed = config.seed;
+        for (int match = 0; match < matches; ++match) {
+            config.seed = firstSeed + match;
+            if (!playLoopbackMatch(config, options, totals)) ++failures;
+        }
+
+        std::cout << matches << " matches, " << config.playerCount << " players over " << (options.udp ? "UDP" : "memory")
+            << " with " << options.conditions.latencyMs << " ms latency, " << options.conditions.jitterMs << " ms jitter, "
+            << options.conditions.lossRate * 100.0 << "% loss, " << options.inputDelayTicks << " tick input delay" << std::endl;
+        std::cout << totals.ticks << " peer ticks, " << totals.rollbacks << " rollbacks re-simulating "
+            << totals.resimulatedTicks << " ticks (max " << totals.maxRollbackTicks << "), " << totals.stalls << " stalls, "
+            << totals.packetsDropped << " of " << totals.packetsSent << " packets dropped" << std::endl;
+        std::cout << "worst rollback " << totals.maxRollbackMs << " ms against a " << FRAME_MS << " ms frame" << std::endl;
+        if (totals.maxRollbackMs > FRAME_MS) {
+            std::cerr << "Net Error: A rollback took longer than one frame." << std::endl;
+            ++failures;
+        }
+        if (failures > 0) {
+            std::cerr << "Net Error: " << failures << " failures." << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    int runPeer(const MatchConfig& config, int localPlayer, const std::vector<std::string>& peerAddresses, const NetOptions& options) {
+        UdpTransport socket;
+        std::string host;
+        uint16_t port = 0;
+        for (size_t p = 0; p < peerAddresses.size(); ++p) {
+            if (!parseHostPort(peerAddresses[p], host, port)) {
+                std::cerr << "Net Error: '" << peerAddresses[p] << "' is not HOST:PORT." << std::endl;
+                return 2;
+            }
+            if (static_cast<int>(p) == localPlayer) {
+                if (!socket.open(port)) return 1;
+            }
+            else if (!socket.setPeer(static_cast<int>(p), host, port)) {
+                return 1;
+            }
+        }
+
+        Simulation simulation;
+        ConditionedTransport link(socket, options.conditions, config.seed * MAX_PLAYERS + localPlayer);
+        RollbackSession session(simulation, link);
+        RollbackConfig rollbackConfig;
+        rollbackConfig.match = config;
+        rollbackConfig.localPlayer = localPlayer;
+        rollbackConfig.inputDelayTicks = options.inputDelayTicks;
+        if (!session.start(rollbackConfig)) return 1;
+
+        RandomBot bot;
+        Rng botRng(config.seed ^ (0xB07ull + localPlayer));
+        const Clock::time_point start = Clock::now();
+        double lastProgressMs = 0.0;
+        long long lastReceived = 0;
+        int lastConfirmed = 0;
+        // Keep sending for a moment after the end so late peers can finish too.
+        double overAtMs = -1.0;
+        for (long long frame = 0;; ++frame) {
+            double frameStartMs = frame * FRAME_MS;
+            std::this_thread::sleep_until(start + std::chrono::microseconds(static_cast<long long>(frameStartMs * 1000.0)));
+            double nowMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            link.update(nowMs);
+            session.advance(bot.nextButtons(botRng));
+
+            if (session.getStats().packetsReceived != lastReceived || session.getConfirmedTick() != lastConfirmed) {
+                lastReceived = session.getStats().packetsReceived;
+                lastConfirmed = session.getConfirmedTick();
+                lastProgressMs = nowMs;
+            }
+            if (session.isConfirmedOver() && overAtMs < 0.0) overAtMs = nowMs;
+            if (overAtMs >= 0.0 && nowMs - overAtMs > 1000.0) break;
+            if (nowMs - lastProgressMs > PEER_TIMEOUT_MS) {
+                std::cerr << "Net Error: No word from the other peers for " << PEER_TIMEOUT_MS / 1000.0 << " s." << std::endl;
+                return 1;
+            }
+        }
+
+        std::cout << "player " << localPlayer << ": match over after " << session.getTick() << " ticks, checksum "
+            << std::hex << simulation.computeChecksum() << std::dec << "; ";
+        printRollbackStats(session.getStats());
+        std::cout << ", " << link.getDroppedCount() << " of " << link.getSentCount() << " packets dropped" << std::endl;
+        return 0;
+    }
+
+    std::vector<std::string> splitList(const std::string& text) {
+        std::vector<std::string> items;
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ',')) items.push_back(item);
+        return items;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    MatchConfig config;
+    config.playerCount = 2;
+    int matches = 10;
+    NetOptions options;
+    options.conditions.latencyMs = 60.0;
+    options.conditions.jitterMs = 20.0;
+    options.conditions.lossRate = 0.05;
+    int localPlayer = -1;
+    std::vector<std::string> peerAddresses;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--matches" && hasValue) matches = std::atoi(argv[++i]);
+        else if (arg == "--seed" && hasValue) config.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--players" && hasValue) config.playerCount = std::atoi(argv[++i]);
+        else if (arg == "--enemies" && hasValue) config.enemyCount = std::atoi(argv[++i]);
+        else if (arg == "--latency" && hasValue) options.conditions.latencyMs = std::atof(argv[++i]);
+        else if (arg == "--jitter" && hasValue) options.conditions.jitterMs = std::atof(argv[++i]);
+        else if (arg == "--loss" && hasValue) options.conditions.lossRate = std::atof(argv[++i]) / 100.0;
+        else if (arg == "--delay" && hasValue) options.inputDelayTicks = std::atoi(argv[++i]);
+        else if (arg == "--udp") options.udp = true;
+        else if (arg == "--quiet") options.quiet = true;
+        else if (arg == "--play" && hasValue) localPlayer = std::atoi(argv[++i]);
+        else if (arg == "--peers" && hasValue) peerAddresses = splitList(argv[++i]);
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--matches N] [--seed S] [--players P] [--enemies E] [--latency MS] [--jitter MS] [--loss PCT] [--delay TICKS] [--udp] [--quiet] | --play I --peers HOST:PORT,HOST:PORT[,...]" << std::endl;
+            return 2;
+        }
+    }
+
+    if (localPlayer >= 0) {
+        config.playerCount = static_cast<int>(peerAddresses.size());
+        if (config.playerCount < 2 || config.playerCount > MAX_PLAYERS || localPlayer >= config.playerCount) {
+            std::cerr << "Net Error: --peers must list 2 to " << MAX_PLAYERS << " players, including player " << localPlayer << "." << std::endl;
+            return 2;
+        }
+        return runPeer(config, localPlayer, peerAddresses, options);
+    }
+    if (config.playerCount < 2 || config.playerCount > MAX_PLAYERS) {
+        std::cerr << "Net Error: --players must be 2 to " << MAX_PLAYERS << "." << std::endl;
+        return 2;
+    }
+    return runLoopback(config, matches, options);
+}
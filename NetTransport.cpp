@@ -0,0 +1,71 @@
+#include "NetTransport.h"
+#include <utility>
+
+LoopbackNetwork::LoopbackNetwork(int peerCount) {
+    for (int i = 0; i < peerCount; ++i) {
+        mEndpoints.push_back(std::unique_ptr<Endpoint>(new Endpoint(*this, i)));
+    }
+}
+
+void LoopbackNetwork::Endpoint::send(int peer, const uint8_t* data, size_t size) {
+    if (peer < 0 || peer >= static_cast<int>(mNetwork.mEndpoints.size()) || peer == mPeer) return;
+    mNetwork.mEndpoints[peer]->inbox.push_back({ mPeer, std::vector<uint8_t>(data, data + size) });
+}
+
+bool LoopbackNetwork::Endpoint::receive(int& peer, std::vector<uint8_t>& data) {
+    if (inbox.empty()) return false;
+    peer = inbox.front().from;
+    data.swap(inbox.front().data);
+    inbox.pop_front();
+    return true;
+}
+
+ConditionedTransport::ConditionedTransport(NetTransport& inner, const NetConditions& conditions, uint64_t seed)
+    : mInner(inner),
+    mConditions(conditions),
+    mRng(seed),
+    mNowMs(0.0),
+    mSentCount(0),
+    mDroppedCount(0)
+{
+}
+
+void ConditionedTransport::update(double nowMs) {
+    mNowMs = nowMs;
+    // Held datagrams stay in send order; ones drawn with a shorter delay
+    // overtake those ahead of them.
+    size_t kept = 0;
+    for (size_t i = 0; i < mHeld.size(); ++i) {
+        HeldDatagram& held = mHeld[i];
+        if (held.dueMs <= mNowMs) {
+            mInner.send(held.peer, held.data.data(), held.data.size());
+        }
+        else {
+            if (kept != i) std::swap(mHeld[kept], held);
+            ++kept;
+        }
+    }
+    mHeld.resize(kept);
+}
+
+void ConditionedTransport::send(int peer, const uint8_t* data, size_t size) {
+    ++mSentCount;
+    if (mConditions.lossRate > 0.0 && nextUnit() < mConditions.lossRate) {
+        ++mDroppedCount;
+        return;
+    }
+    double delayMs = mConditions.latencyMs + (mConditions.jitterMs > 0.0 ? nextUnit() * mConditions.jitterMs : 0.0);
+    if (delayMs <= 0.0) {
+        mInner.send(peer, data, size);
+        return;
+    }
+    mHeld.push_back({ mNowMs + delayMs, peer, std::vector<uint8_t>(data, data + size) });
+}
+
+bool ConditionedTransport::receive(int& peer, std::vector<uint8_t>& data) {
+    return mInner.receive(peer, data);
+}
+
+double ConditionedTransport::nextUnit() {
+    return static_cast<double>(mRng.next() >> 11) * (1.0 / 9007199254740992.0);
+}
@@ -0,0 +1,103 @@
+#ifndef NET_TRANSPORT_H
+#define NET_TRANSPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "Rng.h"
+
+// Unreliable datagrams between the peers of one match, addressed by player
+// index. Like UDP, a send may be dropped, delayed or reordered; callers make
+// every packet self-contained and resend what has not been acknowledged.
+class NetTransport {
+public:
+    // Stays under common path MTUs so a datagram is never fragmented.
+    static const size_t MAX_DATAGRAM_SIZE = 1200;
+
+    virtual ~NetTransport() {}
+
+    virtual void send(int peer, const uint8_t* data, size_t size) = 0;
+    // Pops one waiting datagram into `data`. Returns false when none is
+    // waiting; never blocks.
+    virtual bool receive(int& peer, std::vector<uint8_t>& data) = 0;
+};
+
+// In-process network for tests and tools: one endpoint per peer, each with
+// its own inbox, and no loss or delay of its own (wrap the endpoints in a
+// ConditionedTransport for that).
+class LoopbackNetwork {
+public:
+    explicit LoopbackNetwork(int peerCount);
+
+    NetTransport& getEndpoint(int peer) { return *mEndpoints[peer]; }
+
+private:
+    struct Datagram {
+        int from;
+        std::vector<uint8_t> data;
+    };
+
+    class Endpoint : public NetTransport {
+    public:
+        Endpoint(LoopbackNetwork& network, int peer) : mNetwork(network), mPeer(peer) {}
+
+        void send(int peer, const uint8_t* data, size_t size) override;
+        bool receive(int& peer, std::vector<uint8_t>& data) override;
+
+        std::deque<Datagram> inbox;
+
+    private:
+        LoopbackNetwork& mNetwork;
+        int mPeer;
+    };
+
+    std::vector<std::unique_ptr<Endpoint>> mEndpoints;
+};
+
+struct NetConditions {
+    // One-way delay added to every datagram that gets through.
+    double latencyMs = 0.0;
+    // Extra delay drawn uniformly from [0, jitterMs]; enough of it reorders
+    // datagrams.
+    double jitterMs = 0.0;
+    // Share of datagrams dropped, 0 to 1.
+    double lossRate = 0.0;
+};
+
+// Wraps another transport and applies latency, jitter and loss to outgoing
+// datagrams against a clock the caller advances, so a test over loopback
+// sees a bad network deterministically for a given seed.
+class ConditionedTransport : public NetTransport {
+public:
+    ConditionedTransport(NetTransport& inner, const NetConditions& conditions, uint64_t seed);
+
+    // Sets the current time and forwards every held datagram now due.
+    void update(double nowMs);
+
+    void send(int peer, const uint8_t* data, size_t size) override;
+    bool receive(int& peer, std::vector<uint8_t>& data) override;
+
+    long long getSentCount() const { return mSentCount; }
+    long long getDroppedCount() const { return mDroppedCount; }
+
+private:
+    struct HeldDatagram {
+        double dueMs;
+        int peer;
+        std::vector<uint8_t> data;
+    };
+
+    NetTransport& mInner;
+    NetConditions mConditions;
+    Rng mRng;
+    double mNowMs;
+    std::vector<HeldDatagram> mHeld;
+    long long mSentCount;
+    long long mDroppedCount;
+
+    double nextUnit();
+};
+
+#endif // NET_TRANSPORT_H
@@ -0,0 +1,24 @@
+#include "NullRenderer.h"
+
+Texture* NullRenderer::createTextureFromSurface(SDL_Surface* surface) {
+    if (!surface) return nullptr;
+    Texture* texture = new Texture();
+    texture->width = surface->w;
+    texture->height = surface->h;
+    ++mStats.texturesCreated;
+    return texture;
+}
+
+Texture* NullRenderer::createRenderTarget(int width, int height) {
+    Texture* texture = new Texture();
+    texture->width = width;
+    texture->height = height;
+    ++mStats.texturesCreated;
+    return texture;
+}
+
+void NullRenderer::destroyTexture(Texture* texture) {
+    if (!texture) return;
+    ++mStats.texturesDestroyed;
+    delete texture;
+}
@@ -0,0 +1,39 @@
+#ifndef NULL_RENDERER_H
+#define NULL_RENDERER_H
+
+#include "Renderer.h"
+#include <cstdint>
+
+// Headless backend: draws nothing and only counts what would have been drawn.
+// Textures carry their size so layout code behaves exactly as with SDL.
+class NullRenderer : public Renderer {
+public:
+    struct Stats {
+        uint64_t copies = 0;
+        uint64_t fills = 0;
+        uint64_t clears = 0;
+        uint64_t presents = 0;
+        uint64_t texturesCreated = 0;
+        uint64_t texturesDestroyed = 0;
+    };
+
+    Texture* createTextureFromSurface(SDL_Surface* surface) override;
+    void destroyTexture(Texture* texture) override;
+
+    Texture* createRenderTarget(int width, int height) override;
+    bool setRenderTarget(Texture*) override { return true; }
+
+    void setDrawColor(Uint8, Uint8, Uint8, Uint8) override {}
+    void setBlendMode(SDL_BlendMode) override {}
+    void clear() override { ++mStats.clears; }
+    void copy(Texture* texture, const SDL_Rect*, const SDL_Rect*) override { if (texture) ++mStats.copies; }
+    void fillRect(const SDL_Rect*) override { ++mStats.fills; }
+    void present() override { ++mStats.presents; }
+
+    const Stats& getStats() const { return mStats; }
+
+private:
+    Stats mStats;
+};
+
+#endif // NULL_RENDERER_H
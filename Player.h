@@ -1,58 +1,50 @@
-﻿#ifndef PLAYER_H
-#define PLAYER_H
-
-#include <SDL.h>
-#include <vector>
-#include <memory>
-#include "enemies.h" 
-#include "bomb.h"   
-
-class Map;
-
-class Player {
-public:
-    Player(SDL_Renderer* renderer, SDL_Texture* texture, int x, int y, Map* mapRef); 
-    ~Player() = default;
-
-    void handleEvent(SDL_Event& e);
-    void update(float deltaTime);
-    void render();
-
-   
-
-    void setMap(Map* map); 
-
-    int getX() const { return mX; }
-    int getY() const { return mY; }
-    int getWidth() const { return mWidth; }
-    int getHeight() const { return mHeight; }
-
-    void setPosition(int x, int y);
-    void setSpeed(float newSpeed); // << THÊM HÀM NÀY
-
-
-private:
-    SDL_Renderer* mRenderer;
-    SDL_Texture* mTexture;
-
-    int mX, mY;
-    int mWidth, mHeight;
-    int mVelX, mVelY;
-    float mSpeed;
-
-    bool mMovingUp;
-    bool mMovingDown;
-    bool mMovingLeft;
-    bool mMovingRight;
-
-    std::vector<SDL_Rect> mSpriteClips;
-    float mFrameTime;
-    int mCurrentFrame;
-    int mTotalFrames;
-    Direction mFacingDirection;
-
-    Map* mMap; 
-
-};
-
-#endif // PLAYER_H
+﻿#ifndef PLAYER_H
+#define PLAYER_H
+
+#include <cstdint>
+#include "SimTypes.h"
+
+class Map;
+class ByteWriter;
+class ByteReader;
+
+class Player {
+public:
+    Player(int x, int y);
+
+    // Takes this tick's buttons; a newly pressed direction turns the player.
+    void applyInput(uint8_t buttons);
+    // Moves one tick, clamped to the map and reverted if it would enter a wall.
+    void update(const Map& map);
+
+    int getX() const { return mX; }
+    int getY() const { return mY; }
+    int getWidth() const { return mWidth; }
+    int getHeight() const { return mHeight; }
+    Rect getRect() const { return { mX, mY, mWidth, mHeight }; }
+    Direction getFacingDirection() const { return mFacingDirection; }
+    bool isMoving() const { return mVelX != 0 || mVelY != 0; }
+    bool isAlive() const { return mAlive; }
+
+    void setPosition(int x, int y);
+    void setSpeed(float newSpeed);
+    void kill() { mAlive = false; }
+
+    // Snapshot support. Size and speed are not stored; they come from the
+    // match config.
+    void saveState(ByteWriter& writer) const;
+    void loadState(ByteReader& reader);
+
+private:
+    int mX, mY;
+    int mWidth, mHeight;
+    int mVelX, mVelY;
+    // Pixels per tick, truncated the way the 60 FPS loop used to truncate them.
+    int mStep;
+    int mDiagonalStep;
+    uint8_t mButtons;
+    Direction mFacingDirection;
+    bool mAlive;
+};
+
+#endif // PLAYER_H
@@ -0,0 +1,160 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+std::atomic<bool> Profiler::sEnabled(false);
+
+namespace {
+    struct EventSlot {
+        std::atomic<const char*> name;
+        std::atomic<uint64_t> startNs;
+        std::atomic<uint64_t> durationNs;
+    };
+
+    struct ThreadRing {
+        int threadId = 0;
+        std::atomic<uint64_t> writeIndex{ 0 };
+        std::unique_ptr<EventSlot[]> slots{ new EventSlot[Profiler::EVENTS_PER_THREAD] };
+    };
+
+    // Rings are never freed, so events from threads that have already exited
+    // (asset workers, batch runners) can still be exported.
+    struct RingRegistry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadRing>> rings;
+    };
+
+    RingRegistry& registry() {
+        static RingRegistry instance;
+        return instance;
+    }
+
+    const std::chrono::steady_clock::time_point gEpoch = std::chrono::steady_clock::now();
+    thread_local ThreadRing* tRing = nullptr;
+
+    ThreadRing* currentRing() {
+        if (!tRing) {
+            RingRegistry& rings = registry();
+            std::lock_guard<std::mutex> lock(rings.mutex);
+            rings.rings.push_back(std::make_unique<ThreadRing>());
+            tRing = rings.rings.back().get();
+            tRing->threadId = static_cast<int>(rings.rings.size()) - 1;
+        }
+        return tRing;
+    }
+
+    // Frame history is written and read by the main loop only.
+    float gFrameTimes[Profiler::FRAME_HISTORY] = {};
+    size_t gFrameCount = 0;
+    uint64_t gLastFrameNs = 0;
+}
+
+void Profiler::setEnabled(bool enabled) {
+    gLastFrameNs = 0;
+    sEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+int Profiler::currentThreadId() {
+    return currentRing()->threadId;
+}
+
+uint64_t Profiler::nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - gEpoch).count());
+}
+
+void Profiler::record(const char* name, uint64_t startNs, uint64_t endNs) {
+    ThreadRing* ring = currentRing();
+    uint64_t index = ring->writeIndex.load(std::memory_order_relaxed);
+    EventSlot& slot = ring->slots[index % EVENTS_PER_THREAD];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.startNs.store(startNs, std::memory_order_relaxed);
+    slot.durationNs.store(endNs - startNs, std::memory_order_relaxed);
+    ring->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::endFrame() {
+    if (!isEnabled()) return;
+    uint64_t now = nowNs();
+    if (gLastFrameNs != 0) {
+        gFrameTimes[gFrameCount % FRAME_HISTORY] = (now - gLastFrameNs) / 1e6f;
+        ++gFrameCount;
+    }
+    gLastFrameNs = now;
+}
+
+std::vector<float> Profiler::getFrameTimes() {
+    size_t count = gFrameCount < FRAME_HISTORY ? gFrameCount : FRAME_HISTORY;
+    std::vector<float> frames;
+    frames.reserve(count);
+    for (size_t i = gFrameCount - count; i < gFrameCount; ++i) {
+        frames.push_back(gFrameTimes[i % FRAME_HISTORY]);
+    }
+    return frames;
+}
+
+std::vector<ProfileEvent> Profiler::collect(uint64_t sinceNs) {
+    std::vector<ProfileEvent> events;
+    RingRegistry& rings = registry();
+    std::lock_guard<std::mutex> lock(rings.mutex);
+    for (const auto& ring : rings.rings) {
+        uint64_t end = ring->writeIndex.load(std::memory_order_acquire);
+        uint64_t begin = end > EVENTS_PER_THREAD ? end - EVENTS_PER_THREAD : 0;
+        size_t firstCopied = events.size();
+        for (uint64_t i = begin; i < end; ++i) {
+            const EventSlot& slot = ring->slots[i % EVENTS_PER_THREAD];
+            ProfileEvent event;
+            event.name = slot.name.load(std::memory_order_relaxed);
+            event.startNs = slot.startNs.load(std::memory_order_relaxed);
+            event.durationNs = slot.durationNs.load(std::memory_order_relaxed);
+            event.threadId = ring->threadId;
+            events.push_back(event);
+        }
+
+        // The owner kept writing while we copied; anything it may have lapped
+        // is unreliable and is dropped.
+        uint64_t endAfter = ring->writeIndex.load(std::memory_order_acquire);
+        uint64_t oldestValid = endAfter > EVENTS_PER_THREAD ? endAfter - EVENTS_PER_THREAD : 0;
+        if (oldestValid > begin) {
+            size_t lapped = static_cast<size_t>(std::min(oldestValid, end) - begin);
+            events.erase(events.begin() + firstCopied, events.begin() + firstCopied + lapped);
+        }
+    }
+    events.erase(std::remove_if(events.begin(), events.end(), [sinceNs](const ProfileEvent& event) {
+        return event.startNs < sinceNs;
+    }), events.end());
+    std::sort(events.begin(), events.end(), [](const ProfileEvent& a, const ProfileEvent& b) {
+        return a.startNs < b.startNs;
+    });
+    return events;
+}
+
+void Profiler::writeChromeTrace(std::ostream& out, double seconds) {
+    uint64_t now = nowNs();
+    uint64_t window = static_cast<uint64_t>(seconds * 1e9);
+    std::vector<ProfileEvent> events = collect(now > window ? now - window : 0);
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (size_t i = 0; i < events.size(); ++i) {
+        const ProfileEvent& event = events[i];
+        out << (i ? ",\n" : "") << "{\"name\":\"" << event.name << "\",\"cat\":\"bomberman\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+            << event.threadId << ",\"ts\":" << event.startNs / 1000.0 << ",\"dur\":" << event.durationNs / 1000.0 << "}";
+    }
+    out << "\n]}\n";
+}
+
+bool Profiler::writeChromeTrace(const std::string& path, double seconds) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Profiler Error: Cannot open '" << path << "' for writing." << std::endl;
+        return false;
+    }
+    writeChromeTrace(out, seconds);
+    std::cout << "Profiler trace written: " << path << std::endl;
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,81 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Scoped CPU timers recorded into a fixed-size ring per thread. Each ring has
+// exactly one writer (its thread), so recording is a few relaxed stores and no
+// locks; readers copy a ring and drop whatever was overwritten while copying.
+// When the profiler is disabled at runtime a scope costs one relaxed load.
+// Define BOMBERMAN_PROFILER_DISABLED to compile the scopes out entirely.
+
+struct ProfileEvent {
+    const char* name;
+    uint64_t startNs;
+    uint64_t durationNs;
+    int threadId;
+};
+
+class Profiler {
+public:
+    static const size_t EVENTS_PER_THREAD = 1 << 16;
+    static const size_t FRAME_HISTORY = 240;
+
+    static bool isEnabled() { return sEnabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool enabled);
+
+    static uint64_t nowNs();
+    static int currentThreadId();
+    // Names must be string literals (or otherwise outlive the profiler).
+    static void record(const char* name, uint64_t startNs, uint64_t endNs);
+
+    // Marks the end of a main-loop frame; feeds the frame-time graph.
+    static void endFrame();
+    // Most recent frame durations in milliseconds, oldest first.
+    static std::vector<float> getFrameTimes();
+
+    // Every event from every thread that started at or after sinceNs.
+    static std::vector<ProfileEvent> collect(uint64_t sinceNs);
+
+    // Writes the last `seconds` of events as Chrome trace_event JSON
+    // (load it in chrome://tracing or Perfetto).
+    static void writeChromeTrace(std::ostream& out, double seconds);
+    static bool writeChromeTrace(const std::string& path, double seconds);
+
+private:
+    static std::atomic<bool> sEnabled;
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name)
+        : mName(Profiler::isEnabled() ? name : nullptr),
+        mStartNs(mName ? Profiler::nowNs() : 0)
+    {
+    }
+
+    ~ProfileScope() {
+        if (mName) Profiler::record(mName, mStartNs, Profiler::nowNs());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* mName;
+    uint64_t mStartNs;
+};
+
+#ifndef BOMBERMAN_PROFILER_DISABLED
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,130 @@
+#include "ProfilerOverlay.h"
+#include "Profiler.h"
+#include "Counters.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
+namespace {
+    const uint64_t REFRESH_INTERVAL_NS = 500000000ull;
+    const uint64_t AVERAGE_WINDOW_NS = 1000000000ull;
+    const float GRAPH_FULL_SCALE_MS = 33.3f;
+    const float FRAME_BUDGET_MS = 1000.0f / 60.0f;
+}
+
+ProfilerOverlay::ProfilerOverlay(Renderer* renderer, TTF_Font* font)
+    : mRenderer(renderer),
+    mFont(font),
+    mVisible(false),
+    mLastRefreshNs(0)
+{
+}
+
+ProfilerOverlay::~ProfilerOverlay() {
+    clearLines();
+}
+
+void ProfilerOverlay::toggle() {
+    mVisible = !mVisible;
+    Profiler::setEnabled(mVisible);
+    mLastRefreshNs = 0;
+    if (!mVisible) clearLines();
+}
+
+void ProfilerOverlay::clearLines() {
+    for (Texture* line : mLines) {
+        mRenderer->destroyTexture(line);
+    }
+    mLines.clear();
+}
+
+void ProfilerOverlay::addLine(const std::string& text) {
+    if (!mFont) return;
+    SDL_Color color = { 255, 255, 160, 255 };
+    SDL_Surface* surface = TTF_RenderText_Solid(mFont, text.c_str(), color);
+    if (!surface) return;
+    Texture* texture = mRenderer->createTextureFromSurface(surface);
+    SDL_FreeSurface(surface);
+    if (texture) mLines.push_back(texture);
+}
+
+void ProfilerOverlay::refreshText() {
+    PROFILE_SCOPE("profiler.overlayText");
+    clearLines();
+
+    uint64_t now = Profiler::nowNs();
+    int threadId = Profiler::currentThreadId();
+    std::map<std::string, uint64_t> totals;
+    int frames = 0;
+    for (const auto& event : Profiler::collect(now > AVERAGE_WINDOW_NS ? now - AVERAGE_WINDOW_NS : 0)) {
+        if (event.threadId != threadId) continue;
+        totals[event.name] += event.durationNs;
+        if (std::string(event.name) == "frame") ++frames;
+    }
+    if (frames == 0) frames = 1;
+
+    std::vector<std::pair<std::string, uint64_t>> phases(totals.begin(), totals.end());
+    std::sort(phases.begin(), phases.end(), [](const std::pair<std::string, uint64_t>& a, const std::pair<std::string, uint64_t>& b) {
+        return a.second > b.second;
+    });
+
+    char buffer[96];
+    std::snprintf(buffer, sizeof(buffer), "Profiler (F3 hide, F4 dump) - %d frames/s", frames);
+    addLine(buffer);
+    for (size_t i = 0; i < phases.size() && static_cast<int>(i) < MAX_PHASE_LINES; ++i) {
+        std::snprintf(buffer, sizeof(buffer), "%-22s %7.3f ms", phases[i].first.c_str(), phases[i].second / 1e6 / frames);
+        addLine(buffer);
+    }
+
+    CounterFrame counters = Counters::getLastFrame();
+    for (int counter = 0; counter < COUNTER_COUNT; ++counter) {
+        std::snprintf(buffer, sizeof(buffer), "%-22s %10llu", Counters::getName(static_cast<Counter>(counter)),
+            static_cast<unsigned long long>(counters.values[counter]));
+        addLine(buffer);
+    }
+    addLine(Counters::isCsvLogOpen() ? "F5: stop counter log" : "F5: log counters to CSV");
+}
+
+void ProfilerOverlay::render() {
+    if (!mVisible) return;
+    PROFILE_SCOPE("profiler.overlay");
+
+    uint64_t now = Profiler::nowNs();
+    if (mLastRefreshNs == 0 || now - mLastRefreshNs >= REFRESH_INTERVAL_NS) {
+        refreshText();
+        mLastRefreshNs = now;
+    }
+
+    std::vector<float> frameTimes = Profiler::getFrameTimes();
+    int panelWidth = std::max(static_cast<int>(Profiler::FRAME_HISTORY), 300);
+    int textHeight = 0;
+    for (Texture* line : mLines) textHeight += line->height;
+    SDL_Rect panel = { 4, 4, panelWidth + 8, textHeight + GRAPH_HEIGHT + 16 };
+
+    mRenderer->setBlendMode(SDL_BLENDMODE_BLEND);
+    mRenderer->setDrawColor(0, 0, 0, 170);
+    mRenderer->fillRect(&panel);
+    mRenderer->setBlendMode(SDL_BLENDMODE_NONE);
+
+    int y = panel.y + 4;
+    for (Texture* line : mLines) {
+        SDL_Rect dest = { panel.x + 4, y, line->width, line->height };
+        mRenderer->copy(line, nullptr, &dest);
+        y += line->height;
+    }
+
+    int graphBottom = y + 4 + GRAPH_HEIGHT;
+    for (size_t i = 0; i < frameTimes.size(); ++i) {
+        float ms = frameTimes[i];
+        int height = static_cast<int>(std::min(ms / GRAPH_FULL_SCALE_MS, 1.0f) * GRAPH_HEIGHT);
+        if (height < 1) height = 1;
+        if (ms <= FRAME_BUDGET_MS) mRenderer->setDrawColor(80, 220, 80, 255);
+        else mRenderer->setDrawColor(230, 60, 60, 255);
+        SDL_Rect bar = { panel.x + 4 + static_cast<int>(i), graphBottom - height, 1, height };
+        mRenderer->fillRect(&bar);
+    }
+    int budgetY = graphBottom - static_cast<int>(FRAME_BUDGET_MS / GRAPH_FULL_SCALE_MS * GRAPH_HEIGHT);
+    SDL_Rect budgetLine = { panel.x + 4, budgetY, static_cast<int>(Profiler::FRAME_HISTORY), 1 };
+    mRenderer->setDrawColor(255, 255, 255, 255);
+    mRenderer->fillRect(&budgetLine);
+}
@@ -0,0 +1,44 @@
+#ifndef PROFILER_OVERLAY_H
+#define PROFILER_OVERLAY_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Renderer.h"
+
+// Debug panel drawn over the game: per-phase averages for the calling thread
+// over the last second, the engine counters of the latest frame and a bar
+// graph of recent frame times. The text is
+// rebuilt twice a second so the overlay does not add texture churn of its own.
+class ProfilerOverlay {
+public:
+    ProfilerOverlay(Renderer* renderer, TTF_Font* font);
+    ~ProfilerOverlay();
+
+    ProfilerOverlay(const ProfilerOverlay&) = delete;
+    ProfilerOverlay& operator=(const ProfilerOverlay&) = delete;
+
+    // Showing the overlay also turns recording on; hiding it turns it off.
+    void toggle();
+    bool isVisible() const { return mVisible; }
+
+    void render();
+
+private:
+    static const int MAX_PHASE_LINES = 12;
+    static const int GRAPH_HEIGHT = 60;
+
+    Renderer* mRenderer;
+    TTF_Font* mFont;
+    bool mVisible;
+    uint64_t mLastRefreshNs;
+    std::vector<Texture*> mLines;
+
+    void refreshText();
+    void clearLines();
+    void addLine(const std::string& text);
+};
+
+#endif // PROFILER_OVERLAY_H
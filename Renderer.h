@@ -0,0 +1,42 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <SDL.h>
+
+// Backend-owned texture. Width and height are cached at creation so callers
+// never need to round-trip to the backend to size a draw.
+struct Texture {
+    SDL_Texture* handle = nullptr;
+    int width = 0;
+    int height = 0;
+};
+
+// Everything the game draws goes through this interface. SDL_Rect and
+// SDL_Surface are plain data and stay in the signatures; no call here may
+// require a window or GPU context unless the backend provides one.
+class Renderer {
+public:
+    virtual ~Renderer() = default;
+
+    virtual Texture* createTextureFromSurface(SDL_Surface* surface) = 0;
+    virtual void destroyTexture(Texture* texture) = 0;
+
+    // Offscreen targets; createRenderTarget returns nullptr when unsupported.
+    // Passing nullptr to setRenderTarget restores the default target.
+    virtual Texture* createRenderTarget(int width, int height) = 0;
+    virtual bool setRenderTarget(Texture* target) = 0;
+
+    virtual void setDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a) = 0;
+    virtual void setBlendMode(SDL_BlendMode mode) = 0;
+    virtual void clear() = 0;
+    virtual void copy(Texture* texture, const SDL_Rect* srcRect, const SDL_Rect* destRect) = 0;
+    virtual void fillRect(const SDL_Rect* rect) = 0;
+    virtual void present() = 0;
+
+    static void queryTexture(const Texture* texture, int* width, int* height) {
+        if (width) *width = texture ? texture->width : 0;
+        if (height) *height = texture ? texture->height : 0;
+    }
+};
+
+#endif // RENDERER_H
@@ -0,0 +1,140 @@
+#include "Replay.h"
+#include "ByteStream.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace {
+    const uint8_t REPLAY_MAGIC[4] = { 'B', 'M', 'R', 'P' };
+    // Far beyond any real match, but small enough that a corrupt header
+    // cannot ask for gigabytes of inputs or tiles.
+    const int MAX_REPLAY_TICKS = 24 * 60 * 60 * TICKS_PER_SECOND;
+    const int MAX_REPLAY_MAP_SIDE = 1024;
+
+    // The checks Simulation::reset and Map::initialize make, plus the bounds
+    // above, so a bad header is reported here instead of by the simulation.
+    bool isValidConfig(const MatchConfig& config) {
+        return config.playerCount >= 1 && config.playerCount <= MAX_PLAYERS
+            && config.columns > 2 && config.columns <= MAX_REPLAY_MAP_SIDE
+            && config.rows > 2 && config.rows <= MAX_REPLAY_MAP_SIDE
+            && config.tileSize > 0 && config.enemyCount >= 0
+            && config.maxActiveBombs >= 0 && config.bombRange >= 0
+            && config.matchTicks > 0 && config.matchTicks <= MAX_REPLAY_TICKS;
+    }
+
+    bool sameInput(const TickInput& a, const TickInput& b, int playerCount) {
+        return std::memcmp(a.buttons, b.buttons, playerCount) == 0;
+    }
+}
+
+void ReplayRecorder::begin(const MatchConfig& config) {
+    mReplay.config = config;
+    mReplay.inputs.clear();
+    mReplay.inputs.reserve(config.matchTicks);
+    mReplay.finalChecksum = 0;
+    mRecording = true;
+}
+
+bool Replay::save(const std::string& path) const {
+    std::vector<uint8_t> bytes;
+    ByteWriter writer(bytes);
+    writer.writeBytes(REPLAY_MAGIC, 4);
+    writer.writeU32(VERSION);
+    writer.writeU32(static_cast<uint32_t>(config.columns));
+    writer.writeU32(static_cast<uint32_t>(config.rows));
+    writer.writeU32(static_cast<uint32_t>(config.tileSize));
+    writer.writeU32(static_cast<uint32_t>(config.playerCount));
+    writer.writeU32(static_cast<uint32_t>(config.enemyCount));
+    writer.writeFloat(config.playerSpeed);
+    writer.writeU32(static_cast<uint32_t>(config.maxActiveBombs));
+    writer.writeU32(static_cast<uint32_t>(config.bombRange));
+    writer.writeU32(static_cast<uint32_t>(config.matchTicks));
+    writer.writeU64(config.seed);
+    writer.writeU32(config.invulnerablePlayers ? 1 : 0);
+    writer.writeU32(static_cast<uint32_t>(inputs.size()));
+    writer.writeU64(finalChecksum);
+
+    for (size_t i = 0; i < inputs.size();) {
+        size_t run = 1;
+        while (i + run < inputs.size() && sameInput(inputs[i], inputs[i + run], config.playerCount)) ++run;
+        writer.writeVarint(run);
+        writer.writeBytes(inputs[i].buttons, config.playerCount);
+        i += run;
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Replay Error: Cannot open '" << path << "' for writing." << std::endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return static_cast<bool>(out);
+}
+
+bool Replay::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Replay Error: Cannot open '" << path << "'." << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (bytes.size() < 8 || std::memcmp(bytes.data(), REPLAY_MAGIC, 4) != 0) {
+        std::cerr << "Replay Error: '" << path << "' is not a replay file." << std::endl;
+        return false;
+    }
+
+    ByteReader reader(bytes.data(), bytes.size(), 4);
+    if (reader.readU32() != VERSION) {
+        std::cerr << "Replay Error: '" << path << "' has an unsupported version." << std::endl;
+        return false;
+    }
+    config.columns = static_cast<int>(reader.readU32());
+    config.rows = static_cast<int>(reader.readU32());
+    config.tileSize = static_cast<int>(reader.readU32());
+    config.playerCount = static_cast<int>(reader.readU32());
+    config.enemyCount = static_cast<int>(reader.readU32());
+    config.playerSpeed = reader.readFloat();
+    config.maxActiveBombs = static_cast<int>(reader.readU32());
+    config.bombRange = static_cast<int>(reader.readU32());
+    config.matchTicks = static_cast<int>(reader.readU32());
+    config.seed = reader.readU64();
+    config.invulnerablePlayers = reader.readU32() != 0;
+    uint32_t tickCount = reader.readU32();
+    finalChecksum = reader.readU64();
+
+    if (!reader.isOk() || !isValidConfig(config) || tickCount > static_cast<uint32_t>(config.matchTicks)) {
+        std::cerr << "Replay Error: '" << path << "' has a corrupt header." << std::endl;
+        return false;
+    }
+
+    inputs.clear();
+    inputs.reserve(tickCount);
+    while (inputs.size() < tickCount && reader.isOk()) {
+        uint64_t run = reader.readVarint();
+        TickInput input;
+        reader.readBytes(input.buttons, config.playerCount);
+        if (run == 0 || inputs.size() + run > tickCount) reader.fail();
+        if (reader.isOk()) inputs.resize(inputs.size() + run, input);
+    }
+    if (!reader.isOk()) {
+        std::cerr << "Replay Error: '" << path << "' has truncated or corrupt input data." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+ReplayResult playReplay(const Replay& replay, Simulation& simulation) {
+    ReplayResult result;
+    auto start = std::chrono::steady_clock::now();
+    if (!simulation.reset(replay.config)) return result;
+    for (const auto& input : replay.inputs) {
+        simulation.step(input);
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.ticks = static_cast<int>(replay.inputs.size());
+    result.checksum = simulation.computeChecksum();
+    result.matchesRecording = result.checksum == replay.finalChecksum;
+    return result;
+}
@@ -0,0 +1,54 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Simulation.h"
+
+// A recorded match: the config (which carries the seed and everything taken
+// from GameOptions) plus the input of every tick. Since the simulation is
+// deterministic this is enough to reproduce the match exactly.
+//
+// File layout (little-endian):
+//   "BMRP" | u32 version | config | u32 tickCount | u64 finalChecksum | runs
+// Inputs are run-length encoded: a varint repeat count followed by one
+// button byte per player, repeated until tickCount ticks are covered.
+struct Replay {
+    static const uint32_t VERSION = 2;
+
+    MatchConfig config;
+    std::vector<TickInput> inputs;
+    uint64_t finalChecksum = 0;
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+};
+
+// Collects a match as it is played.
+class ReplayRecorder {
+public:
+    void begin(const MatchConfig& config);
+    void recordTick(const TickInput& input) { mReplay.inputs.push_back(input); }
+    // Stores the checksum of the final state so playback can verify itself.
+    void finish(const Simulation& simulation) { mReplay.finalChecksum = simulation.computeChecksum(); }
+
+    const Replay& getReplay() const { return mReplay; }
+    bool isRecording() const { return mRecording; }
+
+private:
+    Replay mReplay;
+    bool mRecording = false;
+};
+
+struct ReplayResult {
+    int ticks = 0;
+    double seconds = 0.0;
+    uint64_t checksum = 0;
+    bool matchesRecording = false;
+};
+
+// Re-runs a replay with no rendering and no frame pacing.
+ReplayResult playReplay(const Replay& replay, Simulation& simulation);
+
+#endif // REPLAY_H
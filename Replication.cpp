@@ -0,0 +1,677 @@
+#include "Replication.h"
+#include "BitStream.h"
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+// Message layout, bit-packed (see BitStream.h):
+//   keyframe flag | u8 generation | varint tick | keyframe or delta body
+//
+// Keyframe: varint columns, rows, tile size | u4 players | status | varint
+// scores | every tile | every player | varint enemies, each an enemy record
+// | varint bombs, each a bomb record.
+//
+// Delta: varint ticks since the base | status changed? status | scores
+// changed? per player: changed? signed varint difference | varint tile
+// changes, each tile index and type | per player: moved? x y, flags
+// changed? flags | enemies removed? | per base enemy: [removed?] then if
+// kept, moved? x y | varint added enemies, each an enemy record | per base
+// bomb: removed? then if kept and not yet exploding, exploded? arms |
+// varint added bombs, each a bomb record.
+//
+// Status is u2 outcome and u4 winner + 1. An enemy record is a varint id
+// gap from the previous record's id + 1, then x and y. A bomb record is the
+// tile index, u3 owner, varint age, exploding? arms. A moved coordinate is a
+// 0 bit when unchanged, 10 and a 4-bit code for a step of up to SMALL_STEP
+// pixels, or 11 and the absolute value. "Removed" and "added" cover both
+// entities that died or were placed and those that left or entered the
+// client's interest area.
+
+namespace {
+    const int GENERATION_BITS = 8;
+    const int PLAYER_COUNT_BITS = 4;
+    const int OUTCOME_BITS = 2;
+    const int WINNER_BITS = 4;
+    const int TILE_TYPE_BITS = 2;
+    const int PLAYER_FLAG_BITS = 4;
+    const int OWNER_BITS = 3;
+    const int ARM_BITS = 4;
+    const int SMALL_STEP = 8;
+    const int SMALL_STEP_BITS = 4;
+    // Bounds a keyframe may claim, so a corrupt one cannot ask for a huge map.
+    const int MAX_MAP_TILES = 1 << 20;
+    const int MAX_TILE_SIZE = 1024;
+
+    int bitsFor(uint32_t maxValue) {
+        int bits = 1;
+        while (bits < 32 && (maxValue >> bits) != 0) ++bits;
+        return bits;
+    }
+
+    // Field widths that follow from the map, so both ends derive them from
+    // the keyframe instead of sending them.
+    struct FieldWidths {
+        int tile;
+        int x;
+        int y;
+    };
+
+    FieldWidths getFieldWidths(int columns, int rows, int tileSize) {
+        return { bitsFor(static_cast<uint32_t>(columns * rows - 1)), bitsFor(static_cast<uint32_t>(columns * tileSize)),
+            bitsFor(static_cast<uint32_t>(rows * tileSize)) };
+    }
+
+    bool enemyLess(const ReplicaEnemy& a, const ReplicaEnemy& b) {
+        return a.id < b.id;
+    }
+
+    bool bombLess(const ReplicaBomb& a, const ReplicaBomb& b) {
+        return a.spawnTick < b.spawnTick || (a.spawnTick == b.spawnTick && a.tile < b.tile);
+    }
+
+    bool sameBomb(const ReplicaBomb& a, const ReplicaBomb& b) {
+        return a.tile == b.tile && a.spawnTick == b.spawnTick;
+    }
+
+    void writeStatus(BitWriter& writer, const ReplicaFrame& frame) {
+        writer.writeBits(static_cast<uint32_t>(frame.outcome), OUTCOME_BITS);
+        writer.writeBits(static_cast<uint32_t>(frame.winner + 1), WINNER_BITS);
+    }
+
+    void readStatus(BitReader& reader, ReplicaFrame& frame) {
+        frame.outcome = static_cast<MatchOutcome>(reader.readBits(OUTCOME_BITS));
+        frame.winner = static_cast<int>(reader.readBits(WINNER_BITS)) - 1;
+        if (frame.winner >= frame.playerCount) reader.fail();
+    }
+
+    void writeCoordinate(BitWriter& writer, int from, int to, int bits) {
+        int step = to - from;
+        if (step == 0) {
+            writer.writeBits(0, 1);
+        }
+        else if (step >= -SMALL_STEP && step <= SMALL_STEP) {
+            writer.writeBits(0x1, 2);
+            writer.writeBits(static_cast<uint32_t>(step > 0 ? 2 * step - 2 : -2 * step - 1), SMALL_STEP_BITS);
+        }
+        else {
+            writer.writeBits(0x3, 2);
+            writer.writeBits(static_cast<uint32_t>(to), bits);
+        }
+    }
+
+    int readCoordinate(BitReader& reader, int from, int bits) {
+        if (!reader.readBool()) return from;
+        if (reader.readBool()) return static_cast<int>(reader.readBits(bits));
+        int code = static_cast<int>(reader.readBits(SMALL_STEP_BITS));
+        return from + ((code & 1) ? -(code + 1) / 2 : code / 2 + 1);
+    }
+
+    void writeEnemyRecord(BitWriter& writer, const ReplicaEnemy& enemy, uint32_t& nextId, const FieldWidths& widths) {
+        writer.writeVarint(enemy.id - nextId);
+        writer.writeBits(static_cast<uint32_t>(enemy.x), widths.x);
+        writer.writeBits(static_cast<uint32_t>(enemy.y), widths.y);
+        nextId = enemy.id + 1;
+    }
+
+    void readEnemyRecord(BitReader& reader, ReplicaEnemy& enemy, uint32_t& nextId, const FieldWidths& widths) {
+        enemy.id = nextId + reader.readVarint();
+        enemy.x = static_cast<int>(reader.readBits(widths.x));
+        enemy.y = static_cast<int>(reader.readBits(widths.y));
+        if (enemy.id < nextId) reader.fail();
+        nextId = enemy.id + 1;
+    }
+
+    void writeArms(BitWriter& writer, const ReplicaBomb& bomb) {
+        for (uint8_t arm : bomb.arms) writer.writeBits(arm, ARM_BITS);
+    }
+
+    void readArms(BitReader& reader, ReplicaBomb& bomb) {
+        for (uint8_t& arm : bomb.arms) {
+            arm = static_cast<uint8_t>(reader.readBits(ARM_BITS));
+            if (arm > Explosion::MAX_RANGE) reader.fail();
+        }
+    }
+
+    void writeBombRecord(BitWriter& writer, const ReplicaBomb& bomb, int tick, const FieldWidths& widths) {
+        writer.writeBits(static_cast<uint32_t>(bomb.tile), widths.tile);
+        writer.writeBits(static_cast<uint32_t>(bomb.owner), OWNER_BITS);
+        writer.writeVarint(static_cast<uint32_t>(tick - bomb.spawnTick));
+        writer.writeBool(bomb.exploding);
+        if (bomb.exploding) writeArms(writer, bomb);
+    }
+
+    void readBombRecord(BitReader& reader, ReplicaBomb& bomb, int tick, int tileCount, int playerCount, const FieldWidths& widths) {
+        bomb.tile = static_cast<int>(reader.readBits(widths.tile));
+        bomb.owner = static_cast<int>(reader.readBits(OWNER_BITS));
+        bomb.spawnTick = tick - static_cast<int>(reader.readVarint());
+        bomb.exploding = reader.readBool();
+        for (uint8_t& arm : bomb.arms) arm = 0;
+        if (bomb.exploding) readArms(reader, bomb);
+        if (bomb.tile >= tileCount || bomb.owner >= playerCount) reader.fail();
+    }
+
+    // Every list carries a count; refuse counts the rest of the message
+    // could not possibly hold.
+    bool plausibleCount(const BitReader& reader, uint32_t count, size_t size) {
+        return reader.isOk() && count <= size * 8 - reader.getBitPosition();
+    }
+
+    // Merges the entities a delta kept with those it added. Both are sorted;
+    // an entity in both means the message was malformed.
+    template <typename Entity, typename Less>
+    bool mergeEntities(const std::vector<Entity>& kept, const std::vector<Entity>& added, std::vector<Entity>& out, Less less) {
+        out.clear();
+        std::merge(kept.begin(), kept.end(), added.begin(), added.end(), std::back_inserter(out), less);
+        for (size_t i = 1; i < out.size(); ++i) {
+            if (!less(out[i - 1], out[i])) return false;
+        }
+        return true;
+    }
+
+    void writeKeyframe(BitWriter& writer, const ReplicaFrame& frame, const std::vector<ReplicaEnemy>& enemies,
+        const std::vector<ReplicaBomb>& bombs, const Map& map) {
+        FieldWidths widths = getFieldWidths(map.getColumns(), map.getRows(), map.getTileSize());
+        writer.writeVarint(static_cast<uint32_t>(map.getColumns()));
+        writer.writeVarint(static_cast<uint32_t>(map.getRows()));
+        writer.writeVarint(static_cast<uint32_t>(map.getTileSize()));
+        writer.writeBits(static_cast<uint32_t>(frame.playerCount), PLAYER_COUNT_BITS);
+        writeStatus(writer, frame);
+        for (int p = 0; p < frame.playerCount; ++p) {
+            writer.writeVarint(static_cast<uint32_t>(frame.scores[p]));
+        }
+        for (int row = 0; row < map.getRows(); ++row) {
+            for (int col = 0; col < map.getColumns(); ++col) {
+                writer.writeBits(static_cast<uint32_t>(map.getTileType(row, col)), TILE_TYPE_BITS);
+            }
+        }
+        for (int p = 0; p < frame.playerCount; ++p) {
+            const ReplicaPlayer& player = frame.players[p];
+            writer.writeBits(static_cast<uint32_t>(player.x), widths.x);
+            writer.writeBits(static_cast<uint32_t>(player.y), widths.y);
+            writer.writeBits(player.flags, PLAYER_FLAG_BITS);
+        }
+        writer.writeVarint(static_cast<uint32_t>(enemies.size()));
+        uint32_t nextId = 0;
+        for (const auto& enemy : enemies) {
+            writeEnemyRecord(writer, enemy, nextId, widths);
+        }
+        writer.writeVarint(static_cast<uint32_t>(bombs.size()));
+        for (const auto& bomb : bombs) {
+            writeBombRecord(writer, bomb, frame.tick, widths);
+        }
+    }
+
+    void writeEnemyDelta(BitWriter& writer, const std::vector<ReplicaEnemy>& enemies, const std::vector<ReplicaEnemy>& baseEnemies,
+        const FieldWidths& widths) {
+        // Both lists are in id order, so one walk pairs them up. Counting the
+        // survivors first lets the usual tick, where none left, skip the
+        // per-enemy removed bits.
+        size_t kept = 0;
+        for (size_t i = 0, j = 0; i < baseEnemies.size() && j < enemies.size();) {
+            if (baseEnemies[i].id == enemies[j].id) {
+                ++kept;
+                ++i;
+                ++j;
+            }
+            else if (baseEnemies[i].id < enemies[j].id) {
+                ++i;
+            }
+            else {
+                ++j;
+            }
+        }
+
+        bool removed = kept != baseEnemies.size();
+        writer.writeBool(removed);
+        size_t next = 0;
+        for (const auto& from : baseEnemies) {
+            while (next < enemies.size() && enemies[next].id < from.id) ++next;
+            bool isKept = next < enemies.size() && enemies[next].id == from.id;
+            if (removed) writer.writeBool(!isKept);
+            if (!isKept) continue;
+            const ReplicaEnemy& to = enemies[next++];
+            bool moved = from.x != to.x || from.y != to.y;
+            writer.writeBool(moved);
+            if (moved) {
+                writeCoordinate(writer, from.x, to.x, widths.x);
+                writeCoordinate(writer, from.y, to.y, widths.y);
+            }
+        }
+
+        writer.writeVarint(static_cast<uint32_t>(enemies.size() - kept));
+        uint32_t nextId = 0;
+        next = 0;
+        for (const auto& to : enemies) {
+            while (next < baseEnemies.size() && baseEnemies[next].id < to.id) ++next;
+            if (next < baseEnemies.size() && baseEnemies[next].id == to.id) continue;
+            writeEnemyRecord(writer, to, nextId, widths);
+        }
+    }
+
+    void writeBombDelta(BitWriter& writer, const std::vector<ReplicaBomb>& bombs, const std::vector<ReplicaBomb>& baseBombs,
+        int tick, const FieldWidths& widths) {
+        size_t kept = 0;
+        size_t next = 0;
+        for (const auto& from : baseBombs) {
+            while (next < bombs.size() && bombLess(bombs[next], from)) ++next;
+            bool isKept = next < bombs.size() && sameBomb(bombs[next], from);
+            writer.writeBool(!isKept);
+            if (!isKept) continue;
+            ++kept;
+            const ReplicaBomb& to = bombs[next++];
+            if (from.exploding) continue;
+            writer.writeBool(to.exploding);
+            if (to.exploding) writeArms(writer, to);
+        }
+
+        writer.writeVarint(static_cast<uint32_t>(bombs.size() - kept));
+        next = 0;
+        for (const auto& to : bombs) {
+            while (next < baseBombs.size() && bombLess(baseBombs[next], to)) ++next;
+            if (next < baseBombs.size() && sameBomb(baseBombs[next], to)) continue;
+            writeBombRecord(writer, to, tick, widths);
+        }
+    }
+
+    void writeDelta(BitWriter& writer, const ReplicaFrame& frame, const ReplicaFrame& base, const Map& map,
+        const std::vector<ReplicaEnemy>& enemies, const std::vector<ReplicaEnemy>& baseEnemies,
+        const std::vector<ReplicaBomb>& bombs, const std::vector<ReplicaBomb>& baseBombs) {
+        FieldWidths widths = getFieldWidths(map.getColumns(), map.getRows(), map.getTileSize());
+        writer.writeVarint(static_cast<uint32_t>(frame.tick - base.tick));
+
+        bool statusChanged = frame.outcome != base.outcome || frame.winner != base.winner;
+        writer.writeBool(statusChanged);
+        if (statusChanged) writeStatus(writer, frame);
+
+        bool scoresChanged = false;
+        for (int p = 0; p < frame.playerCount; ++p) {
+            if (frame.scores[p] != base.scores[p]) scoresChanged = true;
+        }
+        writer.writeBool(scoresChanged);
+        if (scoresChanged) {
+            for (int p = 0; p < frame.playerCount; ++p) {
+                int difference = frame.scores[p] - base.scores[p];
+                writer.writeBool(difference != 0);
+                if (difference != 0) writer.writeSignedVarint(difference);
+            }
+        }
+
+        // Each change is sent with the tile's current type, so a tile that
+        // changed twice ends up right whichever order they apply in.
+        writer.writeVarint(frame.mapChanges - base.mapChanges);
+        for (uint32_t number = base.mapChanges; number != frame.mapChanges; ++number) {
+            int tile = map.getChangedTile(number);
+            writer.writeBits(static_cast<uint32_t>(tile), widths.tile);
+            writer.writeBits(static_cast<uint32_t>(map.getTileType(tile / map.getColumns(), tile % map.getColumns())), TILE_TYPE_BITS);
+        }
+
+        for (int p = 0; p < frame.playerCount; ++p) {
+            const ReplicaPlayer& from = base.players[p];
+            const ReplicaPlayer& to = frame.players[p];
+            bool moved = from.x != to.x || from.y != to.y;
+            writer.writeBool(moved);
+            if (moved) {
+                writeCoordinate(writer, from.x, to.x, widths.x);
+                writeCoordinate(writer, from.y, to.y, widths.y);
+            }
+            writer.writeBool(from.flags != to.flags);
+            if (from.flags != to.flags) writer.writeBits(to.flags, PLAYER_FLAG_BITS);
+        }
+
+        writeEnemyDelta(writer, enemies, baseEnemies, widths);
+        writeBombDelta(writer, bombs, baseBombs, frame.tick, widths);
+    }
+
+    // First and last grid cell an area overlaps along one axis.
+    void cellRange(int start, int length, int cellPixels, int cellCount, int& first, int& last) {
+        first = start <= 0 ? 0 : start / cellPixels;
+        int end = start + length - 1;
+        last = end < 0 ? -1 : end / cellPixels;
+        if (last >= cellCount) last = cellCount - 1;
+    }
+}
+
+void ReplicaFrame::capture(const Simulation& simulation) {
+    tick = simulation.getTick();
+    outcome = simulation.getOutcome();
+    winner = simulation.getWinner();
+    const std::vector<Player>& simulationPlayers = simulation.getPlayers();
+    playerCount = static_cast<int>(simulationPlayers.size());
+    for (int p = 0; p < playerCount; ++p) {
+        const Player& player = simulationPlayers[p];
+        scores[p] = simulation.getScore(p);
+        players[p].x = player.getX();
+        players[p].y = player.getY();
+        players[p].flags = static_cast<uint8_t>(player.getFacingDirection() | (player.isAlive() ? 0x04 : 0)
+            | (player.isMoving() ? 0x08 : 0));
+    }
+
+    const Map& map = simulation.getMap();
+    mapChanges = map.getChangeCount();
+    columns = map.getColumns();
+    tileSize = map.getTileSize();
+    // The simulation hands out enemy ids in spawn order and never reorders
+    // its list, so this is already in id order.
+    enemies.clear();
+    for (const auto& enemy : simulation.getEnemies()) {
+        enemies.push_back({ enemy.getId(), enemy.getX(), enemy.getY() });
+    }
+
+    bombs.clear();
+    for (const auto& bomb : simulation.getBombs()) {
+        ReplicaBomb replica;
+        replica.tile = bomb.getY() / tileSize * columns + bomb.getX() / tileSize;
+        replica.spawnTick = tick - bomb.getAgeTicks() - bomb.getExplosionTicks();
+        replica.owner = bomb.getOwner();
+        replica.exploding = bomb.isExploding();
+        int lengths[4];
+        bomb.getArmLengths(lengths);
+        for (int d = 0; d < 4; ++d) replica.arms[d] = static_cast<uint8_t>(lengths[d]);
+        bombs.push_back(replica);
+    }
+    // Placement order already sorts by spawn tick; this orders bombs placed
+    // on the same tick.
+    std::sort(bombs.begin(), bombs.end(), bombLess);
+
+    // Counting sort of the enemies into grid cells: count per cell, turn
+    // the counts into end offsets while placing, then shift them back into
+    // start offsets.
+    int cellPixels = GRID_CELL_TILES * tileSize;
+    gridColumns = (columns + GRID_CELL_TILES - 1) / GRID_CELL_TILES;
+    gridRows = (map.getRows() + GRID_CELL_TILES - 1) / GRID_CELL_TILES;
+    int cellCount = gridColumns * gridRows;
+    cellStarts.assign(static_cast<size_t>(cellCount) + 1, 0);
+    cellEnemies.resize(enemies.size());
+    auto cellOf = [&](const ReplicaEnemy& enemy) {
+        int col = std::min(std::max(enemy.x / cellPixels, 0), gridColumns - 1);
+        int row = std::min(std::max(enemy.y / cellPixels, 0), gridRows - 1);
+        return row * gridColumns + col;
+    };
+    for (const auto& enemy : enemies) ++cellStarts[cellOf(enemy) + 1];
+    for (int cell = 0; cell < cellCount; ++cell) cellStarts[cell + 1] += cellStarts[cell];
+    for (size_t i = 0; i < enemies.size(); ++i) {
+        cellEnemies[cellStarts[cellOf(enemies[i])]++] = static_cast<int>(i);
+    }
+    for (int cell = cellCount; cell > 0; --cell) cellStarts[cell] = cellStarts[cell - 1];
+    cellStarts[0] = 0;
+}
+
+void ReplicaFrame::collect(const InterestArea& area, std::vector<int>& scratch, std::vector<ReplicaEnemy>& enemiesOut,
+    std::vector<ReplicaBomb>& bombsOut) const {
+    enemiesOut.clear();
+    bombsOut.clear();
+    if (area.isWholeMap()) {
+        enemiesOut.assign(enemies.begin(), enemies.end());
+        bombsOut.assign(bombs.begin(), bombs.end());
+        return;
+    }
+
+    int cellPixels = GRID_CELL_TILES * tileSize;
+    int firstCol, lastCol, firstRow, lastRow;
+    cellRange(area.x, area.width, cellPixels, gridColumns, firstCol, lastCol);
+    cellRange(area.y, area.height, cellPixels, gridRows, firstRow, lastRow);
+    scratch.clear();
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int col = firstCol; col <= lastCol; ++col) {
+            int cell = row * gridColumns + col;
+            for (int k = cellStarts[cell]; k < cellStarts[cell + 1]; ++k) {
+                const ReplicaEnemy& enemy = enemies[cellEnemies[k]];
+                if (area.contains(enemy.x, enemy.y)) scratch.push_back(cellEnemies[k]);
+            }
+        }
+    }
+    std::sort(scratch.begin(), scratch.end());
+    for (int index : scratch) enemiesOut.push_back(enemies[index]);
+
+    for (const auto& bomb : bombs) {
+        if (area.contains(bomb.tile % columns * tileSize, bomb.tile / columns * tileSize)) bombsOut.push_back(bomb);
+    }
+}
+
+Replicator::Replicator()
+    : mSimulation(nullptr),
+    mLatest(0),
+    mGeneration(0)
+{
+}
+
+void Replicator::capture(const Simulation& simulation) {
+    if (&simulation != mSimulation || simulation.getTick() != mHistory[mLatest].tick + 1) {
+        ++mGeneration;
+        for (auto& frame : mHistory) frame.tick = -1;
+    }
+    mSimulation = &simulation;
+    mLatest = simulation.getTick() % HISTORY_SIZE;
+    mHistory[mLatest].capture(simulation);
+}
+
+void Replicator::acknowledge(ReplicaClient& client, uint8_t generation, int tick) const {
+    if (generation != mGeneration || tick > mHistory[mLatest].tick) return;
+    if (client.generation != mGeneration) {
+        client.generation = mGeneration;
+        client.ackedTick = -1;
+        client.lastKeyframeTick = -1;
+    }
+    if (tick > client.ackedTick) client.ackedTick = tick;
+}
+
+bool Replicator::encode(ReplicaClient& client, std::vector<uint8_t>& out) {
+    const ReplicaFrame& frame = mHistory[mLatest];
+    const Map& map = mSimulation->getMap();
+    if (client.generation != mGeneration) {
+        client.generation = mGeneration;
+        client.ackedTick = -1;
+        client.lastKeyframeTick = -1;
+    }
+
+    const ReplicaFrame* base = client.ackedTick >= 0 ? findFrame(client.ackedTick) : nullptr;
+    bool keyframe = !base || client.lastKeyframeTick < 0 || frame.tick - client.lastKeyframeTick >= client.keyframeInterval
+        || frame.mapChanges - base->mapChanges > static_cast<uint32_t>(Map::CHANGE_LOG_SIZE);
+
+    // Whole-map clients read the captured lists directly.
+    const std::vector<ReplicaEnemy>* enemies = &frame.enemies;
+    const std::vector<ReplicaBomb>* bombs = &frame.bombs;
+    if (!client.area.isWholeMap()) {
+        frame.collect(client.area, mIndices, mEnemyViews[0], mBombViews[0]);
+        enemies = &mEnemyViews[0];
+        bombs = &mBombViews[0];
+    }
+
+    BitWriter writer(out);
+    writer.writeBool(keyframe);
+    writer.writeBits(mGeneration, GENERATION_BITS);
+    writer.writeVarint(static_cast<uint32_t>(frame.tick));
+    if (keyframe) {
+        writeKeyframe(writer, frame, *enemies, *bombs, map);
+        client.lastKeyframeTick = frame.tick;
+    }
+    else {
+        const InterestArea& baseArea = client.sentAreas[base->tick % HISTORY_SIZE];
+        const std::vector<ReplicaEnemy>* baseEnemies = &base->enemies;
+        const std::vector<ReplicaBomb>* baseBombs = &base->bombs;
+        if (!baseArea.isWholeMap()) {
+            base->collect(baseArea, mIndices, mEnemyViews[1], mBombViews[1]);
+            baseEnemies = &mEnemyViews[1];
+            baseBombs = &mBombViews[1];
+        }
+        writeDelta(writer, frame, *base, map, *enemies, *baseEnemies, *bombs, *baseBombs);
+    }
+    writer.flush();
+    client.sentAreas[frame.tick % HISTORY_SIZE] = client.area;
+    return keyframe;
+}
+
+const ReplicaFrame* Replicator::findFrame(int tick) const {
+    const ReplicaFrame& frame = mHistory[tick % HISTORY_SIZE];
+    return frame.tick == tick ? &frame : nullptr;
+}
+
+ReplicaDecoder::ReplicaDecoder()
+    : mLatest(-1),
+    mGeneration(0),
+    mColumns(0),
+    mRows(0),
+    mTileSize(0)
+{
+}
+
+bool ReplicaDecoder::decode(const uint8_t* data, size_t size) {
+    BitReader reader(data, size);
+    bool keyframe = reader.readBool();
+    uint8_t generation = static_cast<uint8_t>(reader.readBits(GENERATION_BITS));
+    int tick = static_cast<int>(reader.readVarint());
+    if (!reader.isOk() || tick < 0) return false;
+    if (hasState()) {
+        int8_t newer = static_cast<int8_t>(generation - mGeneration);
+        if (newer < 0 || (newer == 0 && tick <= getLatestTick())) return true;
+    }
+
+    ReplicaFrame& frame = mScratch;
+    frame.tick = tick;
+    mPendingTiles.clear();
+    int columns = mColumns;
+    int rows = mRows;
+    int tileSize = mTileSize;
+
+    if (keyframe) {
+        columns = static_cast<int>(reader.readVarint());
+        rows = static_cast<int>(reader.readVarint());
+        tileSize = static_cast<int>(reader.readVarint());
+        frame.playerCount = static_cast<int>(reader.readBits(PLAYER_COUNT_BITS));
+        if (!reader.isOk() || columns <= 0 || rows <= 0 || columns > MAX_MAP_TILES / rows || tileSize <= 0
+            || tileSize > MAX_TILE_SIZE || frame.playerCount > MAX_PLAYERS) {
+            return false;
+        }
+        FieldWidths widths = getFieldWidths(columns, rows, tileSize);
+        readStatus(reader, frame);
+        for (int p = 0; p < frame.playerCount; ++p) {
+            frame.scores[p] = static_cast<int>(reader.readVarint());
+        }
+        if (!plausibleCount(reader, static_cast<uint32_t>(columns * rows), size)) return false;
+        for (int tile = 0; tile < columns * rows; ++tile) {
+            mPendingTiles.push_back({ tile, static_cast<TileType>(reader.readBits(TILE_TYPE_BITS)) });
+        }
+        for (int p = 0; p < frame.playerCount; ++p) {
+            ReplicaPlayer& player = frame.players[p];
+            player.x = static_cast<int>(reader.readBits(widths.x));
+            player.y = static_cast<int>(reader.readBits(widths.y));
+            player.flags = static_cast<uint8_t>(reader.readBits(PLAYER_FLAG_BITS));
+        }
+        uint32_t enemyCount = reader.readVarint();
+        if (!plausibleCount(reader, enemyCount, size)) return false;
+        frame.enemies.clear();
+        uint32_t nextId = 0;
+        for (uint32_t i = 0; i < enemyCount; ++i) {
+            ReplicaEnemy enemy;
+            readEnemyRecord(reader, enemy, nextId, widths);
+            frame.enemies.push_back(enemy);
+        }
+        uint32_t bombCount = reader.readVarint();
+        if (!plausibleCount(reader, bombCount, size)) return false;
+        frame.bombs.clear();
+        for (uint32_t i = 0; i < bombCount; ++i) {
+            ReplicaBomb bomb;
+            readBombRecord(reader, bomb, tick, columns * rows, frame.playerCount, widths);
+            if (!frame.bombs.empty() && !bombLess(frame.bombs.back(), bomb)) return false;
+            frame.bombs.push_back(bomb);
+        }
+    }
+    else {
+        int distance = static_cast<int>(reader.readVarint());
+        if (!reader.isOk() || !hasState() || generation != mGeneration || distance <= 0 || distance >= Replicator::HISTORY_SIZE) {
+            return false;
+        }
+        const ReplicaFrame& base = mFrames[(tick - distance) % Replicator::HISTORY_SIZE];
+        if (base.tick != tick - distance) return false;
+        FieldWidths widths = getFieldWidths(columns, rows, tileSize);
+
+        frame.playerCount = base.playerCount;
+        frame.outcome = base.outcome;
+        frame.winner = base.winner;
+        if (reader.readBool()) readStatus(reader, frame);
+        for (int p = 0; p < frame.playerCount; ++p) frame.scores[p] = base.scores[p];
+        if (reader.readBool()) {
+            for (int p = 0; p < frame.playerCount; ++p) {
+                if (reader.readBool()) frame.scores[p] += reader.readSignedVarint();
+            }
+        }
+
+        uint32_t tileChanges = reader.readVarint();
+        if (!plausibleCount(reader, tileChanges, size)) return false;
+        for (uint32_t i = 0; i < tileChanges; ++i) {
+            int tile = static_cast<int>(reader.readBits(widths.tile));
+            TileType type = static_cast<TileType>(reader.readBits(TILE_TYPE_BITS));
+            if (tile >= columns * rows) return false;
+            mPendingTiles.push_back({ tile, type });
+        }
+
+        for (int p = 0; p < frame.playerCount; ++p) {
+            ReplicaPlayer& player = frame.players[p];
+            player = base.players[p];
+            if (reader.readBool()) {
+                player.x = readCoordinate(reader, player.x, widths.x);
+                player.y = readCoordinate(reader, player.y, widths.y);
+            }
+            if (reader.readBool()) player.flags = static_cast<uint8_t>(reader.readBits(PLAYER_FLAG_BITS));
+        }
+
+        bool enemiesRemoved = reader.readBool();
+        mKeptEnemies.clear();
+        for (const auto& from : base.enemies) {
+            if (enemiesRemoved && reader.readBool()) continue;
+            ReplicaEnemy enemy = from;
+            if (reader.readBool()) {
+                enemy.x = readCoordinate(reader, enemy.x, widths.x);
+                enemy.y = readCoordinate(reader, enemy.y, widths.y);
+            }
+            mKeptEnemies.push_back(enemy);
+        }
+        uint32_t addedEnemies = reader.readVarint();
+        if (!plausibleCount(reader, addedEnemies, size)) return false;
+        mAddedEnemies.clear();
+        uint32_t nextId = 0;
+        for (uint32_t i = 0; i < addedEnemies; ++i) {
+            ReplicaEnemy enemy;
+            readEnemyRecord(reader, enemy, nextId, widths);
+            mAddedEnemies.push_back(enemy);
+        }
+        if (!mergeEntities(mKeptEnemies, mAddedEnemies, frame.enemies, enemyLess)) return false;
+
+        mKeptBombs.clear();
+        for (const auto& from : base.bombs) {
+            if (reader.readBool()) continue;
+            ReplicaBomb bomb = from;
+            if (!bomb.exploding && reader.readBool()) {
+                bomb.exploding = true;
+                readArms(reader, bomb);
+            }
+            mKeptBombs.push_back(bomb);
+        }
+        uint32_t addedBombs = reader.readVarint();
+        if (!plausibleCount(reader, addedBombs, size)) return false;
+        mAddedBombs.clear();
+        for (uint32_t i = 0; i < addedBombs; ++i) {
+            ReplicaBomb bomb;
+            readBombRecord(reader, bomb, tick, columns * rows, frame.playerCount, widths);
+            mAddedBombs.push_back(bomb);
+        }
+        std::sort(mAddedBombs.begin(), mAddedBombs.end(), bombLess);
+        if (!mergeEntities(mKeptBombs, mAddedBombs, frame.bombs, bombLess)) return false;
+    }
+    if (!reader.isOk()) return false;
+
+    if (keyframe) {
+        if (generation != mGeneration || !hasState()) {
+            for (auto& held : mFrames) held.tick = -1;
+        }
+        mGeneration = generation;
+        mColumns = columns;
+        mRows = rows;
+        mTileSize = tileSize;
+        mTiles.resize(static_cast<size_t>(columns) * rows);
+    }
+    for (const auto& change : mPendingTiles) mTiles[change.first] = change.second;
+    mLatest = tick % Replicator::HISTORY_SIZE;
+    std::swap(mFrames[mLatest], mScratch);
+    return true;
+}
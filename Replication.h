@@ -0,0 +1,202 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Simulation.h"
+
+// What a client needs to draw one tick of a match. Positions are whole
+// pixels, packed at the bit width the map's pixel extent needs.
+struct ReplicaPlayer {
+    int x;
+    int y;
+    // Facing direction in bits 0-1, alive in bit 2, moving in bit 3.
+    uint8_t flags;
+};
+
+struct ReplicaEnemy {
+    // Enemy::getId(). Lists of enemies are kept in id order.
+    uint32_t id;
+    int x;
+    int y;
+};
+
+struct ReplicaBomb {
+    // row * columns + col.
+    int tile;
+    // Tick the bomb was placed on; with the tile it identifies the bomb, and
+    // the frame tick minus it is the age the fuse animation needs. Lists of
+    // bombs are kept in (spawnTick, tile) order.
+    int spawnTick;
+    int owner;
+    bool exploding;
+    // Explosion arm lengths in Bomb::getArmLengths order.
+    uint8_t arms[4];
+};
+
+// The part of the map a client is shown enemies and bombs for, in pixels.
+// Players, scores and tiles are always replicated in full: there are at most
+// eight players, and tiles change a few at a time. An empty area means the
+// whole map.
+struct InterestArea {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+
+    // The area of the given size centred on a point, such as a player.
+    static InterestArea centredOn(int px, int py, int areaWidth, int areaHeight) {
+        return { px - areaWidth / 2, py - areaHeight / 2, areaWidth, areaHeight };
+    }
+
+    bool isWholeMap() const { return width <= 0 || height <= 0; }
+    bool contains(int px, int py) const {
+        return isWholeMap() || (px >= x && px < x + width && py >= y && py < y + height);
+    }
+};
+
+struct ReplicaFrame {
+    int tick = -1;
+    MatchOutcome outcome = MatchOutcome::IN_PROGRESS;
+    int winner = -1;
+    int playerCount = 0;
+    int scores[MAX_PLAYERS] = {};
+    ReplicaPlayer players[MAX_PLAYERS] = {};
+    std::vector<ReplicaEnemy> enemies;
+    std::vector<ReplicaBomb> bombs;
+
+    // Server side only: Map::getChangeCount() at this tick, and a grid of
+    // GRID_CELL_TILES square cells listing the enemies in each (as indices
+    // into `enemies`), so that filtering by interest area only visits the
+    // cells the area overlaps.
+    static const int GRID_CELL_TILES = 8;
+    uint32_t mapChanges = 0;
+    int columns = 0;
+    int tileSize = 0;
+    int gridColumns = 0;
+    int gridRows = 0;
+    std::vector<int> cellStarts;
+    std::vector<int> cellEnemies;
+
+    // Reuses the vectors' capacity, so capturing every tick does not
+    // allocate once a match is under way.
+    void capture(const Simulation& simulation);
+
+    // The enemies and bombs inside `area`, in list order. `scratch` holds
+    // enemy indices while the grid is walked.
+    void collect(const InterestArea& area, std::vector<int>& scratch, std::vector<ReplicaEnemy>& enemiesOut,
+        std::vector<ReplicaBomb>& bombsOut) const;
+};
+
+struct ReplicaClient;
+
+// Server side of state replication. Rather than a full snapshot every tick,
+// each client gets the latest state as a bit-packed delta against the last
+// state it acknowledged: tiles changed since then (from the map's change
+// log), position deltas for entities that moved, and the enemies and bombs
+// that entered or left its interest area, died, went off or cleared. A
+// client with no usable acknowledgement gets a keyframe holding the whole
+// state, and every client gets one at least every keyframeInterval ticks
+// regardless.
+//
+// A generation number tells matches apart: when the captured tick does not
+// follow the previous one (a new match, a restored snapshot), acknowledged
+// states stop counting and every client is sent a keyframe next.
+class Replicator {
+public:
+    // Deltas can only be made against states this recent (about a second).
+    static const int HISTORY_SIZE = 64;
+    static const int KEYFRAME_INTERVAL = 5 * TICKS_PER_SECOND;
+
+    Replicator();
+
+    // Records the simulation's current state; call after every step and
+    // reset. The simulation must not change again before the encode() calls
+    // for this tick, which read its map.
+    void capture(const Simulation& simulation);
+
+    // A client has decoded the state of `tick`. Acknowledgements for another
+    // generation, or older than the client's last one, are ignored.
+    void acknowledge(ReplicaClient& client, uint8_t generation, int tick) const;
+
+    // Appends the message for the captured state, filtered by client.area,
+    // to `out` and returns true if it was a keyframe.
+    bool encode(ReplicaClient& client, std::vector<uint8_t>& out);
+
+    uint8_t getGeneration() const { return mGeneration; }
+    const ReplicaFrame& getLatest() const { return mHistory[mLatest]; }
+
+private:
+    const Simulation* mSimulation;
+    ReplicaFrame mHistory[HISTORY_SIZE];
+    int mLatest;
+    uint8_t mGeneration;
+
+    // Filtered views of the current and the base frame for one encode.
+    std::vector<int> mIndices;
+    std::vector<ReplicaEnemy> mEnemyViews[2];
+    std::vector<ReplicaBomb> mBombViews[2];
+
+    const ReplicaFrame* findFrame(int tick) const;
+};
+
+// Replication state the server keeps per client.
+struct ReplicaClient {
+    // Where the client is looking; set before each encode.
+    InterestArea area;
+    int keyframeInterval = Replicator::KEYFRAME_INTERVAL;
+    uint8_t generation = 0;
+    // Newest tick of `generation` the client has acknowledged, -1 for none.
+    int ackedTick = -1;
+    int lastKeyframeTick = -1;
+    // The area each recent message was filtered by, indexed by tick, since a
+    // delta has to know what its base held.
+    InterestArea sentAreas[Replicator::HISTORY_SIZE];
+};
+
+// Client side: rebuilds the state from Replicator messages. It keeps the
+// decoded frames of the last HISTORY_SIZE ticks as delta bases, and the
+// tiles of the newest one.
+class ReplicaDecoder {
+public:
+    ReplicaDecoder();
+
+    // Applies one message. Returns false if it is malformed or a delta whose
+    // base state is not held (the decoder is unchanged then). A message older
+    // than the newest state is ignored and returns true.
+    bool decode(const uint8_t* data, size_t size);
+
+    bool hasState() const { return mLatest >= 0; }
+    const ReplicaFrame& getLatest() const { return mFrames[mLatest]; }
+    // What to acknowledge after a successful decode.
+    uint8_t getGeneration() const { return mGeneration; }
+    int getLatestTick() const { return hasState() ? mFrames[mLatest].tick : -1; }
+
+    int getColumns() const { return mColumns; }
+    int getRows() const { return mRows; }
+    int getTileSize() const { return mTileSize; }
+    // Tiles of the newest state, row by row.
+    const std::vector<TileType>& getTiles() const { return mTiles; }
+
+private:
+    ReplicaFrame mFrames[Replicator::HISTORY_SIZE];
+    int mLatest;
+    uint8_t mGeneration;
+    int mColumns;
+    int mRows;
+    int mTileSize;
+    std::vector<TileType> mTiles;
+    // The message being decoded goes here first and is swapped into the
+    // history once it has all read cleanly; its tile changes likewise.
+    // Entities kept from the base and those new to the client are read
+    // apart, then merged.
+    ReplicaFrame mScratch;
+    std::vector<std::pair<int, TileType>> mPendingTiles;
+    std::vector<ReplicaEnemy> mKeptEnemies;
+    std::vector<ReplicaEnemy> mAddedEnemies;
+    std::vector<ReplicaBomb> mKeptBombs;
+    std::vector<ReplicaBomb> mAddedBombs;
+};
+
+#endif // REPLICATION_H
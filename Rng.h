@@ -0,0 +1,41 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+
+// Small deterministic generator (xorshift64*) owned by each simulation, so a
+// match replays identically from its seed on every platform.
+class Rng {
+public:
+    explicit Rng(uint64_t seed = 1) { reseed(seed); }
+
+    void reseed(uint64_t seed) {
+        // splitmix64 scramble so that nearby seeds give unrelated streams
+        uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        mState = z ^ (z >> 31);
+        if (mState == 0) mState = 0x2545F4914F6CDD1Dull;
+    }
+
+    uint64_t next() {
+        mState ^= mState >> 12;
+        mState ^= mState << 25;
+        mState ^= mState >> 27;
+        return mState * 0x2545F4914F6CDD1Dull;
+    }
+
+    // Uniform integer in [0, bound).
+    int nextInt(int bound) {
+        if (bound <= 1) return 0;
+        return static_cast<int>((next() >> 33) % static_cast<uint64_t>(bound));
+    }
+
+    uint64_t getState() const { return mState; }
+    void setState(uint64_t state) { mState = state ? state : 0x2545F4914F6CDD1Dull; }
+
+private:
+    uint64_t mState;
+};
+
+#endif // RNG_H
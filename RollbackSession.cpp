@@ -0,0 +1,219 @@
+#include "RollbackSession.h"
+#include "ByteStream.h"
+#include "NetTransport.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace {
+    const uint8_t PROTOCOL_VERSION = 2;
+
+    // Peers only accept each other's packets when they agree on the protocol
+    // and on every setting that affects the simulation.
+    uint32_t computeSessionTag(const MatchConfig& config) {
+        std::vector<uint8_t> bytes;
+        ByteWriter writer(bytes);
+        writer.writeU8(PROTOCOL_VERSION);
+        writer.writeVarint(static_cast<uint64_t>(config.columns));
+        writer.writeVarint(static_cast<uint64_t>(config.rows));
+        writer.writeVarint(static_cast<uint64_t>(config.tileSize));
+        writer.writeVarint(static_cast<uint64_t>(config.playerCount));
+        writer.writeVarint(static_cast<uint64_t>(config.enemyCount));
+        writer.writeFloat(config.playerSpeed);
+        writer.writeVarint(static_cast<uint64_t>(config.maxActiveBombs));
+        writer.writeVarint(static_cast<uint64_t>(config.bombRange));
+        writer.writeVarint(static_cast<uint64_t>(config.matchTicks));
+        writer.writeU64(config.seed);
+        writer.writeU8(config.invulnerablePlayers ? 1 : 0);
+
+        uint32_t hash = 2166136261u;
+        for (uint8_t byte : bytes) {
+            hash ^= byte;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+}
+
+RollbackSession::RollbackSession(Simulation& simulation, NetTransport& transport)
+    : mSimulation(simulation),
+    mTransport(transport),
+    mSessionTag(0),
+    mRollbackFrom(NO_ROLLBACK)
+{
+    std::fill(mConfirmed, mConfirmed + MAX_PLAYERS, 0);
+    std::fill(mAcked, mAcked + MAX_PLAYERS, 0);
+}
+
+bool RollbackSession::start(const RollbackConfig& config) {
+    if (config.localPlayer < 0 || config.localPlayer >= config.match.playerCount) {
+        std::cerr << "Rollback Error: Local player " << config.localPlayer << " is not in the match." << std::endl;
+        return false;
+    }
+    if (config.inputDelayTicks < 0 || config.inputDelayTicks > MAX_INPUT_DELAY_TICKS) {
+        std::cerr << "Rollback Error: Input delay must be 0 to " << MAX_INPUT_DELAY_TICKS << " ticks." << std::endl;
+        return false;
+    }
+    if (!mSimulation.reset(config.match)) return false;
+
+    mConfig = config;
+    mSessionTag = computeSessionTag(config.match);
+    mInputs.assign(config.match.matchTicks + MAX_ROLLBACK_TICKS + MAX_INPUT_DELAY_TICKS + 1, TickInput());
+    std::fill(mConfirmed, mConfirmed + MAX_PLAYERS, 0);
+    std::fill(mAcked, mAcked + MAX_PLAYERS, 0);
+    // The first inputDelayTicks local inputs are empty and known to everyone.
+    mConfirmed[config.localPlayer] = config.inputDelayTicks;
+    mRollbackFrom = NO_ROLLBACK;
+    mStats = RollbackStats();
+    mPacket.reserve(NetTransport::MAX_DATAGRAM_SIZE);
+    mReceived.reserve(NetTransport::MAX_DATAGRAM_SIZE);
+    return true;
+}
+
+int RollbackSession::getConfirmedTick() const {
+    int confirmed = INT_MAX;
+    for (int p = 0; p < mConfig.match.playerCount; ++p) confirmed = std::min(confirmed, mConfirmed[p]);
+    return confirmed;
+}
+
+void RollbackSession::poll() {
+    int peer = -1;
+    while (mTransport.receive(peer, mReceived)) {
+        handlePacket(peer, mReceived);
+    }
+    rollback();
+}
+
+bool RollbackSession::advance(uint8_t localButtons) {
+    poll();
+    if (mSimulation.isOver()) {
+        sendInputs();
+        return false;
+    }
+
+    const int tick = getTick();
+    const int local = mConfig.localPlayer;
+    for (int p = 0; p < mConfig.match.playerCount; ++p) {
+        if (p != local && tick - mConfirmed[p] >= MAX_ROLLBACK_TICKS) {
+            ++mStats.stalls;
+            sendInputs();
+            return false;
+        }
+    }
+
+    int localTick = tick + mConfig.inputDelayTicks;
+    if (localTick < static_cast<int>(mInputs.size())) {
+        mInputs[localTick].buttons[local] = localButtons;
+        mConfirmed[local] = localTick + 1;
+    }
+    for (int p = 0; p < mConfig.match.playerCount; ++p) {
+        if (tick >= mConfirmed[p]) mInputs[tick].buttons[p] = predict(p);
+    }
+
+    mSimulation.saveSnapshot(mSnapshots[tick % MAX_ROLLBACK_TICKS]);
+    mSimulation.step(mInputs[tick]);
+    ++mStats.ticks;
+    sendInputs();
+    return true;
+}
+
+void RollbackSession::sendInputs() {
+    const int local = mConfig.localPlayer;
+    const int available = mConfirmed[local];
+    for (int peer = 0; peer < mConfig.match.playerCount; ++peer) {
+        if (peer == local) continue;
+        int first = mAcked[peer];
+        int count = available - first;
+        if (count > MAX_INPUTS_PER_PACKET) count = MAX_INPUTS_PER_PACKET;
+
+        mPacket.clear();
+        ByteWriter writer(mPacket);
+        writer.writeU32(mSessionTag);
+        writer.writeU8(static_cast<uint8_t>(local));
+        writer.writeVarint(static_cast<uint64_t>(mConfirmed[peer]));
+        writer.writeVarint(static_cast<uint64_t>(first));
+        writer.writeU8(static_cast<uint8_t>(count));
+        for (int i = 0; i < count; ++i) writer.writeU8(mInputs[first + i].buttons[local]);
+
+        mTransport.send(peer, mPacket.data(), mPacket.size());
+        ++mStats.packetsSent;
+    }
+}
+
+// Held directions usually stay held, but a bomb press is a single tick.
+uint8_t RollbackSession::predict(int player) const {
+    if (mConfirmed[player] == 0) return 0;
+    return mInputs[mConfirmed[player] - 1].buttons[player] & ~INPUT_BOMB;
+}
+
+void RollbackSession::handlePacket(int peer, const std::vector<uint8_t>& packet) {
+    ByteReader reader(packet.data(), packet.size());
+    uint32_t tag = reader.readU32();
+    int sender = reader.readU8();
+    uint64_t ack = reader.readVarint();
+    uint64_t first = reader.readVarint();
+    int count = reader.readU8();
+    const size_t inputsAt = reader.getPosition();
+    if (!reader.isOk() || tag != mSessionTag || sender != peer || sender == mConfig.localPlayer
+        || sender >= mConfig.match.playerCount || packet.size() - inputsAt != static_cast<size_t>(count)
+        || ack > mInputs.size() || first > mInputs.size()) {
+        ++mStats.packetsRejected;
+        return;
+    }
+    ++mStats.packetsReceived;
+
+    mAcked[sender] = std::max(mAcked[sender], static_cast<int>(std::min<uint64_t>(ack, mConfirmed[mConfig.localPlayer])));
+
+    const int previouslyConfirmed = mConfirmed[sender];
+    for (int i = 0; i < count; ++i) {
+        int tick = static_cast<int>(first) + i;
+        if (tick < mConfirmed[sender]) continue;
+        // A gap means an earlier packet was lost; a later one will resend.
+        if (tick > mConfirmed[sender] || tick >= static_cast<int>(mInputs.size())) break;
+        confirmInput(sender, tick, packet[inputsAt + i]);
+    }
+    if (mConfirmed[sender] == previouslyConfirmed) return;
+
+    // Ticks already simulated past the new confirmations were predicted from
+    // an older input; predict them again and roll back where that changes.
+    const uint8_t prediction = predict(sender);
+    for (int tick = mConfirmed[sender]; tick < getTick(); ++tick) {
+        if (mInputs[tick].buttons[sender] != prediction) {
+            mInputs[tick].buttons[sender] = prediction;
+            mRollbackFrom = std::min(mRollbackFrom, tick);
+        }
+    }
+}
+
+void RollbackSession::confirmInput(int player, int tick, uint8_t buttons) {
+    if (tick < getTick() && mInputs[tick].buttons[player] != buttons) {
+        mRollbackFrom = std::min(mRollbackFrom, tick);
+    }
+    mInputs[tick].buttons[player] = buttons;
+    mConfirmed[player] = tick + 1;
+}
+
+void RollbackSession::rollback() {
+    const int from = mRollbackFrom;
+    mRollbackFrom = NO_ROLLBACK;
+    const int to = getTick();
+    if (from >= to) return;
+
+    PROFILE_SCOPE("net.rollback");
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (!mSimulation.restoreSnapshot(mSnapshots[from % MAX_ROLLBACK_TICKS])) {
+        std::cerr << "Rollback Error: Snapshot for tick " << from << " did not restore." << std::endl;
+        return;
+    }
+    for (int tick = from; tick < to && !mSimulation.isOver(); ++tick) {
+        if (tick > from) mSimulation.saveSnapshot(mSnapshots[tick % MAX_ROLLBACK_TICKS]);
+        mSimulation.step(mInputs[tick]);
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    ++mStats.rollbacks;
+    mStats.resimulatedTicks += to - from;
+    mStats.maxRollbackTicks = std::max(mStats.maxRollbackTicks, to - from);
+    mStats.maxRollbackMs = std::max(mStats.maxRollbackMs, ms);
+}
@@ -0,0 +1,115 @@
+#ifndef ROLLBACK_SESSION_H
+#define ROLLBACK_SESSION_H
+
+#include <climits>
+#include <cstdint>
+#include <vector>
+#include "Simulation.h"
+
+class NetTransport;
+
+struct RollbackConfig {
+    // Every peer must start from the same config, seed included.
+    MatchConfig match;
+    int localPlayer = 0;
+    // Local input is applied this many ticks after it is sampled. Each tick
+    // of delay hides one tick of latency from the other peers, which then
+    // roll back less often, at the cost of responsiveness.
+    int inputDelayTicks = 1;
+};
+
+struct RollbackStats {
+    long long ticks = 0;
+    // advance() calls that could not run a tick because a remote peer fell
+    // MAX_ROLLBACK_TICKS behind.
+    long long stalls = 0;
+    long long rollbacks = 0;
+    long long resimulatedTicks = 0;
+    int maxRollbackTicks = 0;
+    // Restore plus re-simulation time of the most expensive rollback.
+    double maxRollbackMs = 0.0;
+    long long packetsSent = 0;
+    long long packetsReceived = 0;
+    // Malformed packets and packets from another session.
+    long long packetsRejected = 0;
+};
+
+// Rollback netcode for one peer of a 2-8 player match. Every peer runs the
+// full simulation: ticks are stepped at once with remote inputs predicted
+// (the last confirmed buttons, bomb released), and each tick's starting
+// state is kept in a snapshot ring. When a remote input arrives that differs
+// from what was predicted, the simulation is restored to that tick and
+// re-simulated to the present with the corrected inputs.
+//
+// Peers exchange inputs only. Each packet carries every local input the
+// receiver has not acknowledged, plus an acknowledgement of the receiver's
+// own inputs, so a lost packet is repaired by the next one.
+class RollbackSession {
+public:
+    // How far the simulation may run ahead of the oldest unconfirmed remote
+    // input; also the snapshot ring size. A peer that falls further behind
+    // stalls the others rather than forcing a longer rollback.
+    static const int MAX_ROLLBACK_TICKS = 16;
+    static const int MAX_INPUT_DELAY_TICKS = 8;
+    static const int MAX_INPUTS_PER_PACKET = 64;
+
+    RollbackSession(Simulation& simulation, NetTransport& transport);
+
+    // Resets the simulation to the config's match and forgets every input.
+    bool start(const RollbackConfig& config);
+
+    // Reads every waiting packet, then restores and re-simulates if any of
+    // them corrected a predicted input. advance() calls this first.
+    void poll();
+    // Samples the local buttons and runs one tick. Returns false, leaving
+    // the buttons unused, if the match is over or a remote peer is too far
+    // behind to predict for.
+    bool advance(uint8_t localButtons);
+    // Sends each peer the inputs it has not acknowledged. advance() does
+    // this after every tick; call it on frames that do not advance so that
+    // stalled or finished peers still catch up.
+    void sendInputs();
+
+    int getTick() const { return mSimulation.getTick(); }
+    int getLocalPlayer() const { return mConfig.localPlayer; }
+    // Every player's input is known for all ticks before this one.
+    int getConfirmedTick() const;
+    // The match has ended on a tick whose inputs are all confirmed, so no
+    // late packet can change the result.
+    bool isConfirmedOver() const { return mSimulation.isOver() && getConfirmedTick() >= getTick(); }
+    // Inputs for ticks 0 .. getConfirmedTick() - 1 are final and can be
+    // recorded as a replay.
+    const TickInput& getInput(int tick) const { return mInputs[tick]; }
+
+    const RollbackStats& getStats() const { return mStats; }
+
+private:
+    static const int NO_ROLLBACK = INT_MAX;
+
+    Simulation& mSimulation;
+    NetTransport& mTransport;
+    RollbackConfig mConfig;
+    uint32_t mSessionTag;
+
+    // Inputs for every tick of the match, allocated up front. Player p's
+    // inputs are real for ticks below mConfirmed[p] and predicted above.
+    std::vector<TickInput> mInputs;
+    int mConfirmed[MAX_PLAYERS];
+    // How many of our inputs each peer has acknowledged.
+    int mAcked[MAX_PLAYERS];
+    int mRollbackFrom;
+
+    // mSnapshots[t % MAX_ROLLBACK_TICKS] holds the state before tick t.
+    std::vector<uint8_t> mSnapshots[MAX_ROLLBACK_TICKS];
+    std::vector<uint8_t> mPacket;
+    std::vector<uint8_t> mReceived;
+
+    RollbackStats mStats;
+
+    uint8_t predict(int player) const;
+    void handlePacket(int peer, const std::vector<uint8_t>& packet);
+    void confirmInput(int player, int tick, uint8_t buttons);
+    void rollback();
+};
+
+#endif // ROLLBACK_SESSION_H
@@ -0,0 +1,804 @@
+#include "RoomServer.h"
+#include "Profiler.h"
+#include "Replication.h"
+#include "SpectatorRelay.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    const std::chrono::nanoseconds TICK_PERIOD(1000000000LL / TICKS_PER_SECOND);
+    const int MAX_EPOLL_EVENTS = 128;
+    const int EPOLL_TIMEOUT_MS = 50;
+    const int DATAGRAM_BATCH = 64;
+    // Spectator datagrams per sendmmsg call.
+    const int SPECTATOR_BATCH = 256;
+    // Inputs are a handful of bytes; anything longer is not an input.
+    const size_t MAX_INPUT_DATAGRAM = 32;
+    const size_t MAX_TCP_BUFFER = 4096;
+    const int SOCKET_BUFFER_BYTES = 4 * 1024 * 1024;
+
+    uint64_t packAddress(const sockaddr_in& address) {
+        return (static_cast<uint64_t>(address.sin_addr.s_addr) << 16) | address.sin_port;
+    }
+
+    void unpackAddress(uint64_t packed, sockaddr_in& address) {
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = static_cast<uint32_t>(packed >> 16);
+        address.sin_port = static_cast<uint16_t>(packed);
+    }
+
+    bool makeNonBlocking(int fd) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    bool addToEpoll(int epoll, int fd, uint32_t events) {
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = events;
+        event.data.fd = fd;
+        return epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) == 0;
+    }
+
+    double percentile(const std::vector<double>& sorted, double fraction) {
+        if (sorted.empty()) return 0.0;
+        return sorted[static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5)];
+    }
+
+    void storeMax(std::atomic<uint64_t>& target, uint64_t value) {
+        uint64_t current = target.load(std::memory_order_relaxed);
+        while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+}
+
+struct SpectatorViewer {
+    int region;
+    uint64_t address;
+};
+
+// The simulation, replication state and match counter belong to the room's
+// worker. The slots and spectator connections belong to the network thread.
+// Inputs, addresses, acknowledgements and statistics are the atomics in
+// between; the spectators the worker sends to are an immutable list the
+// network thread replaces whenever one joins, leaves or moves.
+struct ServerRoom {
+    uint32_t id = 0;
+    Simulation simulation;
+    uint64_t nextSeed = 0;
+    Replicator replicator;
+    ReplicaClient replicaClients[MAX_PLAYERS];
+    SpectatorRelay relay;
+
+    int slots[MAX_PLAYERS];
+    int clientCount = 0;
+    std::vector<int> spectators;
+    // Read and replaced with std::atomic_load and std::atomic_store.
+    std::shared_ptr<const std::vector<SpectatorViewer>> viewers;
+
+    std::atomic<uint8_t> heldButtons[MAX_PLAYERS];
+    std::atomic<uint8_t> bombPresses[MAX_PLAYERS];
+    // Where to send state; 0 until the player's first input arrives.
+    std::atomic<uint64_t> addresses[MAX_PLAYERS];
+    // Newest state each client decoded: generation << 32 | tick + 1, or 0
+    // until it has one.
+    std::atomic<uint64_t> acks[MAX_PLAYERS];
+    std::atomic<bool> closed;
+
+    std::atomic<uint64_t> ticks;
+    std::atomic<uint64_t> tickNs;
+    std::atomic<uint64_t> maxTickNs;
+    std::atomic<uint64_t> statesSent;
+    std::atomic<uint64_t> bytesSent;
+
+    ServerRoom() : closed(false), ticks(0), tickNs(0), maxTickNs(0), statesSent(0), bytesSent(0) {
+        for (int p = 0; p < MAX_PLAYERS; ++p) {
+            slots[p] = -1;
+            heldButtons[p].store(0);
+            bombPresses[p].store(0);
+            addresses[p].store(0);
+            acks[p].store(0);
+        }
+    }
+};
+
+struct ServerWorker {
+    std::thread thread;
+    std::mutex mutex;
+    // New rooms, handed over under the mutex and adopted at the next tick.
+    std::vector<std::shared_ptr<ServerRoom>> incoming;
+    std::vector<std::shared_ptr<ServerRoom>> rooms;
+    std::atomic<int> roomCount;
+    std::atomic<uint64_t> busyNs;
+    std::atomic<uint64_t> overruns;
+    // Encoding buffers, reused for every room.
+    std::vector<uint8_t> states[MAX_PLAYERS];
+    std::vector<uint8_t> header;
+    std::vector<uint8_t> watched;
+
+    ServerWorker() : roomCount(0), busyNs(0), overruns(0) {}
+};
+
+struct ServerConnection {
+    int fd = -1;
+    std::vector<uint8_t> received;
+    std::shared_ptr<ServerRoom> room;
+    int player = -1;
+    uint32_t token = 0;
+    int lastInputTick = -1;
+    // Spectators watch `region` of `room` instead of holding a slot; the
+    // address is 0 until their first WATCH.
+    bool spectator = false;
+    int region = -1;
+    uint64_t address = 0;
+};
+
+RoomServer::RoomServer(const ServerConfig& config)
+    : mConfig(config),
+    mPort(0),
+    mEpoll(-1),
+    mListenSocket(-1),
+    mUdpSocket(-1),
+    mWakeFd(-1),
+    mStopping(false),
+    mNextRoomId(1),
+    mTokenState(static_cast<uint64_t>(Clock::now().time_since_epoch().count())),
+    mInputsReceived(0)
+{
+}
+
+RoomServer::~RoomServer() {
+    stop();
+    for (auto& worker : mWorkers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+    for (auto& entry : mConnections) close(entry.first);
+    if (mListenSocket >= 0) close(mListenSocket);
+    if (mUdpSocket >= 0) close(mUdpSocket);
+    if (mWakeFd >= 0) close(mWakeFd);
+    if (mEpoll >= 0) close(mEpoll);
+}
+
+bool RoomServer::start() {
+    if (mConfig.match.playerCount < 1 || mConfig.match.playerCount > MAX_PLAYERS) {
+        std::cerr << "Server Error: Rooms must hold 1 to " << MAX_PLAYERS << " players." << std::endl;
+        return false;
+    }
+    Simulation probe;
+    if (!probe.reset(mConfig.match)) {
+        std::cerr << "Server Error: The match config is not playable." << std::endl;
+        return false;
+    }
+
+    mListenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    mUdpSocket = socket(AF_INET, SOCK_DGRAM, 0);
+    mEpoll = epoll_create1(0);
+    mWakeFd = eventfd(0, EFD_NONBLOCK);
+    if (mListenSocket < 0 || mUdpSocket < 0 || mEpoll < 0 || mWakeFd < 0) {
+        std::cerr << "Server Error: Could not create sockets: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    int enabled = 1;
+    setsockopt(mListenSocket, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled));
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(mConfig.port);
+    if (bind(mListenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || listen(mListenSocket, SOMAXCONN) != 0) {
+        std::cerr << "Server Error: Could not listen on TCP port " << mConfig.port << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    // With port 0 the kernel picks the TCP port; UDP then takes the same one.
+    socklen_t length = sizeof(address);
+    getsockname(mListenSocket, reinterpret_cast<sockaddr*>(&address), &length);
+    mPort = ntohs(address.sin_port);
+    if (bind(mUdpSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "Server Error: Could not bind UDP port " << mPort << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    setsockopt(mUdpSocket, SOL_SOCKET, SO_SNDBUF, &SOCKET_BUFFER_BYTES, sizeof(SOCKET_BUFFER_BYTES));
+    setsockopt(mUdpSocket, SOL_SOCKET, SO_RCVBUF, &SOCKET_BUFFER_BYTES, sizeof(SOCKET_BUFFER_BYTES));
+
+    if (!makeNonBlocking(mListenSocket) || !makeNonBlocking(mUdpSocket)
+        || !addToEpoll(mEpoll, mListenSocket, EPOLLIN) || !addToEpoll(mEpoll, mUdpSocket, EPOLLIN)
+        || !addToEpoll(mEpoll, mWakeFd, EPOLLIN)) {
+        std::cerr << "Server Error: Could not set up epoll: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    int workerCount = mConfig.workers > 0 ? mConfig.workers : static_cast<int>(std::thread::hardware_concurrency());
+    if (workerCount < 1) workerCount = 1;
+    for (int i = 0; i < workerCount; ++i) {
+        mWorkers.push_back(std::unique_ptr<ServerWorker>(new ServerWorker()));
+    }
+    for (auto& worker : mWorkers) {
+        ServerWorker* owner = worker.get();
+        worker->thread = std::thread([this, owner]() { runWorker(*owner); });
+    }
+    return true;
+}
+
+void RoomServer::run(double reportSeconds, void (*onReport)(const ServerReport&)) {
+    epoll_event events[MAX_EPOLL_EVENTS];
+    Clock::time_point lastReport = Clock::now();
+    while (!mStopping.load()) {
+        int count = epoll_wait(mEpoll, events, MAX_EPOLL_EVENTS, EPOLL_TIMEOUT_MS);
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == mListenSocket) {
+                acceptConnections();
+            }
+            else if (fd == mUdpSocket) {
+                receiveDatagrams();
+            }
+            else if (fd == mWakeFd) {
+                uint64_t value;
+                while (read(mWakeFd, &value, sizeof(value)) > 0) {}
+                sendMatchResults();
+            }
+            else {
+                auto found = mConnections.find(fd);
+                if (found != mConnections.end()) readConnection(*found->second);
+            }
+        }
+
+        double elapsed = std::chrono::duration<double>(Clock::now() - lastReport).count();
+        if (onReport && reportSeconds > 0.0 && elapsed >= reportSeconds) {
+            onReport(collectReport(elapsed));
+            lastReport = Clock::now();
+        }
+    }
+
+    for (auto& worker : mWorkers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+void RoomServer::acceptConnections() {
+    while (true) {
+        int fd = accept4(mListenSocket, nullptr, nullptr, SOCK_NONBLOCK);
+        if (fd < 0) return;
+        int enabled = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+        if (!addToEpoll(mEpoll, fd, EPOLLIN | EPOLLRDHUP)) {
+            close(fd);
+            continue;
+        }
+        std::unique_ptr<ServerConnection> connection(new ServerConnection());
+        connection->fd = fd;
+        mConnections[fd] = std::move(connection);
+    }
+}
+
+void RoomServer::readConnection(ServerConnection& connection) {
+    uint8_t buffer[1024];
+    while (true) {
+        ssize_t received = recv(connection.fd, buffer, sizeof(buffer), 0);
+        if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            closeConnection(connection.fd);
+            return;
+        }
+        if (received < 0) break;
+        connection.received.insert(connection.received.end(), buffer, buffer + received);
+        if (connection.received.size() > MAX_TCP_BUFFER) {
+            closeConnection(connection.fd);
+            return;
+        }
+    }
+
+    size_t consumed = 0;
+    size_t length = 0;
+    while (true) {
+        FrameStatus status = findFrame(connection.received.data() + consumed, connection.received.size() - consumed, length);
+        if (status == FrameStatus::INCOMPLETE) break;
+        if (status == FrameStatus::INVALID
+            || !handleFrame(connection, connection.received.data() + consumed + FRAME_HEADER_SIZE, length)) {
+            closeConnection(connection.fd);
+            return;
+        }
+        consumed += FRAME_HEADER_SIZE + length;
+    }
+    connection.received.erase(connection.received.begin(), connection.received.begin() + consumed);
+}
+
+// Returns false to drop the connection.
+bool RoomServer::handleFrame(ServerConnection& connection, const uint8_t* message, size_t length) {
+    ByteReader reader(message, length);
+    ServerMessage type = static_cast<ServerMessage>(reader.readU8());
+    if (type != ServerMessage::JOIN && type != ServerMessage::SPECTATE) return false;
+    uint8_t version = reader.readU8();
+    uint64_t roomId = reader.readVarint();
+    uint64_t region = type == ServerMessage::SPECTATE ? reader.readVarint() : 0;
+    if (!reader.isOk() || version != SERVER_PROTOCOL_VERSION || roomId > UINT32_MAX || region > UINT32_MAX || connection.room) {
+        return false;
+    }
+    if (type == ServerMessage::SPECTATE) return spectate(connection, static_cast<uint32_t>(roomId), static_cast<uint32_t>(region));
+    return join(connection, static_cast<uint32_t>(roomId));
+}
+
+// Seats the connection in the requested room, or in any room with a free
+// slot, creating the room if needed. Returns false if the client was
+// refused or could not be told it joined.
+bool RoomServer::join(ServerConnection& connection, uint32_t roomId) {
+    std::shared_ptr<ServerRoom> room;
+    if (roomId != 0) {
+        auto found = mRooms.find(roomId);
+        if (found != mRooms.end()) room = found->second;
+    }
+    else {
+        for (auto& entry : mRooms) {
+            if (entry.second->clientCount < mConfig.match.playerCount) {
+                room = entry.second;
+                break;
+            }
+        }
+    }
+
+    if (!room && static_cast<int>(mRooms.size()) < mConfig.maxRooms) {
+        if (roomId == 0) {
+            while (mRooms.count(mNextRoomId)) ++mNextRoomId;
+            roomId = mNextRoomId++;
+        }
+        room = std::make_shared<ServerRoom>();
+        room->id = roomId;
+        room->nextSeed = mConfig.match.seed + roomId;
+        MatchConfig match = mConfig.match;
+        match.seed = room->nextSeed++;
+        room->simulation.reset(match);
+        const Map& map = room->simulation.getMap();
+        room->relay.configure(map.getColumns(), map.getRows(), map.getTileSize(), mConfig.interestColumns, mConfig.interestRows);
+        mRooms[roomId] = room;
+
+        ServerWorker* target = mWorkers[0].get();
+        for (auto& worker : mWorkers) {
+            if (worker->roomCount.load() < target->roomCount.load()) target = worker.get();
+        }
+        target->roomCount.fetch_add(1);
+        std::lock_guard<std::mutex> lock(target->mutex);
+        target->incoming.push_back(room);
+    }
+
+    std::vector<uint8_t> reply;
+    if (!room || room->clientCount >= mConfig.match.playerCount) {
+        appendFrame(reply, ServerMessage::JOIN_REFUSED, [](ByteWriter&) {});
+        send(connection.fd, reply.data(), reply.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+        return false;
+    }
+
+    int player = 0;
+    while (room->slots[player] >= 0) ++player;
+    room->slots[player] = connection.fd;
+    ++room->clientCount;
+    room->heldButtons[player].store(0);
+    room->bombPresses[player].store(0);
+    room->addresses[player].store(0);
+    room->acks[player].store(0);
+
+    connection.room = room;
+    connection.player = player;
+    connection.token = nextToken();
+    connection.lastInputTick = -1;
+    mConnectionsByToken[connection.token] = &connection;
+
+    const uint32_t token = connection.token;
+    const uint16_t port = mPort;
+    appendFrame(reply, ServerMessage::JOINED, [&](ByteWriter& writer) {
+        writer.writeVarint(room->id);
+        writer.writeU8(static_cast<uint8_t>(player));
+        writer.writeU32(token);
+        writer.writeU16(port);
+    });
+    return send(connection.fd, reply.data(), reply.size(), MSG_NOSIGNAL | MSG_DONTWAIT) == static_cast<ssize_t>(reply.size());
+}
+
+// Adds the connection to a room's spectators. The worker starts sending to
+// it once its WATCH gives the address. Returns false as join() does.
+bool RoomServer::spectate(ServerConnection& connection, uint32_t roomId, uint32_t region) {
+    std::shared_ptr<ServerRoom> room;
+    if (roomId != 0) {
+        auto found = mRooms.find(roomId);
+        if (found != mRooms.end()) room = found->second;
+    }
+    else if (!mRooms.empty()) {
+        room = mRooms.begin()->second;
+    }
+
+    std::vector<uint8_t> reply;
+    if (!room || static_cast<int>(room->spectators.size()) >= mConfig.maxSpectatorsPerRoom) {
+        appendFrame(reply, ServerMessage::JOIN_REFUSED, [](ByteWriter&) {});
+        send(connection.fd, reply.data(), reply.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+        return false;
+    }
+
+    const int regionCount = room->relay.getRegionCount();
+    room->spectators.push_back(connection.fd);
+    connection.room = room;
+    connection.spectator = true;
+    connection.region = static_cast<int>(region % static_cast<uint32_t>(regionCount));
+    connection.address = 0;
+    connection.token = nextToken();
+    mConnectionsByToken[connection.token] = &connection;
+
+    const uint32_t token = connection.token;
+    const uint16_t port = mPort;
+    const int watched = connection.region;
+    appendFrame(reply, ServerMessage::SPECTATING, [&](ByteWriter& writer) {
+        writer.writeVarint(room->id);
+        writer.writeVarint(static_cast<uint64_t>(watched));
+        writer.writeVarint(static_cast<uint64_t>(regionCount));
+        writer.writeU32(token);
+        writer.writeU16(port);
+    });
+    return send(connection.fd, reply.data(), reply.size(), MSG_NOSIGNAL | MSG_DONTWAIT) == static_cast<ssize_t>(reply.size());
+}
+
+// Replaces the list the room's worker sends spectator streams to. The
+// worker keeps using the old list until its next tick, and the last
+// reference frees it.
+void RoomServer::publishViewers(ServerRoom& room) {
+    std::shared_ptr<std::vector<SpectatorViewer>> viewers = std::make_shared<std::vector<SpectatorViewer>>();
+    viewers->reserve(room.spectators.size());
+    for (int fd : room.spectators) {
+        const ServerConnection& connection = *mConnections[fd];
+        if (connection.address != 0) viewers->push_back({ connection.region, connection.address });
+    }
+    // Grouped by region, so the worker sends each stream in a run.
+    std::sort(viewers->begin(), viewers->end(),
+        [](const SpectatorViewer& a, const SpectatorViewer& b) { return a.region < b.region; });
+    std::atomic_store(&room.viewers, std::shared_ptr<const std::vector<SpectatorViewer>>(std::move(viewers)));
+}
+
+void RoomServer::closeConnection(int fd) {
+    auto found = mConnections.find(fd);
+    if (found == mConnections.end()) return;
+    ServerConnection& connection = *found->second;
+    std::vector<int> orphans;
+    if (connection.room && connection.spectator) {
+        ServerRoom& room = *connection.room;
+        room.spectators.erase(std::find(room.spectators.begin(), room.spectators.end(), fd));
+        mConnectionsByToken.erase(connection.token);
+        if (connection.address != 0) publishViewers(room);
+    }
+    else if (connection.room) {
+        ServerRoom& room = *connection.room;
+        room.slots[connection.player] = -1;
+        room.addresses[connection.player].store(0);
+        room.heldButtons[connection.player].store(0);
+        --room.clientCount;
+        mConnectionsByToken.erase(connection.token);
+        if (room.clientCount == 0) {
+            room.closed.store(true);
+            mRooms.erase(room.id);
+            orphans.swap(room.spectators);
+        }
+    }
+    epoll_ctl(mEpoll, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    mConnections.erase(found);
+    // Spectators of a closed room have nothing left to watch.
+    for (int orphan : orphans) closeConnection(orphan);
+}
+
+void RoomServer::receiveDatagrams() {
+    uint8_t buffers[DATAGRAM_BATCH][MAX_INPUT_DATAGRAM];
+    sockaddr_in addresses[DATAGRAM_BATCH];
+    iovec vectors[DATAGRAM_BATCH];
+    mmsghdr messages[DATAGRAM_BATCH];
+    while (true) {
+        for (int i = 0; i < DATAGRAM_BATCH; ++i) {
+            vectors[i].iov_base = buffers[i];
+            vectors[i].iov_len = MAX_INPUT_DATAGRAM;
+            std::memset(&messages[i], 0, sizeof(messages[i]));
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_name = &addresses[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+        }
+        int count = recvmmsg(mUdpSocket, messages, DATAGRAM_BATCH, MSG_DONTWAIT, nullptr);
+        if (count <= 0) return;
+
+        for (int i = 0; i < count; ++i) {
+            if (messages[i].msg_hdr.msg_flags & MSG_TRUNC) continue;
+            ByteReader reader(buffers[i], messages[i].msg_len);
+            ServerMessage type = static_cast<ServerMessage>(reader.readU8());
+            uint32_t token = reader.readU32();
+            if (!reader.isOk()) continue;
+            auto found = mConnectionsByToken.find(token);
+            if (found == mConnectionsByToken.end()) continue;
+            ServerConnection& connection = *found->second;
+
+            if (type == ServerMessage::WATCH && connection.spectator) {
+                uint64_t address = packAddress(addresses[i]);
+                if (address != connection.address) {
+                    connection.address = address;
+                    publishViewers(*connection.room);
+                }
+                continue;
+            }
+            uint64_t tick = reader.readVarint();
+            uint8_t buttons = reader.readU8();
+            uint8_t generation = reader.readU8();
+            uint64_t ack = reader.readVarint();
+            if (!reader.isOk() || type != ServerMessage::INPUT || connection.spectator || tick > INT32_MAX || ack > INT32_MAX) continue;
+            if (static_cast<int>(tick) <= connection.lastInputTick) continue;
+            connection.lastInputTick = static_cast<int>(tick);
+
+            ServerRoom& room = *connection.room;
+            room.addresses[connection.player].store(packAddress(addresses[i]), std::memory_order_relaxed);
+            room.acks[connection.player].store((static_cast<uint64_t>(generation) << 32) | ack, std::memory_order_relaxed);
+            room.heldButtons[connection.player].store(buttons & ~INPUT_BOMB, std::memory_order_relaxed);
+            if (buttons & INPUT_BOMB) room.bombPresses[connection.player].store(INPUT_BOMB, std::memory_order_relaxed);
+            ++mInputsReceived;
+        }
+        if (count < DATAGRAM_BATCH) return;
+    }
+}
+
+void RoomServer::postMatchResult(uint32_t room, int tick, MatchOutcome outcome, int winner) {
+    {
+        std::lock_guard<std::mutex> lock(mResultsMutex);
+        mResults.push_back({ room, tick, outcome, winner });
+    }
+    uint64_t one = 1;
+    ssize_t written = write(mWakeFd, &one, sizeof(one));
+    (void)written;
+}
+
+void RoomServer::sendMatchResults() {
+    std::vector<MatchResult> results;
+    {
+        std::lock_guard<std::mutex> lock(mResultsMutex);
+        results.swap(mResults);
+    }
+    std::vector<uint8_t> frame;
+    std::vector<int> failed;
+    for (const auto& result : results) {
+        auto found = mRooms.find(result.room);
+        if (found == mRooms.end()) continue;
+        frame.clear();
+        appendFrame(frame, ServerMessage::MATCH_OVER, [&result](ByteWriter& writer) {
+            writer.writeVarint(result.room);
+            writer.writeVarint(static_cast<uint64_t>(result.tick));
+            writer.writeU8(static_cast<uint8_t>(result.outcome));
+            writer.writeSignedVarint(result.winner);
+        });
+        const ServerRoom& room = *found->second;
+        for (int fd : room.slots) {
+            if (fd < 0) continue;
+            if (send(fd, frame.data(), frame.size(), MSG_NOSIGNAL | MSG_DONTWAIT) != static_cast<ssize_t>(frame.size())) {
+                failed.push_back(fd);
+            }
+        }
+        for (int fd : room.spectators) {
+            if (send(fd, frame.data(), frame.size(), MSG_NOSIGNAL | MSG_DONTWAIT) != static_cast<ssize_t>(frame.size())) {
+                failed.push_back(fd);
+            }
+        }
+    }
+    // A client too slow to take a few bytes of TCP is dropped.
+    for (int fd : failed) closeConnection(fd);
+}
+
+ServerReport RoomServer::collectReport(double seconds) {
+    ServerReport report;
+    report.seconds = seconds;
+    report.rooms = static_cast<int>(mRooms.size());
+
+    std::vector<double> roomTickUs;
+    roomTickUs.reserve(mRooms.size());
+    double totalUs = 0.0;
+    for (auto& entry : mRooms) {
+        ServerRoom& room = *entry.second;
+        report.clients += room.clientCount;
+        report.spectators += static_cast<int>(room.spectators.size());
+        uint64_t ticks = room.ticks.exchange(0);
+        uint64_t tickNs = room.tickNs.exchange(0);
+        uint64_t maxTickNs = room.maxTickNs.exchange(0);
+        report.ticks += static_cast<long long>(ticks);
+        report.statesSent += static_cast<long long>(room.statesSent.exchange(0));
+        report.bytesSent += static_cast<long long>(room.bytesSent.exchange(0));
+        if (ticks == 0) continue;
+        double meanUs = tickNs / 1000.0 / ticks;
+        roomTickUs.push_back(meanUs);
+        totalUs += meanUs;
+        report.maxRoomTickUs = std::max(report.maxRoomTickUs, maxTickNs / 1000.0);
+    }
+    std::sort(roomTickUs.begin(), roomTickUs.end());
+    if (!roomTickUs.empty()) report.meanRoomTickUs = totalUs / roomTickUs.size();
+    report.p99RoomTickUs = percentile(roomTickUs, 0.99);
+
+    uint64_t busyNs = 0;
+    for (auto& worker : mWorkers) {
+        busyNs += worker->busyNs.exchange(0);
+        report.overruns += static_cast<long long>(worker->overruns.exchange(0));
+    }
+    report.workerBusy = seconds > 0.0 ? busyNs / (seconds * 1e9 * mWorkers.size()) : 0.0;
+    report.inputsReceived = mInputsReceived;
+    mInputsReceived = 0;
+    return report;
+}
+
+// Ticks every room of the worker at 60 Hz on an absolute schedule. A worker
+// that falls a full period behind skips the missed ticks instead of
+// bursting to catch up, and counts an overrun.
+void RoomServer::runWorker(ServerWorker& worker) {
+    Clock::time_point next = Clock::now();
+    while (!mStopping.load(std::memory_order_relaxed)) {
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            for (auto& room : worker.incoming) worker.rooms.push_back(std::move(room));
+            worker.incoming.clear();
+        }
+        size_t before = worker.rooms.size();
+        worker.rooms.erase(std::remove_if(worker.rooms.begin(), worker.rooms.end(),
+            [](const std::shared_ptr<ServerRoom>& room) { return room->closed.load(); }), worker.rooms.end());
+        if (worker.rooms.size() != before) worker.roomCount.fetch_sub(static_cast<int>(before - worker.rooms.size()));
+
+        Clock::time_point start = Clock::now();
+        {
+            PROFILE_SCOPE("server.tick");
+            for (auto& room : worker.rooms) tickRoom(worker, *room);
+        }
+        Clock::time_point end = Clock::now();
+        worker.busyNs.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()),
+            std::memory_order_relaxed);
+
+        next += TICK_PERIOD;
+        if (end - next >= TICK_PERIOD) {
+            worker.overruns.fetch_add(1, std::memory_order_relaxed);
+            next = end;
+        }
+        std::this_thread::sleep_until(next);
+    }
+}
+
+// Encodes each watched region's stream once, then points every viewer's
+// datagram at the shared header and that stream rather than copying them.
+void RoomServer::sendSpectatorStates(ServerWorker& worker, ServerRoom& room) {
+    std::shared_ptr<const std::vector<SpectatorViewer>> viewers = std::atomic_load(&room.viewers);
+    if (!viewers || viewers->empty()) return;
+    worker.watched.assign(static_cast<size_t>(room.relay.getRegionCount()), 0);
+    for (const auto& viewer : *viewers) worker.watched[viewer.region] = 1;
+    room.relay.update(room.replicator, worker.watched);
+
+    const std::vector<uint8_t>& header = worker.header;
+    sockaddr_in addresses[SPECTATOR_BATCH];
+    iovec vectors[SPECTATOR_BATCH][2];
+    mmsghdr messages[SPECTATOR_BATCH];
+    size_t next = 0;
+    while (next < viewers->size()) {
+        int count = 0;
+        size_t bytes = 0;
+        for (; count < SPECTATOR_BATCH && next < viewers->size(); ++count, ++next) {
+            const SpectatorViewer& viewer = (*viewers)[next];
+            const std::vector<uint8_t>& stream = room.relay.getStream(viewer.region);
+            unpackAddress(viewer.address, addresses[count]);
+            vectors[count][0].iov_base = const_cast<uint8_t*>(header.data());
+            vectors[count][0].iov_len = header.size();
+            vectors[count][1].iov_base = const_cast<uint8_t*>(stream.data());
+            vectors[count][1].iov_len = stream.size();
+            std::memset(&messages[count], 0, sizeof(messages[count]));
+            messages[count].msg_hdr.msg_name = &addresses[count];
+            messages[count].msg_hdr.msg_namelen = sizeof(addresses[count]);
+            messages[count].msg_hdr.msg_iov = vectors[count];
+            messages[count].msg_hdr.msg_iovlen = 2;
+            bytes += header.size() + stream.size();
+        }
+        // A full socket buffer drops the rest of this tick's batch; viewers
+        // recover at their stream's next keyframe.
+        int sent = sendmmsg(mUdpSocket, messages, count, MSG_DONTWAIT);
+        if (sent <= 0) break;
+        room.statesSent.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+        room.bytesSent.fetch_add(sent == count ? bytes : bytes * sent / count, std::memory_order_relaxed);
+        if (sent < count) break;
+    }
+}
+
+void RoomServer::tickRoom(ServerWorker& worker, ServerRoom& room) {
+    Clock::time_point start = Clock::now();
+    Simulation& simulation = room.simulation;
+
+    TickInput input;
+    for (int p = 0; p < mConfig.match.playerCount; ++p) {
+        input.buttons[p] = room.heldButtons[p].load(std::memory_order_relaxed)
+            | room.bombPresses[p].exchange(0, std::memory_order_relaxed);
+    }
+    simulation.step(input);
+    if (simulation.isOver()) {
+        postMatchResult(room.id, simulation.getTick(), simulation.getOutcome(), simulation.getWinner());
+        MatchConfig match = mConfig.match;
+        match.seed = room.nextSeed++;
+        simulation.reset(match);
+    }
+
+    // The state is captured once per room and encoded per client against
+    // what that client last acknowledged and for the area around its
+    // player; every datagram goes out in a single sendmmsg behind a shared
+    // header.
+    room.replicator.capture(simulation);
+    const int tileSize = simulation.getMap().getTileSize();
+    std::vector<uint8_t>& header = worker.header;
+    header.clear();
+    ByteWriter writer(header);
+    writer.writeU8(static_cast<uint8_t>(ServerMessage::STATE));
+    writer.writeVarint(room.id);
+    writer.writeVarint(static_cast<uint64_t>(simulation.getTick()));
+
+    sockaddr_in addresses[MAX_PLAYERS];
+    iovec vectors[MAX_PLAYERS][2];
+    mmsghdr messages[MAX_PLAYERS];
+    size_t datagramBytes[MAX_PLAYERS];
+    int count = 0;
+    for (int p = 0; p < mConfig.match.playerCount; ++p) {
+        ReplicaClient& client = room.replicaClients[p];
+        uint64_t packed = room.addresses[p].load(std::memory_order_relaxed);
+        uint64_t ack = room.acks[p].load(std::memory_order_relaxed);
+        // No acknowledgement yet may also mean a new client in the slot.
+        if (packed == 0 || ack == 0) client = ReplicaClient();
+        if (packed == 0) continue;
+        if (ack != 0) {
+            room.replicator.acknowledge(client, static_cast<uint8_t>(ack >> 32), static_cast<int>(static_cast<uint32_t>(ack)) - 1);
+        }
+        if (mConfig.interestColumns > 0 && mConfig.interestRows > 0) {
+            const Player& player = simulation.getPlayers()[p];
+            client.area = InterestArea::centredOn(player.getX(), player.getY(), mConfig.interestColumns * tileSize,
+                mConfig.interestRows * tileSize);
+        }
+        std::vector<uint8_t>& state = worker.states[count];
+        state.clear();
+        room.replicator.encode(client, state);
+        datagramBytes[count] = header.size() + state.size();
+
+        unpackAddress(packed, addresses[count]);
+        vectors[count][0].iov_base = header.data();
+        vectors[count][0].iov_len = header.size();
+        vectors[count][1].iov_base = state.data();
+        vectors[count][1].iov_len = state.size();
+        std::memset(&messages[count], 0, sizeof(messages[count]));
+        messages[count].msg_hdr.msg_name = &addresses[count];
+        messages[count].msg_hdr.msg_namelen = sizeof(addresses[count]);
+        messages[count].msg_hdr.msg_iov = vectors[count];
+        messages[count].msg_hdr.msg_iovlen = 2;
+        ++count;
+    }
+    int sent = count > 0 ? sendmmsg(mUdpSocket, messages, count, MSG_DONTWAIT) : 0;
+    if (sent > 0) {
+        size_t bytes = 0;
+        for (int i = 0; i < sent; ++i) bytes += datagramBytes[i];
+        room.statesSent.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+        room.bytesSent.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    sendSpectatorStates(worker, room);
+
+    uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    room.ticks.fetch_add(1, std::memory_order_relaxed);
+    room.tickNs.fetch_add(ns, std::memory_order_relaxed);
+    storeMax(room.maxTickNs, ns);
+}
+
+uint32_t RoomServer::nextToken() {
+    while (true) {
+        uint64_t z = (mTokenState += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        uint32_t token = static_cast<uint32_t>(z ^ (z >> 31));
+        if (token != 0 && !mConnectionsByToken.count(token)) return token;
+    }
+}
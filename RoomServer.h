@@ -0,0 +1,131 @@
+#ifndef ROOM_SERVER_H
+#define ROOM_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Simulation.h"
+#include "ServerProtocol.h"
+
+struct ServerConfig {
+    uint16_t port = DEFAULT_SERVER_PORT;
+    // 0 uses every hardware thread.
+    int workers = 0;
+    // Every room plays this match; playerCount is the room size. The seed
+    // of a room's first match is match.seed + room id, and each further
+    // match adds one.
+    MatchConfig match;
+    int maxRooms = 4096;
+    // Size in tiles of the area around its player each client is sent
+    // enemies and bombs for, and of the regions spectators pick from; 0
+    // sends the whole map.
+    int interestColumns = 0;
+    int interestRows = 0;
+    int maxSpectatorsPerRoom = 1024;
+};
+
+// One reporting interval, summed over every room and worker.
+struct ServerReport {
+    double seconds = 0.0;
+    int rooms = 0;
+    int clients = 0;
+    int spectators = 0;
+    long long ticks = 0;
+    // Per-room cost of one tick (simulation step plus encoding and sending
+    // state), from each room's mean over the interval.
+    double meanRoomTickUs = 0.0;
+    double p99RoomTickUs = 0.0;
+    double maxRoomTickUs = 0.0;
+    // Share of wall time the workers spent ticking rooms.
+    double workerBusy = 0.0;
+    // Ticks a worker started late by a full tick period or more.
+    long long overruns = 0;
+    long long inputsReceived = 0;
+    // Both include the datagrams sent to spectators.
+    long long statesSent = 0;
+    long long bytesSent = 0;
+};
+
+struct ServerRoom;
+struct ServerWorker;
+struct ServerConnection;
+
+// Authoritative server for many independent rooms, with no SDL. One network
+// thread owns every socket through epoll: TCP for joining and match
+// results, UDP for inputs and state. Rooms are spread over a pool of worker
+// threads; each worker ticks all of its rooms on a fixed 60 Hz schedule,
+// taking the latest input of each player and sending every client the new
+// state as a delta against the last one it acknowledged (see Replicator),
+// and every spectator its region's stream (see SpectatorRelay). Network
+// thread and workers share only per-room atomics, each room's published
+// list of spectators, and a queue of match results.
+class RoomServer {
+public:
+    explicit RoomServer(const ServerConfig& config);
+    ~RoomServer();
+
+    RoomServer(const RoomServer&) = delete;
+    RoomServer& operator=(const RoomServer&) = delete;
+
+    // Binds the TCP and UDP sockets and starts the workers.
+    bool start();
+    // Serves on the calling thread until stop(), calling `onReport` every
+    // `reportSeconds` (if given). Stops the workers before returning.
+    void run(double reportSeconds, void (*onReport)(const ServerReport&));
+    // Safe to call from a signal handler or another thread.
+    void stop() { mStopping.store(true); }
+
+    uint16_t getPort() const { return mPort; }
+
+private:
+    ServerConfig mConfig;
+    uint16_t mPort;
+    int mEpoll;
+    int mListenSocket;
+    int mUdpSocket;
+    // Workers signal finished matches through this eventfd.
+    int mWakeFd;
+    std::atomic<bool> mStopping;
+
+    std::vector<std::unique_ptr<ServerWorker>> mWorkers;
+    std::unordered_map<uint32_t, std::shared_ptr<ServerRoom>> mRooms;
+    uint32_t mNextRoomId;
+    std::unordered_map<int, std::unique_ptr<ServerConnection>> mConnections;
+    std::unordered_map<uint32_t, ServerConnection*> mConnectionsByToken;
+    uint64_t mTokenState;
+
+    struct MatchResult {
+        uint32_t room;
+        int tick;
+        MatchOutcome outcome;
+        int winner;
+    };
+    std::mutex mResultsMutex;
+    std::vector<MatchResult> mResults;
+
+    long long mInputsReceived;
+
+    void acceptConnections();
+    void readConnection(ServerConnection& connection);
+    bool handleFrame(ServerConnection& connection, const uint8_t* message, size_t length);
+    bool join(ServerConnection& connection, uint32_t roomId);
+    bool spectate(ServerConnection& connection, uint32_t roomId, uint32_t region);
+    void publishViewers(ServerRoom& room);
+    void closeConnection(int fd);
+    void receiveDatagrams();
+    void sendMatchResults();
+    void postMatchResult(uint32_t room, int tick, MatchOutcome outcome, int winner);
+    ServerReport collectReport(double seconds);
+
+    void runWorker(ServerWorker& worker);
+    void tickRoom(ServerWorker& worker, ServerRoom& room);
+    void sendSpectatorStates(ServerWorker& worker, ServerRoom& room);
+
+    uint32_t nextToken();
+};
+
+#endif // ROOM_SERVER_H
@@ -0,0 +1,86 @@
+#include "SdlRenderer.h"
+#include "Counters.h"
+#include <iostream>
+
+SdlRenderer::SdlRenderer(SDL_Renderer* renderer)
+    : mRenderer(renderer)
+{
+    if (!mRenderer) {
+        std::cerr << "SdlRenderer Error: SDL renderer is null!" << std::endl;
+    }
+}
+
+SdlRenderer::SdlRenderer()
+    : mRenderer(nullptr)
+{
+}
+
+Texture* SdlRenderer::createTextureFromSurface(SDL_Surface* surface) {
+    if (!mRenderer || !surface) return nullptr;
+    SDL_Texture* handle = SDL_CreateTextureFromSurface(mRenderer, surface);
+    if (!handle) {
+        std::cerr << "SdlRenderer Error: SDL_CreateTextureFromSurface failed. SDL_Error: " << SDL_GetError() << std::endl;
+        return nullptr;
+    }
+    COUNTER_ADD(Counter::TEXTURES_CREATED, 1);
+    Texture* texture = new Texture();
+    texture->handle = handle;
+    SDL_QueryTexture(handle, nullptr, nullptr, &texture->width, &texture->height);
+    return texture;
+}
+
+void SdlRenderer::destroyTexture(Texture* texture) {
+    if (!texture) return;
+    if (texture->handle) {
+        SDL_DestroyTexture(texture->handle);
+        COUNTER_ADD(Counter::TEXTURES_DESTROYED, 1);
+    }
+    delete texture;
+}
+
+Texture* SdlRenderer::createRenderTarget(int width, int height) {
+    if (!mRenderer || !SDL_RenderTargetSupported(mRenderer)) return nullptr;
+    SDL_Texture* handle = SDL_CreateTexture(mRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!handle) {
+        std::cerr << "SdlRenderer Error: SDL_CreateTexture (target) failed. SDL_Error: " << SDL_GetError() << std::endl;
+        return nullptr;
+    }
+    COUNTER_ADD(Counter::TEXTURES_CREATED, 1);
+    Texture* texture = new Texture();
+    texture->handle = handle;
+    texture->width = width;
+    texture->height = height;
+    return texture;
+}
+
+bool SdlRenderer::setRenderTarget(Texture* target) {
+    if (!mRenderer) return false;
+    return SDL_SetRenderTarget(mRenderer, target ? target->handle : nullptr) == 0;
+}
+
+void SdlRenderer::setDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+    SDL_SetRenderDrawColor(mRenderer, r, g, b, a);
+}
+
+void SdlRenderer::setBlendMode(SDL_BlendMode mode) {
+    SDL_SetRenderDrawBlendMode(mRenderer, mode);
+}
+
+void SdlRenderer::clear() {
+    SDL_RenderClear(mRenderer);
+}
+
+void SdlRenderer::copy(Texture* texture, const SDL_Rect* srcRect, const SDL_Rect* destRect) {
+    if (!texture || !texture->handle) return;
+    SDL_RenderCopy(mRenderer, texture->handle, srcRect, destRect);
+    COUNTER_ADD(Counter::DRAW_CALLS, 1);
+}
+
+void SdlRenderer::fillRect(const SDL_Rect* rect) {
+    SDL_RenderFillRect(mRenderer, rect);
+    COUNTER_ADD(Counter::DRAW_CALLS, 1);
+}
+
+void SdlRenderer::present() {
+    SDL_RenderPresent(mRenderer);
+}
@@ -0,0 +1,33 @@
+#ifndef SDL_RENDERER_BACKEND_H
+#define SDL_RENDERER_BACKEND_H
+
+#include "Renderer.h"
+
+class SdlRenderer : public Renderer {
+public:
+    explicit SdlRenderer(SDL_Renderer* renderer);
+    // For when the SDL renderer is created later, during startup; attach it
+    // before anything is drawn or uploaded.
+    SdlRenderer();
+    void attach(SDL_Renderer* renderer) { mRenderer = renderer; }
+
+    Texture* createTextureFromSurface(SDL_Surface* surface) override;
+    void destroyTexture(Texture* texture) override;
+
+    Texture* createRenderTarget(int width, int height) override;
+    bool setRenderTarget(Texture* target) override;
+
+    void setDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a) override;
+    void setBlendMode(SDL_BlendMode mode) override;
+    void clear() override;
+    void copy(Texture* texture, const SDL_Rect* srcRect, const SDL_Rect* destRect) override;
+    void fillRect(const SDL_Rect* rect) override;
+    void present() override;
+
+    SDL_Renderer* getSdlRenderer() const { return mRenderer; }
+
+private:
+    SDL_Renderer* mRenderer;
+};
+
+#endif // SDL_RENDERER_BACKEND_H
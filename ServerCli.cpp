@@ -0,0 +1,98 @@
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
+#include "RoomServer.h"
+
+// Dedicated headless server: no SDL, no window, no audio. Hosts rooms of
+// --players clients each, created as clients join and closed when the last
+// one leaves; every room restarts its match as soon as one ends.
+//
+//   bomberman_server [--port P] [--workers N] [--players P] [--enemies E]
+//                    [--columns C] [--rows R] [--interest CxR] [--seed S]
+//                    [--max-rooms N] [--report SECONDS] [--duration SECONDS]
+//
+// --interest sends each client only the enemies and bombs within C x R
+// tiles around its player, and splits the map into regions of that size
+// for spectators. Prints a line per report interval with the per-room tick
+// cost. Load it with bomberman_loadclient.
+
+namespace {
+    RoomServer* gServer = nullptr;
+
+    void handleSignal(int) {
+        if (gServer) gServer->stop();
+    }
+
+    void printReport(const ServerReport& report) {
+        std::cout << report.rooms << " rooms, " << report.clients << " clients, " << report.spectators << " spectators: "
+            << report.ticks / report.seconds << " room ticks/s, room tick mean " << report.meanRoomTickUs
+            << " us, p99 " << report.p99RoomTickUs << " us, max " << report.maxRoomTickUs << " us; workers "
+            << report.workerBusy * 100.0 << "% busy, " << report.overruns << " overruns; "
+            << report.inputsReceived / report.seconds << " inputs/s in, " << report.statesSent / report.seconds
+            << " states/s and " << report.bytesSent / report.seconds / 1024.0 << " KiB/s out" << std::endl;
+    }
+
+    // "CxR", both positive.
+    bool parseArea(const std::string& text, int& columns, int& rows) {
+        size_t separator = text.find('x');
+        if (separator == std::string::npos) return false;
+        columns = std::atoi(text.substr(0, separator).c_str());
+        rows = std::atoi(text.substr(separator + 1).c_str());
+        return columns > 0 && rows > 0;
+    }
+
+    // Every client holds a TCP socket; lift the soft descriptor limit so a
+    // few thousand of them fit.
+    void raiseDescriptorLimit() {
+        rlimit limit;
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limit);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    ServerConfig config;
+    config.match.playerCount = 4;
+    double reportSeconds = 5.0;
+    double duration = 0.0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--port" && hasValue) config.port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        else if (arg == "--workers" && hasValue) config.workers = std::atoi(argv[++i]);
+        else if (arg == "--players" && hasValue) config.match.playerCount = std::atoi(argv[++i]);
+        else if (arg == "--enemies" && hasValue) config.match.enemyCount = std::atoi(argv[++i]);
+        else if (arg == "--columns" && hasValue) config.match.columns = std::atoi(argv[++i]);
+        else if (arg == "--rows" && hasValue) config.match.rows = std::atoi(argv[++i]);
+        else if (arg == "--interest" && hasValue && parseArea(argv[++i], config.interestColumns, config.interestRows)) {}
+        else if (arg == "--seed" && hasValue) config.match.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--max-rooms" && hasValue) config.maxRooms = std::atoi(argv[++i]);
+        else if (arg == "--report" && hasValue) reportSeconds = std::atof(argv[++i]);
+        else if (arg == "--duration" && hasValue) duration = std::atof(argv[++i]);
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--port P] [--workers N] [--players P] [--enemies E] [--columns C] [--rows R] [--interest CxR] [--seed S] [--max-rooms N] [--report SECONDS] [--duration SECONDS]" << std::endl;
+            return 2;
+        }
+    }
+
+    raiseDescriptorLimit();
+    RoomServer server(config);
+    if (!server.start()) return 1;
+    gServer = &server;
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+    if (duration > 0.0) {
+        std::signal(SIGALRM, handleSignal);
+        alarm(static_cast<unsigned>(duration + 0.5));
+    }
+
+    std::cout << "Serving " << config.match.playerCount << "-player rooms on TCP and UDP port " << server.getPort() << std::endl;
+    server.run(reportSeconds, printReport);
+    gServer = nullptr;
+    return 0;
+}
@@ -0,0 +1,78 @@
+#ifndef SERVER_PROTOCOL_H
+#define SERVER_PROTOCOL_H
+
+#include <cstdint>
+#include <vector>
+#include "ByteStream.h"
+
+// Wire format between bomberman_server and its clients. Joining and match
+// results go over TCP, each message framed by a little-endian u16 length;
+// inputs and state go over UDP to the same port, one message per datagram.
+
+const uint16_t DEFAULT_SERVER_PORT = 27960;
+const uint8_t SERVER_PROTOCOL_VERSION = 3;
+const size_t FRAME_HEADER_SIZE = 2;
+
+enum class ServerMessage : uint8_t {
+    // TCP, client to server: u8 version, varint room (0 joins any room with
+    // a free slot).
+    JOIN = 1,
+    // TCP, server to client: varint room, u8 player, u32 token, u16 UDP port.
+    JOINED = 2,
+    // TCP, server to client: no body; the connection is closed after it.
+    JOIN_REFUSED = 3,
+    // TCP, server to client: varint room, varint tick, u8 outcome, signed
+    // varint winner. The room starts its next match straight after.
+    MATCH_OVER = 4,
+    // TCP, client to server: u8 version, varint room (0 watches any room),
+    // varint region, taken modulo the room's region count. Answered with
+    // SPECTATING, or JOIN_REFUSED if there is no such room or it is full.
+    SPECTATE = 5,
+    // TCP, server to client: varint room, varint region, varint region
+    // count, u32 token, u16 UDP port. The connection stays open for
+    // MATCH_OVER and is closed when the room closes.
+    SPECTATING = 6,
+    // UDP, client to server: u32 token, varint tick, u8 buttons, then the
+    // newest state decoded as u8 replication generation and varint tick + 1
+    // (0 for none yet). Inputs older than the newest one seen are dropped; a
+    // bomb press is held until the room's next tick.
+    INPUT = 16,
+    // UDP, server to client: varint room, varint tick, then a Replicator
+    // message for this client, or the SpectatorRelay stream of its region,
+    // filling the rest of the datagram.
+    STATE = 17,
+    // UDP, spectator to server: u32 token. Tells the server where to send
+    // the region's stream; resend it now and then in case it was lost.
+    WATCH = 18
+};
+
+// Appends a TCP frame: the length prefix, then the message written by
+// `writeBody`, which is handed a ByteWriter on the same buffer.
+template <typename WriteBody>
+void appendFrame(std::vector<uint8_t>& out, ServerMessage type, WriteBody writeBody) {
+    size_t lengthAt = out.size();
+    ByteWriter writer(out);
+    writer.writeU16(0);
+    writer.writeU8(static_cast<uint8_t>(type));
+    writeBody(writer);
+    size_t length = out.size() - lengthAt - FRAME_HEADER_SIZE;
+    out[lengthAt] = static_cast<uint8_t>(length);
+    out[lengthAt + 1] = static_cast<uint8_t>(length >> 8);
+}
+
+enum class FrameStatus : uint8_t {
+    INCOMPLETE,
+    READY,
+    INVALID
+};
+
+// Looks for a complete TCP frame at the start of data[0, size). When READY,
+// the message (type byte first) is the `length` bytes after the header.
+inline FrameStatus findFrame(const uint8_t* data, size_t size, size_t& length) {
+    if (size < FRAME_HEADER_SIZE) return FrameStatus::INCOMPLETE;
+    length = data[0] | (static_cast<size_t>(data[1]) << 8);
+    if (length == 0) return FrameStatus::INVALID;
+    return size < FRAME_HEADER_SIZE + length ? FrameStatus::INCOMPLETE : FrameStatus::READY;
+}
+
+#endif // SERVER_PROTOCOL_H
@@ -0,0 +1,708 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "Simulation.h"
+#include "BatchRunner.h"
+#include "Replay.h"
+#include "AllocationTracker.h"
+#include "Replication.h"
+#include "SpectatorRelay.h"
+#include "MctsBot.h"
+#include "WallSkeleton.h"
+#include "Leaderboard.h"
+
+// Command-line driver for the simulation core: plays whole matches with
+// random-walk bots and no SDL across a pool of threads, printing one line per
+// match and aggregate statistics.
+//
+//   bomberman_sim [--matches N] [--seed S] [--players P] [--enemies E]
+//                 [--range R] [--bombs B] [--speed PX] [--threads T]
+//                 [--quiet] [--csv FILE] [--record FILE]
+//   bomberman_sim --replay FILE [--repeat N]
+//   bomberman_sim --check-allocations [--matches N] [match options]
+//   bomberman_sim --check-snapshots [--matches N] [match options]
+//   bomberman_sim --check-replication [--matches N] [match options]
+//   bomberman_sim --check-distances
+//   bomberman_sim --check-leaderboard [--seed S]
+//   bomberman_sim --mcts N [--think US] [--playouts N] [--threads T]
+//                 [--matches N] [match options]
+//
+// --csv writes one row per match for offline analysis; --record saves the
+// first match as a replay; --replay re-runs one as fast as possible and
+// checks that it ends in the recorded state. --check-allocations fails if
+// any Simulation::step after the first tick of a match allocates.
+// --check-distances compares the wall skeleton's distances with a search.
+// --check-leaderboard compares a scratch leaderboard's ranks and top scores
+// with a sort, across compaction, a torn append and a lost or garbled index.
+// --check-snapshots restores every tick's snapshot into a second simulation
+// and fails unless both stay identical. --check-replication replicates every
+// tick to clients with different loss, acknowledgement delay and interest
+// area, and to lossy spectator relay viewers, and fails unless each decodes
+// exactly the server's state for its area. --mcts plays matches one at a
+// time with the first N players driven by MctsBot, thinking --think
+// microseconds (or exactly --playouts play-outs) per decision on --threads
+// threads, and the rest by RandomBot, and compares how the two fare.
+
+namespace {
+    int runReplay(const std::string& path, int repeat) {
+        Replay replay;
+        if (!replay.load(path)) return 1;
+        Simulation simulation;
+        double seconds = 0.0;
+        ReplayResult result;
+        for (int i = 0; i < repeat; ++i) {
+            result = playReplay(replay, simulation);
+            seconds += result.seconds;
+            if (!result.matchesRecording) break;
+        }
+        std::cout << "replay " << path << ": " << result.ticks << " ticks, seed " << replay.config.seed
+            << ", checksum " << std::hex << result.checksum << std::dec
+            << (result.matchesRecording ? " (matches recording)" : " (DIVERGED from recording)") << std::endl;
+        std::cout << repeat << " runs in " << seconds << " s (" << (seconds > 0.0 ? repeat * static_cast<double>(result.ticks) / seconds : 0.0)
+            << " ticks/s, " << (seconds > 0.0 ? repeat * result.ticks / (seconds * TICKS_PER_SECOND) : 0.0) << "x real time)" << std::endl;
+        return result.matchesRecording ? 0 : 1;
+    }
+
+    int runAllocationCheck(MatchConfig config, int matches) {
+        Simulation simulation;
+        const uint64_t firstSeed = config.seed;
+        long long ticksChecked = 0;
+        long long allocatingTicks = 0;
+        AllocationTracker::resetPhaseStats();
+        for (int match = 0; match < matches; ++match) {
+            config.seed = firstSeed + match;
+            if (!simulation.reset(config)) return 1;
+            Rng botRng(config.seed);
+            RandomBot bots[MAX_PLAYERS];
+            TickInput input;
+            while (!simulation.isOver()) {
+                for (int p = 0; p < config.playerCount; ++p) {
+                    input.buttons[p] = bots[p].nextButtons(botRng);
+                }
+                bool warmup = simulation.getTick() == 0;
+                uint64_t before = AllocationTracker::getThreadAllocations();
+                simulation.step(input);
+                if (warmup) continue;
+                ++ticksChecked;
+                if (AllocationTracker::getThreadAllocations() != before) ++allocatingTicks;
+            }
+        }
+
+        std::cout << "allocation check: " << ticksChecked << " steady-state ticks over " << matches << " matches, "
+            << allocatingTicks << " allocated" << std::endl;
+        if (AllocationTracker::isTrackingPhases()) {
+            for (const auto& phase : AllocationTracker::getPhaseStats()) {
+                std::cout << "  " << phase.name << ": " << phase.allocations << " allocations, " << phase.bytes << " bytes" << std::endl;
+            }
+        }
+        return allocatingTicks == 0 ? 0 : 1;
+    }
+
+    int runSnapshotCheck(MatchConfig config, int matches) {
+        Simulation simulation;
+        Simulation restored;
+        std::vector<uint8_t> blob;
+        const uint64_t firstSeed = config.seed;
+        long long ticksChecked = 0;
+        size_t totalBytes = 0;
+        size_t maxBytes = 0;
+        for (int match = 0; match < matches; ++match) {
+            config.seed = firstSeed + match;
+            if (!simulation.reset(config)) return 1;
+            Rng botRng(config.seed);
+            RandomBot bots[MAX_PLAYERS];
+            TickInput input;
+            while (!simulation.isOver()) {
+                simulation.saveSnapshot(blob);
+                totalBytes += blob.size();
+                if (blob.size() > maxBytes) maxBytes = blob.size();
+                if (!restored.restoreSnapshot(blob) || restored.computeChecksum() != simulation.computeChecksum()) {
+                    std::cerr << "Sim Error: Snapshot of match " << match << " tick " << simulation.getTick() << " did not restore." << std::endl;
+                    return 1;
+                }
+                for (int p = 0; p < config.playerCount; ++p) {
+                    input.buttons[p] = bots[p].nextButtons(botRng);
+                }
+                simulation.step(input);
+                restored.step(input);
+                if (restored.computeChecksum() != simulation.computeChecksum()) {
+                    std::cerr << "Sim Error: Restored simulation diverged in match " << match << " at tick " << simulation.getTick() << "." << std::endl;
+                    return 1;
+                }
+                ++ticksChecked;
+            }
+        }
+        std::cout << "snapshot check: " << ticksChecked << " ticks over " << matches << " matches, snapshots "
+            << (ticksChecked > 0 ? totalBytes / ticksChecked : 0) << " bytes on average, " << maxBytes << " at most" << std::endl;
+        return 0;
+    }
+
+    // Compares every WallSkeleton distance against a breadth-first search over
+    // the open tiles, from every open tile, on maps of odd and even sizes.
+    int runDistanceCheck() {
+        const TilePos SIZES[] = { { 3, 3 }, { 5, 5 }, { 6, 7 }, { 15, 20 }, { 16, 21 }, { 48, 64 } };
+        long long pairsChecked = 0;
+        std::vector<int> distances;
+        std::vector<int> queue;
+        for (const auto& size : SIZES) {
+            WallSkeleton skeleton;
+            skeleton.build(size.col, size.row);
+            int tiles = size.row * size.col;
+            for (int source = 0; source < tiles; ++source) {
+                TilePos from = { source / size.col, source % size.col };
+                if (!skeleton.isOpen(from.row, from.col)) continue;
+                distances.assign(static_cast<size_t>(tiles), -1);
+                queue.assign(1, source);
+                distances[source] = 0;
+                for (size_t next = 0; next < queue.size(); ++next) {
+                    TilePos tile = { queue[next] / size.col, queue[next] % size.col };
+                    for (Direction direction : { UP, DOWN, LEFT, RIGHT }) {
+                        TilePos neighbour = WallSkeleton::step(tile, direction);
+                        int index = neighbour.row * size.col + neighbour.col;
+                        if (!skeleton.isOpen(neighbour.row, neighbour.col) || distances[index] >= 0) continue;
+                        distances[index] = distances[queue[next]] + 1;
+                        queue.push_back(index);
+                    }
+                }
+                for (int target = 0; target < tiles; ++target) {
+                    TilePos to = { target / size.col, target % size.col };
+                    Direction steps[2];
+                    int stepCount = skeleton.nextSteps(from, to, steps);
+                    if (skeleton.distance(from, to) != distances[target] || (distances[target] > 0) != (stepCount > 0)) {
+                        std::cerr << "Sim Error: Skeleton distance on a " << size.col << "x" << size.row << " map from ("
+                            << from.row << "," << from.col << ") to (" << to.row << "," << to.col << ") is "
+                            << skeleton.distance(from, to) << ", search found " << distances[target] << "." << std::endl;
+                        return 1;
+                    }
+                    ++pairsChecked;
+                }
+            }
+        }
+        std::cout << "distance check: " << pairsChecked << " tile pairs match a breadth-first search" << std::endl;
+        return 0;
+    }
+
+    // Higher scores first, then the earlier, then the lower source: the order
+    // Leaderboard promises.
+    bool scoreRanksAbove(const ScoreRecord& a, const ScoreRecord& b) {
+        if (a.score != b.score) return a.score > b.score;
+        if (a.time != b.time) return a.time < b.time;
+        return a.source < b.source;
+    }
+
+    // Compares the board's count, best score, top entries and the rank of
+    // every score in range with a sort of everything added to it.
+    bool matchesSortedScores(const Leaderboard& board, std::vector<ScoreRecord> all, uint32_t topK, int maxScore,
+        const char* stage) {
+        std::sort(all.begin(), all.end(), scoreRanksAbove);
+        if (board.getCount() != all.size() || board.getBestScore() != (all.empty() ? 0 : all.front().score)) {
+            std::cerr << "Sim Error: Leaderboard holds " << board.getCount() << " scores, best " << board.getBestScore()
+                << ", after " << stage << "; expected " << all.size() << "." << std::endl;
+            return false;
+        }
+        std::vector<ScoreRecord> top;
+        for (size_t count : { static_cast<size_t>(10), static_cast<size_t>(topK) + 5 }) {
+            board.getTop(count, top);
+            size_t expected = std::min(all.size(), std::min(count, static_cast<size_t>(topK)));
+            bool same = top.size() == expected;
+            for (size_t i = 0; same && i < expected; ++i) {
+                same = top[i].score == all[i].score && top[i].time == all[i].time && top[i].source == all[i].source;
+            }
+            if (!same) {
+                std::cerr << "Sim Error: Leaderboard top " << count << " differs from a sort after " << stage << "." << std::endl;
+                return false;
+            }
+        }
+        size_t above = 0;
+        for (int score = maxScore; score >= -1; --score) {
+            while (above < all.size() && all[above].score > score) ++above;
+            if (board.getRank(score) != above + 1) {
+                std::cerr << "Sim Error: Leaderboard ranks " << score << " at " << board.getRank(score) << " after "
+                    << stage << ", a sort at " << above + 1 << "." << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Fills a scratch leaderboard past several compactions and checks it
+    // against a sort after each step, then damages its files: a torn append
+    // has to be cut off without losing a record, and a deleted or garbled
+    // index rebuilt from the log.
+    int runLeaderboardCheck(uint64_t seed) {
+        const uint32_t TOP_K = 100;
+        const int MAX_SCORE = 500;
+        std::string path = (std::filesystem::temp_directory_path() / "bomberman_check_scores").string();
+        std::string logPath = path + ".log";
+        std::string indexPath = path + ".idx";
+        std::error_code error;
+        std::filesystem::remove(logPath, error);
+        std::filesystem::remove(indexPath, error);
+
+        Rng rng(seed);
+        std::vector<ScoreRecord> all;
+        uint64_t nextTime = 0;
+        auto makeScores = [&](size_t count) {
+            std::vector<ScoreRecord> scores(count);
+            for (auto& record : scores) {
+                record.score = rng.nextInt(MAX_SCORE);
+                record.source = static_cast<uint32_t>(rng.nextInt(4));
+                // Shared times make the source decide some ties.
+                record.time = nextTime++ / 3;
+            }
+            all.insert(all.end(), scores.begin(), scores.end());
+            return scores;
+        };
+
+        Leaderboard board;
+        int checks = 0;
+        auto check = [&](const char* stage, uint32_t topK) {
+            ++checks;
+            return board.isOpen() && matchesSortedScores(board, all, topK, MAX_SCORE, stage);
+        };
+        bool ok = board.open(path, TOP_K) && check("creating the board", TOP_K);
+        for (int i = 0; ok && i < 50; ++i) ok = board.add(makeScores(1).front());
+        ok = ok && check("single appends", TOP_K);
+        // Past COMPACT_THRESHOLD, so add() folds them into the index itself.
+        for (int i = 0; ok && i < 5; ++i) ok = board.add(makeScores(Leaderboard::COMPACT_THRESHOLD / 2 + 7)) && check("batch appends", TOP_K);
+        ok = ok && board.add(makeScores(300)) && board.compact() && check("compacting", TOP_K);
+        ok = ok && board.add(makeScores(200)) && check("appending after compacting", TOP_K);
+        if (ok) board.close();
+        ok = ok && board.open(path, TOP_K) && check("reopening", TOP_K);
+
+        if (ok) {
+            board.close();
+            uintmax_t logSize = std::filesystem::file_size(logPath, error);
+            std::ofstream log(logPath, std::ios::binary | std::ios::app);
+            for (int i = 0; i < 37; ++i) log.put(static_cast<char>(rng.nextInt(256)));
+            log.close();
+            ok = board.open(path, TOP_K) && check("reopening after a torn append", TOP_K);
+            if (ok && std::filesystem::file_size(logPath, error) != logSize) {
+                std::cerr << "Sim Error: Leaderboard did not cut the torn append off its log." << std::endl;
+                ok = false;
+            }
+            ok = ok && board.add(makeScores(20)) && check("appending after a torn append", TOP_K);
+        }
+
+        if (ok) {
+            board.close();
+            std::filesystem::remove(indexPath, error);
+            ok = board.open(path, TOP_K) && check("deleting the index", TOP_K);
+        }
+        if (ok) {
+            board.close();
+            uintmax_t indexSize = std::filesystem::file_size(indexPath, error);
+            std::fstream index(indexPath, std::ios::binary | std::ios::in | std::ios::out);
+            index.seekg(static_cast<std::streamoff>(indexSize / 2));
+            char byte = static_cast<char>(index.get());
+            index.seekp(static_cast<std::streamoff>(indexSize / 2));
+            index.put(static_cast<char>(byte ^ 0x5A));
+            index.close();
+            ok = board.open(path, TOP_K) && check("garbling the index", TOP_K);
+        }
+        if (ok) {
+            board.close();
+            ok = board.open(path, TOP_K * 3) && check("reopening with a larger top-K", TOP_K * 3);
+        }
+
+        board.close();
+        std::filesystem::remove(logPath, error);
+        std::filesystem::remove(indexPath, error);
+        if (!ok) {
+            std::cerr << "Sim Error: Leaderboard check failed." << std::endl;
+            return 1;
+        }
+        std::cout << "leaderboard check: " << all.size() << " scores match a sort at " << checks
+            << " points, through compaction, a torn append and a lost or garbled index" << std::endl;
+        return 0;
+    }
+
+    // Whether a client's decoded state is what the server captured.
+    bool matchesReplica(const ReplicaDecoder& decoder, const ReplicaFrame& expected, const Map& map) {
+        const ReplicaFrame& decoded = decoder.getLatest();
+        if (decoded.tick != expected.tick || decoded.outcome != expected.outcome || decoded.winner != expected.winner
+            || decoded.playerCount != expected.playerCount || decoded.enemies.size() != expected.enemies.size()
+            || decoded.bombs.size() != expected.bombs.size()) {
+            return false;
+        }
+        for (int p = 0; p < expected.playerCount; ++p) {
+            const ReplicaPlayer& a = decoded.players[p];
+            const ReplicaPlayer& b = expected.players[p];
+            if (decoded.scores[p] != expected.scores[p] || a.x != b.x || a.y != b.y || a.flags != b.flags) return false;
+        }
+        for (size_t i = 0; i < expected.enemies.size(); ++i) {
+            const ReplicaEnemy& a = decoded.enemies[i];
+            const ReplicaEnemy& b = expected.enemies[i];
+            if (a.id != b.id || a.x != b.x || a.y != b.y) return false;
+        }
+        for (size_t i = 0; i < expected.bombs.size(); ++i) {
+            const ReplicaBomb& a = decoded.bombs[i];
+            const ReplicaBomb& b = expected.bombs[i];
+            if (a.tile != b.tile || a.spawnTick != b.spawnTick || a.owner != b.owner || a.exploding != b.exploding
+                || std::memcmp(a.arms, b.arms, sizeof(a.arms)) != 0) {
+                return false;
+            }
+        }
+        const std::vector<TileType>& tiles = decoder.getTiles();
+        for (int row = 0; row < map.getRows(); ++row) {
+            for (int col = 0; col < map.getColumns(); ++col) {
+                if (tiles[row * map.getColumns() + col] != map.getTileType(row, col)) return false;
+            }
+        }
+        return true;
+    }
+
+    struct ReplicationCheckClient {
+        ReplicationCheckClient(double loss, int delay, int area) : lossRate(loss), ackDelay(delay), areaTiles(area) {}
+
+        double lossRate = 0.0;
+        // Ticks until an acknowledgement reaches the server; -1 never sends any.
+        int ackDelay = 1;
+        // Side of a square interest area, in tiles, that follows player 0;
+        // 0 watches the whole map.
+        int areaTiles = 0;
+        ReplicaClient state;
+        ReplicaDecoder decoder;
+        // Due time in ticks checked so far, then the generation and tick.
+        std::deque<std::pair<long long, std::pair<uint8_t, int>>> acks;
+        long long bytes = 0;
+        long long messages = 0;
+        long long keyframes = 0;
+    };
+
+    // A viewer of one SpectatorRelay region, losing `lossRate` of the stream.
+    struct RelayCheckViewer {
+        ReplicaDecoder decoder;
+        // Every delta must decode while the stream's last keyframe arrived.
+        bool hasKeyframe = false;
+        long long bytes = 0;
+    };
+
+    const double RELAY_LOSS_RATE = 0.2;
+
+    int runReplicationCheck(MatchConfig config, int matches) {
+        ReplicationCheckClient clients[] = { ReplicationCheckClient(0.0, 1, 0), ReplicationCheckClient(0.05, 3, 0),
+            ReplicationCheckClient(0.2, 8, 0), ReplicationCheckClient(0.5, 20, 0), ReplicationCheckClient(0.0, -1, 0),
+            ReplicationCheckClient(0.0, 1, 7), ReplicationCheckClient(0.2, 8, 5) };
+        Simulation simulation;
+        Replicator replicator;
+        Rng network(config.seed ^ 0x4E37ull);
+        std::vector<uint8_t> message;
+        std::vector<uint8_t> blob;
+        ReplicaFrame expected;
+        std::vector<int> scratch;
+        SpectatorRelay relay;
+        relay.configure(config.columns, config.rows, config.tileSize, (config.columns + 1) / 2, (config.rows + 1) / 2);
+        std::vector<RelayCheckViewer> viewers(relay.getRegionCount());
+        std::vector<uint8_t> watched(relay.getRegionCount(), 1);
+        long long snapshotBytes = 0;
+        long long ticksChecked = 0;
+        const uint64_t firstSeed = config.seed;
+        for (int match = 0; match < matches; ++match) {
+            config.seed = firstSeed + match;
+            if (!simulation.reset(config)) return 1;
+            Rng botRng(config.seed);
+            RandomBot bots[MAX_PLAYERS];
+            TickInput input;
+            while (true) {
+                replicator.capture(simulation);
+                simulation.saveSnapshot(blob);
+                snapshotBytes += static_cast<long long>(blob.size());
+                int tick = simulation.getTick();
+                const ReplicaFrame& latest = replicator.getLatest();
+                for (auto& client : clients) {
+                    client.state.area = InterestArea();
+                    if (client.areaTiles > 0) {
+                        int side = client.areaTiles * simulation.getMap().getTileSize();
+                        const Player& followed = simulation.getPlayers()[0];
+                        client.state.area = InterestArea::centredOn(followed.getX(), followed.getY(), side, side);
+                    }
+                    expected.tick = latest.tick;
+                    expected.outcome = latest.outcome;
+                    expected.winner = latest.winner;
+                    expected.playerCount = latest.playerCount;
+                    std::copy(latest.scores, latest.scores + MAX_PLAYERS, expected.scores);
+                    std::copy(latest.players, latest.players + MAX_PLAYERS, expected.players);
+                    latest.collect(client.state.area, scratch, expected.enemies, expected.bombs);
+
+                    while (!client.acks.empty() && client.acks.front().first <= ticksChecked) {
+                        replicator.acknowledge(client.state, client.acks.front().second.first, client.acks.front().second.second);
+                        client.acks.pop_front();
+                    }
+                    message.clear();
+                    if (replicator.encode(client.state, message)) ++client.keyframes;
+                    client.bytes += static_cast<long long>(message.size());
+                    ++client.messages;
+                    if (network.nextInt(1000) < static_cast<int>(client.lossRate * 1000.0)) continue;
+
+                    if (!client.decoder.decode(message.data(), message.size())
+                        || !matchesReplica(client.decoder, expected, simulation.getMap())) {
+                        std::cerr << "Sim Error: Replicated state of match " << match << " tick " << tick
+                            << " did not decode to the server's state." << std::endl;
+                        return 1;
+                    }
+                    bool ackLost = network.nextInt(1000) < static_cast<int>(client.lossRate * 1000.0);
+                    if (client.ackDelay >= 0 && !ackLost) {
+                        client.acks.push_back({ ticksChecked + client.ackDelay, { client.decoder.getGeneration(), tick } });
+                    }
+                }
+
+                relay.update(replicator, watched);
+                for (int region = 0; region < relay.getRegionCount(); ++region) {
+                    RelayCheckViewer& viewer = viewers[region];
+                    const std::vector<uint8_t>& stream = relay.getStream(region);
+                    bool keyframe = (stream[0] & 1) != 0;
+                    viewer.bytes += static_cast<long long>(stream.size());
+                    if (network.nextInt(1000) < static_cast<int>(RELAY_LOSS_RATE * 1000.0)) {
+                        if (keyframe) viewer.hasKeyframe = false;
+                        continue;
+                    }
+                    if (keyframe) viewer.hasKeyframe = true;
+                    if (!viewer.hasKeyframe) continue;
+                    latest.collect(relay.getRegionArea(region), scratch, expected.enemies, expected.bombs);
+                    if (!viewer.decoder.decode(stream.data(), stream.size())
+                        || !matchesReplica(viewer.decoder, expected, simulation.getMap())) {
+                        std::cerr << "Sim Error: Spectator stream of region " << region << ", match " << match << " tick " << tick
+                            << " did not decode to the server's state." << std::endl;
+                        return 1;
+                    }
+                }
+                ++ticksChecked;
+                if (simulation.isOver()) break;
+                for (int p = 0; p < config.playerCount; ++p) {
+                    input.buttons[p] = bots[p].nextButtons(botRng);
+                }
+                simulation.step(input);
+            }
+        }
+
+        std::cout << "replication check: " << ticksChecked << " ticks over " << matches << " matches, snapshots "
+            << (ticksChecked > 0 ? snapshotBytes / ticksChecked : 0) << " bytes per tick" << std::endl;
+        for (const auto& client : clients) {
+            std::cout << "  loss " << client.lossRate * 100.0 << "%, ack delay " << client.ackDelay << ", ";
+            if (client.areaTiles > 0) std::cout << client.areaTiles << "x" << client.areaTiles << " tile area: ";
+            else std::cout << "whole map: ";
+            std::cout << (client.messages > 0 ? static_cast<double>(client.bytes) / client.messages : 0.0) << " bytes per tick, "
+                << client.keyframes << " keyframes" << std::endl;
+        }
+        long long relayBytes = 0;
+        for (const auto& viewer : viewers) relayBytes += viewer.bytes;
+        std::cout << "  spectator relay, " << viewers.size() << " regions at loss " << RELAY_LOSS_RATE * 100.0 << "%: "
+            << (ticksChecked > 0 ? static_cast<double>(relayBytes) / ticksChecked / viewers.size() : 0.0)
+            << " bytes per region per tick" << std::endl;
+        return 0;
+    }
+
+    const char* outcomeName(MatchOutcome outcome) {
+        switch (outcome) {
+        case MatchOutcome::WON: return "won";
+        case MatchOutcome::LOST: return "lost";
+        case MatchOutcome::TIME_UP: return "time_up";
+        default: return "in_progress";
+        }
+    }
+
+    int runMctsMatches(MatchConfig config, int matches, int mctsPlayers, const MctsConfig& mctsConfig) {
+        if (mctsPlayers < 1 || mctsPlayers > config.playerCount) {
+            std::cerr << "Sim Error: --mcts needs 1 to " << config.playerCount << " players." << std::endl;
+            return 2;
+        }
+        Simulation simulation;
+        // Per kind of bot, MctsBot then RandomBot.
+        long long survived[2] = {};
+        long long wins[2] = {};
+        long long scores[2] = {};
+        long long seats[2] = {};
+        long long playouts = 0;
+        long long decisions = 0;
+        double thinkSeconds = 0.0;
+        const uint64_t firstSeed = config.seed;
+        for (int match = 0; match < matches; ++match) {
+            config.seed = firstSeed + match;
+            if (!simulation.reset(config)) return 1;
+            std::vector<std::unique_ptr<MctsBot>> mctsBots;
+            for (int p = 0; p < mctsPlayers; ++p) {
+                MctsConfig botConfig = mctsConfig;
+                botConfig.seed = config.seed * MAX_PLAYERS + p;
+                mctsBots.push_back(std::unique_ptr<MctsBot>(new MctsBot(botConfig)));
+            }
+            Rng botRng(config.seed);
+            RandomBot randomBots[MAX_PLAYERS];
+            TickInput input;
+            while (!simulation.isOver()) {
+                for (int p = 0; p < config.playerCount; ++p) {
+                    input.buttons[p] = p < mctsPlayers ? mctsBots[p]->nextButtons(simulation, p) : randomBots[p].nextButtons(botRng);
+                }
+                simulation.step(input);
+            }
+
+            std::cout << "match " << match << " seed " << config.seed << ": " << outcomeName(simulation.getOutcome()) << " after "
+                << simulation.getTick() << " ticks, winner " << simulation.getWinner() << ", scores";
+            for (int p = 0; p < config.playerCount; ++p) {
+                int kind = p < mctsPlayers ? 0 : 1;
+                ++seats[kind];
+                scores[kind] += simulation.getScore(p);
+                if (simulation.getPlayers()[p].isAlive()) ++survived[kind];
+                if (simulation.getWinner() == p) ++wins[kind];
+                std::cout << " " << simulation.getScore(p) << (p < mctsPlayers ? "*" : "");
+            }
+            std::cout << std::endl;
+            for (const auto& bot : mctsBots) {
+                playouts += bot->getStats().playouts;
+                decisions += bot->getStats().decisions;
+                thinkSeconds += bot->getStats().thinkSeconds;
+            }
+        }
+
+        const char* kinds[2] = { "mcts", "random" };
+        for (int kind = 0; kind < 2; ++kind) {
+            if (seats[kind] == 0) continue;
+            std::cout << kinds[kind] << " bots: survived " << survived[kind] << " of " << seats[kind] << ", won " << wins[kind]
+                << ", mean score " << static_cast<double>(scores[kind]) / seats[kind] << std::endl;
+        }
+        std::cout << decisions << " decisions, " << (decisions > 0 ? static_cast<double>(playouts) / decisions : 0.0)
+            << " play-outs each, " << (thinkSeconds > 0.0 ? playouts / thinkSeconds : 0.0) << " play-outs/s on "
+            << mctsConfig.threads << " threads" << std::endl;
+        return 0;
+    }
+
+    void printDistribution(const char* label, const Distribution& distribution) {
+        std::cout << label << ": mean " << distribution.mean << ", p50 " << distribution.p50 << ", p90 " << distribution.p90
+            << ", p99 " << distribution.p99 << ", min " << distribution.min << ", max " << distribution.max << std::endl;
+    }
+
+    bool writeMatchCsv(const std::string& path, const std::vector<MatchResult>& results, int playerCount) {
+        std::ofstream out(path);
+        if (!out) {
+            std::cerr << "Sim Error: Cannot open '" << path << "' for writing." << std::endl;
+            return false;
+        }
+        out << "match,seed,outcome,ticks,winner,enemies_left,mean_tick_ns,max_tick_ns";
+        for (int p = 0; p < playerCount; ++p) out << ",score" << p;
+        out << "\n";
+        for (size_t match = 0; match < results.size(); ++match) {
+            const MatchResult& result = results[match];
+            out << match << "," << result.seed << "," << outcomeName(result.outcome) << "," << result.ticks << ","
+                << result.winner << "," << result.enemiesLeft << "," << result.meanTickNs << "," << result.maxTickNs;
+            for (int p = 0; p < playerCount; ++p) out << "," << result.scores[p];
+            out << "\n";
+        }
+        return static_cast<bool>(out);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    MatchConfig config;
+    int matches = 10;
+    bool quiet = false;
+    std::string recordPath;
+    std::string replayPath;
+    int repeat = 1;
+    int threads = 0;
+    std::string csvPath;
+    bool checkAllocations = false;
+    bool checkSnapshots = false;
+    bool checkReplication = false;
+    bool checkDistances = false;
+    bool checkLeaderboard = false;
+    int mctsPlayers = 0;
+    MctsConfig mctsConfig;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--matches" && hasValue) matches = std::atoi(argv[++i]);
+        else if (arg == "--seed" && hasValue) config.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--players" && hasValue) config.playerCount = std::atoi(argv[++i]);
+        else if (arg == "--enemies" && hasValue) config.enemyCount = std::atoi(argv[++i]);
+        else if (arg == "--range" && hasValue) config.bombRange = std::atoi(argv[++i]);
+        else if (arg == "--bombs" && hasValue) config.maxActiveBombs = std::atoi(argv[++i]);
+        else if (arg == "--speed" && hasValue) config.playerSpeed = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--threads" && hasValue) threads = std::atoi(argv[++i]);
+        else if (arg == "--quiet") quiet = true;
+        else if (arg == "--csv" && hasValue) csvPath = argv[++i];
+        else if (arg == "--check-allocations") checkAllocations = true;
+        else if (arg == "--check-snapshots") checkSnapshots = true;
+        else if (arg == "--check-replication") checkReplication = true;
+        else if (arg == "--check-distances") checkDistances = true;
+        else if (arg == "--check-leaderboard") checkLeaderboard = true;
+        else if (arg == "--mcts" && hasValue) mctsPlayers = std::atoi(argv[++i]);
+        else if (arg == "--think" && hasValue) mctsConfig.thinkMicroseconds = std::atoi(argv[++i]);
+        else if (arg == "--playouts" && hasValue) mctsConfig.fixedPlayouts = std::atoi(argv[++i]);
+        else if (arg == "--record" && hasValue) recordPath = argv[++i];
+        else if (arg == "--replay" && hasValue) replayPath = argv[++i];
+        else if (arg == "--repeat" && hasValue) repeat = std::atoi(argv[++i]);
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--matches N] [--seed S] [--players P] [--enemies E] [--range R] [--bombs B] [--speed PX] [--threads T] [--quiet] [--csv FILE] [--record FILE] [--check-allocations] [--check-snapshots] [--check-replication] [--check-distances] [--check-leaderboard] [--mcts N [--think US] [--playouts N]] | --replay FILE [--repeat N]" << std::endl;
+            return 2;
+        }
+    }
+    if (!replayPath.empty()) {
+        return runReplay(replayPath, repeat > 0 ? repeat : 1);
+    }
+    if (checkAllocations) {
+        return runAllocationCheck(config, matches);
+    }
+    if (checkSnapshots) {
+        return runSnapshotCheck(config, matches);
+    }
+    if (checkReplication) {
+        return runReplicationCheck(config, matches);
+    }
+    if (checkDistances) {
+        return runDistanceCheck();
+    }
+    if (checkLeaderboard) {
+        return runLeaderboardCheck(config.seed);
+    }
+    if (mctsPlayers > 0) {
+        mctsConfig.threads = threads > 0 ? threads : 1;
+        return runMctsMatches(config, matches, mctsPlayers, mctsConfig);
+    }
+
+    if (!recordPath.empty()) {
+        Simulation simulation;
+        ReplayRecorder recorder;
+        playBotMatch(simulation, config, &recorder);
+        if (!recorder.getReplay().save(recordPath)) return 1;
+    }
+
+    BatchConfig batch;
+    batch.match = config;
+    batch.matches = matches;
+    batch.threads = threads;
+    std::vector<MatchResult> results;
+    BatchSummary summary = runBatch(batch, &results);
+
+    if (!quiet) {
+        for (size_t match = 0; match < results.size(); ++match) {
+            const MatchResult& result = results[match];
+            std::cout << "match " << match << " seed " << result.seed << ": " << outcomeName(result.outcome)
+                << " after " << result.ticks << " ticks, winner " << result.winner
+                << ", enemies left " << result.enemiesLeft << ", scores";
+            for (int p = 0; p < config.playerCount; ++p) std::cout << " " << result.scores[p];
+            std::cout << std::endl;
+        }
+    }
+    if (!csvPath.empty() && !writeMatchCsv(csvPath, results, config.playerCount)) return 1;
+
+    std::cout << summary.matches << " matches on " << summary.threads << " threads, " << summary.totalTicks << " ticks in "
+        << summary.wallSeconds << " s (" << summary.ticksPerSecond << " ticks/s); won " << summary.outcomes[1]
+        << ", lost " << summary.outcomes[2] << ", time up " << summary.outcomes[3]
+        << " (win rate " << summary.winRate * 100.0 << "%)" << std::endl;
+    if (config.playerCount > 1) {
+        std::cout << "wins by player:";
+        for (int p = 0; p < config.playerCount; ++p) std::cout << " " << summary.wins[p];
+        std::cout << std::endl;
+    }
+    printDistribution("match length (s)", summary.matchSeconds);
+    printDistribution("score", summary.scores);
+    printDistribution("mean tick (ns)", summary.meanTickNs);
+    printDistribution("worst tick (ns)", summary.maxTickNs);
+    return 0;
+}
@@ -0,0 +1,54 @@
+#ifndef SIM_TYPES_H
+#define SIM_TYPES_H
+
+#include <cstdint>
+#include "Counters.h"
+
+// Shared plain types for the simulation core. Nothing in the core includes SDL.
+
+const int TICKS_PER_SECOND = 60;
+const int MAX_PLAYERS = 8;
+
+struct Rect {
+    int x;
+    int y;
+    int w;
+    int h;
+};
+
+inline bool checkCollision(const Rect& a, const Rect& b) {
+    COUNTER_ADD(Counter::COLLISION_PAIR_TESTS, 1);
+    return !(a.y + a.h <= b.y || a.y >= b.y + b.h || a.x + a.w <= b.x || a.x >= b.x + b.w);
+}
+
+struct TilePos {
+    int row;
+    int col;
+};
+
+enum Direction {
+    UP,
+    DOWN,
+    LEFT,
+    RIGHT
+};
+
+// One player's buttons for one tick. Directions are held state; BOMB asks
+// for a bomb to be placed on this tick.
+enum InputButton : uint8_t {
+    INPUT_UP = 1 << 0,
+    INPUT_DOWN = 1 << 1,
+    INPUT_LEFT = 1 << 2,
+    INPUT_RIGHT = 1 << 3,
+    INPUT_BOMB = 1 << 4
+};
+
+struct TickInput {
+    uint8_t buttons[MAX_PLAYERS] = {};
+};
+
+inline int secondsToTicks(float seconds) {
+    return static_cast<int>(seconds * TICKS_PER_SECOND + 0.5f);
+}
+
+#endif // SIM_TYPES_H
@@ -0,0 +1,444 @@
+#include "Simulation.h"
+#include "AllocationTracker.h"
+#include "ByteStream.h"
+#include <algorithm>
+#include <iostream>
+
+MatchConfig MatchConfig::fromOptions(const GameOptions& options, int screenWidth, int screenHeight) {
+    MatchConfig config;
+    const int DESIRED_COLUMNS = 20;
+    config.tileSize = std::max(20, screenWidth / DESIRED_COLUMNS);
+    config.columns = DESIRED_COLUMNS;
+    config.rows = screenHeight / config.tileSize;
+    if (config.rows <= 2) {
+        config.tileSize = 40;
+        config.columns = screenWidth / config.tileSize;
+        config.rows = screenHeight / config.tileSize;
+    }
+    config.enemyCount = options.enemyCount;
+    config.playerSpeed = options.actualPlayerSpeed;
+    config.maxActiveBombs = options.playerMaxActiveBombs;
+    config.bombRange = options.playerBombRange;
+    config.playerCount = std::min(MAX_PLAYERS, 1 + std::max(0, options.botOpponents));
+    return config;
+}
+
+Simulation::Simulation()
+    : mTick(0),
+    mOutcome(MatchOutcome::IN_PROGRESS),
+    mWinner(-1)
+{
+    std::fill(mScores, mScores + MAX_PLAYERS, 0);
+}
+
+TilePos Simulation::getSpawnTile(int player) const {
+    int lastRow = mMap.getRows() - 2;
+    int lastCol = mMap.getColumns() - 2;
+    switch (player) {
+    case 0: return { 1, 1 };
+    case 1: return { lastRow, lastCol };
+    case 2: return { 1, lastCol };
+    case 3: return { lastRow, 1 };
+    case 4: return { 1, mMap.getColumns() / 2 };
+    case 5: return { lastRow, mMap.getColumns() / 2 };
+    case 6: return { mMap.getRows() / 2, 1 };
+    default: return { mMap.getRows() / 2, lastCol };
+    }
+}
+
+bool Simulation::reset(const MatchConfig& config) {
+    if (config.playerCount < 1 || config.playerCount > MAX_PLAYERS) {
+        std::cerr << "Simulation Error: Player count must be between 1 and " << MAX_PLAYERS << "." << std::endl;
+        return false;
+    }
+    mConfig = config;
+    if (!mMap.initialize(mConfig.columns, mConfig.rows, mConfig.tileSize)) {
+        return false;
+    }
+    mRng.reseed(mConfig.seed);
+
+    mSpawnTiles.clear();
+    for (int i = 0; i < mConfig.playerCount; ++i) {
+        mSpawnTiles.push_back(getSpawnTile(i));
+    }
+    mMap.generateInitialLayout(mRng, mSpawnTiles);
+
+    int tileSize = mMap.getTileSize();
+    mPlayers.clear();
+    for (const auto& spawn : mSpawnTiles) {
+        Player player(spawn.col * tileSize, spawn.row * tileSize);
+        player.setSpeed(mConfig.playerSpeed);
+        mPlayers.push_back(player);
+    }
+
+    mEnemies.clear();
+    mEnemies.reserve(mConfig.enemyCount);
+    for (int i = 0; i < mConfig.enemyCount; ++i) {
+        Enemy enemy(0, 0, tileSize, static_cast<Direction>(mRng.nextInt(4)));
+        if (enemy.findSafePosition(mMap, mRng, mSpawnTiles)) {
+            enemy.setId(static_cast<uint32_t>(mEnemies.size()));
+            mEnemies.push_back(enemy);
+        }
+    }
+    if (mEnemies.size() < static_cast<size_t>(mConfig.enemyCount)) {
+        std::cerr << "Simulation Warning: Placed " << mEnemies.size() << " of " << mConfig.enemyCount << " enemies." << std::endl;
+    }
+
+    // Room for every player's fused bombs plus as many still exploding, and
+    // for the most events one tick can emit, so that steady-state ticks never
+    // grow these vectors.
+    int bombCapacity = 2 * mConfig.playerCount * std::max(1, mConfig.maxActiveBombs);
+    mBombs.clear();
+    mBombs.reserve(bombCapacity);
+    mEvents.clear();
+    mEvents.reserve(2 * mConfig.playerCount + 2 * bombCapacity + mConfig.enemyCount + 1);
+    mPlayerTiles.clear();
+    mPlayerTiles.reserve(MAX_PLAYERS);
+    std::fill(mScores, mScores + MAX_PLAYERS, 0);
+    mTick = 0;
+    mOutcome = MatchOutcome::IN_PROGRESS;
+    mWinner = -1;
+    return true;
+}
+
+int Simulation::getAlivePlayerCount() const {
+    int alive = 0;
+    for (const auto& player : mPlayers) {
+        if (player.isAlive()) ++alive;
+    }
+    return alive;
+}
+
+namespace {
+    const uint64_t FNV_OFFSET = 14695981039346656037ull;
+    const uint64_t FNV_PRIME = 1099511628211ull;
+
+    void hashValue(uint64_t& hash, uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            hash ^= (value >> (i * 8)) & 0xFF;
+            hash *= FNV_PRIME;
+        }
+    }
+}
+
+uint64_t Simulation::computeChecksum() const {
+    uint64_t hash = FNV_OFFSET;
+    hashValue(hash, static_cast<uint64_t>(mTick));
+    hashValue(hash, mRng.getState());
+    hashValue(hash, static_cast<uint64_t>(mOutcome));
+    for (int r = 0; r < mMap.getRows(); ++r) {
+        for (int c = 0; c < mMap.getColumns(); ++c) {
+            hashValue(hash, static_cast<uint64_t>(mMap.getTileType(r, c)));
+        }
+    }
+    for (size_t i = 0; i < mPlayers.size(); ++i) {
+        hashValue(hash, static_cast<uint64_t>(mPlayers[i].getX()));
+        hashValue(hash, static_cast<uint64_t>(mPlayers[i].getY()));
+        hashValue(hash, mPlayers[i].isAlive());
+        hashValue(hash, static_cast<uint64_t>(mScores[i]));
+    }
+    for (const auto& enemy : mEnemies) {
+        hashValue(hash, static_cast<uint64_t>(enemy.getX()));
+        hashValue(hash, static_cast<uint64_t>(enemy.getY()));
+    }
+    for (const auto& bomb : mBombs) {
+        hashValue(hash, static_cast<uint64_t>(bomb.getX()));
+        hashValue(hash, static_cast<uint64_t>(bomb.getY()));
+        hashValue(hash, static_cast<uint64_t>(bomb.getAgeTicks()));
+        hashValue(hash, bomb.isExploding());
+    }
+    return hash;
+}
+
+namespace {
+    const uint8_t SNAPSHOT_MAGIC[2] = { 'B', 'S' };
+    const int MAX_SNAPSHOT_DIMENSION = 4096;
+}
+
+// Layout: "BS" | u8 version | config | tick | rng | outcome | winner | scores
+// | tiles | players | enemy count, enemies | bomb count, bombs. Sizes and
+// positions are varints, so a default match fits in a couple hundred bytes.
+void Simulation::saveSnapshot(std::vector<uint8_t>& out) const {
+    out.clear();
+    ByteWriter writer(out);
+    writer.writeU8(SNAPSHOT_MAGIC[0]);
+    writer.writeU8(SNAPSHOT_MAGIC[1]);
+    writer.writeU8(SNAPSHOT_VERSION);
+
+    writer.writeVarint(static_cast<uint64_t>(mConfig.columns));
+    writer.writeVarint(static_cast<uint64_t>(mConfig.rows));
+    writer.writeVarint(static_cast<uint64_t>(mConfig.tileSize));
+    writer.writeU8(static_cast<uint8_t>(mConfig.playerCount));
+    writer.writeVarint(static_cast<uint64_t>(mConfig.enemyCount));
+    writer.writeFloat(mConfig.playerSpeed);
+    writer.writeVarint(static_cast<uint64_t>(mConfig.maxActiveBombs));
+    writer.writeVarint(static_cast<uint64_t>(mConfig.bombRange));
+    writer.writeVarint(static_cast<uint64_t>(mConfig.matchTicks));
+    writer.writeVarint(mConfig.seed);
+    writer.writeU8(mConfig.invulnerablePlayers ? 1 : 0);
+
+    writer.writeVarint(static_cast<uint64_t>(mTick));
+    writer.writeU64(mRng.getState());
+    writer.writeU8(static_cast<uint8_t>(mOutcome));
+    writer.writeSignedVarint(mWinner);
+    for (int i = 0; i < mConfig.playerCount; ++i) {
+        writer.writeVarint(static_cast<uint64_t>(mScores[i]));
+    }
+
+    mMap.saveTiles(writer);
+    for (const auto& player : mPlayers) {
+        player.saveState(writer);
+    }
+    writer.writeVarint(mEnemies.size());
+    for (const auto& enemy : mEnemies) {
+        enemy.saveState(writer);
+    }
+    writer.writeVarint(mBombs.size());
+    for (const auto& bomb : mBombs) {
+        bomb.saveState(writer);
+    }
+}
+
+bool Simulation::restoreSnapshot(const uint8_t* data, size_t size) {
+    if (size < 3 || data[0] != SNAPSHOT_MAGIC[0] || data[1] != SNAPSHOT_MAGIC[1] || data[2] != SNAPSHOT_VERSION) {
+        std::cerr << "Simulation Error: Not a version " << static_cast<int>(SNAPSHOT_VERSION) << " snapshot." << std::endl;
+        return false;
+    }
+    ByteReader reader(data, size, 3);
+
+    MatchConfig config;
+    config.columns = static_cast<int>(reader.readVarint());
+    config.rows = static_cast<int>(reader.readVarint());
+    config.tileSize = static_cast<int>(reader.readVarint());
+    config.playerCount = reader.readU8();
+    config.enemyCount = static_cast<int>(reader.readVarint());
+    config.playerSpeed = reader.readFloat();
+    config.maxActiveBombs = static_cast<int>(reader.readVarint());
+    config.bombRange = static_cast<int>(reader.readVarint());
+    config.matchTicks = static_cast<int>(reader.readVarint());
+    config.seed = reader.readVarint();
+    config.invulnerablePlayers = reader.readU8() != 0;
+    if (!reader.isOk() || config.playerCount < 1 || config.playerCount > MAX_PLAYERS
+        || config.columns > MAX_SNAPSHOT_DIMENSION || config.rows > MAX_SNAPSHOT_DIMENSION) {
+        std::cerr << "Simulation Error: Snapshot has a corrupt config." << std::endl;
+        return false;
+    }
+    if (!mMap.initialize(config.columns, config.rows, config.tileSize)) {
+        return false;
+    }
+    mConfig = config;
+
+    mTick = static_cast<int>(reader.readVarint());
+    mRng.setState(reader.readU64());
+    mOutcome = static_cast<MatchOutcome>(reader.readU8());
+    mWinner = static_cast<int>(reader.readSignedVarint());
+    std::fill(mScores, mScores + MAX_PLAYERS, 0);
+    for (int i = 0; i < mConfig.playerCount; ++i) {
+        mScores[i] = static_cast<int>(reader.readVarint());
+    }
+
+    mMap.loadTiles(reader);
+
+    int tileSize = mMap.getTileSize();
+    mSpawnTiles.clear();
+    mPlayers.clear();
+    for (int i = 0; i < mConfig.playerCount; ++i) {
+        mSpawnTiles.push_back(getSpawnTile(i));
+        Player player(0, 0);
+        player.setSpeed(mConfig.playerSpeed);
+        player.loadState(reader);
+        mPlayers.push_back(player);
+    }
+
+    uint64_t enemyCount = reader.readVarint();
+    if (enemyCount > static_cast<uint64_t>(mConfig.columns) * mConfig.rows) reader.fail();
+    mEnemies.clear();
+    for (uint64_t i = 0; i < enemyCount && reader.isOk(); ++i) {
+        Enemy enemy(0, 0, tileSize, UP);
+        enemy.loadState(reader);
+        mEnemies.push_back(enemy);
+    }
+
+    uint64_t bombCount = reader.readVarint();
+    if (bombCount > static_cast<uint64_t>(mConfig.columns) * mConfig.rows) reader.fail();
+    mBombs.clear();
+    for (uint64_t i = 0; i < bombCount && reader.isOk(); ++i) {
+        Bomb bomb(0, 0, tileSize, 0, 0, 0);
+        bomb.loadState(reader);
+        if (bomb.getOwner() >= mConfig.playerCount) reader.fail();
+        mBombs.push_back(bomb);
+    }
+    mEvents.clear();
+
+    if (!reader.isOk() || !reader.atEnd() || mOutcome > MatchOutcome::TIME_UP) {
+        std::cerr << "Simulation Error: Snapshot is truncated or corrupt." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void Simulation::emit(SimEventType type, int player, int x, int y, int count) {
+    mEvents.push_back({ type, player, x, y, count });
+}
+
+void Simulation::step(const TickInput& input) {
+    ALLOCATION_PHASE("sim.step");
+    mEvents.clear();
+    if (isOver()) return;
+    ++mTick;
+
+    for (size_t i = 0; i < mPlayers.size(); ++i) {
+        Player& player = mPlayers[i];
+        if (!player.isAlive()) continue;
+        player.applyInput(input.buttons[i]);
+        if (input.buttons[i] & INPUT_BOMB) placeBomb(static_cast<int>(i));
+        player.update(mMap);
+    }
+
+    int tileSize = mMap.getTileSize();
+    mPlayerTiles.clear();
+    for (const auto& player : mPlayers) {
+        if (!player.isAlive()) continue;
+        mPlayerTiles.push_back({ (player.getY() + player.getHeight() / 2) / tileSize, (player.getX() + player.getWidth() / 2) / tileSize });
+    }
+    for (auto& enemy : mEnemies) {
+        enemy.update(mMap, mRng, mPlayerTiles);
+        Rect enemyRect = enemy.getRect();
+        for (size_t i = 0; i < mPlayers.size(); ++i) {
+            if (mPlayers[i].isAlive() && checkCollision(mPlayers[i].getRect(), enemyRect)) {
+                killPlayer(static_cast<int>(i));
+            }
+        }
+    }
+
+    updateBombs();
+    checkMatchOver();
+
+    if (!isOver() && mTick >= mConfig.matchTicks) {
+        finish(MatchOutcome::TIME_UP);
+    }
+}
+
+void Simulation::placeBomb(int player) {
+    const Player& owner = mPlayers[player];
+
+    int activeBombsCount = 0;
+    for (const auto& bomb : mBombs) {
+        if (bomb.getOwner() == player && !bomb.isExploding() && !bomb.isDone()) {
+            activeBombsCount++;
+        }
+    }
+    if (activeBombsCount >= mConfig.maxActiveBombs) {
+        return;
+    }
+
+    int tileSize = mMap.getTileSize();
+    int bombPlacementX = (owner.getX() + owner.getWidth() / 2) / tileSize * tileSize;
+    int bombPlacementY = (owner.getY() + owner.getHeight() / 2) / tileSize * tileSize;
+
+    for (const auto& bomb : mBombs) {
+        if (!bomb.isDone() && bomb.getX() == bombPlacementX && bomb.getY() == bombPlacementY) {
+            return;
+        }
+    }
+
+    int fuseTicks = Bomb::DEFAULT_FUSE_TICKS;
+    mBombs.emplace_back(bombPlacementX, bombPlacementY, tileSize, fuseTicks, mConfig.bombRange, player);
+    emit(SimEventType::BOMB_PLACED, player, bombPlacementX, bombPlacementY);
+}
+
+bool Simulation::addBomb(int row, int col, int owner, int fuseTicks) {
+    if (owner < 0 || owner >= static_cast<int>(mPlayers.size()) || mMap.getTileType(row, col) != TileType::EMPTY) {
+        return false;
+    }
+    int tileSize = mMap.getTileSize();
+    for (const auto& bomb : mBombs) {
+        if (bomb.getX() == col * tileSize && bomb.getY() == row * tileSize) return false;
+    }
+    mBombs.emplace_back(col * tileSize, row * tileSize, tileSize, fuseTicks, mConfig.bombRange, owner);
+    return true;
+}
+
+void Simulation::killPlayer(int player) {
+    if (mConfig.invulnerablePlayers) return;
+    mPlayers[player].kill();
+    emit(SimEventType::PLAYER_KILLED, player, mPlayers[player].getX(), mPlayers[player].getY());
+}
+
+void Simulation::updateBombs() {
+    int tileSize = mMap.getTileSize();
+    for (auto& bomb : mBombs) {
+        if (bomb.update(mMap)) {
+            emit(SimEventType::BOMB_EXPLODED, bomb.getOwner(), bomb.getX(), bomb.getY());
+        }
+        if (!bomb.isExploding() || bomb.isDone()) continue;
+
+        const Explosion& explosion = bomb.getExplosion();
+        int softWallsDestroyed = mMap.handleExplosion(explosion);
+        if (softWallsDestroyed > 0) {
+            mScores[bomb.getOwner()] += softWallsDestroyed * SCORE_PER_SOFT_WALL;
+            emit(SimEventType::SOFT_WALL_DESTROYED, bomb.getOwner(), bomb.getX(), bomb.getY(), softWallsDestroyed);
+        }
+
+        for (const auto& part : explosion) {
+            Rect explosionRect = { part.x, part.y, tileSize, tileSize };
+            for (size_t i = 0; i < mPlayers.size(); ++i) {
+                if (mPlayers[i].isAlive() && checkCollision(mPlayers[i].getRect(), explosionRect)) {
+                    killPlayer(static_cast<int>(i));
+                }
+            }
+        }
+
+        for (auto enemyIt = mEnemies.begin(); enemyIt != mEnemies.end();) {
+            bool enemyHit = false;
+            Rect enemyRect = enemyIt->getRect();
+            for (const auto& part : explosion) {
+                Rect explosionRect = { part.x, part.y, tileSize, tileSize };
+                if (checkCollision(enemyRect, explosionRect)) {
+                    enemyHit = true;
+                    break;
+                }
+            }
+            if (enemyHit) {
+                mScores[bomb.getOwner()] += SCORE_PER_ENEMY;
+                emit(SimEventType::ENEMY_KILLED, bomb.getOwner(), enemyIt->getX(), enemyIt->getY());
+                enemyIt = mEnemies.erase(enemyIt);
+            }
+            else {
+                ++enemyIt;
+            }
+        }
+    }
+    mBombs.erase(std::remove_if(mBombs.begin(), mBombs.end(), [](const Bomb& bomb) { return bomb.isDone(); }), mBombs.end());
+}
+
+// One player: lose on death, win once every enemy is gone. Several players:
+// the match also ends when at most one of them is left standing.
+void Simulation::checkMatchOver() {
+    int alive = getAlivePlayerCount();
+    if (alive == 0) {
+        finish(MatchOutcome::LOST);
+    }
+    else if (mConfig.enemyCount > 0 && mEnemies.empty()) {
+        finish(MatchOutcome::WON);
+    }
+    else if (mConfig.playerCount > 1 && alive == 1) {
+        finish(MatchOutcome::WON);
+    }
+}
+
+void Simulation::finish(MatchOutcome outcome) {
+    mOutcome = outcome;
+    if (getAlivePlayerCount() == 1) {
+        for (size_t i = 0; i < mPlayers.size(); ++i) {
+            if (mPlayers[i].isAlive()) mWinner = static_cast<int>(i);
+        }
+    }
+    if (outcome == MatchOutcome::WON) {
+        int timeBonus = getRemainingTicks() / TICKS_PER_SECOND * SCORE_PER_SECOND_LEFT;
+        for (size_t i = 0; i < mPlayers.size(); ++i) {
+            if (mPlayers[i].isAlive()) mScores[i] += timeBonus;
+        }
+    }
+    emit(SimEventType::MATCH_OVER, mWinner, 0, 0);
+}
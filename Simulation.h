@@ -0,0 +1,137 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <cstdint>
+#include <vector>
+#include "SimTypes.h"
+#include "Rng.h"
+#include "GameOptions.h"
+#include "Map.h"
+#include "Player.h"
+#include "Enemies.h"
+#include "Bomb.h"
+
+// Everything needed to start a match. The defaults match the 800x600 game.
+struct MatchConfig {
+    int columns = 20;
+    int rows = 15;
+    int tileSize = 40;
+    int playerCount = 1;
+    int enemyCount = 3;
+    float playerSpeed = 200.0f;
+    int maxActiveBombs = 1;
+    int bombRange = 1;
+    int matchTicks = 180 * TICKS_PER_SECOND;
+    uint64_t seed = 1;
+    // Players survive enemies and blasts, so benchmarks and soak runs keep a
+    // match going at a steady load.
+    bool invulnerablePlayers = false;
+
+    static MatchConfig fromOptions(const GameOptions& options, int screenWidth, int screenHeight);
+};
+
+enum class SimEventType : uint8_t {
+    BOMB_PLACED,
+    BOMB_EXPLODED,
+    SOFT_WALL_DESTROYED,
+    ENEMY_KILLED,
+    PLAYER_KILLED,
+    MATCH_OVER
+};
+
+// player is the owner/victim where one applies, -1 otherwise. For
+// SOFT_WALL_DESTROYED, count holds the number of walls.
+struct SimEvent {
+    SimEventType type;
+    int player;
+    int x;
+    int y;
+    int count;
+};
+
+enum class MatchOutcome : uint8_t {
+    IN_PROGRESS,
+    WON,
+    LOST,
+    TIME_UP
+};
+
+// The gameplay rules with no platform dependencies. A match advances in fixed
+// ticks of 1/TICKS_PER_SECOND seconds and is fully determined by its config
+// and the sequence of inputs, so simulations can be copied, stepped in bulk or
+// run on a server without SDL.
+class Simulation {
+public:
+    static const int SCORE_PER_SOFT_WALL = 50;
+    static const int SCORE_PER_ENEMY = 500;
+    static const int SCORE_PER_SECOND_LEFT = 20;
+
+    Simulation();
+
+    bool reset(const MatchConfig& config);
+    void step(const TickInput& input);
+
+    // Events produced by the most recent step().
+    const std::vector<SimEvent>& getEvents() const { return mEvents; }
+
+    const MatchConfig& getConfig() const { return mConfig; }
+    const Map& getMap() const { return mMap; }
+    const std::vector<Player>& getPlayers() const { return mPlayers; }
+    const std::vector<Enemy>& getEnemies() const { return mEnemies; }
+    const std::vector<Bomb>& getBombs() const { return mBombs; }
+    int getScore(int player) const { return mScores[player]; }
+    int getTick() const { return mTick; }
+    int getRemainingTicks() const { return mTick < mConfig.matchTicks ? mConfig.matchTicks - mTick : 0; }
+    MatchOutcome getOutcome() const { return mOutcome; }
+    bool isOver() const { return mOutcome != MatchOutcome::IN_PROGRESS; }
+    // The only surviving player when the match is over, -1 if there is none.
+    int getWinner() const { return mWinner; }
+    int getAlivePlayerCount() const;
+
+    // Hash of the full match state (map, entities, scores, tick, RNG). Two
+    // runs that agree on this after every tick have not diverged.
+    uint64_t computeChecksum() const;
+
+    static const uint8_t SNAPSHOT_VERSION = 2;
+
+    // Writes the complete match state (config, tick, RNG, map, entities and
+    // scores) into `out`, replacing its contents. Reusing the buffer keeps
+    // this allocation-free, so it is cheap enough to call every tick.
+    void saveSnapshot(std::vector<uint8_t>& out) const;
+    // Restores a state written by saveSnapshot, config included; events are
+    // cleared. Returns false for a malformed blob or another version, after
+    // which the simulation must be reset before it is stepped again.
+    bool restoreSnapshot(const uint8_t* data, size_t size);
+    bool restoreSnapshot(const std::vector<uint8_t>& data) { return restoreSnapshot(data.data(), data.size()); }
+
+    TilePos getSpawnTile(int player) const;
+
+    // Scenario setup for tools: drops a bomb on an empty tile regardless of
+    // the owner's bomb limit. Returns false if the tile is not free.
+    bool addBomb(int row, int col, int owner, int fuseTicks);
+
+private:
+    MatchConfig mConfig;
+    Map mMap;
+    Rng mRng;
+    std::vector<Player> mPlayers;
+    std::vector<Enemy> mEnemies;
+    std::vector<Bomb> mBombs;
+    std::vector<TilePos> mSpawnTiles;
+    // Tiles of the living players, gathered each tick for enemies to chase.
+    std::vector<TilePos> mPlayerTiles;
+    std::vector<SimEvent> mEvents;
+    int mScores[MAX_PLAYERS];
+    int mTick;
+    MatchOutcome mOutcome;
+    int mWinner;
+
+    void placeBomb(int player);
+    void killPlayer(int player);
+    void updateBombs();
+    void checkMatchOver();
+    void finish(MatchOutcome outcome);
+    void emit(SimEventType type, int player, int x, int y, int count = 1);
+};
+
+#endif // SIMULATION_H
@@ -0,0 +1,44 @@
+#include "SpectatorRelay.h"
+
+SpectatorRelay::SpectatorRelay() {
+    configure(0, 0, 0, 0, 0);
+}
+
+void SpectatorRelay::configure(int columns, int rows, int tileSize, int regionColumns, int regionRows) {
+    mAreas.clear();
+    if (regionColumns <= 0 || regionRows <= 0 || columns <= 0 || rows <= 0) {
+        mAreas.push_back(InterestArea());
+    }
+    else {
+        for (int row = 0; row < rows; row += regionRows) {
+            for (int col = 0; col < columns; col += regionColumns) {
+                InterestArea area;
+                area.x = col * tileSize;
+                area.y = row * tileSize;
+                area.width = (col + regionColumns > columns ? columns - col : regionColumns) * tileSize;
+                area.height = (row + regionRows > rows ? rows - row : regionRows) * tileSize;
+                mAreas.push_back(area);
+            }
+        }
+    }
+
+    mClients.assign(mAreas.size(), ReplicaClient());
+    mStreams.assign(mAreas.size(), std::vector<uint8_t>());
+    for (size_t region = 0; region < mAreas.size(); ++region) {
+        mClients[region].area = mAreas[region];
+        mClients[region].keyframeInterval = KEYFRAME_INTERVAL;
+    }
+}
+
+void SpectatorRelay::update(Replicator& replicator, const std::vector<uint8_t>& watched) {
+    for (size_t region = 0; region < mAreas.size() && region < watched.size(); ++region) {
+        if (!watched[region]) continue;
+        ReplicaClient& client = mClients[region];
+        std::vector<uint8_t>& stream = mStreams[region];
+        stream.clear();
+        // Acknowledging only keyframes keeps them as the base of every delta.
+        if (replicator.encode(client, stream)) {
+            replicator.acknowledge(client, replicator.getGeneration(), replicator.getLatest().tick);
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef SPECTATOR_RELAY_H
+#define SPECTATOR_RELAY_H
+
+#include <cstdint>
+#include <vector>
+#include "Replication.h"
+
+// Replication for viewers who only watch. The map is cut into regions of a
+// fixed size, and each tick one stream is encoded per watched region, however
+// many viewers watch it, so a server sends the same bytes to all of them.
+//
+// Viewers never acknowledge anything. Instead every delta in a stream is
+// against the stream's last keyframe, which goes out every KEYFRAME_INTERVAL
+// ticks: a lost delta costs nothing, and a viewer who joins or loses a
+// keyframe catches up at the next one.
+class SpectatorRelay {
+public:
+    // Must stay below Replicator::HISTORY_SIZE, the oldest base a delta can use.
+    static const int KEYFRAME_INTERVAL = TICKS_PER_SECOND / 2;
+
+    SpectatorRelay();
+
+    // Regions of regionColumns x regionRows tiles, the last row and column
+    // cut short at the map's edge. 0 for either makes the whole map one
+    // region.
+    void configure(int columns, int rows, int tileSize, int regionColumns, int regionRows);
+
+    int getRegionCount() const { return static_cast<int>(mAreas.size()); }
+    const InterestArea& getRegionArea(int region) const { return mAreas[region]; }
+
+    // Encodes the replicator's captured state for each region where
+    // watched[region] is non-zero. Unwatched regions keep their last stream.
+    void update(Replicator& replicator, const std::vector<uint8_t>& watched);
+
+    // The region's message for the last update that encoded it.
+    const std::vector<uint8_t>& getStream(int region) const { return mStreams[region]; }
+
+private:
+    std::vector<InterestArea> mAreas;
+    std::vector<ReplicaClient> mClients;
+    std::vector<std::vector<uint8_t>> mStreams;
+};
+
+#endif // SPECTATOR_RELAY_H
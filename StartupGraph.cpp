@@ -0,0 +1,185 @@
+#include "StartupGraph.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <utility>
+
+StartupGraph::StartupGraph()
+    : mOrigin(std::chrono::steady_clock::now())
+{
+}
+
+StartupGraph::TaskId StartupGraph::add(const std::string& name, TaskThread thread, std::vector<TaskId> dependencies, TaskFunction run) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    TaskId id = static_cast<TaskId>(mTasks.size());
+    // Only tasks added earlier can be depended on, which keeps the graph acyclic.
+    dependencies.erase(std::remove_if(dependencies.begin(), dependencies.end(),
+        [id](TaskId dependency) { return dependency < 0 || dependency >= id; }), dependencies.end());
+    Task task;
+    task.name = name;
+    task.thread = thread;
+    task.dependencies = std::move(dependencies);
+    task.run = std::move(run);
+    mTasks.push_back(std::move(task));
+    return id;
+}
+
+bool StartupGraph::run(int workerCount) {
+    size_t first = 0;
+    size_t workerTasks = 0;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        while (first < mTasks.size() && mTasks[first].state != TaskState::WAITING) ++first;
+        for (size_t i = first; i < mTasks.size(); ++i) {
+            if (mTasks[i].thread == TaskThread::WORKER) ++workerTasks;
+        }
+    }
+    if (workerCount <= 0) {
+        int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+        workerCount = std::max(1, std::min(4, hardwareThreads));
+    }
+    workerCount = static_cast<int>(std::min(workerTasks, static_cast<size_t>(workerCount)));
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&StartupGraph::workerLoop, this);
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (hasUnfinished()) {
+            TaskId id = findReady(TaskThread::MAIN);
+            if (id != NO_TASK) execute(lock, id);
+            else mChanged.wait(lock);
+        }
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    bool succeeded = true;
+    for (size_t i = first; i < mTasks.size(); ++i) {
+        if (mTasks[i].state != TaskState::DONE) succeeded = false;
+    }
+    return succeeded;
+}
+
+StartupGraph::TaskId StartupGraph::findReady(TaskThread thread) {
+    TaskId ready = NO_TASK;
+    bool skipped = false;
+    for (size_t i = 0; i < mTasks.size(); ++i) {
+        Task& task = mTasks[i];
+        if (task.state != TaskState::WAITING) continue;
+        bool blocked = false;
+        const Task* failed = nullptr;
+        for (TaskId dependency : task.dependencies) {
+            TaskState state = mTasks[dependency].state;
+            if (state == TaskState::FAILED || state == TaskState::SKIPPED) failed = &mTasks[dependency];
+            else if (state != TaskState::DONE) blocked = true;
+        }
+        if (failed) {
+            // Dependencies precede their dependents, so a failure cascades in this one pass.
+            std::cerr << "StartupGraph Error: Skipping '" << task.name << "' because '" << failed->name << "' did not complete." << std::endl;
+            task.state = TaskState::SKIPPED;
+            task.startMs = task.endMs = elapsedMs();
+            skipped = true;
+            continue;
+        }
+        if (!blocked && task.thread == thread && ready == NO_TASK) ready = static_cast<TaskId>(i);
+    }
+    if (skipped) mChanged.notify_all();
+    return ready;
+}
+
+bool StartupGraph::hasUnfinished() const {
+    for (const Task& task : mTasks) {
+        if (task.state == TaskState::WAITING || task.state == TaskState::RUNNING) return true;
+    }
+    return false;
+}
+
+void StartupGraph::execute(std::unique_lock<std::mutex>& lock, TaskId id) {
+    Task& task = mTasks[id];
+    task.state = TaskState::RUNNING;
+    task.startMs = elapsedMs();
+    // Tasks are only added between runs, so the reference stays valid unlocked.
+    lock.unlock();
+    bool succeeded = task.run();
+    lock.lock();
+    task.endMs = elapsedMs();
+    task.state = succeeded ? TaskState::DONE : TaskState::FAILED;
+    task.run = nullptr;
+    mChanged.notify_all();
+}
+
+void StartupGraph::workerLoop() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+        TaskId id = findReady(TaskThread::WORKER);
+        if (id != NO_TASK) {
+            execute(lock, id);
+            continue;
+        }
+        bool workerTaskWaiting = false;
+        for (const Task& task : mTasks) {
+            if (task.thread == TaskThread::WORKER && task.state == TaskState::WAITING) workerTaskWaiting = true;
+        }
+        if (!workerTaskWaiting) return;
+        mChanged.wait(lock);
+    }
+}
+
+void StartupGraph::mark(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMilestones.push_back({ name, elapsedMs() });
+}
+
+double StartupGraph::elapsedMs() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mOrigin).count();
+}
+
+void StartupGraph::printReport(std::ostream& out) const {
+    static const char* STATE_NAMES[] = { "waiting", "running", "ok", "failed", "skipped" };
+
+    size_t nameWidth = 4;
+    for (const Task& task : mTasks) {
+        nameWidth = std::max(nameWidth, task.name.size());
+    }
+
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1);
+    out << "Startup timeline (ms since launch):" << std::endl;
+
+    double mainMs = 0.0;
+    double workerMs = 0.0;
+    std::vector<std::pair<double, double>> spans;
+    for (const Task& task : mTasks) {
+        double duration = task.endMs - task.startMs;
+        out << "  " << std::left << std::setw(static_cast<int>(nameWidth)) << task.name << std::right
+            << (task.thread == TaskThread::MAIN ? "  main  " : "  worker")
+            << std::setw(9) << task.startMs << " ->" << std::setw(8) << task.endMs
+            << std::setw(8) << duration << " ms  " << STATE_NAMES[static_cast<int>(task.state)] << std::endl;
+        (task.thread == TaskThread::MAIN ? mainMs : workerMs) += duration;
+        spans.push_back({ task.startMs, task.endMs });
+    }
+    for (const Milestone& milestone : mMilestones) {
+        out << "  " << milestone.name << " at " << milestone.atMs << " ms" << std::endl;
+    }
+
+    // Time covered by at least one task, to show how much the overlap saved
+    // over running the same tasks one after another.
+    std::sort(spans.begin(), spans.end());
+    double coveredMs = 0.0;
+    double coveredUntil = 0.0;
+    for (const auto& span : spans) {
+        double from = std::max(span.first, coveredUntil);
+        if (span.second > from) coveredMs += span.second - from;
+        coveredUntil = std::max(coveredUntil, span.second);
+    }
+    out << "Startup work: " << mainMs << " ms on the main thread, " << workerMs << " ms on workers, "
+        << (mainMs + workerMs - coveredMs) << " ms of it overlapped" << std::endl;
+    out.flags(flags);
+    out.precision(precision);
+}
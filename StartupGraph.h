@@ -0,0 +1,91 @@
+#ifndef STARTUP_GRAPH_H
+#define STARTUP_GRAPH_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Where a startup task may run. SDL wants video and event work on the thread
+// that initialized it; everything else may go to a worker.
+enum class TaskThread {
+    MAIN,
+    WORKER
+};
+
+// Brings the program up as a dependency graph of tasks instead of one long
+// sequence, so that independent work (opening the audio device, reading
+// fonts, creating the window) overlaps. Tasks return false on failure; their
+// dependents are then skipped. run() may be called again after more tasks are
+// added, and every task and milestone is timed from the graph's creation,
+// which should be as close to launch as possible.
+class StartupGraph {
+public:
+    using TaskId = int;
+    using TaskFunction = std::function<bool()>;
+
+    // Dependency placeholder for work that was done outside the graph.
+    static const TaskId NO_TASK = -1;
+
+    StartupGraph();
+
+    StartupGraph(const StartupGraph&) = delete;
+    StartupGraph& operator=(const StartupGraph&) = delete;
+
+    TaskId add(const std::string& name, TaskThread thread, std::vector<TaskId> dependencies, TaskFunction run);
+
+    // Runs every task added since the last call, MAIN tasks on the calling
+    // thread and WORKER tasks on up to workerCount threads (0 picks one per
+    // core, at most four). Returns false if any task failed or was skipped.
+    bool run(int workerCount = 0);
+
+    // Records a point in time such as the first frame being shown.
+    void mark(const std::string& name);
+    double elapsedMs() const;
+
+    // Per-task timeline, milestones and how much of the work overlapped.
+    void printReport(std::ostream& out) const;
+
+private:
+    enum class TaskState {
+        WAITING,
+        RUNNING,
+        DONE,
+        FAILED,
+        SKIPPED
+    };
+
+    struct Task {
+        std::string name;
+        TaskThread thread;
+        std::vector<TaskId> dependencies;
+        TaskFunction run;
+        TaskState state = TaskState::WAITING;
+        double startMs = 0.0;
+        double endMs = 0.0;
+    };
+
+    struct Milestone {
+        std::string name;
+        double atMs;
+    };
+
+    std::chrono::steady_clock::time_point mOrigin;
+    std::vector<Task> mTasks;
+    std::vector<Milestone> mMilestones;
+
+    std::mutex mMutex;
+    std::condition_variable mChanged;
+
+    // Expects mMutex held. Skips tasks whose dependencies failed and returns
+    // the first runnable task for `thread`, or NO_TASK.
+    TaskId findReady(TaskThread thread);
+    bool hasUnfinished() const;
+    void execute(std::unique_lock<std::mutex>& lock, TaskId id);
+    void workerLoop();
+};
+
+#endif // STARTUP_GRAPH_H
@@ -0,0 +1,194 @@
+#include "UdpTransport.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int SocketLength;
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef socklen_t SocketLength;
+#endif
+
+namespace {
+    const intptr_t NO_SOCKET = -1;
+    const int MAX_RECEIVE_ERRORS = 16;
+
+#ifdef _WIN32
+    // Winsock must be started once per process before the first socket.
+    bool startSockets() {
+        static bool started = false;
+        if (!started) {
+            WSADATA data;
+            started = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+        }
+        return started;
+    }
+
+    void closeSocket(intptr_t socketHandle) {
+        closesocket(static_cast<SOCKET>(socketHandle));
+    }
+
+    bool makeNonBlocking(intptr_t socketHandle) {
+        u_long enabled = 1;
+        return ioctlsocket(static_cast<SOCKET>(socketHandle), FIONBIO, &enabled) == 0;
+    }
+
+    bool lastReceiveWouldBlock() {
+        return WSAGetLastError() == WSAEWOULDBLOCK;
+    }
+#else
+    bool startSockets() {
+        return true;
+    }
+
+    void closeSocket(intptr_t socketHandle) {
+        ::close(static_cast<int>(socketHandle));
+    }
+
+    bool makeNonBlocking(intptr_t socketHandle) {
+        int flags = fcntl(static_cast<int>(socketHandle), F_GETFL, 0);
+        return flags >= 0 && fcntl(static_cast<int>(socketHandle), F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    bool lastReceiveWouldBlock() {
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+#endif
+}
+
+UdpTransport::UdpTransport()
+    : mSocket(NO_SOCKET),
+    mLocalPort(0)
+{
+}
+
+UdpTransport::~UdpTransport() {
+    close();
+}
+
+bool UdpTransport::open(uint16_t port) {
+    close();
+    if (!startSockets()) {
+        std::cerr << "Net Error: Could not start the socket library." << std::endl;
+        return false;
+    }
+    intptr_t socketHandle = static_cast<intptr_t>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+    if (socketHandle == NO_SOCKET) {
+        std::cerr << "Net Error: Could not create a UDP socket." << std::endl;
+        return false;
+    }
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(socketHandle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "Net Error: Could not bind UDP port " << port << "." << std::endl;
+        closeSocket(socketHandle);
+        return false;
+    }
+    if (!makeNonBlocking(socketHandle)) {
+        std::cerr << "Net Error: Could not make the UDP socket non-blocking." << std::endl;
+        closeSocket(socketHandle);
+        return false;
+    }
+
+    SocketLength length = sizeof(address);
+    getsockname(socketHandle, reinterpret_cast<sockaddr*>(&address), &length);
+    mSocket = socketHandle;
+    mLocalPort = ntohs(address.sin_port);
+    return true;
+}
+
+void UdpTransport::close() {
+    if (mSocket != NO_SOCKET) {
+        closeSocket(mSocket);
+        mSocket = NO_SOCKET;
+    }
+    mLocalPort = 0;
+}
+
+bool UdpTransport::isOpen() const {
+    return mSocket != NO_SOCKET;
+}
+
+uint16_t UdpTransport::getLocalPort() const {
+    return mLocalPort;
+}
+
+bool UdpTransport::setPeer(int peer, const std::string& host, uint16_t port) {
+    if (peer < 0 || !startSockets()) return false;
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &found) != 0 || !found) {
+        std::cerr << "Net Error: Could not resolve '" << host << "'." << std::endl;
+        return false;
+    }
+    uint32_t address = reinterpret_cast<sockaddr_in*>(found->ai_addr)->sin_addr.s_addr;
+    freeaddrinfo(found);
+
+    if (peer >= static_cast<int>(mPeers.size())) mPeers.resize(peer + 1, PeerAddress{ 0, 0 });
+    mPeers[peer] = PeerAddress{ address, htons(port) };
+    return true;
+}
+
+void UdpTransport::send(int peer, const uint8_t* data, size_t size) {
+    if (mSocket == NO_SOCKET || peer < 0 || peer >= static_cast<int>(mPeers.size()) || mPeers[peer].port == 0) return;
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = mPeers[peer].address;
+    address.sin_port = mPeers[peer].port;
+    // A full send buffer or an unreachable peer is just a lost datagram.
+    sendto(mSocket, reinterpret_cast<const char*>(data), static_cast<int>(size), 0,
+        reinterpret_cast<sockaddr*>(&address), sizeof(address));
+}
+
+bool UdpTransport::receive(int& peer, std::vector<uint8_t>& data) {
+    if (mSocket == NO_SOCKET) return false;
+    uint8_t buffer[MAX_DATAGRAM_SIZE];
+    int errors = 0;
+    while (true) {
+        sockaddr_in address;
+        SocketLength length = sizeof(address);
+        int received = static_cast<int>(recvfrom(mSocket, reinterpret_cast<char*>(buffer), sizeof(buffer), 0,
+            reinterpret_cast<sockaddr*>(&address), &length));
+        // Windows reports an ICMP error from an earlier send to a peer that
+        // is not up yet as a failed receive; skip it and read on.
+        if (received < 0) {
+            if (lastReceiveWouldBlock() || ++errors > MAX_RECEIVE_ERRORS) return false;
+            continue;
+        }
+        for (size_t i = 0; i < mPeers.size(); ++i) {
+            if (mPeers[i].port == address.sin_port && mPeers[i].address == address.sin_addr.s_addr) {
+                peer = static_cast<int>(i);
+                data.assign(buffer, buffer + received);
+                return true;
+            }
+        }
+    }
+}
+
+bool parseHostPort(const std::string& text, std::string& host, uint16_t& port) {
+    size_t colon = text.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == text.size()) return false;
+    char* end = nullptr;
+    long value = std::strtol(text.c_str() + colon + 1, &end, 10);
+    if (*end != '\0' || value <= 0 || value > 65535) return false;
+    host = text.substr(0, colon);
+    port = static_cast<uint16_t>(value);
+    return true;
+}
@@ -0,0 +1,49 @@
+#ifndef UDP_TRANSPORT_H
+#define UDP_TRANSPORT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "NetTransport.h"
+
+// Non-blocking IPv4 UDP socket. Each peer index is bound to one address;
+// datagrams from any other address are ignored, so a stray sender cannot
+// feed inputs into a match.
+class UdpTransport : public NetTransport {
+public:
+    UdpTransport();
+    ~UdpTransport();
+
+    UdpTransport(const UdpTransport&) = delete;
+    UdpTransport& operator=(const UdpTransport&) = delete;
+
+    // Binds to `port` on every interface; 0 picks a free port.
+    bool open(uint16_t port);
+    void close();
+    bool isOpen() const;
+    uint16_t getLocalPort() const;
+
+    // `host` is a dotted IPv4 address or a name to resolve.
+    bool setPeer(int peer, const std::string& host, uint16_t port);
+
+    void send(int peer, const uint8_t* data, size_t size) override;
+    bool receive(int& peer, std::vector<uint8_t>& data) override;
+
+private:
+    struct PeerAddress {
+        // Both in network byte order; a zero port marks an unset peer.
+        uint32_t address;
+        uint16_t port;
+    };
+
+    // A SOCKET on Windows, a file descriptor elsewhere.
+    intptr_t mSocket;
+    uint16_t mLocalPort;
+    std::vector<PeerAddress> mPeers;
+};
+
+// Splits "host:port". Returns false if either part is missing or the port
+// is out of range.
+bool parseHostPort(const std::string& text, std::string& host, uint16_t& port);
+
+#endif // UDP_TRANSPORT_H
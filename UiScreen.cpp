@@ -0,0 +1,227 @@
+#include "UiScreen.h"
+#include <algorithm>
+#include <iostream>
+
+UiScreen::UiScreen(Renderer* renderer, TTF_Font* font)
+    : mRenderer(renderer),
+    mFont(font),
+    mLayoutDirty(true)
+{
+}
+
+UiScreen::~UiScreen() {
+    for (auto& widget : mWidgets) {
+        if (widget.texture) mRenderer->destroyTexture(widget.texture);
+    }
+    for (auto& shared : mSharedTexts) {
+        if (shared.texture) mRenderer->destroyTexture(shared.texture);
+    }
+}
+
+UiScreen::WidgetId UiScreen::addWidget(WidgetKind kind, const std::string& text, SDL_Color color, TTF_Font* font) {
+    Widget widget;
+    widget.kind = kind;
+    widget.text = text;
+    widget.color = color;
+    widget.font = font ? font : mFont;
+    mWidgets.push_back(widget);
+    mLayoutDirty = true;
+    return static_cast<WidgetId>(mWidgets.size() - 1);
+}
+
+UiScreen::WidgetId UiScreen::addLabel(const std::string& text, SDL_Color color, TTF_Font* font) {
+    return addWidget(WidgetKind::LABEL, text, color, font);
+}
+
+UiScreen::WidgetId UiScreen::addButton(const std::string& text, SDL_Color color, int action, TTF_Font* font) {
+    WidgetId id = addWidget(WidgetKind::BUTTON, text, color, font);
+    mWidgets[id].action = action;
+    return id;
+}
+
+UiScreen::WidgetId UiScreen::addStepper(int value, int minValue, int maxValue, SDL_Color valueColor, SDL_Color buttonColor,
+    int decreaseAction, int increaseAction) {
+    WidgetId id = addWidget(WidgetKind::STEPPER, std::string(), valueColor, nullptr);
+    Widget& widget = mWidgets[id];
+    widget.textDirty = false;
+    widget.minValue = minValue;
+    widget.maxValue = std::max(minValue, maxValue);
+    widget.value = std::max(widget.minValue, std::min(widget.maxValue, value));
+    widget.decreaseAction = decreaseAction;
+    widget.increaseAction = increaseAction;
+    widget.decreaseTexture = sharedText("-", buttonColor, widget.font);
+    widget.increaseTexture = sharedText("+", buttonColor, widget.font);
+    for (int v = widget.minValue; v <= widget.maxValue; ++v) {
+        Texture* texture = sharedText(std::to_string(v), valueColor, widget.font);
+        widget.valueTextures.push_back(texture);
+        if (texture) widget.slotWidth = std::max(widget.slotWidth, texture->width);
+    }
+    widget.buttonSize = (widget.decreaseTexture ? widget.decreaseTexture->height : 0) + STEPPER_PADDING / 2;
+    return id;
+}
+
+void UiScreen::place(WidgetId id, int x, int y, UiAlign alignX, UiAlign alignY, WidgetId below) {
+    if (id < 0 || id >= static_cast<WidgetId>(mWidgets.size())) return;
+    Widget& widget = mWidgets[id];
+    widget.x = x;
+    widget.y = y;
+    widget.alignX = alignX;
+    widget.alignY = alignY;
+    widget.below = below < id ? below : NO_WIDGET;
+    mLayoutDirty = true;
+}
+
+void UiScreen::setText(WidgetId id, const std::string& text) {
+    if (id < 0 || id >= static_cast<WidgetId>(mWidgets.size())) return;
+    Widget& widget = mWidgets[id];
+    if (widget.kind == WidgetKind::STEPPER || widget.text == text) return;
+    widget.text = text;
+    widget.textDirty = true;
+}
+
+void UiScreen::setVisible(WidgetId id, bool visible) {
+    if (id < 0 || id >= static_cast<WidgetId>(mWidgets.size())) return;
+    if (mWidgets[id].visible == visible) return;
+    mWidgets[id].visible = visible;
+    // Hidden widgets keep their place but leave the hit table.
+    mLayoutDirty = true;
+}
+
+void UiScreen::setValue(WidgetId id, int value) {
+    if (id < 0 || id >= static_cast<WidgetId>(mWidgets.size())) return;
+    Widget& widget = mWidgets[id];
+    widget.value = std::max(widget.minValue, std::min(widget.maxValue, value));
+}
+
+int UiScreen::getValue(WidgetId id) const {
+    if (id < 0 || id >= static_cast<WidgetId>(mWidgets.size())) return 0;
+    return mWidgets[id].value;
+}
+
+int UiScreen::click(int x, int y) {
+    prepare();
+    SDL_Point point = { x, y };
+    for (const HitRegion& region : mHitRegions) {
+        if (!SDL_PointInRect(&point, &region.rect)) continue;
+        if (region.step == 0) return region.action;
+        Widget& widget = mWidgets[region.widget];
+        int value = widget.value + region.step;
+        if (value < widget.minValue || value > widget.maxValue) return NO_ACTION;
+        widget.value = value;
+        return region.action;
+    }
+    return NO_ACTION;
+}
+
+void UiScreen::prepare() {
+    for (auto& widget : mWidgets) {
+        if (!widget.textDirty) continue;
+        int oldWidth = widget.texture ? widget.texture->width : -1;
+        int oldHeight = widget.texture ? widget.texture->height : -1;
+        if (widget.texture) mRenderer->destroyTexture(widget.texture);
+        widget.texture = widget.text.empty() ? nullptr : renderText(widget.text, widget.color, widget.font);
+        widget.textDirty = false;
+        int newWidth = widget.texture ? widget.texture->width : -1;
+        int newHeight = widget.texture ? widget.texture->height : -1;
+        if (newWidth != oldWidth || newHeight != oldHeight) mLayoutDirty = true;
+    }
+    if (mLayoutDirty) layout();
+}
+
+void UiScreen::layout() {
+    mHitRegions.clear();
+    for (size_t i = 0; i < mWidgets.size(); ++i) {
+        Widget& widget = mWidgets[i];
+        int width = 0;
+        int height = 0;
+        if (widget.kind == WidgetKind::STEPPER) {
+            width = 2 * widget.buttonSize + 2 * STEPPER_PADDING + widget.slotWidth;
+            height = widget.buttonSize;
+            for (Texture* texture : widget.valueTextures) {
+                if (texture) height = std::max(height, texture->height);
+            }
+        }
+        else {
+            Renderer::queryTexture(widget.texture, &width, &height);
+        }
+
+        int top = widget.below != NO_WIDGET ? mWidgets[widget.below].rect.y + mWidgets[widget.below].rect.h : 0;
+        widget.rect.w = width;
+        widget.rect.h = height;
+        widget.rect.x = widget.alignX == UiAlign::START ? widget.x
+            : widget.alignX == UiAlign::CENTER ? widget.x - width / 2 : widget.x - width;
+        widget.rect.y = top + (widget.alignY == UiAlign::START ? widget.y
+            : widget.alignY == UiAlign::CENTER ? widget.y - height / 2 : widget.y - height);
+
+        if (widget.kind == WidgetKind::STEPPER) layoutStepper(widget);
+        if (!widget.visible) continue;
+        WidgetId id = static_cast<WidgetId>(i);
+        if (widget.kind == WidgetKind::BUTTON) {
+            mHitRegions.push_back({ widget.rect, id, widget.action, 0 });
+        }
+        else if (widget.kind == WidgetKind::STEPPER) {
+            mHitRegions.push_back({ widget.decreaseRect, id, widget.decreaseAction, -1 });
+            mHitRegions.push_back({ widget.increaseRect, id, widget.increaseAction, 1 });
+        }
+    }
+    mLayoutDirty = false;
+}
+
+void UiScreen::layoutStepper(Widget& widget) {
+    const SDL_Rect& rect = widget.rect;
+    widget.decreaseRect = { rect.x, rect.y, widget.buttonSize, widget.buttonSize };
+    widget.valueRect = { rect.x + widget.buttonSize + STEPPER_PADDING, rect.y, widget.slotWidth, rect.h };
+    widget.increaseRect = { widget.valueRect.x + widget.slotWidth + STEPPER_PADDING, rect.y, widget.buttonSize, widget.buttonSize };
+}
+
+void UiScreen::render() {
+    if (!mRenderer) return;
+    prepare();
+    for (const auto& widget : mWidgets) {
+        if (!widget.visible) continue;
+        if (widget.kind != WidgetKind::STEPPER) {
+            if (widget.texture) mRenderer->copy(widget.texture, nullptr, &widget.rect);
+            continue;
+        }
+        // Glyphs are drawn at their own size, centred in their slots.
+        const SDL_Rect* slots[] = { &widget.decreaseRect, &widget.valueRect, &widget.increaseRect };
+        Texture* textures[] = { widget.decreaseTexture, widget.valueTextures[widget.value - widget.minValue], widget.increaseTexture };
+        for (int part = 0; part < 3; ++part) {
+            if (!textures[part]) continue;
+            const SDL_Rect& slot = *slots[part];
+            SDL_Rect destRect = { slot.x + (slot.w - textures[part]->width) / 2, slot.y + (slot.h - textures[part]->height) / 2,
+                textures[part]->width, textures[part]->height };
+            mRenderer->copy(textures[part], nullptr, &destRect);
+        }
+    }
+}
+
+Texture* UiScreen::renderText(const std::string& text, SDL_Color color, TTF_Font* font) {
+    if (!font || !mRenderer) {
+        std::cerr << "UiScreen Error: Cannot create text texture, font or renderer is null. Text: " << text << std::endl;
+        return nullptr;
+    }
+    SDL_Surface* surface = TTF_RenderText_Solid(font, text.c_str(), color);
+    if (!surface) {
+        std::cerr << "UiScreen Error: TTF_RenderText_Solid failed for \"" << text << "\". TTF_Error: " << TTF_GetError() << std::endl;
+        return nullptr;
+    }
+    Texture* texture = mRenderer->createTextureFromSurface(surface);
+    SDL_FreeSurface(surface);
+    if (!texture) {
+        std::cerr << "UiScreen Error: SDL_CreateTextureFromSurface failed for \"" << text << "\". SDL_Error: " << SDL_GetError() << std::endl;
+    }
+    return texture;
+}
+
+Texture* UiScreen::sharedText(const std::string& text, SDL_Color color, TTF_Font* font) {
+    for (const auto& shared : mSharedTexts) {
+        if (shared.font == font && shared.text == text && shared.color.r == color.r && shared.color.g == color.g
+            && shared.color.b == color.b && shared.color.a == color.a) {
+            return shared.texture;
+        }
+    }
+    Texture* texture = renderText(text, color, font);
+    mSharedTexts.push_back({ text, color, font, texture });
+    return texture;
+}
@@ -0,0 +1,134 @@
+#ifndef UI_SCREEN_H
+#define UI_SCREEN_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include "Renderer.h"
+#include <string>
+#include <vector>
+
+enum class UiAlign {
+    START,
+    CENTER,
+    END
+};
+
+// Retained widgets for one screen: labels, buttons and steppers are created
+// once, laid out once and drawn from cached textures every frame. A widget's
+// text is only re-rendered when setText() actually changes it, and stepper
+// values are pre-rendered for their whole range (shared between steppers), so
+// clicking through a menu never creates or destroys a texture.
+//
+// Actions are the caller's enum values cast to int; 0 is reserved for "no
+// action", which is what the NONE member of every menu action enum is.
+class UiScreen {
+public:
+    using WidgetId = int;
+    static const WidgetId NO_WIDGET = -1;
+    static const int NO_ACTION = 0;
+
+    // `font` is used by every widget that is not given one of its own.
+    UiScreen(Renderer* renderer, TTF_Font* font);
+    ~UiScreen();
+
+    UiScreen(const UiScreen&) = delete;
+    UiScreen& operator=(const UiScreen&) = delete;
+
+    WidgetId addLabel(const std::string& text, SDL_Color color, TTF_Font* font = nullptr);
+    WidgetId addButton(const std::string& text, SDL_Color color, int action, TTF_Font* font = nullptr);
+    // "- value +" with a value slot as wide as the widest value in range.
+    WidgetId addStepper(int value, int minValue, int maxValue, SDL_Color valueColor, SDL_Color buttonColor,
+        int decreaseAction, int increaseAction);
+
+    // Puts the widget's alignX/alignY edge or centre at (x, y). With `below`,
+    // y is measured down from the bottom of that earlier widget instead of
+    // from the top of the screen.
+    void place(WidgetId id, int x, int y, UiAlign alignX = UiAlign::CENTER, UiAlign alignY = UiAlign::START,
+        WidgetId below = NO_WIDGET);
+
+    void setText(WidgetId id, const std::string& text);
+    void setVisible(WidgetId id, bool visible);
+    void setValue(WidgetId id, int value);
+    int getValue(WidgetId id) const;
+
+    // Looks the point up in the hit table built by the last layout. A stepper
+    // half only reports its action if it moved the value.
+    int click(int x, int y);
+
+    // Re-renders dirty widgets, lays out again if any size changed and draws.
+    void render();
+
+private:
+    enum class WidgetKind {
+        LABEL,
+        BUTTON,
+        STEPPER
+    };
+
+    struct Widget {
+        WidgetKind kind;
+        std::string text;
+        SDL_Color color;
+        TTF_Font* font;
+        Texture* texture = nullptr;
+        bool textDirty = true;
+        bool visible = true;
+
+        int x = 0;
+        int y = 0;
+        UiAlign alignX = UiAlign::CENTER;
+        UiAlign alignY = UiAlign::START;
+        WidgetId below = NO_WIDGET;
+        SDL_Rect rect = { 0, 0, 0, 0 };
+
+        int action = NO_ACTION;
+
+        // Steppers: textures index the shared text cache, one per value.
+        int value = 0;
+        int minValue = 0;
+        int maxValue = 0;
+        int decreaseAction = NO_ACTION;
+        int increaseAction = NO_ACTION;
+        Texture* decreaseTexture = nullptr;
+        Texture* increaseTexture = nullptr;
+        std::vector<Texture*> valueTextures;
+        int slotWidth = 0;
+        int buttonSize = 0;
+        SDL_Rect decreaseRect = { 0, 0, 0, 0 };
+        SDL_Rect valueRect = { 0, 0, 0, 0 };
+        SDL_Rect increaseRect = { 0, 0, 0, 0 };
+    };
+
+    struct HitRegion {
+        SDL_Rect rect;
+        WidgetId widget;
+        int action;
+        int step;
+    };
+
+    struct SharedText {
+        std::string text;
+        SDL_Color color;
+        TTF_Font* font;
+        Texture* texture;
+    };
+
+    static const int STEPPER_PADDING = 10;
+
+    Renderer* mRenderer;
+    TTF_Font* mFont;
+    std::vector<Widget> mWidgets;
+    std::vector<HitRegion> mHitRegions;
+    std::vector<SharedText> mSharedTexts;
+    bool mLayoutDirty;
+
+    WidgetId addWidget(WidgetKind kind, const std::string& text, SDL_Color color, TTF_Font* font);
+    Texture* renderText(const std::string& text, SDL_Color color, TTF_Font* font);
+    Texture* sharedText(const std::string& text, SDL_Color color, TTF_Font* font);
+    // Brings textures, rects and the hit table up to date.
+    void prepare();
+    void layout();
+    void layoutStepper(Widget& widget);
+};
+
+#endif // UI_SCREEN_H
@@ -0,0 +1,142 @@
+#include "VecEnv.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    const uint8_t ACTION_BUTTONS[VecEnv::ACTION_COUNT] = { 0, INPUT_UP, INPUT_DOWN, INPUT_LEFT, INPUT_RIGHT, INPUT_BOMB };
+    const uint64_t BOT_SEED_SALT = 0xE7B07ull;
+
+    // Plane value of a bomb `age` ticks into its fuse.
+    uint8_t fuseLevel(int age) {
+        int level = 1 + age * 254 / Bomb::DEFAULT_FUSE_TICKS;
+        return static_cast<uint8_t>(std::min(255, level));
+    }
+}
+
+const float VecEnv::REWARD_PER_POINT = 0.01f;
+const float VecEnv::DEATH_REWARD = -1.0f;
+
+VecEnv::VecEnv()
+    : mEpisodeCount(0),
+    mTickCount(0)
+{
+}
+
+bool VecEnv::reset(const VecEnvConfig& config, const uint64_t* seeds) {
+    if (config.envCount <= 0 || config.frameSkip <= 0) {
+        std::cerr << "VecEnv Error: envCount and frameSkip must be positive." << std::endl;
+        return false;
+    }
+    mConfig = config;
+    mEnvs.resize(static_cast<size_t>(config.envCount));
+    mObservations.assign(mEnvs.size() * getObservationSize(), 0);
+    mRewards.assign(mEnvs.size(), 0.0f);
+    mDones.assign(mEnvs.size(), 0);
+    mEpisodeScores.assign(mEnvs.size(), 0);
+    mEpisodeCount = 0;
+    mTickCount = 0;
+
+    for (size_t i = 0; i < mEnvs.size(); ++i) {
+        if (!startEpisode(mEnvs[i], seeds ? seeds[i] : config.match.seed + i)) {
+            mEnvs.clear();
+            return false;
+        }
+        observe(static_cast<int>(i));
+    }
+    return true;
+}
+
+bool VecEnv::startEpisode(Env& env, uint64_t seed) {
+    MatchConfig match = mConfig.match;
+    match.seed = seed;
+    if (!env.simulation.reset(match)) return false;
+    env.seed = seed;
+    env.botRng.reseed(seed ^ BOT_SEED_SALT);
+    for (auto& bot : env.bots) bot = RandomBot();
+    env.lastScore = 0;
+    return true;
+}
+
+void VecEnv::step(const int32_t* actions) {
+    TickInput input;
+    for (size_t i = 0; i < mEnvs.size(); ++i) {
+        Env& env = mEnvs[i];
+        Simulation& simulation = env.simulation;
+        int action = actions[i] >= 0 && actions[i] < ACTION_COUNT ? actions[i] : ACTION_IDLE;
+        float reward = 0.0f;
+        bool done = false;
+        for (int tick = 0; tick < mConfig.frameSkip && !done; ++tick) {
+            input.buttons[0] = tick == 0 ? ACTION_BUTTONS[action] : ACTION_BUTTONS[action] & ~INPUT_BOMB;
+            for (int p = 1; p < mConfig.match.playerCount; ++p) input.buttons[p] = env.bots[p].nextButtons(env.botRng);
+            simulation.step(input);
+            ++mTickCount;
+
+            int score = simulation.getScore(0);
+            reward += (score - env.lastScore) * REWARD_PER_POINT;
+            env.lastScore = score;
+            if (!simulation.getPlayers()[0].isAlive()) {
+                reward += DEATH_REWARD;
+                done = true;
+            }
+            done = done || simulation.isOver();
+        }
+
+        mRewards[i] = reward;
+        mDones[i] = done ? 1 : 0;
+        if (done) {
+            mEpisodeScores[i] = env.lastScore;
+            ++mEpisodeCount;
+            startEpisode(env, env.seed + mEnvs.size());
+        }
+        observe(static_cast<int>(i));
+    }
+}
+
+void VecEnv::observe(int envIndex) {
+    const Simulation& simulation = mEnvs[envIndex].simulation;
+    const Map& map = simulation.getMap();
+    int rows = getRows();
+    int columns = getColumns();
+    int tileSize = map.getTileSize();
+    size_t planeSize = static_cast<size_t>(rows) * columns;
+    uint8_t* observation = mObservations.data() + envIndex * getObservationSize();
+    std::memset(observation, 0, getObservationSize());
+
+    uint8_t* walls = observation + PLANE_WALLS * planeSize;
+    uint8_t* softWalls = observation + PLANE_SOFT_WALLS * planeSize;
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < columns; ++col) {
+            TileType type = map.getTileType(row, col);
+            walls[row * columns + col] = type == TileType::HARD_WALL || type == TileType::BORDER_WALL;
+            softWalls[row * columns + col] = type == TileType::SOFT_WALL;
+        }
+    }
+
+    // Entities mark the tile under their centre.
+    auto tileOf = [&](int x, int y, int width, int height) {
+        int row = std::max(0, std::min(rows - 1, (y + height / 2) / tileSize));
+        int col = std::max(0, std::min(columns - 1, (x + width / 2) / tileSize));
+        return static_cast<size_t>(row) * columns + col;
+    };
+    const std::vector<Player>& players = simulation.getPlayers();
+    for (size_t p = 0; p < players.size(); ++p) {
+        const Player& player = players[p];
+        if (!player.isAlive()) continue;
+        Plane plane = p == 0 ? PLANE_SELF : PLANE_OPPONENTS;
+        observation[plane * planeSize + tileOf(player.getX(), player.getY(), player.getWidth(), player.getHeight())] = 1;
+    }
+    for (const auto& enemy : simulation.getEnemies()) {
+        observation[PLANE_ENEMIES * planeSize + tileOf(enemy.getX(), enemy.getY(), enemy.getWidth(), enemy.getHeight())] = 1;
+    }
+    for (const auto& bomb : simulation.getBombs()) {
+        if (bomb.isDone()) continue;
+        if (!bomb.isExploding()) {
+            observation[PLANE_BOMBS * planeSize + tileOf(bomb.getX(), bomb.getY(), bomb.getSize(), bomb.getSize())] = fuseLevel(bomb.getAgeTicks());
+            continue;
+        }
+        for (const auto& part : bomb.getExplosion()) {
+            observation[PLANE_BLASTS * planeSize + tileOf(part.x, part.y, tileSize, tileSize)] = 1;
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef VEC_ENV_H
+#define VEC_ENV_H
+
+#include <cstdint>
+#include <vector>
+#include "Simulation.h"
+#include "BatchRunner.h"
+
+struct VecEnvConfig {
+    // Every environment plays this match; its seed is replaced per episode.
+    MatchConfig match;
+    int envCount = 16;
+    // Ticks each action is held for. A bomb is pressed on the first only.
+    int frameSkip = 4;
+};
+
+// N independent matches stepped together for training agents, with no
+// rendering. The agent plays player 0 in each; other players are RandomBots.
+// The environments live in one array and their observations in one
+// contiguous buffer, laid out [env][plane][row][col], one byte per tile, so a
+// caller can hand it to a tensor library without copying.
+//
+// An environment whose episode ends is reset straight away with its seed
+// advanced by envCount, so every step returns a usable observation and a
+// batch never waits on its slowest episode. The done flag marks the step
+// that ended the episode; its observation is already the next episode's.
+//
+// A VecEnv is single-threaded. Run one per core to use more.
+class VecEnv {
+public:
+    enum Action {
+        ACTION_IDLE,
+        ACTION_UP,
+        ACTION_DOWN,
+        ACTION_LEFT,
+        ACTION_RIGHT,
+        ACTION_BOMB,
+        ACTION_COUNT
+    };
+
+    enum Plane {
+        // Hard and border walls.
+        PLANE_WALLS,
+        PLANE_SOFT_WALLS,
+        PLANE_SELF,
+        PLANE_OPPONENTS,
+        PLANE_ENEMIES,
+        // Pending bombs, rising from 1 towards 255 as the fuse burns.
+        PLANE_BOMBS,
+        PLANE_BLASTS,
+        PLANE_COUNT
+    };
+
+    // Reward per point scored, and taken once when the agent dies.
+    static const float REWARD_PER_POINT;
+    static const float DEATH_REWARD;
+
+    VecEnv();
+
+    // Starts environment i with seeds[i], or with match.seed + i when seeds
+    // is null. Returns false if the match config is invalid.
+    bool reset(const VecEnvConfig& config, const uint64_t* seeds = nullptr);
+
+    // Advances every environment by one action, actions[i] for environment
+    // i; out-of-range actions idle.
+    void step(const int32_t* actions);
+
+    int getEnvCount() const { return static_cast<int>(mEnvs.size()); }
+    int getRows() const { return mConfig.match.rows; }
+    int getColumns() const { return mConfig.match.columns; }
+    size_t getObservationSize() const { return static_cast<size_t>(PLANE_COUNT) * getRows() * getColumns(); }
+
+    const uint8_t* getObservations() const { return mObservations.data(); }
+    const float* getRewards() const { return mRewards.data(); }
+    const uint8_t* getDones() const { return mDones.data(); }
+    // Score of each environment's most recently finished episode.
+    const int32_t* getEpisodeScores() const { return mEpisodeScores.data(); }
+    long long getEpisodeCount() const { return mEpisodeCount; }
+    long long getTickCount() const { return mTickCount; }
+    const Simulation& getSimulation(int env) const { return mEnvs[env].simulation; }
+
+private:
+    struct Env {
+        Simulation simulation;
+        Rng botRng;
+        RandomBot bots[MAX_PLAYERS];
+        uint64_t seed = 0;
+        int lastScore = 0;
+    };
+
+    VecEnvConfig mConfig;
+    std::vector<Env> mEnvs;
+    std::vector<uint8_t> mObservations;
+    std::vector<float> mRewards;
+    std::vector<uint8_t> mDones;
+    std::vector<int32_t> mEpisodeScores;
+    long long mEpisodeCount;
+    long long mTickCount;
+
+    bool startEpisode(Env& env, uint64_t seed);
+    void observe(int env);
+};
+
+#endif // VEC_ENV_H
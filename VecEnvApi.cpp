@@ -0,0 +1,94 @@
+#include "VecEnvApi.h"
+#include "VecEnv.h"
+#include <new>
+
+struct BombermanEnv {
+    VecEnvConfig config;
+    VecEnv env;
+};
+
+namespace {
+    VecEnvConfig toVecEnvConfig(const BombermanEnvConfig& config) {
+        VecEnvConfig result;
+        result.envCount = config.envCount;
+        result.frameSkip = config.frameSkip;
+        result.match.columns = config.columns;
+        result.match.rows = config.rows;
+        result.match.playerCount = config.playerCount;
+        result.match.enemyCount = config.enemyCount;
+        result.match.maxActiveBombs = config.maxActiveBombs;
+        result.match.bombRange = config.bombRange;
+        result.match.matchTicks = config.matchTicks;
+        result.match.seed = config.seed;
+        return result;
+    }
+}
+
+void bomberman_env_default_config(BombermanEnvConfig* config) {
+    if (!config) return;
+    VecEnvConfig defaults;
+    config->envCount = defaults.envCount;
+    config->columns = defaults.match.columns;
+    config->rows = defaults.match.rows;
+    config->playerCount = defaults.match.playerCount;
+    config->enemyCount = defaults.match.enemyCount;
+    config->maxActiveBombs = defaults.match.maxActiveBombs;
+    config->bombRange = defaults.match.bombRange;
+    config->matchTicks = defaults.match.matchTicks;
+    config->frameSkip = defaults.frameSkip;
+    config->seed = defaults.match.seed;
+}
+
+BombermanEnv* bomberman_env_create(const BombermanEnvConfig* config) {
+    if (!config) return nullptr;
+    BombermanEnv* env = new (std::nothrow) BombermanEnv();
+    if (!env) return nullptr;
+    env->config = toVecEnvConfig(*config);
+    if (!env->env.reset(env->config)) {
+        delete env;
+        return nullptr;
+    }
+    return env;
+}
+
+void bomberman_env_destroy(BombermanEnv* env) {
+    delete env;
+}
+
+int bomberman_env_reset(BombermanEnv* env, const uint64_t* seeds) {
+    return env && env->env.reset(env->config, seeds) ? 1 : 0;
+}
+
+void bomberman_env_step(BombermanEnv* env, const int32_t* actions) {
+    if (env && actions) env->env.step(actions);
+}
+
+int32_t bomberman_env_count(const BombermanEnv* env) {
+    return env ? env->env.getEnvCount() : 0;
+}
+
+int32_t bomberman_env_action_count(void) {
+    return VecEnv::ACTION_COUNT;
+}
+
+void bomberman_env_observation_shape(const BombermanEnv* env, int32_t shape[3]) {
+    shape[0] = VecEnv::PLANE_COUNT;
+    shape[1] = env ? env->env.getRows() : 0;
+    shape[2] = env ? env->env.getColumns() : 0;
+}
+
+const uint8_t* bomberman_env_observations(const BombermanEnv* env) {
+    return env ? env->env.getObservations() : nullptr;
+}
+
+const float* bomberman_env_rewards(const BombermanEnv* env) {
+    return env ? env->env.getRewards() : nullptr;
+}
+
+const uint8_t* bomberman_env_dones(const BombermanEnv* env) {
+    return env ? env->env.getDones() : nullptr;
+}
+
+const int32_t* bomberman_env_episode_scores(const BombermanEnv* env) {
+    return env ? env->env.getEpisodeScores() : nullptr;
+}
@@ -0,0 +1,65 @@
+#ifndef VEC_ENV_API_H
+#define VEC_ENV_API_H
+
+/* C entry points for VecEnv, for loading the environment from Python (ctypes,
+ * cffi) or any other language with a C FFI. Built as the bomberman_env
+ * shared library. Buffers returned by the getters belong to the environment
+ * and stay valid until the next reset or destroy; observations are laid out
+ * [env][plane][row][col], one byte per tile. */
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define BOMBERMAN_ENV_API __declspec(dllexport)
+#else
+#define BOMBERMAN_ENV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct BombermanEnv BombermanEnv;
+
+typedef struct BombermanEnvConfig {
+    int32_t envCount;
+    int32_t columns;
+    int32_t rows;
+    int32_t playerCount;
+    int32_t enemyCount;
+    int32_t maxActiveBombs;
+    int32_t bombRange;
+    /* Match length in ticks; an episode ends at the latest here. */
+    int32_t matchTicks;
+    int32_t frameSkip;
+    uint64_t seed;
+} BombermanEnvConfig;
+
+/* Fills `config` with the defaults of the 800x600 game. */
+BOMBERMAN_ENV_API void bomberman_env_default_config(BombermanEnvConfig* config);
+
+/* Returns null if the config is invalid. */
+BOMBERMAN_ENV_API BombermanEnv* bomberman_env_create(const BombermanEnvConfig* config);
+BOMBERMAN_ENV_API void bomberman_env_destroy(BombermanEnv* env);
+
+/* Restarts every environment, environment i with seeds[i], or with the
+ * config's seed + i when seeds is null. Returns 0 on failure. */
+BOMBERMAN_ENV_API int bomberman_env_reset(BombermanEnv* env, const uint64_t* seeds);
+/* One action per environment: 0 idle, 1-4 up/down/left/right, 5 bomb. */
+BOMBERMAN_ENV_API void bomberman_env_step(BombermanEnv* env, const int32_t* actions);
+
+BOMBERMAN_ENV_API int32_t bomberman_env_count(const BombermanEnv* env);
+BOMBERMAN_ENV_API int32_t bomberman_env_action_count(void);
+/* Observation shape of one environment: planes x rows x columns. */
+BOMBERMAN_ENV_API void bomberman_env_observation_shape(const BombermanEnv* env, int32_t shape[3]);
+
+BOMBERMAN_ENV_API const uint8_t* bomberman_env_observations(const BombermanEnv* env);
+BOMBERMAN_ENV_API const float* bomberman_env_rewards(const BombermanEnv* env);
+BOMBERMAN_ENV_API const uint8_t* bomberman_env_dones(const BombermanEnv* env);
+BOMBERMAN_ENV_API const int32_t* bomberman_env_episode_scores(const BombermanEnv* env);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VEC_ENV_API_H */
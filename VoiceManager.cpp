@@ -0,0 +1,190 @@
+#include "VoiceManager.h"
+#include "Counters.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+const float VoiceManager::MAX_COALESCED_GAIN = 2.0f;
+
+VoiceManager::VoiceManager(VoiceBackend& backend)
+    : mBackend(backend),
+    mVoices(static_cast<size_t>(std::max(0, backend.getChannelCount()))),
+    mHead(0),
+    mTail(0),
+    mTriggers(0),
+    mCoalesced(0),
+    mStarted(0),
+    mStolen(0),
+    mDropped(0),
+    mMaxPlaying(0),
+    mPlayingCount(0),
+    mRunning(false)
+{
+}
+
+VoiceManager::~VoiceManager() {
+    stop();
+    stopVoices();
+}
+
+void VoiceManager::setSound(int sound, const SoundSettings& settings) {
+    if (sound < 0 || sound >= MAX_SOUNDS) return;
+    mSounds[sound] = settings;
+}
+
+bool VoiceManager::push(const Command& command) {
+    uint32_t tail = mTail.load(std::memory_order_relaxed);
+    if (tail - mHead.load(std::memory_order_acquire) >= static_cast<uint32_t>(QUEUE_SIZE)) {
+        mDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    mQueue[tail & (QUEUE_SIZE - 1)] = command;
+    mTail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool VoiceManager::trigger(int sound, float gain) {
+    if (sound < 0 || sound >= MAX_SOUNDS) return false;
+    mTriggers.fetch_add(1, std::memory_order_relaxed);
+    COUNTER_ADD(Counter::SOUND_TRIGGERS, 1);
+    return push({ CommandType::PLAY, static_cast<uint8_t>(sound), gain });
+}
+
+void VoiceManager::stopAll() {
+    push({ CommandType::STOP_ALL, 0, 0.0f });
+}
+
+void VoiceManager::process(uint32_t nowMs) {
+    for (size_t channel = 0; channel < mVoices.size(); ++channel) {
+        if (mVoices[channel].sound >= 0 && !mBackend.isPlaying(static_cast<int>(channel))) mVoices[channel].sound = -1;
+    }
+
+    uint32_t head = mHead.load(std::memory_order_relaxed);
+    uint32_t tail = mTail.load(std::memory_order_acquire);
+    for (; head != tail; ++head) {
+        const Command& command = mQueue[head & (QUEUE_SIZE - 1)];
+        if (command.type == CommandType::PLAY) play(command.sound, command.gain, nowMs);
+        else stopVoices();
+    }
+    mHead.store(head, std::memory_order_release);
+
+    int playing = 0;
+    for (const auto& voice : mVoices) {
+        if (voice.sound >= 0) ++playing;
+    }
+    mPlayingCount.store(playing, std::memory_order_relaxed);
+    if (playing > mMaxPlaying.load(std::memory_order_relaxed)) mMaxPlaying.store(playing, std::memory_order_relaxed);
+    Counters::set(Counter::VOICES_PLAYING, static_cast<uint64_t>(playing));
+}
+
+void VoiceManager::play(int sound, float gain, uint32_t nowMs) {
+    const SoundSettings& settings = mSounds[sound];
+    int latest = -1;
+    for (size_t channel = 0; channel < mVoices.size(); ++channel) {
+        const Voice& voice = mVoices[channel];
+        if (voice.sound == sound && (latest < 0 || voice.startMs > mVoices[latest].startMs)) {
+            latest = static_cast<int>(channel);
+        }
+    }
+    if (latest >= 0 && nowMs - mVoices[latest].startMs <= static_cast<uint32_t>(settings.coalesceMs)) {
+        Voice& voice = mVoices[latest];
+        voice.gain += gain;
+        mBackend.setVolume(latest, volumeOf(voice));
+        mCoalesced.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    int channel = findChannel(sound, settings.priority);
+    if (channel < 0) {
+        mDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (mVoices[channel].sound >= 0) mStolen.fetch_add(1, std::memory_order_relaxed);
+    startVoice(channel, sound, gain, nowMs);
+}
+
+// At its cap a sound gives up its own oldest voice. Otherwise a free channel
+// is used, and failing that the oldest voice of the lowest priority that
+// does not outrank the new one.
+int VoiceManager::findChannel(int sound, int priority) {
+    int sameSound = 0;
+    int oldestSame = -1;
+    int freeChannel = -1;
+    int victim = -1;
+    for (size_t index = 0; index < mVoices.size(); ++index) {
+        int channel = static_cast<int>(index);
+        const Voice& voice = mVoices[index];
+        if (voice.sound < 0) {
+            if (freeChannel < 0) freeChannel = channel;
+            continue;
+        }
+        if (voice.sound == sound) {
+            ++sameSound;
+            if (oldestSame < 0 || voice.startMs < mVoices[oldestSame].startMs) oldestSame = channel;
+        }
+        if (voice.priority > priority) continue;
+        if (victim < 0 || voice.priority < mVoices[victim].priority
+            || (voice.priority == mVoices[victim].priority && voice.startMs < mVoices[victim].startMs)) {
+            victim = channel;
+        }
+    }
+    if (sameSound >= std::max(1, mSounds[sound].maxVoices)) return oldestSame;
+    return freeChannel >= 0 ? freeChannel : victim;
+}
+
+void VoiceManager::startVoice(int channel, int sound, float gain, uint32_t nowMs) {
+    Voice& voice = mVoices[channel];
+    voice.sound = sound;
+    voice.priority = mSounds[sound].priority;
+    voice.startMs = nowMs;
+    voice.gain = gain;
+    if (!mBackend.play(channel, sound, volumeOf(voice))) {
+        voice.sound = -1;
+        mDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    mStarted.fetch_add(1, std::memory_order_relaxed);
+    COUNTER_ADD(Counter::VOICES_STARTED, 1);
+}
+
+int VoiceManager::volumeOf(const Voice& voice) const {
+    float scale = std::min(std::sqrt(std::max(0.0f, voice.gain)), MAX_COALESCED_GAIN);
+    int volume = static_cast<int>(mSounds[voice.sound].volume * scale * MAX_VOLUME + 0.5f);
+    return std::max(0, std::min(MAX_VOLUME, volume));
+}
+
+void VoiceManager::stopVoices() {
+    for (size_t channel = 0; channel < mVoices.size(); ++channel) {
+        if (mVoices[channel].sound < 0) continue;
+        mBackend.stop(static_cast<int>(channel));
+        mVoices[channel].sound = -1;
+    }
+}
+
+void VoiceManager::start(int intervalMs) {
+    if (mRunning.exchange(true)) return;
+    mThread = std::thread([this, intervalMs]() {
+        std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+        while (mRunning.load(std::memory_order_acquire)) {
+            std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - origin;
+            process(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()));
+            std::this_thread::sleep_for(std::chrono::milliseconds(std::max(1, intervalMs)));
+        }
+    });
+}
+
+void VoiceManager::stop() {
+    if (!mRunning.exchange(false)) return;
+    if (mThread.joinable()) mThread.join();
+}
+
+VoiceStats VoiceManager::getStats() const {
+    VoiceStats stats;
+    stats.triggers = mTriggers.load(std::memory_order_relaxed);
+    stats.coalesced = mCoalesced.load(std::memory_order_relaxed);
+    stats.started = mStarted.load(std::memory_order_relaxed);
+    stats.stolen = mStolen.load(std::memory_order_relaxed);
+    stats.dropped = mDropped.load(std::memory_order_relaxed);
+    stats.maxPlaying = mMaxPlaying.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,139 @@
+#ifndef VOICE_MANAGER_H
+#define VOICE_MANAGER_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Playback side of a VoiceManager: a fixed set of mixer channels, each
+// playing at most one sound. MixerVoiceBackend implements it over SDL_mixer.
+class VoiceBackend {
+public:
+    virtual ~VoiceBackend() = default;
+
+    virtual int getChannelCount() const = 0;
+    // Starts `sound` on `channel` at `volume` (0 to VoiceManager::MAX_VOLUME),
+    // replacing whatever it played. Returns false if the sound is not loaded.
+    virtual bool play(int channel, int sound, int volume) = 0;
+    virtual void setVolume(int channel, int volume) = 0;
+    virtual void stop(int channel) = 0;
+    virtual bool isPlaying(int channel) const = 0;
+};
+
+struct SoundSettings {
+    // Voices of this sound that may play at once; a new one past the cap
+    // replaces the oldest.
+    int maxVoices = 4;
+    // Triggers this soon after a voice of the same sound started join it
+    // instead of starting another.
+    int coalesceMs = 50;
+    // When every channel is busy, a new voice steals the oldest voice of the
+    // lowest priority no higher than its own.
+    int priority = 0;
+    // Volume of one trigger, 0 to 1. Coalesced voices grow up to
+    // MAX_COALESCED_GAIN times louder, clipped at full volume.
+    float volume = 0.5f;
+};
+
+struct VoiceStats {
+    uint64_t triggers = 0;
+    uint64_t coalesced = 0;
+    uint64_t started = 0;
+    uint64_t stolen = 0;
+    // Triggers lost to a full queue or to busier, higher-priority voices.
+    uint64_t dropped = 0;
+    int maxPlaying = 0;
+};
+
+// Decides which sound triggers become voices, so the cost of mixing stays
+// bounded however many bombs go off. A chain reaction fires dozens of the same
+// explosion in one frame; they coalesce into a single voice whose volume grows
+// with the square root of the summed gain, up to MAX_COALESCED_GAIN.
+//
+// The game thread only calls trigger(), which writes a command into a
+// single-producer, single-consumer ring and never blocks. process() drains it
+// and makes every backend call, on the thread start() runs or on whichever one
+// thread calls it directly, so the game thread never waits on the mixer's lock.
+class VoiceManager {
+public:
+    static const int MAX_SOUNDS = 16;
+    static const int MAX_VOLUME = 128;
+    // Commands between two process() calls; more are dropped. A power of two.
+    static const int QUEUE_SIZE = 256;
+    static const float MAX_COALESCED_GAIN;
+
+    explicit VoiceManager(VoiceBackend& backend);
+    // Stops the thread and every voice.
+    ~VoiceManager();
+
+    VoiceManager(const VoiceManager&) = delete;
+    VoiceManager& operator=(const VoiceManager&) = delete;
+
+    // Set up sounds before triggering them or starting the thread.
+    void setSound(int sound, const SoundSettings& settings);
+
+    // Queues a sound from the producer thread. Returns false if the queue is
+    // full or the sound is out of range.
+    bool trigger(int sound, float gain = 1.0f);
+    // Queues a stop of every voice.
+    void stopAll();
+
+    // Applies queued commands at time `nowMs` and frees finished voices.
+    void process(uint32_t nowMs);
+
+    // Runs process() every intervalMs on a thread of its own until stop().
+    void start(int intervalMs = 5);
+    void stop();
+
+    VoiceStats getStats() const;
+    int getPlayingCount() const { return mPlayingCount.load(std::memory_order_relaxed); }
+
+private:
+    enum class CommandType : uint8_t {
+        PLAY,
+        STOP_ALL
+    };
+
+    struct Command {
+        CommandType type;
+        uint8_t sound;
+        float gain;
+    };
+
+    struct Voice {
+        int sound = -1;
+        int priority = 0;
+        uint32_t startMs = 0;
+        float gain = 0.0f;
+    };
+
+    VoiceBackend& mBackend;
+    SoundSettings mSounds[MAX_SOUNDS];
+    std::vector<Voice> mVoices;
+
+    Command mQueue[QUEUE_SIZE];
+    // mTail is written by the producer only and mHead by the consumer only.
+    std::atomic<uint32_t> mHead;
+    std::atomic<uint32_t> mTail;
+
+    std::atomic<uint64_t> mTriggers;
+    std::atomic<uint64_t> mCoalesced;
+    std::atomic<uint64_t> mStarted;
+    std::atomic<uint64_t> mStolen;
+    std::atomic<uint64_t> mDropped;
+    std::atomic<int> mMaxPlaying;
+    std::atomic<int> mPlayingCount;
+
+    std::thread mThread;
+    std::atomic<bool> mRunning;
+
+    bool push(const Command& command);
+    void play(int sound, float gain, uint32_t nowMs);
+    int findChannel(int sound, int priority);
+    void startVoice(int channel, int sound, float gain, uint32_t nowMs);
+    int volumeOf(const Voice& voice) const;
+    void stopVoices();
+};
+
+#endif // VOICE_MANAGER_H
@@ -0,0 +1,86 @@
+#include "WallSkeleton.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+    const Direction STEP_ORDER[4] = { UP, DOWN, LEFT, RIGHT };
+
+    // Hard walls stay clear of the tiles next to the border, so every lane
+    // along the edge is open.
+    bool isBlockedLane(int index, int count) {
+        return index >= 2 && index < count - 2 && index % 2 == 0;
+    }
+}
+
+WallSkeleton::WallSkeleton()
+    : mRows(0),
+    mColumns(0)
+{
+}
+
+void WallSkeleton::build(int columns, int rows) {
+    mRows = rows;
+    mColumns = columns;
+    mBlockedRows.resize(static_cast<size_t>(rows));
+    mBlockedColumns.resize(static_cast<size_t>(columns));
+    mBlockedRowsBefore.resize(static_cast<size_t>(rows) + 1);
+    mBlockedColumnsBefore.resize(static_cast<size_t>(columns) + 1);
+    mBlockedRowsBefore[0] = 0;
+    for (int row = 0; row < rows; ++row) {
+        mBlockedRows[row] = isBlockedLane(row, rows);
+        mBlockedRowsBefore[row + 1] = mBlockedRowsBefore[row] + mBlockedRows[row];
+    }
+    mBlockedColumnsBefore[0] = 0;
+    for (int col = 0; col < columns; ++col) {
+        mBlockedColumns[col] = isBlockedLane(col, columns);
+        mBlockedColumnsBefore[col + 1] = mBlockedColumnsBefore[col] + mBlockedColumns[col];
+    }
+}
+
+bool WallSkeleton::hasLaneBetween(const std::vector<int>& blockedBefore, int a, int b) {
+    if (a > b) std::swap(a, b);
+    return blockedBefore[b] - blockedBefore[a + 1] > 0;
+}
+
+int WallSkeleton::distance(TilePos from, TilePos to) const {
+    if (!isOpen(from.row, from.col) || !isOpen(to.row, to.col)) return -1;
+    int rows = std::abs(from.row - to.row);
+    int cols = std::abs(from.col - to.col);
+    // A hard wall sits where a blocked column crosses the blocked row. The
+    // lanes either side of a blocked one are open, so the detour is one step
+    // out and one step back.
+    if (rows == 0 && mBlockedRows[from.row] && hasLaneBetween(mBlockedColumnsBefore, from.col, to.col)) return cols + 2;
+    if (cols == 0 && mBlockedColumns[from.col] && hasLaneBetween(mBlockedRowsBefore, from.row, to.row)) return rows + 2;
+    return rows + cols;
+}
+
+TilePos WallSkeleton::step(TilePos tile, Direction direction) {
+    switch (direction) {
+    case UP:    return { tile.row - 1, tile.col };
+    case DOWN:  return { tile.row + 1, tile.col };
+    case LEFT:  return { tile.row, tile.col - 1 };
+    case RIGHT: return { tile.row, tile.col + 1 };
+    }
+    return tile;
+}
+
+int WallSkeleton::nextSteps(TilePos from, TilePos to, Direction directions[2]) const {
+    int remaining = distance(from, to);
+    if (remaining <= 0) return 0;
+    int count = 0;
+    for (Direction direction : STEP_ORDER) {
+        TilePos next = step(from, direction);
+        if (distance(next, to) == remaining - 1) {
+            directions[count++] = direction;
+            if (count == 2) break;
+        }
+    }
+    return count;
+}
+
+bool WallSkeleton::nextStep(TilePos from, TilePos to, Direction& direction) const {
+    Direction directions[2];
+    if (nextSteps(from, to, directions) == 0) return false;
+    direction = directions[0];
+    return true;
+}
@@ -0,0 +1,66 @@
+#ifndef WALL_SKELETON_H
+#define WALL_SKELETON_H
+
+#include <cstdint>
+#include <vector>
+#include "SimTypes.h"
+
+// The walls of a map that never change: the border ring, and a hard wall
+// wherever a blocked row crosses a blocked column (every even row and column
+// away from the border). It depends only on the map's dimensions.
+//
+// That structure makes shortest paths through the open tiles exact without a
+// search or per-pair table. Two open tiles are their Manhattan distance apart
+// unless they lie on the same blocked row or column with a hard wall between
+// them, where the path steps out to a neighbouring open lane and back, two
+// tiles more. So the whole table is a flag and a running count of blocked
+// lanes per row and per column, however big the map.
+//
+// Soft walls are not part of it: callers layer them on top, for instance by
+// only taking a next step whose tile is empty right now.
+class WallSkeleton {
+public:
+    WallSkeleton();
+
+    void build(int columns, int rows);
+
+    int getRows() const { return mRows; }
+    int getColumns() const { return mColumns; }
+
+    bool isBorder(int row, int col) const {
+        return row <= 0 || col <= 0 || row >= mRows - 1 || col >= mColumns - 1;
+    }
+    bool isHardWall(int row, int col) const {
+        return !isBorder(row, col) && mBlockedRows[row] && mBlockedColumns[col];
+    }
+    bool isOpen(int row, int col) const { return !isBorder(row, col) && !(mBlockedRows[row] && mBlockedColumns[col]); }
+
+    // Length in steps of the shortest path between two open tiles with every
+    // soft wall cleared; -1 if either is a wall.
+    int distance(TilePos from, TilePos to) const;
+
+    // The direction of the first step of a shortest path from `from` to `to`,
+    // trying UP, DOWN, LEFT, RIGHT in turn. Returns false if the tiles are
+    // equal or either is a wall.
+    bool nextStep(TilePos from, TilePos to, Direction& direction) const;
+
+    // Fills `directions` with every first step of a shortest path, in the same
+    // order, and returns how many there are (at most two).
+    int nextSteps(TilePos from, TilePos to, Direction directions[2]) const;
+
+    static TilePos step(TilePos tile, Direction direction);
+
+private:
+    int mRows;
+    int mColumns;
+    std::vector<uint8_t> mBlockedRows;
+    std::vector<uint8_t> mBlockedColumns;
+    // Blocked lanes before each index, so the hard walls on a lane between
+    // two tiles are counted with one subtraction.
+    std::vector<int> mBlockedRowsBefore;
+    std::vector<int> mBlockedColumnsBefore;
+
+    static bool hasLaneBetween(const std::vector<int>& blockedBefore, int a, int b);
+};
+
+#endif // WALL_SKELETON_H